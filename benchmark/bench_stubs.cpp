@@ -0,0 +1,66 @@
+#include "stdafx.h"
+#include "../main/Logger.h"
+#include "../main/WorkerServices.h"
+#include "../push/WebsocketPush.h"
+#include "../hardware/EvohomeBase.h"
+
+//Link time stand-ins for the application objects the benchmarked sources refer to.
+//The benchmarks run without the MainWorker, hardware and websocket push subscriptions,
+//so their calls do nothing here.
+
+CLogger _log;
+bool g_bUseSyslog = false;
+bool g_bRunAsDaemon = false;
+bool g_bIsWSL = false;
+
+//Heartbeats and log notifications go nowhere, there is no sunrise/sunset yet
+class CBenchWorkerServices : public IWorkerServices
+{
+public:
+	void HeartbeatUpdate(const std::string &component, bool critical = true) override
+	{
+	}
+	void HeartbeatRemove(const std::string &component) override
+	{
+	}
+	void ForceLogNotificationCheck() override
+	{
+	}
+	std::string GetLastSunriseSet() override
+	{
+		return "";
+	}
+};
+
+static CBenchWorkerServices BenchWorkerServices;
+IWorkerServices *g_pWorkerServices = &BenchWorkerServices;
+
+CBasePush::CBasePush()
+{
+	m_bLinkActive = false;
+	m_DeviceRowIdx = -1;
+	m_DeviceUpdateSubscription = 0;
+}
+
+CWebSocketPush::CWebSocketPush(http::server::CWebsocketHandler *sock)
+{
+	listenRoomplan = false;
+	listenDeviceTable = false;
+	m_sock = sock;
+	isStarted = false;
+}
+
+void CWebSocketPush::Start()
+{
+	isStarted = true;
+}
+
+void CWebSocketPush::Stop()
+{
+	isStarted = false;
+}
+
+const char* CEvohomeBase::GetWebAPIModeName(uint8_t nControllerMode)
+{
+	return "Unknown";
+}
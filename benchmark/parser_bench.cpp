@@ -0,0 +1,263 @@
+//Equivalence check and benchmark of the HTTP request parser and the query string parsing.
+//The character at a time parser and query loop as they were before they copied spans
+//(legacy_request_parser, LegacyParseQueryString) are compared against
+//request_parser and cWebem::ParseQueryString on a few typical requests.
+//
+//usage: parser_bench [rounds]
+//Returns 1 when any request is parsed differently.
+
+#include "stdafx.h"
+#include "legacy_request_parser.hpp"
+#include "../webserver/request_parser.hpp"
+#include "../webserver/request.hpp"
+#include "../webserver/cWebem.h"
+#include <chrono>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace http::server;
+
+struct _tBenchRequest
+{
+	const char *szName;
+	std::string data;
+};
+
+static std::vector<_tBenchRequest> BenchRequests;
+
+static void BuildRequests()
+{
+	std::string headers =
+		"Host: 192.168.0.10:8080\r\n"
+		"User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0\r\n"
+		"Accept: application/json, text/javascript, */*; q=0.01\r\n"
+		"Accept-Language: en-US,en;q=0.5\r\n"
+		"Accept-Encoding: gzip, deflate\r\n"
+		"X-Requested-With: XMLHttpRequest\r\n"
+		"Connection: keep-alive\r\n"
+		"Referer: http://192.168.0.10:8080/\r\n"
+		"Cookie: DMZSID=d3c4e5f6a7b8c9d0e1f2a3b4c5d6e7f8_ODgzNTQxMjM0NQ==.1696000000\r\n";
+
+	_tBenchRequest breq;
+	breq.szName = "json_get";
+	breq.data = "GET /json.htm?type=devices&filter=all&used=true&order=Name&plan=0&lastupdate=1696000000&favorite=0 HTTP/1.1\r\n" + headers + "\r\n";
+	BenchRequests.push_back(breq);
+
+	breq.szName = "json_get_encoded";
+	breq.data = "GET /json.htm?type=command&param=addtimer&idx=12&active=true&timertype=2&hour=07&min=30&randomness=false&command=0&days=%2C1%2C2%2C3%2C4%2C5&date=&mday=0&month=0&occurence=0&name=Morning+lights+%28living+room%29&comment=Wake%20up%21 HTTP/1.1\r\n" + headers + "\r\n";
+	BenchRequests.push_back(breq);
+
+	std::string content;
+	for (int ii = 0; ii < 40; ii++)
+	{
+		if (ii != 0)
+			content += "&";
+		content += "field" + std::to_string(ii) + "=value+number+" + std::to_string(ii) + "%3A%20%C3%A9t%C3%A9";
+	}
+	breq.szName = "form_post";
+	breq.data = "POST /storesettings HTTP/1.1\r\n" + headers +
+		"Content-Type: application/x-www-form-urlencoded; charset=UTF-8\r\n"
+		"Content-Length: " + std::to_string(content.size()) + "\r\n\r\n" + content;
+	BenchRequests.push_back(breq);
+
+	std::string large_headers = headers;
+	for (int ii = 0; ii < 30; ii++)
+		large_headers += "X-Forwarded-Custom-" + std::to_string(ii) + ": " + std::string(120, 'a' + (ii % 26)) + "\r\n";
+	breq.szName = "large_headers";
+	breq.data = "GET /images/logo.png HTTP/1.1\r\n" + large_headers + "\r\n";
+	BenchRequests.push_back(breq);
+}
+
+//url_decode as it was, with an istringstream for every escape
+static bool LegacyUrlDecode(const std::string& in, std::string& out)
+{
+	out.clear();
+	out.reserve(in.size());
+	for (std::size_t i = 0; i < in.size(); ++i)
+	{
+		if (in[i] == '%')
+		{
+			if (i + 3 <= in.size())
+			{
+				int value;
+				std::istringstream is(in.substr(i + 1, 2));
+				if (is >> std::hex >> value)
+				{
+					out += static_cast<char>(value);
+					i += 2;
+				}
+				else
+				{
+					return false;
+				}
+			}
+			else
+			{
+				return false;
+			}
+		}
+		else if (in[i] == '+')
+		{
+			out += ' ';
+		}
+		else
+		{
+			out += in[i];
+		}
+	}
+	return true;
+}
+
+//The query loop cWebem::CheckForPageOverride used for the uri and the post content
+static void LegacyParseQueryString(const std::string &params, std::multimap<std::string, std::string> &parameters)
+{
+	std::string name;
+	std::string value;
+
+	size_t q = 0;
+	size_t p = q;
+	int flag_done = 0;
+	std::string uri = params;
+	while (!flag_done)
+	{
+		q = uri.find("=", p);
+		if (q == std::string::npos)
+		{
+			break;
+		}
+		name = uri.substr(p, q - p);
+		p = q + 1;
+		q = uri.find("&", p);
+		if (q != std::string::npos)
+			value = uri.substr(p, q - p);
+		else
+		{
+			value = uri.substr(p);
+			flag_done = 1;
+		}
+		// the browser sends blanks as +
+		while (1)
+		{
+			size_t p = value.find("+");
+			if (p == std::string::npos)
+				break;
+			value.replace(p, 1, " ");
+		}
+
+		std::string decoded;
+		LegacyUrlDecode(value, decoded);
+		parameters.insert(std::pair< std::string, std::string >(name, decoded));
+		p = q + 1;
+	}
+}
+
+template<typename T>
+static bool ParseRequest(T &parser, const std::string &data, request &req)
+{
+	req = request();
+	parser.reset();
+	const char *begin = data.data();
+	boost::tribool result;
+	boost::tie(result, boost::tuples::ignore) = parser.parse(req, begin, data.data() + data.size());
+	return bool(result);
+}
+
+static void ParseLegacyQuery(request &req)
+{
+	size_t paramPos = req.uri.find_first_of('?');
+	if (paramPos != std::string::npos)
+		LegacyParseQueryString(req.uri.substr(paramPos + 1), req.parameters);
+	if (req.method == "POST")
+		LegacyParseQueryString(req.content, req.parameters);
+}
+
+static void ParseQuery(request &req)
+{
+	size_t paramPos = req.uri.find_first_of('?');
+	if (paramPos != std::string::npos)
+		cWebem::ParseQueryString(req.uri, paramPos + 1, req.parameters);
+	if (req.method == "POST")
+		cWebem::ParseQueryString(req.content, 0, req.parameters);
+}
+
+static bool SameRequest(const request &r1, const request &r2)
+{
+	if ((r1.method != r2.method) || (r1.uri != r2.uri) || (r1.content != r2.content))
+		return false;
+	if ((r1.http_version_major != r2.http_version_major) || (r1.http_version_minor != r2.http_version_minor))
+		return false;
+	if (r1.headers.size() != r2.headers.size())
+		return false;
+	for (size_t ii = 0; ii < r1.headers.size(); ii++)
+	{
+		if ((r1.headers[ii].name != r2.headers[ii].name) || (r1.headers[ii].value != r2.headers[ii].value))
+			return false;
+	}
+	return (r1.parameters == r2.parameters);
+}
+
+//Parse the request (and its query parameters) 'rounds' times, returns nanoseconds per request
+template<typename T>
+static double TimeParse(const int rounds, T &parser, void(*parse_query)(request &), const std::string &data, size_t &sink)
+{
+	request req;
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++)
+	{
+		ParseRequest(parser, data, req);
+		parse_query(req);
+		sink += req.headers.size() + req.parameters.size();
+	}
+	double nsec = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count();
+	return nsec / rounds;
+}
+
+int main(int argc, char *argv[])
+{
+	int rounds = (argc > 1) ? atoi(argv[1]) : 100000;
+	if (rounds < 1)
+	{
+		printf("usage: %s [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	BuildRequests();
+
+	legacy_request_parser legacy_parser;
+	request_parser parser;
+
+	int iMismatches = 0;
+	for (const auto &breq : BenchRequests)
+	{
+		request legacy_req, req;
+		bool bLegacyOK = ParseRequest(legacy_parser, breq.data, legacy_req);
+		bool bOK = ParseRequest(parser, breq.data, req);
+		if (bLegacyOK)
+			ParseLegacyQuery(legacy_req);
+		if (bOK)
+			ParseQuery(req);
+		if ((!bLegacyOK) || (!bOK) || (!SameRequest(legacy_req, req)))
+		{
+			printf("MISMATCH %s: legacy %s, new %s\n", breq.szName, bLegacyOK ? "parsed" : "failed", bOK ? "parsed" : "failed");
+			iMismatches++;
+		}
+	}
+	if (iMismatches != 0)
+	{
+		printf("%d requests are parsed differently\n", iMismatches);
+		return 1;
+	}
+	printf("both parsers produce the same request and parameters for all requests\n");
+
+	size_t sink = 0;
+	printf("%-18s %8s %12s %12s %9s\n", "request", "bytes", "legacy(ns)", "new(ns)", "speedup");
+	for (const auto &breq : BenchRequests)
+	{
+		double legacy = TimeParse(rounds, legacy_parser, ParseLegacyQuery, breq.data, sink);
+		double current = TimeParse(rounds, parser, ParseQuery, breq.data, sink);
+		printf("%-18s %8d %12.1f %12.1f %8.1fx\n", breq.szName, (int)breq.data.size(), legacy, current, legacy / current);
+	}
+	//keep the parsing from being optimized away
+	return (sink == 0) ? 2 : 0;
+}
@@ -0,0 +1,69 @@
+//Standalone run of the batched ICMP sweep of the Pinger (CPingSweep).
+//127.0.0.1 has to answer the first echo request, the TEST-NET-2/3 addresses (RFC 5737) do not
+//answer and show that a sweep takes MaxTries * TimeoutMs whatever the number of dead hosts.
+//Extra hosts can be given on the command line. Raw ICMP sockets need root or CAP_NET_RAW.
+//
+//usage: ping_sweep_bench [-t timeout in ms] [-n tries] [-r rounds] [host...]
+//Returns 1 when 127.0.0.1 does not answer, 2 when the ICMP socket could not be opened.
+
+#include "stdafx.h"
+#include "../hardware/PingSweep.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+	int TimeoutMs = 300;
+	int MaxTries = 4;
+	int rounds = 3;
+	std::vector<std::string> Hosts;
+	Hosts.push_back("127.0.0.1");
+	Hosts.push_back("198.51.100.1");
+	Hosts.push_back("203.0.113.1");
+	for (int ii = 1; ii < argc; ii++)
+	{
+		if ((strcmp(argv[ii], "-t") == 0) && (ii + 1 < argc))
+			TimeoutMs = atoi(argv[++ii]);
+		else if ((strcmp(argv[ii], "-n") == 0) && (ii + 1 < argc))
+			MaxTries = atoi(argv[++ii]);
+		else if ((strcmp(argv[ii], "-r") == 0) && (ii + 1 < argc))
+			rounds = atoi(argv[++ii]);
+		else if (argv[ii][0] != '-')
+			Hosts.push_back(argv[ii]);
+		else
+			rounds = 0;
+	}
+	if ((TimeoutMs < 1) || (MaxTries < 1) || (rounds < 1))
+	{
+		printf("usage: %s [-t timeout in ms] [-n tries] [-r rounds] [host...]\n", argv[0]);
+		return 1;
+	}
+
+	printf("%d hosts, timeout %d ms, %d tries, expected sweep time %d ms\n", (int)Hosts.size(), TimeoutMs, MaxTries, TimeoutMs * MaxTries);
+	bool bLocalAlive = true;
+	for (int round = 0; round < rounds; round++)
+	{
+		std::vector<CPingSweep::_tResult> Results;
+		CPingSweep::_tStats Stats;
+		if (!CPingSweep::Sweep(Hosts, TimeoutMs, MaxTries, Results, Stats))
+		{
+			printf("cannot open the ICMP socket (raw sockets need root or CAP_NET_RAW)\n");
+			return 2;
+		}
+		printf("round %d: %d ms, %d sent, %d received, %d alive, %d unresolved\n", round + 1, Stats.DurationMs, Stats.Sent, Stats.Received, Stats.Alive, Stats.Unresolved);
+		for (size_t ii = 0; ii < Hosts.size(); ii++)
+		{
+			if (round == 0)
+				printf("  %-20s %-5s %d sent, %d ms\n", Hosts[ii].c_str(), Results[ii].bAlive ? "alive" : "dead", Results[ii].Sent, Results[ii].RoundTripMs);
+		}
+		if ((!Results[0].bAlive) || (Results[0].Sent != 1))
+			bLocalAlive = false;
+	}
+	if (!bLocalAlive)
+	{
+		printf("127.0.0.1 did not answer the first echo request\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,236 @@
+//Equivalence check and benchmark of the Line and JSON plugin protocol framing.
+//The framing as it was before it scanned only the new data (a copy of the retained data
+//into a string for every read, substr after every message and for JSON a count of all
+//the braces on every read) is compared against CLineFramer and CJSONFramer on large streams
+//fed in reads of a fixed size. Parsing the JSON messages is the same for both and not timed.
+//
+//usage: plugin_framing_bench [-s stream size in MB] [-r read size in bytes]
+//Returns 1 when any stream is split differently, the timings of the streams that match are printed.
+
+#include "../hardware/plugins/PluginFraming.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Plugins;
+
+typedef std::vector<std::string> _tFrames;
+
+//CPluginProtocolLine::ProcessInbound as it was
+class CLegacyLine
+{
+public:
+	std::vector<byte>	m_sRetainedData;
+	void ProcessInbound(const std::vector<byte> &vBuffer, _tFrames &vFrames)
+	{
+		std::vector<byte>	vData = m_sRetainedData;
+		vData.insert(vData.end(), vBuffer.begin(), vBuffer.end());
+
+		std::string		sData(vData.begin(), vData.end());
+		size_t iPos = sData.find_first_of('\r');
+		while (iPos != std::string::npos)
+		{
+			vFrames.push_back(std::string(&sData[0], &sData[iPos]));
+
+			if (sData[iPos + 1] == '\n') iPos++;
+			sData = sData.substr(iPos + 1);
+			iPos = sData.find_first_of('\r');
+		}
+
+		m_sRetainedData.assign(sData.c_str(), sData.c_str() + sData.length());
+	}
+};
+
+//CPluginProtocolJSON::ProcessInbound as it was, without the parsing of the messages
+class CLegacyJSON
+{
+public:
+	std::vector<byte>	m_sRetainedData;
+	void ProcessInbound(const std::vector<byte> &vBuffer, _tFrames &vFrames)
+	{
+		std::vector<byte>	vData = m_sRetainedData;
+		vData.insert(vData.end(), vBuffer.begin(), vBuffer.end());
+
+		std::string		sData(vData.begin(), vData.end());
+		size_t iPos = 1;
+		while (iPos && !sData.empty()) {
+			iPos = sData.find("}{", 0) + 1;
+			if (!iPos)
+			{
+				if ((sData.substr(sData.length() - 1, 1) == "}") &&
+					(std::count(sData.begin(), sData.end(), '{') == std::count(sData.begin(), sData.end(), '}')))
+				{
+					vFrames.push_back(sData);
+					sData.clear();
+				}
+			}
+			else
+			{
+				std::string sMessage = sData.substr(0, iPos);
+				sData = sData.substr(iPos);
+				vFrames.push_back(sMessage);
+			}
+		}
+
+		m_sRetainedData.assign(sData.c_str(), sData.c_str() + sData.length());
+	}
+};
+
+//The retained data handling of CPluginProtocol (AppendInbound, DeliverFrame, ConsumeRetained) around a framer
+template<typename T>
+class CFramed
+{
+public:
+	T					m_Framer;
+	std::vector<byte>	m_sRetainedData;
+	size_t				m_iScanPos;
+	CFramed() : m_iScanPos(0) {};
+	void ProcessInbound(const std::vector<byte> &vBuffer, _tFrames &vFrames)
+	{
+		m_sRetainedData.insert(m_sRetainedData.end(), vBuffer.begin(), vBuffer.end());
+		size_t iLength = m_Framer.Scan(m_sRetainedData, m_iScanPos, [&](const size_t iStart, const size_t iEnd) {
+			vFrames.push_back(std::string((const char*)&m_sRetainedData[0] + iStart, iEnd - iStart));
+		});
+		if (iLength >= m_sRetainedData.size())
+			m_sRetainedData.clear();
+		else if (iLength)
+			m_sRetainedData.erase(m_sRetainedData.begin(), m_sRetainedData.begin() + iLength);
+		m_iScanPos = (m_iScanPos > iLength) ? m_iScanPos - iLength : 0;
+	}
+};
+
+struct _tBenchStream
+{
+	const char *szName;
+	bool bJSON;
+	std::string data;
+};
+
+static std::vector<_tBenchStream> BenchStreams;
+
+//Streams of about iSize bytes with small and with large (1MB) messages
+static void BuildStreams(const size_t iSize)
+{
+	_tBenchStream bstream;
+	bstream.bJSON = false;
+	bstream.szName = "line_small";
+	for (int ii = 0; bstream.data.size() < iSize; ii++)
+		bstream.data += "OK " + std::to_string(ii) + " temperature=21.5 humidity=48 battery=100\r\n";
+	BenchStreams.push_back(bstream);
+
+	bstream.szName = "line_1mb";
+	bstream.data.clear();
+	for (int ii = 0; bstream.data.size() < iSize; ii++)
+		bstream.data += std::string(1024 * 1024, 'a' + (ii % 26)) + "\r\n";
+	BenchStreams.push_back(bstream);
+
+	//No whitespace between the messages and no braces in the strings, the old framing did not handle those
+	bstream.bJSON = true;
+	bstream.szName = "json_small";
+	bstream.data.clear();
+	for (int ii = 0; bstream.data.size() < iSize; ii++)
+		bstream.data += "{\"Type\":\"Update\",\"Id\":" + std::to_string(ii) + ",\"Data\":{\"Temp\":21.5,\"Hum\":48,\"Name\":\"Living \\\"room\\\"\"}}";
+	BenchStreams.push_back(bstream);
+
+	bstream.szName = "json_1mb";
+	bstream.data.clear();
+	while (bstream.data.size() < iSize)
+	{
+		bstream.data += "{\"Type\":\"Devices\",\"List\":[";
+		for (int ii = 0; ii < 16384; ii++)
+			bstream.data += std::string((ii != 0) ? "," : "") + "{\"Id\":" + std::to_string(ii) + ",\"Level\":50,\"On\":true}";
+		bstream.data += "]}";
+	}
+	BenchStreams.push_back(bstream);
+}
+
+//Feed the stream in reads of iReadSize bytes, returns the milliseconds it took
+template<typename T>
+static double FeedStream(const std::string &data, const size_t iReadSize, _tFrames &vFrames)
+{
+	T Protocol;
+	std::vector<byte> vBuffer;
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	for (size_t iPos = 0; iPos < data.size(); iPos += iReadSize)
+	{
+		size_t iLength = std::min(iReadSize, data.size() - iPos);
+		vBuffer.assign((const byte*)data.data() + iPos, (const byte*)data.data() + iPos + iLength);
+		Protocol.ProcessInbound(vBuffer, vFrames);
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+static bool SameFrames(const _tFrames &vLegacy, const _tFrames &vFrames)
+{
+	if (vLegacy.size() != vFrames.size())
+		return false;
+	for (size_t ii = 0; ii < vLegacy.size(); ii++)
+	{
+		//The old line framing left the '\n' of a "\r\n" split over two reads at the start of the next line
+		const std::string &sLegacy = vLegacy[ii];
+		size_t iSkip = ((ii != 0) && !sLegacy.empty() && (sLegacy[0] == '\n')) ? 1 : 0;
+		if (sLegacy.compare(iSkip, std::string::npos, vFrames[ii]) != 0)
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t iSizeMB = 10;
+	size_t iReadSize = 4096;
+	for (int ii = 1; ii < argc; ii++)
+	{
+		if ((strcmp(argv[ii], "-s") == 0) && (ii + 1 < argc))
+			iSizeMB = atoi(argv[++ii]);
+		else if ((strcmp(argv[ii], "-r") == 0) && (ii + 1 < argc))
+			iReadSize = atoi(argv[++ii]);
+		else
+			iSizeMB = 0;
+	}
+	if ((iSizeMB < 1) || (iReadSize < 1))
+	{
+		printf("usage: %s [-s stream size in MB] [-r read size in bytes]\n", argv[0]);
+		return 1;
+	}
+
+	BuildStreams(iSizeMB * 1024 * 1024);
+
+	int iMismatches = 0;
+	size_t sink = 0;
+	printf("%-12s %10s %10s %12s %12s %9s\n", "stream", "bytes", "messages", "legacy(ms)", "new(ms)", "speedup");
+	for (const auto &bstream : BenchStreams)
+	{
+		_tFrames vLegacy, vFrames;
+		double legacy, current;
+		if (bstream.bJSON)
+		{
+			legacy = FeedStream<CLegacyJSON>(bstream.data, iReadSize, vLegacy);
+			current = FeedStream<CFramed<CJSONFramer> >(bstream.data, iReadSize, vFrames);
+		}
+		else
+		{
+			legacy = FeedStream<CLegacyLine>(bstream.data, iReadSize, vLegacy);
+			current = FeedStream<CFramed<CLineFramer> >(bstream.data, iReadSize, vFrames);
+		}
+		if (!SameFrames(vLegacy, vFrames))
+		{
+			printf("MISMATCH %s: legacy %d messages, new %d messages\n", bstream.szName, (int)vLegacy.size(), (int)vFrames.size());
+			iMismatches++;
+			continue;
+		}
+		printf("%-12s %10d %10d %12.1f %12.1f %8.1fx\n", bstream.szName, (int)bstream.data.size(), (int)vFrames.size(), legacy, current, legacy / current);
+		sink += vFrames.size();
+	}
+	if (iMismatches != 0)
+	{
+		printf("%d streams are split differently\n", iMismatches);
+		return 1;
+	}
+	printf("both framings produce the same messages for all streams (reads of %d bytes)\n", (int)iReadSize);
+	//keep the framing from being optimized away
+	return (sink == 0) ? 2 : 0;
+}
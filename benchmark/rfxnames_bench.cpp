@@ -0,0 +1,159 @@
+//Equivalence check and benchmark of the indexed RFXNames lookups.
+//RFXNames.cpp is compiled into this file so its tables and the original linear
+//findTableID* searches can be compared against the public (indexed) functions.
+//
+//usage: rfxnames_bench [rounds]
+//Returns 1 when any lookup differs from the linear search.
+
+#include "../main/RFXNames.cpp"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+static int iMismatches = 0;
+
+static void CheckEqual(const char *szWhat, const long id1, const long id2, const char *pIndexed, const char *pLinear)
+{
+	if (strcmp(pIndexed, pLinear) == 0)
+		return;
+	if (iMismatches++ < 20)
+		printf("MISMATCH %s(%ld, %ld): indexed '%s', linear '%s'\n", szWhat, id1, id2, pIndexed, pLinear);
+}
+
+static void CheckTables()
+{
+	for (int hType = -5; hType <= 3000; hType++)
+	{
+		CheckEqual("Hardware_Type_Desc", hType, 0, Hardware_Type_Desc(hType), findTableIDSingle1(HardwareTypeTable, hType));
+		CheckEqual("Hardware_Short_Desc", hType, 0, Hardware_Short_Desc(hType), findTableIDSingle2(HardwareTypeTable, hType));
+	}
+	for (int sType = 0; sType <= 300; sType++)
+		CheckEqual("Switch_Type_Desc", sType, 0, Switch_Type_Desc((_eSwitchType)sType), findTableIDSingle1(SwitchTypeTable, sType));
+	for (int dType = 0; dType < 256; dType++)
+	{
+		CheckEqual("RFX_Type_Desc", dType, 1, RFX_Type_Desc((unsigned char)dType, 1), findTableIDSingle1(RFXTypeTable, dType));
+		CheckEqual("RFX_Type_Desc", dType, 2, RFX_Type_Desc((unsigned char)dType, 2), findTableIDSingle2(RFXTypeTable, dType));
+		for (int sType = 0; sType < 256; sType++)
+			CheckEqual("RFX_Type_SubType_Desc", dType, sType, RFX_Type_SubType_Desc((unsigned char)dType, (unsigned char)sType), findTableID1ID2(RFXTypeSubTypeTable, dType, sType));
+	}
+
+	//The real tables only use small ids, exercise the hashed fallback, duplicates and
+	//the scan stopping at the first entry without a second string with a synthetic table
+	static const STR_TABLE_SINGLE SingleTable[] =
+	{
+		{ 1, "one", "1" },
+		{ 1, "one again", "1 again" },
+		{ 5000, "large", "L" },
+		{ 5000, "large again", "L again" },
+		{ 7, "seven", NULL },
+		{ 8, "eight", "8" },
+		{ 0, NULL, NULL }
+	};
+	static const STR_TABLE_ID1_ID2 PairTable[] =
+	{
+		{ 1, 2, "pair" },
+		{ 1, 2, "pair again" },
+		{ 300, 2, "large type" },
+		{ 1, 70000, "large subtype" },
+		{ 0, 0, NULL }
+	};
+	CTableIndexSingle Index1(SingleTable, 1);
+	CTableIndexSingle Index2(SingleTable, 2);
+	CTableIndexID1ID2 IndexPair(PairTable);
+	const unsigned long SingleIDs[] = { 0, 1, 2, 7, 8, 1023, 1024, 5000, 5001 };
+	for (const unsigned long id : SingleIDs)
+	{
+		CheckEqual("CTableIndexSingle[1]", id, 0, Index1.find(id), findTableIDSingle1(SingleTable, id));
+		CheckEqual("CTableIndexSingle[2]", id, 0, Index2.find(id), findTableIDSingle2(SingleTable, id));
+	}
+	const unsigned long PairIDs[] = { 0, 1, 2, 255, 256, 300, 70000 };
+	for (const unsigned long id1 : PairIDs)
+		for (const unsigned long id2 : PairIDs)
+			CheckEqual("CTableIndexID1ID2", id1, id2, IndexPair.find(id1, id2), findTableID1ID2(PairTable, id1, id2));
+}
+
+//Time every type/subtype pair, returns nanoseconds per lookup
+template<typename T>
+static double TimeSubTypeLookups(const int rounds, T lookup, size_t &sink)
+{
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++)
+		for (int dType = 0; dType < 256; dType++)
+			for (int sType = 0; sType < 256; sType++)
+				sink += (size_t)lookup((unsigned char)dType, (unsigned char)sType);
+	double nsec = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count();
+	return nsec / ((double)rounds * 256 * 256);
+}
+
+template<typename T>
+static double TimeTypeLookups(const int rounds, T lookup, size_t &sink)
+{
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds * 256; round++)
+		for (int dType = 0; dType < 256; dType++)
+			sink += (size_t)lookup((unsigned char)dType);
+	double nsec = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count();
+	return nsec / ((double)rounds * 256 * 256);
+}
+
+static const char *LinearSubType(const unsigned char dType, const unsigned char sType)
+{
+	return findTableID1ID2(RFXTypeSubTypeTable, dType, sType);
+}
+
+static const char *IndexedSubType(const unsigned char dType, const unsigned char sType)
+{
+	return RFX_Type_SubType_Desc(dType, sType);
+}
+
+static const char *LinearType(const unsigned char dType)
+{
+	return findTableIDSingle1(RFXTypeTable, dType);
+}
+
+static const char *IndexedType(const unsigned char dType)
+{
+	return RFX_Type_Desc(dType, 1);
+}
+
+static const char *LinearHardware(const unsigned char hType)
+{
+	return findTableIDSingle1(HardwareTypeTable, hType);
+}
+
+static const char *IndexedHardware(const unsigned char hType)
+{
+	return Hardware_Type_Desc(hType);
+}
+
+int main(int argc, char *argv[])
+{
+	int rounds = (argc > 1) ? atoi(argv[1]) : 20;
+	if (rounds < 1)
+	{
+		printf("usage: %s [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	CheckTables();
+	if (iMismatches != 0)
+	{
+		printf("%d lookups differ from the linear search\n", iMismatches);
+		return 1;
+	}
+	printf("indexed lookups match the linear search for all type/subtype pairs\n");
+
+	size_t sink = 0;
+	printf("%-24s %12s %12s %9s\n", "lookup (256x256 ids)", "linear(ns)", "indexed(ns)", "speedup");
+	double linear = TimeSubTypeLookups(rounds, LinearSubType, sink);
+	double indexed = TimeSubTypeLookups(rounds, IndexedSubType, sink);
+	printf("%-24s %12.2f %12.2f %8.1fx\n", "RFX_Type_SubType_Desc", linear, indexed, linear / indexed);
+	linear = TimeTypeLookups(rounds, LinearType, sink);
+	indexed = TimeTypeLookups(rounds, IndexedType, sink);
+	printf("%-24s %12.2f %12.2f %8.1fx\n", "RFX_Type_Desc", linear, indexed, linear / indexed);
+	linear = TimeTypeLookups(rounds, LinearHardware, sink);
+	indexed = TimeTypeLookups(rounds, IndexedHardware, sink);
+	printf("%-24s %12.2f %12.2f %8.1fx\n", "Hardware_Type_Desc", linear, indexed, linear / indexed);
+	//keep the lookups from being optimized away
+	return (sink == 0) ? 2 : 0;
+}
@@ -0,0 +1,290 @@
+//Database size before and after storing unchanged Meter/MultiMeter shortlog readings as runs.
+//A synthetic shortlog with a reading every interval is compacted the way
+//CSQLHelper::CompactShortLogRuns (database version 139) does it: rows inside a run of equal
+//same day readings are deleted and the last row of each run is flagged as Unchanged.
+//The daily MIN/MAX rollup of the calendar tables is run on both and has to give the same result.
+//
+//usage: shortlog_bench [-d days] [-n devices] [-i interval in minutes] [-f database file]
+//Returns 1 when the rollup of the compacted shortlog differs.
+
+#ifdef WITH_EXTERNAL_SQLITE
+#include <sqlite3.h>
+#else
+#include "../sqlite/sqlite3.h"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *sqlCreateMeter =
+"CREATE TABLE IF NOT EXISTS [Meter] ("
+"[DeviceRowID] BIGINT NOT NULL, "
+"[Value] REAL NOT NULL, "
+"[Usage] REAL DEFAULT 0, "
+"[Date] DATETIME DEFAULT (datetime('now','localtime')), "
+"[Unchanged] INTEGER DEFAULT 0);";
+
+static const char *sqlCreateMultiMeter =
+"CREATE TABLE IF NOT EXISTS [MultiMeter] ("
+"[DeviceRowID] BIGINT(10) NOT NULL, "
+"[Value1] BIGINT NOT NULL, "
+"[Value2] BIGINT DEFAULT 0, "
+"[Value3] BIGINT DEFAULT 0, "
+"[Value4] BIGINT DEFAULT 0, "
+"[Value5] BIGINT DEFAULT 0, "
+"[Value6] BIGINT DEFAULT 0, "
+"[Date] DATETIME DEFAULT (datetime('now','localtime')), "
+"[Unchanged] INTEGER DEFAULT 0);";
+
+static sqlite3 *dbase = NULL;
+
+static void Exec(const std::string &szQuery)
+{
+	char *errorMessage = NULL;
+	if (sqlite3_exec(dbase, szQuery.c_str(), NULL, NULL, &errorMessage) != SQLITE_OK)
+	{
+		printf("SQL error '%s' on: %s\n", errorMessage ? errorMessage : "", szQuery.c_str());
+		sqlite3_free(errorMessage);
+		exit(2);
+	}
+}
+
+static std::vector<std::vector<std::string> > Query(const std::string &szQuery)
+{
+	std::vector<std::vector<std::string> > results;
+	sqlite3_stmt *statement;
+	if (sqlite3_prepare_v2(dbase, szQuery.c_str(), -1, &statement, NULL) != SQLITE_OK)
+	{
+		printf("SQL error '%s' on: %s\n", sqlite3_errmsg(dbase), szQuery.c_str());
+		exit(2);
+	}
+	int cols = sqlite3_column_count(statement);
+	while (sqlite3_step(statement) == SQLITE_ROW)
+	{
+		std::vector<std::string> values;
+		for (int col = 0; col < cols; col++)
+		{
+			const char *pValue = (const char*)sqlite3_column_text(statement, col);
+			values.push_back(pValue ? pValue : "");
+		}
+		results.push_back(values);
+	}
+	sqlite3_finalize(statement);
+	return results;
+}
+
+static int64_t QueryInt(const std::string &szQuery)
+{
+	std::vector<std::vector<std::string> > result = Query(szQuery);
+	return result.empty() ? 0 : atoll(result[0][0].c_str());
+}
+
+//Size of the database file after a VACUUM
+static int64_t DatabaseSize()
+{
+	Exec("VACUUM");
+	return QueryInt("PRAGMA page_count") * QueryInt("PRAGMA page_size");
+}
+
+//Simple deterministic random numbers, so every run uses the same dataset
+static uint32_t RandomState = 12345;
+static uint32_t Random()
+{
+	RandomState = RandomState * 1103515245 + 12345;
+	return (RandomState >> 8) & 0xFFFFFF;
+}
+
+/*
+ * One reading every interval for every device. The kinds of meters alternate:
+ * gas and water counters (mostly idle, used a few times a day), an electricity counter
+ * that changes most intervals and a P1 smart meter (MultiMeter) that only idles at night
+ */
+static void FillShortLog(const int days, const int devices, const int interval)
+{
+	time_t tStart = time(NULL) - (time_t)days * 24 * 3600;
+	struct tm ltime;
+	localtime_r(&tStart, &ltime);
+	ltime.tm_hour = 0;
+	ltime.tm_min = 0;
+	ltime.tm_sec = 0;
+	ltime.tm_isdst = -1;
+	tStart = mktime(&ltime);
+
+	Exec("BEGIN TRANSACTION");
+	for (int device = 1; device <= devices; device++)
+	{
+		double counter = 1000.0 * device;
+		int64_t p1[4] = { 100000, 50000, 20000, 10000 };
+		for (time_t tNow = tStart; tNow < tStart + (time_t)days * 24 * 3600; tNow += interval * 60)
+		{
+			char szDate[40];
+			localtime_r(&tNow, &ltime);
+			strftime(szDate, sizeof(szDate), "%Y-%m-%d %H:%M:%S", &ltime);
+			bool bDay = (ltime.tm_hour >= 7) && (ltime.tm_hour < 23);
+			char szQuery[300];
+			switch (device % 4)
+			{
+			case 0: //P1 smart meter, usage/return counters and actual power
+				if (bDay || (Random() % 100 < 10))
+				{
+					p1[Random() % 2] += Random() % 50;
+					p1[2] = Random() % 3000;
+				}
+				sprintf(szQuery, "INSERT INTO MultiMeter (DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6, Date) VALUES (%d, %lld, %lld, %lld, %lld, 0, 0, '%s')",
+					device, (long long)p1[0], (long long)p1[1], (long long)p1[2], (long long)p1[3], szDate);
+				Exec(szQuery);
+				continue;
+			case 1: //electricity
+				if (Random() % 100 < 80)
+					counter += 0.001 * (Random() % 100);
+				break;
+			default: //gas and water
+				if (bDay && (Random() % 100 < 8))
+					counter += 0.001 * (Random() % 500);
+				break;
+			}
+			sprintf(szQuery, "INSERT INTO Meter (DeviceRowID, Value, [Usage], Date) VALUES (%d, %.3f, 0, '%s')", device, counter, szDate);
+			Exec(szQuery);
+		}
+	}
+	Exec("COMMIT");
+}
+
+//The row selection of CSQLHelper::CompactShortLogRuns (the synthetic readings have no gaps)
+static size_t CompactShortLog(const char *szTable, const char *szColumns, const int devices)
+{
+	size_t totRemoved = 0;
+	Exec("BEGIN TRANSACTION");
+	for (int device = 1; device <= devices; device++)
+	{
+		std::vector<std::vector<std::string> > result = Query(std::string("SELECT ROWID, ") + szColumns + ", Date FROM " + szTable + " WHERE (DeviceRowID=" + std::to_string(device) + ") ORDER BY Date ASC");
+		if (result.size() < 3)
+			continue;
+		const size_t DateColumn = result[0].size() - 1;
+		bool bPrevRemoved = false;
+		for (size_t ii = 1; ii < result.size(); ii++)
+		{
+			const std::vector<std::string> &prev = result[ii - 1];
+			const std::vector<std::string> &sd = result[ii];
+			bool bSameRun = (
+				(sd[DateColumn].compare(0, 10, prev[DateColumn], 0, 10) == 0)
+				&& std::equal(prev.begin() + 1, prev.begin() + DateColumn, sd.begin() + 1)
+				);
+			bool bRemove = false;
+			if ((bSameRun) && (ii + 1 < result.size()))
+			{
+				const std::vector<std::string> &next = result[ii + 1];
+				bRemove = (
+					(next[DateColumn].compare(0, 10, sd[DateColumn], 0, 10) == 0)
+					&& std::equal(sd.begin() + 1, sd.begin() + DateColumn, next.begin() + 1)
+					);
+			}
+			if (bRemove)
+			{
+				Exec(std::string("DELETE FROM ") + szTable + " WHERE (ROWID=" + sd[0] + ")");
+				totRemoved++;
+			}
+			else if (bPrevRemoved)
+				Exec(std::string("UPDATE ") + szTable + " SET Unchanged=1 WHERE (ROWID=" + sd[0] + ")");
+			bPrevRemoved = bRemove;
+		}
+	}
+	Exec("COMMIT");
+	return totRemoved;
+}
+
+//The daily MIN/MAX of AddCalendarUpdateMeter/MultiMeter for every device and day, and the time it took
+static std::vector<std::vector<std::string> > Rollup(const int devices, double &msec)
+{
+	std::vector<std::vector<std::string> > rollup;
+	std::vector<std::vector<std::string> > dates = Query("SELECT DISTINCT(date(Date)) FROM Meter UNION SELECT DISTINCT(date(Date)) FROM MultiMeter ORDER BY 1");
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	for (int device = 1; device <= devices; device++)
+	{
+		for (const auto &itt : dates)
+		{
+			std::string szWhere = " WHERE (DeviceRowID='" + std::to_string(device) + "' AND Date>='" + itt[0] + "' AND Date<date('" + itt[0] + "', '+1 day'))";
+			std::vector<std::vector<std::string> > result;
+			if (device % 4 == 0)
+				result = Query("SELECT MIN(Value1), MAX(Value1), MIN(Value2), MAX(Value2), MIN(Value3), MAX(Value3), MIN(Value4), MAX(Value4) FROM MultiMeter" + szWhere);
+			else
+				result = Query("SELECT MIN(Value), MAX(Value) FROM Meter" + szWhere);
+			rollup.insert(rollup.end(), result.begin(), result.end());
+		}
+	}
+	msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+	return rollup;
+}
+
+int main(int argc, char *argv[])
+{
+	int days = 30;
+	int devices = 40;
+	int interval = 5;
+	std::string szDatabase = "shortlog_bench.db";
+	for (int ii = 1; ii < argc; ii++)
+	{
+		if ((strcmp(argv[ii], "-d") == 0) && (ii + 1 < argc))
+			days = atoi(argv[++ii]);
+		else if ((strcmp(argv[ii], "-n") == 0) && (ii + 1 < argc))
+			devices = atoi(argv[++ii]);
+		else if ((strcmp(argv[ii], "-i") == 0) && (ii + 1 < argc))
+			interval = atoi(argv[++ii]);
+		else if ((strcmp(argv[ii], "-f") == 0) && (ii + 1 < argc))
+			szDatabase = argv[++ii];
+		else
+			days = 0;
+	}
+	if ((days < 1) || (devices < 1) || (interval < 1))
+	{
+		printf("usage: %s [-d days] [-n devices] [-i interval in minutes] [-f database file]\n", argv[0]);
+		return 1;
+	}
+
+	remove(szDatabase.c_str());
+	if (sqlite3_open(szDatabase.c_str(), &dbase) != SQLITE_OK)
+	{
+		printf("cannot create database %s\n", szDatabase.c_str());
+		return 2;
+	}
+	Exec(sqlCreateMeter);
+	Exec(sqlCreateMultiMeter);
+	FillShortLog(days, devices, interval);
+
+	int64_t rowsBefore = QueryInt("SELECT COUNT(*) FROM Meter") + QueryInt("SELECT COUNT(*) FROM MultiMeter");
+	int64_t sizeBefore = DatabaseSize();
+	double rollupBefore;
+	std::vector<std::vector<std::string> > resultBefore = Rollup(devices, rollupBefore);
+
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	size_t totRemoved = CompactShortLog("Meter", "Value, [Usage]", devices);
+	totRemoved += CompactShortLog("MultiMeter", "Value1, Value2, Value3, Value4, Value5, Value6", devices);
+	double compact = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+	int64_t rowsAfter = QueryInt("SELECT COUNT(*) FROM Meter") + QueryInt("SELECT COUNT(*) FROM MultiMeter");
+	int64_t sizeAfter = DatabaseSize();
+	double rollupAfter;
+	std::vector<std::vector<std::string> > resultAfter = Rollup(devices, rollupAfter);
+
+	sqlite3_close(dbase);
+	remove(szDatabase.c_str());
+
+	if (resultBefore != resultAfter)
+	{
+		printf("the daily rollup of the compacted shortlog differs\n");
+		return 1;
+	}
+	printf("%d devices, %d days, reading every %d minutes, the daily rollup is the same after compaction\n", devices, days, interval);
+	printf("%-18s %14s %14s %9s\n", "", "every reading", "runs", "ratio");
+	printf("%-18s %14lld %14lld %8.1fx\n", "rows", (long long)rowsBefore, (long long)rowsAfter, (double)rowsBefore / rowsAfter);
+	printf("%-18s %14.1f %14.1f %8.1fx\n", "database (KB)", sizeBefore / 1024.0, sizeAfter / 1024.0, (double)sizeBefore / sizeAfter);
+	printf("%-18s %14.1f %14.1f %8.1fx\n", "daily rollup (ms)", rollupBefore, rollupAfter, rollupBefore / rollupAfter);
+	printf("compaction removed %d rows in %.1f ms\n", (int)totRemoved, compact);
+	return 0;
+}
@@ -0,0 +1,478 @@
+#include "stdafx.h"
+#include "../webserver/server.hpp"
+#include "../webserver/cWebem.h"
+#include "../webserver/request.hpp"
+#include "../webserver/reply.hpp"
+#include "../webserver/Websockets.hpp"
+#include "../webserver/Base64.h"
+#include "../webserver/sha1.hpp"
+#include "../main/Helper.h"
+#include "../main/Logger.h"
+#include "../json/json.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+//Load generator for the embedded webserver.
+//Runs http::server::server on the loopback interface with a request handler that serves canned
+//replies, and drives it with keep-alive client threads. For every workload the throughput and
+//the client side latency percentiles are reported.
+//
+//usage: webserver_bench [-p port] [-c clients] [-d seconds] [-w workload] [-s]
+//	-s enables the server request statistics (getwebserverstats), to measure their overhead
+
+using namespace http::server;
+
+enum _eBenchWorkload
+{
+	BWL_SMALL_JSON = 0,
+	BWL_LARGE_JSON,
+	BWL_STATIC_FILE,
+	BWL_WEBSOCKET,
+	BWL_MAX
+};
+
+static const char *szWorkloadNames[BWL_MAX] = { "small_json", "large_json", "static_file", "websocket" };
+
+#define BENCH_STATIC_FILE "/bench.js"
+#define BENCH_STATIC_FILE_SIZE (32 * 1024)
+#define BENCH_LARGE_JSON_DEVICES 300
+
+static std::string szSmallJSON;
+static std::string szLargeJSON;
+
+struct _tBenchResult
+{
+	std::vector<uint32_t> latencies;
+	uint64_t bytes_in = 0;
+	uint64_t errors = 0;
+};
+
+static void BuildReplies()
+{
+	Json::Value root;
+	root["status"] = "OK";
+	root["title"] = "GetUptime";
+	root["days"] = 1;
+	root["hours"] = 2;
+	root["minutes"] = 3;
+	root["seconds"] = 4;
+	szSmallJSON = root.toStyledString();
+
+	//Roughly what a getdevices call returns for a medium sized installation
+	root.clear();
+	root["status"] = "OK";
+	root["title"] = "Devices";
+	for (int ii = 0; ii < BENCH_LARGE_JSON_DEVICES; ii++)
+	{
+		Json::Value &device = root["result"][ii];
+		device["idx"] = std::to_string(ii + 1);
+		device["Name"] = "Bench device " + std::to_string(ii + 1);
+		device["HardwareID"] = 1;
+		device["Type"] = "Temp + Humidity";
+		device["SubType"] = "THGN122/123, THGN132, THGR122/228/238/268";
+		device["Data"] = "21.5 C, 55 %";
+		device["Temp"] = 21.5;
+		device["Humidity"] = 55;
+		device["HumidityStatus"] = "Comfortable";
+		device["BatteryLevel"] = 100;
+		device["SignalLevel"] = 7;
+		device["LastUpdate"] = "2020-01-01 12:00:00";
+		device["Favorite"] = 0;
+		device["Used"] = 1;
+		device["TypeImg"] = "temperature";
+	}
+	szLargeJSON = root.toStyledString();
+}
+
+static bool WriteStaticFile(const std::string &doc_root)
+{
+	std::string content;
+	while (content.size() < BENCH_STATIC_FILE_SIZE)
+		content += "function bench_" + std::to_string(content.size()) + "() { return \"webserver benchmark filler\"; }\n";
+	std::ofstream outfile((doc_root + BENCH_STATIC_FILE).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!outfile.is_open())
+		return false;
+	outfile << content;
+	return outfile.good();
+}
+
+static void SetJSONReply(const std::string &json, reply &rep)
+{
+	rep.status = reply::ok;
+	rep.content = json;
+	reply::add_header(&rep, "Content-Length", std::to_string(rep.content.size()));
+	reply::add_header_content_type(&rep, "application/json;charset=UTF-8");
+	reply::add_header(&rep, "Cache-Control", "no-cache");
+}
+
+//Serves the canned json replies, accepts websocket upgrades and leaves the static files to request_handler
+class CBenchRequestHandler : public request_handler
+{
+public:
+	CBenchRequestHandler(const std::string &doc_root, cWebem *webem) :
+		request_handler(doc_root, webem)
+	{
+	}
+
+	void handle_request(const request &req, reply &rep) override
+	{
+		if (request::get_req_header(&req, "Upgrade") != NULL)
+		{
+			const char *pKey = request::get_req_header(&req, "Sec-Websocket-Key");
+			if (pKey == NULL)
+			{
+				rep = reply::stock_reply(reply::bad_request);
+				return;
+			}
+			rep = reply::stock_reply(reply::switching_protocols);
+			reply::add_header(&rep, "Connection", "Upgrade");
+			reply::add_header(&rep, "Upgrade", "websocket");
+			reply::add_header(&rep, "Sec-Websocket-Accept", compute_accept_header(pKey));
+			reply::add_header(&rep, "Sec-Websocket-Protocol", "domoticz");
+			return;
+		}
+		if (req.uri.find("/json.htm") == 0)
+		{
+			SetJSONReply((req.uri.find("type=large") != std::string::npos) ? szLargeJSON : szSmallJSON, rep);
+			return;
+		}
+		request_handler::handle_request(req, rep);
+	}
+private:
+	static std::string compute_accept_header(const std::string &websocket_key)
+	{
+		unsigned char sha1result[20];
+		std::string combined = websocket_key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+		sha1::calc((void *)combined.c_str(), combined.length(), sha1result);
+		return base64_encode(sha1result, sizeof(sha1result));
+	}
+};
+
+//Websocket requests are dispatched by CWebsocketHandler through cWebem page code
+static void BenchJSONPage(WebEmSession &session, const request &req, reply &rep)
+{
+	rep.content = (req.uri.find("type=large") != std::string::npos) ? szLargeJSON : szSmallJSON;
+}
+
+class CBenchClient
+{
+public:
+	CBenchClient(boost::asio::io_service &ios, const std::string &port) :
+		m_socket(ios),
+		m_port(port),
+		m_requestid(0)
+	{
+	}
+
+	bool Connect(const _eBenchWorkload workload)
+	{
+		boost::system::error_code ec;
+		m_socket.close(ec);
+		m_buffer.clear();
+		boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string("127.0.0.1"), (unsigned short)atoi(m_port.c_str()));
+		m_socket.connect(endpoint, ec);
+		if (ec)
+			return false;
+		m_socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+		if (workload != BWL_WEBSOCKET)
+			return true;
+
+		std::string upgrade =
+			"GET /json HTTP/1.1\r\n"
+			"Host: 127.0.0.1:" + m_port + "\r\n"
+			"Connection: Upgrade\r\n"
+			"Upgrade: websocket\r\n"
+			"Origin: http://127.0.0.1\r\n"
+			"Sec-WebSocket-Version: 13\r\n"
+			"Sec-WebSocket-Protocol: domoticz\r\n"
+			"Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+			"\r\n";
+		boost::asio::write(m_socket, boost::asio::buffer(upgrade), ec);
+		if (ec)
+			return false;
+		std::string body;
+		int status = 0;
+		return ReadHTTPReply(status, body) && (status == 101);
+	}
+
+	//Performs one request/reply round trip, returns the number of bytes received (0 on error)
+	size_t Request(const _eBenchWorkload workload)
+	{
+		boost::system::error_code ec;
+		if (workload == BWL_WEBSOCKET)
+		{
+			std::string query = "{\"event\":\"request\",\"requestid\":" + std::to_string(++m_requestid) + ",\"query\":\"type=command&param=getuptime\"}";
+			boost::asio::write(m_socket, boost::asio::buffer(CWebsocketFrame::Create(opcode_text, query, true)), ec);
+			if (ec)
+				return 0;
+			return ReadWebsocketFrame();
+		}
+
+		std::string uri;
+		switch (workload)
+		{
+		case BWL_SMALL_JSON:
+			uri = "/json.htm?type=command&param=getuptime";
+			break;
+		case BWL_LARGE_JSON:
+			uri = "/json.htm?type=large";
+			break;
+		default:
+			uri = BENCH_STATIC_FILE;
+			break;
+		}
+		std::string req =
+			"GET " + uri + " HTTP/1.1\r\n"
+			"Host: 127.0.0.1:" + m_port + "\r\n"
+			"Connection: Keep-Alive\r\n"
+			"\r\n";
+		boost::asio::write(m_socket, boost::asio::buffer(req), ec);
+		if (ec)
+			return 0;
+		std::string body;
+		int status = 0;
+		if (!ReadHTTPReply(status, body) || (status != 200))
+			return 0;
+		return body.size();
+	}
+private:
+	bool ReadMore()
+	{
+		char buf[16384];
+		boost::system::error_code ec;
+		size_t bytes = m_socket.read_some(boost::asio::buffer(buf), ec);
+		if (ec)
+			return false;
+		m_buffer.append(buf, bytes);
+		return true;
+	}
+
+	bool ReadHTTPReply(int &status, std::string &body)
+	{
+		size_t header_end;
+		while ((header_end = m_buffer.find("\r\n\r\n")) == std::string::npos)
+		{
+			if (!ReadMore())
+				return false;
+		}
+		if (sscanf(m_buffer.c_str(), "HTTP/1.%*d %d", &status) != 1)
+			return false;
+
+		size_t content_length = 0;
+		std::string headers = m_buffer.substr(0, header_end);
+		std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+		size_t pos = headers.find("\r\ncontent-length:");
+		if (pos != std::string::npos)
+			content_length = (size_t)atol(headers.c_str() + pos + 17);
+
+		size_t total = header_end + 4 + content_length;
+		while (m_buffer.size() < total)
+		{
+			if (!ReadMore())
+				return false;
+		}
+		body = m_buffer.substr(header_end + 4, content_length);
+		m_buffer.erase(0, total);
+		return true;
+	}
+
+	size_t ReadWebsocketFrame()
+	{
+		while (true)
+		{
+			CWebsocketFrame frame;
+			if (!m_buffer.empty() && frame.Parse((const uint8_t*)m_buffer.data(), m_buffer.size()))
+			{
+				m_buffer.erase(0, frame.Consumed());
+				if (frame.Opcode() == opcode_text)
+					return frame.Payload().size();
+				continue; //ping or other control frame
+			}
+			if (!ReadMore())
+				return 0;
+		}
+	}
+
+	boost::asio::ip::tcp::socket m_socket;
+	std::string m_port;
+	std::string m_buffer;
+	uint64_t m_requestid;
+};
+
+static void ClientThread(const std::string port, const _eBenchWorkload workload, std::atomic<bool> *pStop, _tBenchResult *pResult)
+{
+	boost::asio::io_service ios;
+	CBenchClient client(ios, port);
+	bool bConnected = false;
+	pResult->latencies.reserve(1000000);
+	while (!*pStop)
+	{
+		if (!bConnected)
+		{
+			bConnected = client.Connect(workload);
+			if (!bConnected)
+			{
+				pResult->errors++;
+				sleep_milliseconds(10);
+				continue;
+			}
+		}
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+		size_t bytes = client.Request(workload);
+		if (bytes == 0)
+		{
+			//reconnect, the server may close a keep-alive connection at any time
+			pResult->errors++;
+			bConnected = false;
+			continue;
+		}
+		pResult->latencies.push_back((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count());
+		pResult->bytes_in += bytes;
+	}
+}
+
+static uint32_t Percentile(const std::vector<uint32_t> &sorted, const int percent)
+{
+	if (sorted.empty())
+		return 0;
+	size_t index = (sorted.size() * percent + 99) / 100;
+	return sorted[(index > 0) ? index - 1 : 0];
+}
+
+static void RunWorkload(const std::string &port, const _eBenchWorkload workload, const int clients, const int seconds)
+{
+	std::atomic<bool> bStop(false);
+	std::vector<_tBenchResult> results(clients);
+	std::vector<std::thread> threads;
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < clients; ii++)
+		threads.push_back(std::thread(ClientThread, port, workload, &bStop, &results[ii]));
+	std::this_thread::sleep_for(std::chrono::seconds(seconds));
+	bStop = true;
+	for (auto &thread : threads)
+		thread.join();
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+	std::vector<uint32_t> latencies;
+	uint64_t bytes_in = 0, errors = 0;
+	for (const auto &result : results)
+	{
+		latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+		bytes_in += result.bytes_in;
+		errors += result.errors;
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	printf("%-12s %8d %10lu %10.0f %9.1f %8u %8u %8u %8u %7lu\n",
+		szWorkloadNames[workload], clients, (unsigned long)latencies.size(),
+		latencies.size() / elapsed, (bytes_in / elapsed) / (1024 * 1024),
+		Percentile(latencies, 50), Percentile(latencies, 90), Percentile(latencies, 99),
+		latencies.empty() ? 0 : latencies.back(), (unsigned long)errors);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	std::string port = "18080";
+	int clients = 4;
+	int seconds = 5;
+	std::string szWorkload;
+	bool bEnableStats = false;
+
+	for (int ii = 1; ii < argc; ii++)
+	{
+		std::string arg = argv[ii];
+		if ((arg == "-p") && (ii + 1 < argc))
+			port = argv[++ii];
+		else if ((arg == "-c") && (ii + 1 < argc))
+			clients = atoi(argv[++ii]);
+		else if ((arg == "-d") && (ii + 1 < argc))
+			seconds = atoi(argv[++ii]);
+		else if ((arg == "-w") && (ii + 1 < argc))
+			szWorkload = argv[++ii];
+		else if (arg == "-s")
+			bEnableStats = true;
+		else
+		{
+			printf("usage: %s [-p port] [-c clients] [-d seconds] [-w small_json|large_json|static_file|websocket] [-s]\n", argv[0]);
+			return 1;
+		}
+	}
+	if ((clients < 1) || (seconds < 1))
+	{
+		printf("clients and seconds must be at least 1\n");
+		return 1;
+	}
+
+	_log.SetLogFlags(LOG_ERROR);
+	BuildReplies();
+
+	char szDocRoot[] = "/tmp/webserver_bench_XXXXXX";
+	if (mkdtemp(szDocRoot) == NULL)
+	{
+		printf("unable to create the document root\n");
+		return 1;
+	}
+	std::string doc_root = szDocRoot;
+	if (!WriteStaticFile(doc_root))
+	{
+		printf("unable to write %s%s\n", doc_root.c_str(), BENCH_STATIC_FILE);
+		return 1;
+	}
+
+	int rc = 0;
+	try
+	{
+		//cWebem is only needed for the websocket dispatch, its own server listens on the next port but is never run
+		server_settings webem_settings;
+		webem_settings.listening_address = "127.0.0.1";
+		webem_settings.listening_port = std::to_string(atoi(port.c_str()) + 1);
+		cWebem webem(webem_settings, doc_root);
+		webem.SetWebCompressionMode(WWW_FORCE_NO_GZIP_SUPPORT);
+		webem.RegisterPageCode("/json.htm", BenchJSONPage);
+		try
+		{
+			server_settings settings;
+			settings.listening_address = "127.0.0.1";
+			settings.listening_port = port;
+			CBenchRequestHandler handler(doc_root, &webem);
+			handler.stats_.enable(bEnableStats);
+			server bench_server(settings, handler);
+			std::thread server_thread(boost::bind(&server::run, &bench_server));
+
+			printf("%-12s %8s %10s %10s %9s %8s %8s %8s %8s %7s\n",
+				"workload", "clients", "requests", "req/s", "MiB/s", "p50(us)", "p90(us)", "p99(us)", "max(us)", "errors");
+			for (int ii = 0; ii < BWL_MAX; ii++)
+			{
+				if (!szWorkload.empty() && (szWorkload != szWorkloadNames[ii]))
+					continue;
+				RunWorkload(port, (_eBenchWorkload)ii, clients, seconds);
+			}
+
+			bench_server.stop();
+			server_thread.join();
+		}
+		catch (std::exception &e)
+		{
+			printf("benchmark failed: %s\n", e.what());
+			rc = 1;
+		}
+		webem.Stop();
+	}
+	catch (std::exception &e)
+	{
+		printf("unable to start the webserver: %s\n", e.what());
+		rc = 1;
+	}
+
+	unlink((doc_root + BENCH_STATIC_FILE).c_str());
+	rmdir(doc_root.c_str());
+	return rc;
+}
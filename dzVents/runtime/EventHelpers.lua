@@ -3,7 +3,7 @@ local GLOBAL = false
 local LOCAL = true
 
 local utils = require('Utils')
-local persistence = require('persistence')
+local StorageCache = require('StorageCache')
 local HTTPResponse = require('HTTPResponse')
 local Timer = require('Timer')
 local Security = require('Security')
@@ -11,6 +11,9 @@ local Security = require('Security')
 local HistoricalStorage = require('HistoricalStorage')
 local _ = require('lodash')
 
+-- scripts loaded in an earlier run of the runtime, by name: { mtime = <file modification time>, module = <script> }
+local loadedScripts = {}
+
 local function EventHelpers(domoticz, mainMethod)
 
 	local globalsDefinition
@@ -75,11 +78,10 @@ local function EventHelpers(domoticz, mainMethod)
 		--require('lodash').print(1, storageDef)
 		if (storageDef ~= nil) then
 			-- load the datafile for this module
-			ok, fileStorage = pcall(require, module)
+			ok, fileStorage = StorageCache.load(module)
 			if type(fileStorage) == boolean then
 				utils.log('Problem with module: ' .. module, utils.LOG_ERROR)
 			end
-			package.loaded[module] = nil -- no caching
 			if (ok) then
 				-- only transfer data as defined in storageDef
 				for _var, _def in pairs(storageDef) do
@@ -160,10 +162,8 @@ local function EventHelpers(domoticz, mainMethod)
 					end
 				end
 			end
-			local ok, err = pcall(persistence.store, dataFilePath, data)
+			local ok, err = pcall(StorageCache.store, dataFileModuleName, dataFilePath, data)
 
-			-- make sure there is no cache for this 'data' module
-			package.loaded[dataFileModuleName] = nil
 			if (not ok) then
 				utils.log('There was a problem writing the storage values', utils.LOG_ERROR)
 				utils.log(err, utils.LOG_ERROR)
@@ -301,6 +301,22 @@ local function EventHelpers(domoticz, mainMethod)
 			return {}
 		end
 
+		-- domoticz keeps the list of scripts and watches the folders for changes
+		if (_G.dzVents_listScripts ~= nil) then
+			local scripts = _G.dzVents_listScripts(type)
+			if (scripts ~= nil) then
+				for i, script in ipairs(scripts) do
+					table.insert(t, {
+						['type'] = type,
+						['name'] = script.name,
+						['mtime'] = script.mtime
+					})
+					namesLookup[script.name] = true
+				end
+				return t, namesLookup
+			end
+		end
+
 		if (sep == '/') then
 			cmd = 'ls -a "' .. directory .. '"'
 		else
@@ -505,6 +521,18 @@ local function EventHelpers(domoticz, mainMethod)
 			table.insert(modules, 1, globalModule)
 		end
 
+		-- forget the scripts that are gone
+		local present = {}
+		for i, moduleInfo in pairs(modules) do
+			present[moduleInfo.name] = true
+		end
+		for name, loaded in pairs(loadedScripts) do
+			if (not present[name]) then
+				loadedScripts[name] = nil
+				package.loaded[name] = nil
+			end
+		end
+
 		for i, moduleInfo in ipairs(modules) do
 
 			local module, skip
@@ -524,7 +552,20 @@ local function EventHelpers(domoticz, mainMethod)
 
 			ok = true
 
-			ok, module = pcall(require, moduleName)
+			local loaded = loadedScripts[moduleName]
+			if (moduleInfo.mtime == nil) then
+				ok, module = pcall(require, moduleName)
+			elseif (loaded ~= nil and loaded.mtime == moduleInfo.mtime) then
+				-- unchanged since it was loaded in an earlier run
+				module = loaded.module
+			else
+				package.loaded[moduleName] = nil
+				loadedScripts[moduleName] = nil
+				ok, module = pcall(require, moduleName)
+				if (ok) then
+					loadedScripts[moduleName] = { ['mtime'] = moduleInfo.mtime, ['module'] = module }
+				end
+			end
 
 			_G.domoticz = nil
 
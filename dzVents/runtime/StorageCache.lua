@@ -0,0 +1,130 @@
+-- Keeps the persistent data of the scripts in memory so reading it does not touch the disk.
+-- The data files are written behind: at most every FLUSH_INTERVAL seconds and when
+-- domoticz stops the runtime (dzVents_flushStorage). When a run is abandoned, domoticz
+-- hands what it did not write yet over to the new runtime (dzVents_pendingStorage/dzVents_adoptStorage).
+
+local persistence = require('persistence')
+local utils = require('Utils')
+
+local FLUSH_INTERVAL = 60 -- seconds
+
+local entries = {} -- by data module name: { source = <serialized data>, filePath = <data file>, dirty = <not written yet>, stored = <by this runtime> }
+local lastFlush = os.time()
+
+-- file object for persistence.store, collects the serialized data
+local function StringFile()
+	local parts = {}
+	return {
+		write = function(self, s)
+			table.insert(parts, s)
+		end,
+		close = function(self)
+		end,
+		toString = function(self)
+			return table.concat(parts)
+		end
+	}
+end
+
+local function writeFile(filePath, source)
+	local file, err = io.open(filePath, 'w')
+	if (not file) then
+		return false, err
+	end
+	file:write(source)
+	file:close()
+	return true
+end
+
+local self = {}
+
+-- returns ok, data like pcall(require, moduleName) would
+function self.load(moduleName)
+	if (_G.TESTMODE) then
+		local ok, data = pcall(require, moduleName)
+		package.loaded[moduleName] = nil
+		return ok, data
+	end
+
+	local entry = entries[moduleName]
+	if (entry == nil) then
+		local source
+		local filePath = package.searchpath(moduleName, package.path)
+		if (filePath ~= nil) then
+			local file = io.open(filePath, 'r')
+			if (file ~= nil) then
+				source = file:read('*a')
+				file:close()
+			end
+		end
+		entry = { ['source'] = source, ['filePath'] = filePath, ['dirty'] = false }
+		entries[moduleName] = entry
+	end
+
+	if (entry.source == nil) then
+		return false, 'module ' .. moduleName .. ' not found'
+	end
+	local chunk, err = load(entry.source, '=' .. moduleName)
+	if (chunk == nil) then
+		return false, err
+	end
+	return pcall(chunk)
+end
+
+function self.store(moduleName, filePath, data)
+	if (_G.TESTMODE) then
+		persistence.store(filePath, data)
+		return
+	end
+
+	local file = StringFile()
+	persistence.store(file, data)
+	entries[moduleName] = { ['source'] = file:toString(), ['filePath'] = filePath, ['dirty'] = true, ['stored'] = true }
+end
+
+-- the data that is not written yet
+function self.pending()
+	local result = {}
+	for moduleName, entry in pairs(entries) do
+		if (entry.dirty) then
+			result[moduleName] = { ['filePath'] = entry.filePath, ['source'] = entry.source }
+		end
+	end
+	return result
+end
+
+-- takes over data an abandoned runtime did not write, unless this runtime stored newer data itself
+function self.adopt(moduleName, filePath, source)
+	local entry = entries[moduleName]
+	if (entry ~= nil and entry.stored) then
+		return
+	end
+	entries[moduleName] = { ['source'] = source, ['filePath'] = filePath, ['dirty'] = true }
+end
+
+function self.flush(force)
+	-- a run that domoticz abandoned (took too long) must not overwrite the data of the new runtime
+	if (_G.dzVents_isCurrentRuntime ~= nil and not _G.dzVents_isCurrentRuntime()) then
+		return
+	end
+
+	local now = os.time()
+	if (not force and os.difftime(now, lastFlush) < FLUSH_INTERVAL) then
+		return
+	end
+	lastFlush = now
+
+	for moduleName, entry in pairs(entries) do
+		if (entry.dirty) then
+			local ok, err = writeFile(entry.filePath, entry.source)
+			if (ok) then
+				entry.dirty = false
+			else
+				utils.log('There was a problem writing the storage values of ' .. moduleName, utils.LOG_ERROR)
+				utils.log(err, utils.LOG_ERROR)
+			end
+		end
+	end
+end
+
+return self
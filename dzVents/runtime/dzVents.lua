@@ -1,3 +1,6 @@
+-- the Lua state is reused, never leave the commands of the previous run in place
+commandArray = {}
+
 local TESTMODE = false
 globalvariables['testmode'] = false
 --globalvariables['dzVents_log_level'] = 4 --debug
@@ -14,17 +17,32 @@ _G.scriptsFolderPath = scriptPath .. 'scripts' -- global
 _G.generatedScriptsFolderPath = scriptPath .. 'generated_scripts' -- global
 _G.dataFolderPath = scriptPath .. 'data' -- global
 
-package.path = package.path .. ';' .. scriptPath .. '?.lua'
-package.path = package.path .. ';' .. runtimePath .. '?.lua'
-package.path = package.path .. ';' .. runtimePath .. 'device-adapters/?.lua'
-package.path = package.path .. ';' .. scriptPath .. 'dzVents/?.lua'
-package.path = package.path .. ';' .. scriptPath .. 'scripts/?.lua'
-package.path = package.path .. ';' .. scriptPath .. '../lua/?.lua'
-package.path = package.path .. ';' .. scriptPath .. 'scripts/modules/?.lua'
-package.path = package.path .. ';' .. scriptPath .. '?.lua'
-package.path = package.path .. ';' .. scriptPath .. 'generated_scripts/?.lua'
-package.path = package.path .. ';' .. scriptPath .. 'data/?.lua'
-package.path = package.path .. ';' .. scriptPath .. 'modules/?.lua'
+-- domoticz keeps the Lua state between runs, only set it up the first time
+if (not _G.dzVentsInitialized) then
+	package.path = package.path .. ';' .. scriptPath .. '?.lua'
+	package.path = package.path .. ';' .. runtimePath .. '?.lua'
+	package.path = package.path .. ';' .. runtimePath .. 'device-adapters/?.lua'
+	package.path = package.path .. ';' .. scriptPath .. 'dzVents/?.lua'
+	package.path = package.path .. ';' .. scriptPath .. 'scripts/?.lua'
+	package.path = package.path .. ';' .. scriptPath .. '../lua/?.lua'
+	package.path = package.path .. ';' .. scriptPath .. 'scripts/modules/?.lua'
+	package.path = package.path .. ';' .. scriptPath .. '?.lua'
+	package.path = package.path .. ';' .. scriptPath .. 'generated_scripts/?.lua'
+	package.path = package.path .. ';' .. scriptPath .. 'data/?.lua'
+	package.path = package.path .. ';' .. scriptPath .. 'modules/?.lua'
+
+	_G.dzVents_flushStorage = function()
+		require('StorageCache').flush(true)
+	end
+	_G.dzVents_pendingStorage = function()
+		return require('StorageCache').pending()
+	end
+	_G.dzVents_adoptStorage = function(moduleName, filePath, source)
+		require('StorageCache').adopt(moduleName, filePath, source)
+	end
+
+	_G.dzVentsInitialized = true
+end
 
 local EventHelpers = require('EventHelpers')
 local helpers = EventHelpers()
@@ -66,4 +84,6 @@ helpers.dispatchSceneGroupEventsToScripts()
 helpers.dispatchHTTPResponseEventsToScripts()
 commandArray = helpers.domoticz.commandArray
 
+require('StorageCache').flush(false)
+
 return commandArray
@@ -112,6 +112,21 @@ describe('event helpers', function()
 			local f = {'f1','f2','f3', 'lua' }
 			assert.are.same(f, _.pluck(files, {'name'}))
 		end)
+
+		it('should get the list of scripts from domoticz when available', function()
+			_G.dzVents_listScripts = function(type)
+				assert.is_same('external', type)
+				return { { name = 'a', mtime = 1 }, { name = 'b', mtime = 2 } }
+			end
+
+			local files, names = helpers.scandir('scandir', 'external')
+			_G.dzVents_listScripts = nil
+
+			assert.are.same({'a', 'b'}, _.pluck(files, {'name'}))
+			assert.are.same({1, 2}, _.pluck(files, {'mtime'}))
+			assert.is_same('external', files[1].type)
+			assert.is_true(names['b'])
+		end)
 	end)
 
 	describe('Time rules', function()
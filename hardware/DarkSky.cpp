@@ -49,7 +49,8 @@ std::string ReadFile(std::string filename)
 
 CDarkSky::CDarkSky(const int ID, const std::string &APIKey, const std::string &Location) :
 m_APIKey(APIKey),
-m_Location(Location)
+m_Location(Location),
+m_PollJobID(0)
 {
 	m_HwdID=ID;
 	Init();
@@ -68,43 +69,48 @@ bool CDarkSky::StartHardware()
 	RequestStart();
 
 	Init();
-	//Start worker thread
-	m_thread = std::make_shared<std::thread>(&CDarkSky::Do_Work, this);
-	SetThreadNameInt(m_thread->native_handle());
+
+	std::stringstream sURL;
+	std::string szExclude = "minutely,hourly,daily,alerts,flags";
+	sURL << "https://api.darksky.net/forecast/" << m_APIKey << "/" << m_Location << "?exclude=" << szExclude;
+
+	CHttpPollerPool::_tRequest request;
+	request.URL = sURL.str();
+
+	//polled by the shared poller pool, which also keeps our heartbeat
+	m_LastHeartbeat = mytime(NULL);
+	m_PollJobID = CHttpPollerPool::GetInstance().Register(this, "DarkSky", request, 300, std::bind(&CDarkSky::OnResponse, this, std::placeholders::_1, std::placeholders::_2), 10);
+	Log(LOG_STATUS, "Started...");
 	m_bIsStarted=true;
 	sOnConnected(this);
-	return (m_thread != nullptr);
+	return true;
 }
 
 bool CDarkSky::StopHardware()
 {
-	if (m_thread)
+	if (m_PollJobID != 0)
 	{
 		RequestStop();
-		m_thread->join();
-		m_thread.reset();
+		CHttpPollerPool::GetInstance().Unregister(m_PollJobID);
+		m_PollJobID = 0;
+		Log(LOG_STATUS, "Worker stopped...");
 	}
-    m_bIsStarted=false;
-    return true;
+	m_bIsStarted=false;
+	return true;
 }
 
-void CDarkSky::Do_Work()
+void CDarkSky::OnResponse(const bool bOK, const std::string &response)
 {
-	Log(LOG_STATUS, "Started...");
-
-	int sec_counter = 290;
-	while (!IsStopRequested(1000))
-	{
-		sec_counter++;
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat = mytime(NULL);
-		}
-		if (sec_counter % 300 == 0)
-		{
-			GetMeterDetails();
-		}
-	}
-	Log(LOG_STATUS,"Worker stopped...");
+#ifdef DEBUG_DarkSkyR
+	GetMeterDetails(ReadFile("E:\\DarkSky.json"));
+#else
+	if (!bOK)
+		return;
+#ifdef DEBUG_DarkSkyW
+	SaveString2Disk(response, "E:\\DarkSky.json");
+#endif
+	GetMeterDetails(response);
+#endif
 }
 
 bool CDarkSky::WriteToHardware(const char* /*pdata*/, const unsigned char /*length*/)
@@ -120,34 +126,8 @@ std::string CDarkSky::GetForecastURL()
 	return sURL.str();
 }
 
-void CDarkSky::GetMeterDetails()
+void CDarkSky::GetMeterDetails(const std::string &sResult)
 {
-	std::string sResult;
-#ifdef DEBUG_DarkSkyR
-	sResult=ReadFile("E:\\DarkSky.json");
-#else
-	std::stringstream sURL;
-	std::string szLoc = m_Location;
-	std::string szExclude = "minutely,hourly,daily,alerts,flags";
-	sURL << "https://api.darksky.net/forecast/" << m_APIKey << "/" << szLoc << "?exclude=" << szExclude;
-	try
-	{
-		if (!HTTPClient::GET(sURL.str(), sResult))
-		{
-			Log(LOG_ERROR, "Error getting http data!.");
-			return;
-		}
-	}
-	catch (...)
-	{
-		Log(LOG_ERROR, "Error getting http data!");
-		return;
-	}
-#ifdef DEBUG_DarkSkyW
-	SaveString2Disk(sResult, "E:\\DarkSky.json");
-#endif
-
-#endif
 	Json::Value root;
 
 	bool ret = ParseJSon(sResult, root);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DomoticzHardware.h"
+#include "HttpPollerPool.h"
 
 class CDarkSky : public CDomoticzHardwareBase
 {
@@ -13,11 +14,11 @@ private:
 	void Init();
 	bool StartHardware() override;
 	bool StopHardware() override;
-	void Do_Work();
-	void GetMeterDetails();
+	void OnResponse(const bool bOK, const std::string &response);
+	void GetMeterDetails(const std::string &sResult);
 private:
 	std::string m_APIKey;
 	std::string m_Location;
-	std::shared_ptr<std::thread> m_thread;
+	int m_PollJobID;
 };
 
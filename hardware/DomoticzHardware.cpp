@@ -9,6 +9,8 @@
 #include "../main/mainworker.h"
 #include "hardwaretypes.h"
 #include "HardwareCereal.h"
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
 
 #define round(a) ( int ) ( a + .5 )
 
@@ -127,6 +129,104 @@ int CDomoticzHardwareBase::SetThreadNameInt(const std::thread::native_handle_typ
 	return SetThreadName(thread, m_ShortName.c_str());
 }
 
+void CDomoticzHardwareBase::BeginRxBatch()
+{
+	std::lock_guard<std::mutex> l(m_rxBatchMutex);
+	if (m_rxBatchDepth == 0)
+	{
+		m_rxBatchThread = std::this_thread::get_id();
+		m_rxBatch.clear();
+	}
+	else if (m_rxBatchThread != std::this_thread::get_id())
+	{
+		//another thread has a batch open, messages of this thread are sent directly
+		return;
+	}
+	m_rxBatchDepth++;
+}
+
+void CDomoticzHardwareBase::EndRxBatch()
+{
+	std::vector<_tRxBatchMessage> messages;
+	{
+		std::lock_guard<std::mutex> l(m_rxBatchMutex);
+		if ((m_rxBatchDepth == 0) || (m_rxBatchThread != std::this_thread::get_id()))
+			return;
+		m_rxBatchDepth--;
+		if (m_rxBatchDepth > 0)
+			return;
+		messages.swap(m_rxBatch);
+		m_rxBatchThread = std::thread::id();
+	}
+	if (messages.empty())
+		return;
+	if (!sDecodeRXMessageBatch.empty())
+	{
+		sDecodeRXMessageBatch(this, messages);
+		return;
+	}
+	for (const auto & itt : messages)
+		sDecodeRXMessage(this, itt.RXCommand, itt.Name.c_str(), itt.BatteryLevel);
+}
+
+void CDomoticzHardwareBase::SendRxMessage(const unsigned char *pRXCommand, const char *defaultName, const int BatteryLevel)
+{
+	{
+		std::lock_guard<std::mutex> l(m_rxBatchMutex);
+		if ((m_rxBatchDepth > 0) && (m_rxBatchThread == std::this_thread::get_id()))
+		{
+			m_rxBatch.resize(m_rxBatch.size() + 1);
+			_tRxBatchMessage &message = m_rxBatch.back();
+			message.BatteryLevel = BatteryLevel;
+			if (defaultName != NULL)
+				message.Name = defaultName;
+			memcpy(message.RXCommand, pRXCommand, pRXCommand[0] + 1);
+			return;
+		}
+	}
+	sDecodeRXMessage(this, pRXCommand, defaultName, BatteryLevel);
+}
+
+bool CDomoticzHardwareBase::FindDeviceRowIdx(const std::string &DeviceID, const int Unit, const int Type, const int SubType, uint64_t &DeviceRowIdx)
+{
+	char szKey[80];
+	snprintf(szKey, sizeof(szKey), "%d/%d/%d/", Unit, Type, SubType);
+	std::string sKey = szKey + DeviceID;
+
+	uint64_t generation = m_sql.GetDeviceDeleteGeneration();
+	{
+		std::lock_guard<std::mutex> l(m_deviceCacheMutex);
+		if (generation != m_deviceCacheGeneration)
+		{
+			//a device was deleted, the cached row ids could be gone
+			m_deviceCache.clear();
+			m_deviceCacheGeneration = generation;
+		}
+		std::map<std::string, uint64_t>::const_iterator itt = m_deviceCache.find(sKey);
+		if (itt != m_deviceCache.end())
+		{
+			DeviceRowIdx = itt->second;
+			return true;
+		}
+	}
+
+	std::vector<std::vector<std::string> > result;
+	if (Unit < 0)
+		result = m_sql.safe_query("SELECT ID FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Type==%d) AND (Subtype==%d)",
+			m_HwdID, DeviceID.c_str(), Type, SubType);
+	else
+		result = m_sql.safe_query("SELECT ID FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Unit == %d) AND (Type==%d) AND (Subtype==%d)",
+			m_HwdID, DeviceID.c_str(), Unit, Type, SubType);
+	if (result.empty())
+		return false; //not cached, the device can be created any moment
+	DeviceRowIdx = std::strtoull(result[0][0].c_str(), nullptr, 10);
+
+	std::lock_guard<std::mutex> l(m_deviceCacheMutex);
+	if (generation == m_deviceCacheGeneration)
+		m_deviceCache[sKey] = DeviceRowIdx;
+	return true;
+}
+
 //Log Helper functions
 #define MAX_LOG_LINE_LENGTH (2048*3)
 void CDomoticzHardwareBase::Log(const _eLogLevel level, const std::string& sLogline)
@@ -176,7 +276,7 @@ void CDomoticzHardwareBase::SendTempSensor(const int NodeID, const int BatteryLe
 	tsen.TEMP.temperatureh = (BYTE)(at10 / 256);
 	at10 -= (tsen.TEMP.temperatureh * 256);
 	tsen.TEMP.temperaturel = (BYTE)(at10);
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.TEMP, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.TEMP, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendHumiditySensor(const int NodeID, const int BatteryLevel, const int humidity, const std::string& defaultname, const int RssiLevel /* =12 */)
@@ -192,7 +292,7 @@ void CDomoticzHardwareBase::SendHumiditySensor(const int NodeID, const int Batte
 	tsen.HUM.id2 = NodeID & 0xFF;
 	tsen.HUM.humidity = (BYTE)humidity;
 	tsen.HUM.humidity_status = Get_Humidity_Level(tsen.HUM.humidity);
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.HUM, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.HUM, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendBaroSensor(const int NodeID, const int ChildID, const int BatteryLevel, const float pressure, const int forecast, const std::string& defaultname)
@@ -202,7 +302,7 @@ void CDomoticzHardwareBase::SendBaroSensor(const int NodeID, const int ChildID,
 	gdevice.intval1 = (NodeID << 8) | ChildID;
 	gdevice.intval2 = forecast;
 	gdevice.floatval1 = pressure;
-	sDecodeRXMessage(this, (const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendTempHumSensor(const int NodeID, const int BatteryLevel, const float temperature, const int humidity, const std::string& defaultname, const int RssiLevel /* =12 */)
@@ -225,7 +325,7 @@ void CDomoticzHardwareBase::SendTempHumSensor(const int NodeID, const int Batter
 	tsen.TEMP_HUM.humidity = (BYTE)humidity;
 	tsen.TEMP_HUM.humidity_status = Get_Humidity_Level(tsen.TEMP_HUM.humidity);
 
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.TEMP_HUM, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.TEMP_HUM, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendTempHumBaroSensor(const int NodeID, const int BatteryLevel, const float temperature, const int humidity, const float pressure, int forecast, const std::string& defaultname, const int RssiLevel /* =12 */)
@@ -255,7 +355,7 @@ void CDomoticzHardwareBase::SendTempHumBaroSensor(const int NodeID, const int Ba
 
 	tsen.TEMP_HUM_BARO.forecast = (BYTE)forecast;
 
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.TEMP_HUM_BARO, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.TEMP_HUM_BARO, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendTempHumBaroSensorFloat(const int NodeID, const int BatteryLevel, const float temperature, const int humidity, const float pressure, const uint8_t forecast, const std::string& defaultname, const int RssiLevel /* =12 */)
@@ -284,7 +384,7 @@ void CDomoticzHardwareBase::SendTempHumBaroSensorFloat(const int NodeID, const i
 	tsen.TEMP_HUM_BARO.barol = (BYTE)(ab10);
 	tsen.TEMP_HUM_BARO.forecast = forecast;
 
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.TEMP_HUM_BARO, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.TEMP_HUM_BARO, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendTempBaroSensor(const uint8_t NodeID, const int BatteryLevel, const float temperature, const float pressure, const std::string& defaultname)
@@ -307,7 +407,7 @@ void CDomoticzHardwareBase::SendTempBaroSensor(const uint8_t NodeID, const int B
 		tsensor.forecast = baroForecastPartlyCloudy;
 	else
 		tsensor.forecast = baroForecastSunny;
-	sDecodeRXMessage(this, (const unsigned char*)& tsensor, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsensor, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendSetPointSensor(const uint8_t NodeID, const uint8_t ChildID, const unsigned char SensorID, const float Temp, const std::string& defaultname)
@@ -322,7 +422,7 @@ void CDomoticzHardwareBase::SendSetPointSensor(const uint8_t NodeID, const uint8
 
 	thermos.temp = Temp;
 
-	sDecodeRXMessage(this, (const unsigned char*)& thermos, defaultname.c_str(), -1);
+	SendRxMessage((const unsigned char*)& thermos, defaultname.c_str(), -1);
 }
 
 
@@ -332,7 +432,7 @@ void CDomoticzHardwareBase::SendDistanceSensor(const int NodeID, const int Child
 	gdevice.subtype = sTypeDistance;
 	gdevice.intval1 = (NodeID << 8) | ChildID;
 	gdevice.floatval1 = distance;
-	sDecodeRXMessage(this, (const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendTextSensor(const int NodeID, const int ChildID, const int BatteryLevel, const std::string& textMessage, const std::string& defaultname)
@@ -344,7 +444,7 @@ void CDomoticzHardwareBase::SendTextSensor(const int NodeID, const int ChildID,
 	if (sstatus.size() > 63)
 		sstatus = sstatus.substr(0, 63);
 	strcpy(gdevice.text, sstatus.c_str());
-	sDecodeRXMessage(this, (const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
 }
 
 std::string CDomoticzHardwareBase::GetTextSensorText(const int NodeID, const int ChildID, bool& bExists)
@@ -389,7 +489,7 @@ void CDomoticzHardwareBase::SendRainSensor(const int NodeID, const int BatteryLe
 	tsen.RAIN.raintotal2 = (BYTE)(tr10 / 256);
 	tr10 -= (tsen.RAIN.raintotal2 * 256);
 	tsen.RAIN.raintotal3 = (BYTE)(tr10);
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.RAIN, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.RAIN, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendRainSensorWU(const int NodeID, const int BatteryLevel, const float RainCounter, const float LastHour, const std::string& defaultname, const int RssiLevel)
@@ -421,7 +521,7 @@ void CDomoticzHardwareBase::SendRainSensorWU(const int NodeID, const int Battery
 	tr10 -= (tsen.RAIN.raintotal2 * 256);
 	tsen.RAIN.raintotal3 = (BYTE)(tr10);
 
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.RAIN, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.RAIN, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendRainRateSensor(const int NodeID, const int BatteryLevel, const float RainRate, const std::string& defaultname, const int RssiLevel /* =12 */)
@@ -445,7 +545,7 @@ void CDomoticzHardwareBase::SendRainRateSensor(const int NodeID, const int Batte
 	tsen.RAIN.raintotal2 = 0;
 	tsen.RAIN.raintotal3 = 0;
 
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.RAIN, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.RAIN, defaultname.c_str(), BatteryLevel);
 }
 
 float CDomoticzHardwareBase::GetRainSensorValue(const int NodeID, bool& bExists)
@@ -514,7 +614,7 @@ void CDomoticzHardwareBase::SendWattMeter(const uint8_t NodeID, const uint8_t Ch
 	umeter.id4 = NodeID;
 	umeter.dunit = ChildID;
 	umeter.fusage = musage;
-	sDecodeRXMessage(this, (const unsigned char*)& umeter, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& umeter, defaultname.c_str(), BatteryLevel);
 }
 
 //Obsolete, we should not call this anymore
@@ -531,7 +631,7 @@ void CDomoticzHardwareBase::SendKwhMeter(const int NodeID, const int ChildID, co
 	gdevice.intval1 = (NodeID << 8) | ChildID;
 	gdevice.floatval1 = (float)musage;
 	gdevice.floatval2 = (float)(mtotal * 1000.0);
-	sDecodeRXMessage(this, (const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
 }
 
 double CDomoticzHardwareBase::GetKwhMeter(const int NodeID, const int ChildID, bool& bExists)
@@ -540,15 +640,14 @@ double CDomoticzHardwareBase::GetKwhMeter(const int NodeID, const int ChildID, b
 	char szTmp[30];
 	sprintf(szTmp, "%08X", dID);
 
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT ID FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Type==%d) AND (Subtype==%d)",
-		m_HwdID, szTmp, int(pTypeGeneral), int(sTypeKwh));
-	if (result.empty())
+	uint64_t DeviceRowIdx;
+	if (!FindDeviceRowIdx(szTmp, -1, pTypeGeneral, sTypeKwh, DeviceRowIdx))
 	{
 		bExists = false;
 		return 0;
 	}
-	result = m_sql.safe_query("SELECT MAX(Counter) FROM Meter_Calendar WHERE (DeviceRowID=='%q')", result[0][0].c_str());
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query("SELECT MAX(Counter) FROM Meter_Calendar WHERE (DeviceRowID==%" PRIu64 ")", DeviceRowIdx);
 	if (result.empty())
 	{
 		bExists = false;
@@ -574,7 +673,7 @@ void CDomoticzHardwareBase::SendMeterSensor(const int NodeID, const int ChildID,
 	tsen.RFXMETER.count2 = (BYTE)((counter & 0x00FF0000) >> 16);
 	tsen.RFXMETER.count3 = (BYTE)((counter & 0x0000FF00) >> 8);
 	tsen.RFXMETER.count4 = (BYTE)(counter & 0x000000FF);
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.RFXMETER, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.RFXMETER, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendLuxSensor(const uint8_t NodeID, const uint8_t ChildID, const uint8_t BatteryLevel, const float Lux, const std::string& defaultname)
@@ -587,7 +686,7 @@ void CDomoticzHardwareBase::SendLuxSensor(const uint8_t NodeID, const uint8_t Ch
 	lmeter.dunit = ChildID;
 	lmeter.fLux = Lux;
 	lmeter.battery_level = BatteryLevel;
-	sDecodeRXMessage(this, (const unsigned char*)& lmeter, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& lmeter, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendAirQualitySensor(const uint8_t NodeID, const uint8_t ChildID, const int BatteryLevel, const int AirQuality, const std::string& defaultname)
@@ -599,7 +698,7 @@ void CDomoticzHardwareBase::SendAirQualitySensor(const uint8_t NodeID, const uin
 	meter.airquality = AirQuality;
 	meter.id1 = NodeID;
 	meter.id2 = ChildID;
-	sDecodeRXMessage(this, (const unsigned char*)& meter, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& meter, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendUsageSensor(const uint8_t NodeID, const uint8_t ChildID, const int BatteryLevel, const float Usage, const std::string& defaultname)
@@ -611,7 +710,7 @@ void CDomoticzHardwareBase::SendUsageSensor(const uint8_t NodeID, const uint8_t
 	umeter.id4 = NodeID;
 	umeter.dunit = ChildID;
 	umeter.fusage = Usage;
-	sDecodeRXMessage(this, (const unsigned char*)& umeter, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& umeter, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendSwitchIfNotExists(const int NodeID, const uint8_t ChildID, const int BatteryLevel, const bool bOn, const double Level, const std::string& defaultname)
@@ -624,10 +723,8 @@ void CDomoticzHardwareBase::SendSwitchIfNotExists(const int NodeID, const uint8_
 
 	char szIdx[10];
 	sprintf(szIdx, "%X%02X%02X%02X", ID1, ID2, ID3, ID4);
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT Name,nValue,sValue FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Unit == %d) AND (Type==%d) AND (Subtype==%d)",
-		m_HwdID, szIdx, ChildID, int(pTypeLighting2), int(sTypeAC));
-	if (result.empty())
+	uint64_t DeviceRowIdx;
+	if (!FindDeviceRowIdx(szIdx, ChildID, pTypeLighting2, sTypeAC, DeviceRowIdx))
 	{
 		SendSwitch(NodeID, ChildID, BatteryLevel, bOn, Level, defaultname);
 	}
@@ -669,7 +766,7 @@ void CDomoticzHardwareBase::SendSwitchUnchecked(const int NodeID, const uint8_t
 	lcmd.LIGHTING2.level = level;
 	lcmd.LIGHTING2.filler = 0;
 	lcmd.LIGHTING2.rssi = RssiLevel;
-	sDecodeRXMessage(this, (const unsigned char*)& lcmd.LIGHTING2, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& lcmd.LIGHTING2, defaultname.c_str(), BatteryLevel);
 }
 
 
@@ -722,7 +819,7 @@ void CDomoticzHardwareBase::SendBlindSensor(const uint8_t NodeID, const uint8_t
 	lcmd.BLINDS1.cmnd = Command;
 	lcmd.BLINDS1.filler = 0;
 	lcmd.BLINDS1.rssi = RssiLevel;
-	sDecodeRXMessage(this, (const unsigned char*)& lcmd.BLINDS1, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& lcmd.BLINDS1, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendRGBWSwitch(const int NodeID, const uint8_t ChildID, const int BatteryLevel, const int Level, const bool bIsRGBW, const std::string& defaultname)
@@ -741,7 +838,7 @@ void CDomoticzHardwareBase::SendRGBWSwitch(const int NodeID, const uint8_t Child
 		lcmd.command = Color_LedOn;
 	lcmd.dunit = ChildID;
 	lcmd.value = (uint32_t)level;
-	sDecodeRXMessage(this, (const unsigned char*)& lcmd, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& lcmd, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendVoltageSensor(const int NodeID, const uint32_t ChildID, const int BatteryLevel, const float Volt, const std::string& defaultname)
@@ -751,7 +848,7 @@ void CDomoticzHardwareBase::SendVoltageSensor(const int NodeID, const uint32_t C
 	gDevice.id = ChildID;
 	gDevice.intval1 = (NodeID << 8) | ChildID;
 	gDevice.floatval1 = Volt;
-	sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendCurrentSensor(const int NodeID, const int BatteryLevel, const float Current1, const float Current2, const float Current3, const std::string& defaultname, const int RssiLevel /* =12 */)
@@ -781,7 +878,7 @@ void CDomoticzHardwareBase::SendCurrentSensor(const int NodeID, const int Batter
 	at10 -= (tsen.TEMP.temperatureh * 256);
 	tsen.CURRENT.ch3l = (BYTE)(at10);
 
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.CURRENT, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.CURRENT, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendPercentageSensor(const int NodeID, const uint8_t ChildID, const int BatteryLevel, const float Percentage, const std::string& defaultname)
@@ -791,17 +888,15 @@ void CDomoticzHardwareBase::SendPercentageSensor(const int NodeID, const uint8_t
 	gDevice.id = ChildID;
 	gDevice.intval1 = NodeID;
 	gDevice.floatval1 = Percentage;
-	sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 }
 
 bool CDomoticzHardwareBase::CheckPercentageSensorExists(const int NodeID, const int /*ChildID*/)
 {
-	std::vector<std::vector<std::string> > result;
 	char szTmp[30];
 	sprintf(szTmp, "%08X", (unsigned int)NodeID);
-	result = m_sql.safe_query("SELECT Name FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Type==%d) AND (Subtype==%d)",
-		m_HwdID, szTmp, int(pTypeGeneral), int(sTypePercentage));
-	return (!result.empty());
+	uint64_t DeviceRowIdx;
+	return FindDeviceRowIdx(szTmp, -1, pTypeGeneral, sTypePercentage, DeviceRowIdx);
 }
 
 void CDomoticzHardwareBase::SendWaterflowSensor(const int NodeID, const uint8_t ChildID, const int BatteryLevel, const float LPM, const std::string& defaultname)
@@ -811,7 +906,7 @@ void CDomoticzHardwareBase::SendWaterflowSensor(const int NodeID, const uint8_t
 	gDevice.id = ChildID;
 	gDevice.intval1 = (NodeID << 8) | ChildID;
 	gDevice.floatval1 = LPM;
-	sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendVisibilitySensor(const int NodeID, const int ChildID, const int BatteryLevel, const float Visibility, const std::string& defaultname)
@@ -821,7 +916,7 @@ void CDomoticzHardwareBase::SendVisibilitySensor(const int NodeID, const int Chi
 	gDevice.id = ChildID;
 	gDevice.intval1 = (NodeID << 8) | ChildID;
 	gDevice.floatval1 = Visibility;
-	sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendCustomSensor(const int NodeID, const uint8_t ChildID, const int BatteryLevel, const float CustomValue, const std::string& defaultname, const std::string& defaultLabel)
@@ -835,13 +930,11 @@ void CDomoticzHardwareBase::SendCustomSensor(const int NodeID, const uint8_t Chi
 
 	char szTmp[9];
 	sprintf(szTmp, "%08X", gDevice.intval1);
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT Name FROM DeviceStatus WHERE (HardwareID==%d) AND (DeviceID=='%q') AND (Type==%d) AND (Subtype==%d)",
-		m_HwdID, szTmp, int(pTypeGeneral), int(sTypeCustom));
-	bool bDoesExists = !result.empty();
+	uint64_t DeviceRowIdx;
+	bool bDoesExists = FindDeviceRowIdx(szTmp, -1, pTypeGeneral, sTypeCustom, DeviceRowIdx);
 
 	if (bDoesExists)
-		sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+		SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 	else
 	{
 		m_mainworker.PushAndWaitRxMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
@@ -915,7 +1008,7 @@ void CDomoticzHardwareBase::SendWind(const int NodeID, const int BatteryLevel, c
 		tsen.WIND.chilll = (BYTE)(at10);
 	}
 
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.WIND, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.WIND, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendPressureSensor(const int NodeID, const int ChildID, const int BatteryLevel, const float pressure, const std::string& defaultname)
@@ -924,7 +1017,7 @@ void CDomoticzHardwareBase::SendPressureSensor(const int NodeID, const int Child
 	gdevice.subtype = sTypePressure;
 	gdevice.intval1 = (NodeID << 8) | ChildID;
 	gdevice.floatval1 = pressure;
-	sDecodeRXMessage(this, (const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendSolarRadiationSensor(const unsigned char NodeID, const int BatteryLevel, const float radiation, const std::string& defaultname)
@@ -933,7 +1026,7 @@ void CDomoticzHardwareBase::SendSolarRadiationSensor(const unsigned char NodeID,
 	gdevice.subtype = sTypeSolarRadiation;
 	gdevice.id = NodeID;
 	gdevice.floatval1 = radiation;
-	sDecodeRXMessage(this, (const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gdevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendSoundSensor(const int NodeID, const int BatteryLevel, const int sLevel, const std::string& defaultname)
@@ -943,7 +1036,7 @@ void CDomoticzHardwareBase::SendSoundSensor(const int NodeID, const int BatteryL
 	gDevice.id = 1;
 	gDevice.intval1 = NodeID;
 	gDevice.intval2 = sLevel;
-	sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendAlertSensor(const int NodeID, const int BatteryLevel, const int alertLevel, const std::string& message, const std::string& defaultname)
@@ -953,7 +1046,7 @@ void CDomoticzHardwareBase::SendAlertSensor(const int NodeID, const int BatteryL
 	gDevice.id = (unsigned char)NodeID;
 	gDevice.intval1 = alertLevel;
 	sprintf(gDevice.text, "%.63s", message.c_str());
-	sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendGeneralSwitch(const int NodeID, const int ChildID, const int BatteryLevel, const uint8_t SwitchState, const uint8_t Level, const std::string& defaultname, const int RssiLevel)
@@ -964,7 +1057,7 @@ void CDomoticzHardwareBase::SendGeneralSwitch(const int NodeID, const int ChildI
 	gSwitch.cmnd = SwitchState;
 	gSwitch.level = Level;
 	gSwitch.rssi = (uint8_t)RssiLevel;
-	sDecodeRXMessage(this, (const unsigned char*)& gSwitch, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gSwitch, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendMoistureSensor(const int NodeID, const int BatteryLevel, const int mLevel, const std::string& defaultname)
@@ -974,7 +1067,7 @@ void CDomoticzHardwareBase::SendMoistureSensor(const int NodeID, const int Batte
 	gDevice.id = 1;
 	gDevice.intval1 = NodeID;
 	gDevice.intval2 = mLevel;
-	sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendUVSensor(const int NodeID, const int ChildID, const int BatteryLevel, const float UVI, const std::string& defaultname, const int RssiLevel /* =12 */)
@@ -990,7 +1083,7 @@ void CDomoticzHardwareBase::SendUVSensor(const int NodeID, const int ChildID, co
 	tsen.UV.id2 = (unsigned char)ChildID;
 
 	tsen.UV.uv = (BYTE)round(UVI * 10);
-	sDecodeRXMessage(this, (const unsigned char*)& tsen.UV, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& tsen.UV, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendZWaveAlarmSensor(const int NodeID, const uint8_t InstanceID, const int BatteryLevel, const uint8_t aType, const int aValue, const std::string& alarmLabel, const std::string& defaultname)
@@ -1012,7 +1105,7 @@ void CDomoticzHardwareBase::SendZWaveAlarmSensor(const int NodeID, const uint8_t
 	strncpy(gDevice.text, alarmLabel.c_str(), maxChars);
 	gDevice.text[maxChars] = 0;
 
-	sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 }
 
 void CDomoticzHardwareBase::SendFanSensor(const int Idx, const int BatteryLevel, const int FanSpeed, const std::string& defaultname)
@@ -1022,5 +1115,5 @@ void CDomoticzHardwareBase::SendFanSensor(const int Idx, const int BatteryLevel,
 	gDevice.id = 1;
 	gDevice.intval1 = Idx;
 	gDevice.intval2 = FanSpeed;
-	sDecodeRXMessage(this, (const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
+	SendRxMessage((const unsigned char*)& gDevice, defaultname.c_str(), BatteryLevel);
 }
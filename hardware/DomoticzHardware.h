@@ -3,6 +3,7 @@
 #include <boost/signals2.hpp>
 #include "../main/RFXNames.h"
 #include "../main/StoppableTask.h"
+#include "../main/RxMessageQueue.h"
 // type support
 #include "../cereal/types/string.hpp"
 #include "../cereal/types/memory.hpp"
@@ -45,10 +46,17 @@ public:
 	unsigned char m_SeqNr = { 0 };
 	bool m_bEnableReceive = { false };
 	boost::signals2::signal<void(CDomoticzHardwareBase *pHardware, const unsigned char *pRXCommand, const char *defaultName, const int BatteryLevel)> sDecodeRXMessage;
+	boost::signals2::signal<void(CDomoticzHardwareBase *pHardware, const std::vector<_tRxBatchMessage> &messages)> sDecodeRXMessageBatch;
 	boost::signals2::signal<void(CDomoticzHardwareBase *pDevice)> sOnConnected;
 	void *m_pUserData = { NULL };
 	bool m_bOutputLog = { true };
 
+	//Received messages queue options of this hardware (see CRxMessageQueue), set from the RxQueueSize/RxQueuePolicy columns of the Hardware table.
+	//By default the queue is unbounded and nothing is dropped, the policy applies once a size is set
+	size_t m_RxQueueSize = { 0 };
+	_eRxQueuePolicy m_RxQueuePolicy = { RXQ_POLICY_BLOCK };
+	int m_RxQueueWeight = { 1 };
+
 	int SetThreadNameInt(const std::thread::native_handle_type &thread);
 
 	//Log Helper functions
@@ -75,6 +83,18 @@ protected:
 	void StopHeartbeatThread();
 	void HandleHBCounter(const int iInterval);
 
+	//Batched sensor emission, for hardware that produces many values per reading.
+	//Messages sent by the calling thread between BeginRxBatch and EndRxBatch (calls may be nested) are collected
+	//and handed to the receive queue at the last EndRxBatch, in order and with a single wakeup of the decoder
+	void BeginRxBatch();
+	void EndRxBatch();
+	//Sends a message to the decoder, or adds it to the open batch. Use this instead of calling sDecodeRXMessage directly
+	void SendRxMessage(const unsigned char *pRXCommand, const char *defaultName, const int BatteryLevel);
+
+	//Returns true (and the row id) when the device of this hardware exists. Found devices are cached until a device
+	//is deleted, so checking a known device does not hit the database. Unit -1 matches any unit
+	bool FindDeviceRowIdx(const std::string &DeviceID, const int Unit, const int Type, const int SubType, uint64_t &DeviceRowIdx);
+
 	//Sensor Helpers
 	void SendTempSensor(const int NodeID, const int BatteryLevel, const float temperature, const std::string &defaultname, const int RssiLevel = 12);
 	void SendHumiditySensor(const int NodeID, const int BatteryLevel, const int humidity, const std::string &defaultname, const int RssiLevel = 12);
@@ -130,5 +150,14 @@ private:
 
 	volatile bool m_stopHeartbeatrequested = { false };
 	std::shared_ptr<std::thread> m_Heartbeatthread = { nullptr };
+
+	std::mutex m_rxBatchMutex;
+	std::vector<_tRxBatchMessage> m_rxBatch;
+	int m_rxBatchDepth = { 0 };
+	std::thread::id m_rxBatchThread;
+
+	std::mutex m_deviceCacheMutex;
+	std::map<std::string, uint64_t> m_deviceCache;
+	uint64_t m_deviceCacheGeneration = { 0 };
 };
 
@@ -57,7 +57,11 @@ std::string ReadFile(std::string filename)
 #endif
 
 EnphaseAPI::EnphaseAPI(const int ID, const std::string &IPAddress, const unsigned short /*usIPPort*/) :
-	m_szIPAddress(IPAddress)
+	m_szIPAddress(IPAddress),
+	m_PollJobID(0),
+	m_production("production[0]"),
+	m_consumption("consumption[0]"),
+	m_netconsumption("consumption[1]")
 {
 	m_p1power.ID = 1;
 	m_c1power.ID = 2;
@@ -74,51 +78,49 @@ bool EnphaseAPI::StartHardware()
 {
 	RequestStart();
 
-	//Start worker thread
-	m_thread = std::make_shared<std::thread>(&EnphaseAPI::Do_Work, this);
-	SetThreadNameInt(m_thread->native_handle());
+	m_values.Clear();
+
+	CHttpPollerPool::_tRequest request;
+	std::stringstream sURL;
+	sURL << "http://" << m_szIPAddress << "/production.json";
+	request.URL = sURL.str();
+
+	//polled by the shared poller pool, which also keeps our heartbeat
+	m_LastHeartbeat = mytime(NULL);
+	m_PollJobID = CHttpPollerPool::GetInstance().Register(this, "EnphaseAPI", request, Enphase_request_INTERVAL, std::bind(&EnphaseAPI::OnResponse, this, std::placeholders::_1, std::placeholders::_2));
+	_log.Log(LOG_STATUS, "EnphaseAPI Worker started...");
 	m_bIsStarted = true;
 	sOnConnected(this);
-	return (m_thread != nullptr);
+	return true;
 }
 
 bool EnphaseAPI::StopHardware()
 {
-	if (m_thread)
+	if (m_PollJobID != 0)
 	{
 		RequestStop();
-		m_thread->join();
-		m_thread.reset();
+		CHttpPollerPool::GetInstance().Unregister(m_PollJobID);
+		m_PollJobID = 0;
+		_log.Log(LOG_STATUS, "EnphaseAPI Worker stopped...");
 	}
 	m_bIsStarted = false;
 	return true;
 }
 
-void EnphaseAPI::Do_Work()
+void EnphaseAPI::OnResponse(const bool bOK, const std::string &response)
 {
-	_log.Log(LOG_STATUS, "EnphaseAPI Worker started...");
-	int sec_counter = Enphase_request_INTERVAL - 5;
+	if (!bOK)
+		return;
 
-	while (!IsStopRequested(1000))
+	Json::Value result;
+	if (getProductionDetails(response, result))
 	{
-		sec_counter++;
-
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat = mytime(NULL);
-		}
-
-		if (sec_counter % Enphase_request_INTERVAL == 0)
-		{
-			Json::Value result;
-			if (getProductionDetails(result))
-			{
-				parseProduction(result);
-				parseConsumption(result);
-				parseNetConsumption(result);
-			}
-		}
+		BeginRxBatch();
+		parseProduction(result);
+		parseConsumption(result);
+		parseNetConsumption(result);
+		EndRxBatch();
 	}
-	_log.Log(LOG_STATUS, "EnphaseAPI Worker stopped...");
 }
 
 bool EnphaseAPI::WriteToHardware(const char* /*pdata*/, const unsigned char /*length*/)
@@ -153,23 +155,14 @@ int EnphaseAPI::getSunRiseSunSetMinutes(const bool bGetSunRise)
 	return 0;
 }
 
-bool EnphaseAPI::getProductionDetails(Json::Value& result)
+bool EnphaseAPI::getProductionDetails(const std::string &sResponse, Json::Value& result)
 {
-	std::string sResult;
-
 #ifdef DEBUG_EnphaseAPI_R
-	sResult = ReadFile("E:\\EnphaseAPI_production.json");
+	std::string sResult = ReadFile("E:\\EnphaseAPI_production.json");
 #else
-	std::stringstream sURL;
-	sURL << "http://" << m_szIPAddress << "/production.json";
-
-	if (!HTTPClient::GET(sURL.str(), sResult))
-	{
-		_log.Log(LOG_ERROR, "EnphaseAPI: Error getting http data!");
-		return false;
-	}
+	const std::string &sResult = sResponse;
 #ifdef DEBUG_EnphaseAPI_W
-	SaveString2Disk(sResult, "E:\\EnphaseAPI_production.json")
+	SaveString2Disk(sResult, "E:\\EnphaseAPI_production.json");
 #endif
 #endif
 
@@ -213,23 +206,13 @@ void EnphaseAPI::parseProduction(const Json::Value& root)
 			return;
 	}
 
-	if (root["production"].empty() == true)
+	const Json::Value &reading = m_production.Get(root);
+	if (reading.empty())
 	{
 		//No production details available
 		return;
 	}
-
-	Json::Value reading = root["production"][0];
-
-	int musage = reading["wNow"].asInt();
-	int mtotal = reading["whLifetime"].asInt();
-
-	SendKwhMeter(m_HwdID, 1, 255, musage, mtotal / 1000.0, "Enphase kWh Production");
-
-	m_p1power.powerusage1 = mtotal;
-	m_p1power.powerusage2 = 0;
-	m_p1power.usagecurrent = musage;
-	sDecodeRXMessage(this, (const unsigned char *)&m_p1power, "Enphase Production kWh Total", 255);
+	sendReading(reading, 1, m_p1power, "Enphase kWh Production", "Enphase Production kWh Total");
 }
 
 void EnphaseAPI::parseConsumption(const Json::Value& root)
@@ -238,23 +221,13 @@ void EnphaseAPI::parseConsumption(const Json::Value& root)
 	{
 		return;
 	}
-	if (root["consumption"][0].empty())
+	const Json::Value &reading = m_consumption.Get(root);
+	if (reading.empty())
 	{
 		_log.Log(LOG_ERROR, "EnphaseAPI: Invalid data received");
 		return;
 	}
-
-	Json::Value reading = root["consumption"][0];
-
-	int musage = reading["wNow"].asInt();
-	int mtotal = reading["whLifetime"].asInt();
-
-	SendKwhMeter(m_HwdID, 2, 255, musage, mtotal / 1000.0, "Enphase kWh Consumption");
-
-	m_c1power.powerusage1 = mtotal;
-	m_c1power.powerusage2 = 0;
-	m_c1power.usagecurrent = musage;
-	sDecodeRXMessage(this, (const unsigned char *)&m_c1power, "Enphase Consumption kWh Total", 255);
+	sendReading(reading, 2, m_c1power, "Enphase kWh Consumption", "Enphase Consumption kWh Total");
 }
 
 void EnphaseAPI::parseNetConsumption(const Json::Value& root)
@@ -263,21 +236,28 @@ void EnphaseAPI::parseNetConsumption(const Json::Value& root)
 	{
 		return;
 	}
-	if (root["consumption"][1].empty() == true)
+	const Json::Value &reading = m_netconsumption.Get(root);
+	if (reading.empty())
 	{
 		_log.Log(LOG_ERROR, "EnphaseAPI: Invalid data received");
 		return;
 	}
+	sendReading(reading, 3, m_c2power, "Enphase kWh Net Consumption", "Enphase Net Consumption kWh Total");
+}
 
-	Json::Value reading = root["consumption"][1];
-
+void EnphaseAPI::sendReading(const Json::Value& reading, const int ID, P1Power &power, const char *szKwhName, const char *szP1Name)
+{
 	int musage = reading["wNow"].asInt();
 	int mtotal = reading["whLifetime"].asInt();
 
-	SendKwhMeter(m_HwdID, 3, 255, musage, mtotal / 1000.0, "Enphase kWh Net Consumption");
+	//only send readings that changed
+	if (!m_values.Changed(std::to_string(ID), std::to_string(musage) + ";" + std::to_string(mtotal)))
+		return;
+
+	SendKwhMeter(m_HwdID, ID, 255, musage, mtotal / 1000.0, szKwhName);
 
-	m_c2power.powerusage1 = mtotal;
-	m_c2power.powerusage2 = 0;
-	m_c2power.usagecurrent = musage;
-	sDecodeRXMessage(this, (const unsigned char *)&m_c2power, "Enphase Net Consumption kWh Total", 255);
+	power.powerusage1 = mtotal;
+	power.powerusage2 = 0;
+	power.usagecurrent = musage;
+	SendRxMessage((const unsigned char *)&power, szP1Name, 255);
 }
@@ -2,11 +2,7 @@
 
 #include "DomoticzHardware.h"
 #include "hardwaretypes.h"
-
-namespace Json
-{
-	class Value;
-};
+#include "HttpPollerPool.h"
 
 class EnphaseAPI : public CDomoticzHardwareBase
 {
@@ -17,13 +13,14 @@ public:
 private:
 	bool StartHardware() override;
 	bool StopHardware() override;
-	void Do_Work();
+	void OnResponse(const bool bOK, const std::string &response);
 
-	bool getProductionDetails(Json::Value& result);
+	bool getProductionDetails(const std::string &sResult, Json::Value& result);
 
 	void parseProduction(const Json::Value& root);
 	void parseConsumption(const Json::Value& root);
 	void parseNetConsumption(const Json::Value& root);
+	void sendReading(const Json::Value& reading, const int ID, P1Power &power, const char *szKwhName, const char *szP1Name);
 
 	int getSunRiseSunSetMinutes(const bool bGetSunRise);
 private:
@@ -31,6 +28,10 @@ private:
 	P1Power m_p1power;
 	P1Power m_c1power;
 	P1Power m_c2power;
-	std::shared_ptr<std::thread> m_thread;
+	int m_PollJobID;
+	CJsonPath m_production;
+	CJsonPath m_consumption;
+	CJsonPath m_netconsumption;
+	CPolledValueCache m_values;
 };
 
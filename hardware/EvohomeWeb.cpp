@@ -644,7 +644,7 @@ void CEvohomeWeb::DecodeZone(zone* hz)
 	}
 
 	// Notify MQTT and various push mechanisms
-	m_mainworker.sOnDeviceReceived(this->m_HwdID, DevRowIdx, (*hz->installationInfo)["name"].asString(), NULL);
+	m_mainworker.m_deviceupdates.Publish(this->m_HwdID, DevRowIdx, (*hz->installationInfo)["name"].asString(), NULL);
 }
 
 
@@ -712,7 +712,7 @@ void CEvohomeWeb::DecodeDHWState(temperatureControlSystem* tcs)
 	uint64_t DevRowIdx = m_sql.UpdateValue(this->m_HwdID, szId.c_str(), 1, pTypeEvohomeWater, sTypeEvohomeWater, 10, 255, 50, ssUpdateStat.str().c_str(), sdevname);
 
 	// Notify MQTT and various push mechanisms
-	m_mainworker.sOnDeviceReceived(this->m_HwdID, DevRowIdx, "Hot Water", NULL);
+	m_mainworker.m_deviceupdates.Publish(this->m_HwdID, DevRowIdx, "Hot Water", NULL);
 }
 
 
@@ -159,6 +159,8 @@ void CHardwareMonitor::Do_Work()
 			if (sec_counter % 12 == 0)
 				m_LastHeartbeat = mytime(NULL);
 
+			//the sensors read in this second are queued at once
+			BeginRxBatch();
 			if (sec_counter % POLL_INTERVAL_TEMP == 0)
 			{
 				try
@@ -208,6 +210,7 @@ void CHardwareMonitor::Do_Work()
 				}
 			}
 #endif
+			EndRxBatch();
 		}
 	}
 	_log.Log(LOG_STATUS,"Hardware Monitor: Stopped...");
@@ -220,7 +223,7 @@ void CHardwareMonitor::SendCurrent(const unsigned long Idx, const float Curr, co
 	gDevice.id = 1;
 	gDevice.floatval1 = Curr;
 	gDevice.intval1 = static_cast<int>(Idx);
-	sDecodeRXMessage(this, (const unsigned char *)&gDevice, defaultname.c_str(), 255);
+	SendRxMessage((const unsigned char *)&gDevice, defaultname.c_str(), 255);
 }
 
 void CHardwareMonitor::GetInternalTemperature()
@@ -11,6 +11,7 @@
 #include "../webserver/Base64.h"
 #include "../main/WebServer.h"
 #include "../main/LuaHandler.h"
+#include "HttpPollerPool.h"
 
 #define round(a) ( int ) ( a + .5 )
 
@@ -18,12 +19,14 @@ CHttpPoller::CHttpPoller(const int ID, const std::string& username, const std::s
 m_username(CURLEncode::URLEncode(username)),
 m_password(CURLEncode::URLEncode(password)),
 m_url(url),
-m_refresh(refresh)
+m_refresh(refresh),
+m_bSkipUnchanged(false),
+m_PollJobID(0)
 {
 	// extract the data
 	std::vector<std::string> strextra;
 	StringSplit(extradata, "|", strextra);
-	if (strextra.size() == 3 || strextra.size() == 4 || strextra.size() == 5)
+	if (strextra.size() >= 3 && strextra.size() <= 6)
 	{
 		m_script = base64_decode(strextra[0]);
 		m_method = (unsigned short)atoi(base64_decode(strextra[1]).c_str());
@@ -31,9 +34,13 @@ m_refresh(refresh)
 		if (strextra.size() >= 4)
 		{
 			m_headers = base64_decode(strextra[3]);
-			if (strextra.size() == 5)
+			if (strextra.size() >= 5)
 			{
 				m_postdata = base64_decode(strextra[4]);
+				if (strextra.size() == 6)
+				{
+					m_bSkipUnchanged = (base64_decode(strextra[5]) == "1");
+				}
 			}
 		}
 	}
@@ -60,51 +67,19 @@ bool CHttpPoller::StartHardware()
 	RequestStart();
 
 	Init();
-	//Start worker thread
-	m_thread = std::make_shared<std::thread>(&CHttpPoller::Do_Work, this);
-	SetThreadNameInt(m_thread->native_handle());
-	m_bIsStarted=true;
-	sOnConnected(this);
-	return (m_thread != nullptr);
-}
 
-bool CHttpPoller::StopHardware()
-{
-	if (m_thread)
+	CHttpPollerPool::_tRequest request;
+	request.URL = m_url;
+	//by default the script runs for every response, also when it did not change
+	request.bDeliverUnchanged = !m_bSkipUnchanged;
+	if (m_method == 1)
 	{
-		RequestStop();
-		m_thread->join();
-		m_thread.reset();
+		request.Method = HTTPClient::HTTP_METHOD_POST;
+		request.PostData = m_postdata;
 	}
-    m_bIsStarted=false;
-    return true;
-}
-
-void CHttpPoller::Do_Work()
-{
-	int sec_counter = 300 - 5;
-	_log.Log(LOG_STATUS, "Http: Worker started...");
-	while (!IsStopRequested(1000))
-	{
-		sec_counter++;
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat = mytime(NULL);
-		}
-		if (sec_counter % m_refresh == 0) {
-			GetScript();
-		}
-	}
-	_log.Log(LOG_STATUS,"Http: Worker stopped...");
-}
-
-void CHttpPoller::GetScript()
-{
-	std::string sURL(m_url);
-	std::vector<std::string> ExtraHeaders;
-	std::string sResult;
 
 	if (m_contenttype.length() > 0) {
-		ExtraHeaders.push_back("Content-type: " + m_contenttype);
+		request.ExtraHeaders.push_back("Content-type: " + m_contenttype);
 	}
 
 	if (m_headers.length() > 0)
@@ -113,7 +88,7 @@ void CHttpPoller::GetScript()
 		StringSplit(m_headers, "\n", ExtraHeaders2);
 		for (size_t i = 0; i < ExtraHeaders2.size(); i++)
 		{
-			ExtraHeaders.push_back(ExtraHeaders2[i]);
+			request.ExtraHeaders.push_back(ExtraHeaders2[i]);
 		}
 	}
 
@@ -130,26 +105,37 @@ void CHttpPoller::GetScript()
 			auth += m_password;
 		}
 		std::string encodedAuth = base64_encode(auth);
-		ExtraHeaders.push_back("Authorization:Basic " + encodedAuth);
+		request.ExtraHeaders.push_back("Authorization:Basic " + encodedAuth);
 	}
 
-	if (m_method == 0) {
-		if (!HTTPClient::GET(sURL, ExtraHeaders, sResult))
-		{
-			std::string err = "Http: Error getting data from url \"" + sURL + "\"";
-			_log.Log(LOG_ERROR, err);
-			return;
-		}
-	}
-	if (m_method == 1) {
-		if (!HTTPClient::POST(sURL, m_postdata, ExtraHeaders, sResult)) {
-			std::string err = "Http: Error getting data from url \"" + sURL + "\"";
-			_log.Log(LOG_ERROR, err);
-			return;
-		}
+	//polled by the shared poller pool, which also keeps our heartbeat
+	m_LastHeartbeat = mytime(NULL);
+	m_PollJobID = CHttpPollerPool::GetInstance().Register(this, "Http", request, m_refresh, std::bind(&CHttpPoller::OnResponse, this, std::placeholders::_1, std::placeholders::_2));
+	_log.Log(LOG_STATUS, "Http: Worker started...");
+	m_bIsStarted=true;
+	sOnConnected(this);
+	return true;
+}
+
+bool CHttpPoller::StopHardware()
+{
+	if (m_PollJobID != 0)
+	{
+		RequestStop();
+		CHttpPollerPool::GetInstance().Unregister(m_PollJobID);
+		m_PollJobID = 0;
+		_log.Log(LOG_STATUS, "Http: Worker stopped...");
 	}
+	m_bIsStarted=false;
+	return true;
+}
+
+void CHttpPoller::OnResponse(const bool bOK, const std::string &response)
+{
+	if (!bOK)
+		return;
 
 	// Got some data, send them to the lua parsers for processing
 	CLuaHandler luaScript(m_HwdID);
-	luaScript.executeLuaScript(m_script, sResult);
+	luaScript.executeLuaScript(m_script, response);
 }
@@ -17,8 +17,7 @@ private:
 	void Init();
 	bool StartHardware() override;
 	bool StopHardware() override;
-	void Do_Work();
-	void GetScript();
+	void OnResponse(const bool bOK, const std::string &response);
 private:
 	std::string m_username;
 	std::string m_password;
@@ -29,6 +28,7 @@ private:
 	std::string m_postdata;
 	unsigned short m_method;
 	unsigned short m_refresh;
-	std::shared_ptr<std::thread> m_thread;
+	bool m_bSkipUnchanged;
+	int m_PollJobID;
 };
 
@@ -0,0 +1,373 @@
+#include "stdafx.h"
+#include "HttpPollerPool.h"
+#include "DomoticzHardware.h"
+#include "../main/Helper.h"
+#include "../main/Logger.h"
+#include "../main/localtime_r.h"
+
+#define POLLER_WORKERS 4
+#define POLLER_HEARTBEAT_SEC 12
+
+enum _ePollResult
+{
+	POLL_FAILED = 0,
+	POLL_NOT_MODIFIED,
+	POLL_UNCHANGED,
+	POLL_DELIVERED
+};
+
+CHttpPollerPool &CHttpPollerPool::GetInstance()
+{
+	static CHttpPollerPool instance;
+	return instance;
+}
+
+CHttpPollerPool::CHttpPollerPool() :
+	m_NextJobID(1),
+	m_bStopRequested(false)
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_nextHeartbeat = std::chrono::steady_clock::now();
+}
+
+CHttpPollerPool::~CHttpPollerPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_bStopRequested = true;
+	}
+	m_cv.notify_all();
+	for (auto & itt : m_workers)
+		itt->join();
+	m_workers.clear();
+}
+
+int CHttpPollerPool::Register(CDomoticzHardwareBase *pHardware, const std::string &Name, const _tRequest &request, const int IntervalSec, const tResponseCallback &callback, const int FirstPollSec)
+{
+	std::shared_ptr<_tJob> pJob = std::make_shared<_tJob>();
+	pJob->pHardware = pHardware;
+	pJob->Name = Name;
+	pJob->Request = request;
+	pJob->IntervalSec = (IntervalSec > 0) ? IntervalSec : 1;
+	pJob->Callback = callback;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	pJob->ID = m_NextJobID++;
+	m_jobs[pJob->ID] = pJob;
+	ScheduleJob(*pJob, FirstPollSec);
+	if (m_workers.empty())
+	{
+		//started on first use, most systems do not have any polled hardware
+		for (int ii = 0; ii < POLLER_WORKERS; ii++)
+		{
+			std::shared_ptr<std::thread> pThread = std::make_shared<std::thread>(&CHttpPollerPool::Do_Work, this);
+			SetThreadName(pThread->native_handle(), "HttpPollerPool");
+			m_workers.push_back(pThread);
+		}
+	}
+	lock.unlock();
+	m_cv.notify_all();
+	return pJob->ID;
+}
+
+void CHttpPollerPool::SetRequest(const int JobID, const _tRequest &request)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::map<int, std::shared_ptr<_tJob> >::iterator itt = m_jobs.find(JobID);
+	if (itt == m_jobs.end())
+		return;
+	itt->second->Request = request;
+	itt->second->bResetCache = true;
+}
+
+void CHttpPollerPool::Unregister(const int JobID)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::map<int, std::shared_ptr<_tJob> >::iterator itt = m_jobs.find(JobID);
+	if (itt == m_jobs.end())
+		return;
+	std::shared_ptr<_tJob> pJob = itt->second;
+	pJob->bRemoved = true;
+	m_jobs.erase(itt);
+	while (pJob->bRunning)
+		m_cvDone.wait(lock);
+}
+
+void CHttpPollerPool::GetStats(_tPoolStats &stats)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	stats = m_stats;
+	stats.jobs = m_jobs.size();
+}
+
+void CHttpPollerPool::ScheduleJob(_tJob &job, const int DelaySec)
+{
+	job.Generation++;
+	m_schedule.push(std::make_pair(std::chrono::steady_clock::now() + std::chrono::seconds(DelaySec), std::make_pair(job.ID, job.Generation)));
+}
+
+void CHttpPollerPool::Do_Work()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_bStopRequested)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now >= m_nextHeartbeat)
+		{
+			m_nextHeartbeat = now + std::chrono::seconds(POLLER_HEARTBEAT_SEC);
+			time_t atime = mytime(NULL);
+			for (const auto & itt : m_jobs)
+			{
+				if (itt.second->pHardware != NULL)
+					itt.second->pHardware->m_LastHeartbeat = atime;
+			}
+		}
+		std::chrono::steady_clock::time_point wakeup = m_nextHeartbeat;
+		if (!m_schedule.empty())
+		{
+			const tScheduleItem &item = m_schedule.top();
+			std::map<int, std::shared_ptr<_tJob> >::iterator itt = m_jobs.find(item.second.first);
+			if ((itt == m_jobs.end()) || (itt->second->Generation != item.second.second))
+			{
+				//job removed or rescheduled
+				m_schedule.pop();
+				continue;
+			}
+			if (item.first <= now)
+			{
+				std::shared_ptr<_tJob> pJob = itt->second;
+				m_schedule.pop();
+				pJob->bRunning = true;
+				if (pJob->bResetCache)
+				{
+					pJob->ETag.clear();
+					pJob->LastModified.clear();
+					pJob->ResponseHash = 0;
+					pJob->bResetCache = false;
+				}
+				_tRequest request = pJob->Request;
+				lock.unlock();
+
+				Poll(*pJob, request);
+
+				lock.lock();
+				pJob->bRunning = false;
+				if (!pJob->bRemoved)
+					ScheduleJob(*pJob, pJob->IntervalSec);
+				m_cvDone.notify_all();
+				continue;
+			}
+			if (item.first < wakeup)
+				wakeup = item.first;
+		}
+		m_cv.wait_until(lock, wakeup);
+	}
+}
+
+void CHttpPollerPool::Poll(_tJob &job, const _tRequest &request)
+{
+	std::vector<std::string> ExtraHeaders = request.ExtraHeaders;
+	if ((request.Method == HTTPClient::HTTP_METHOD_GET) && (!request.bDeliverUnchanged))
+	{
+		if (!job.ETag.empty())
+			ExtraHeaders.push_back("If-None-Match: " + job.ETag);
+		if (!job.LastModified.empty())
+			ExtraHeaders.push_back("If-Modified-Since: " + job.LastModified);
+	}
+
+	std::string sResult;
+	std::vector<std::string> vHeaderData;
+	bool bOK = false;
+	switch (request.Method)
+	{
+	case HTTPClient::HTTP_METHOD_GET:
+		bOK = HTTPClient::GET(request.URL, ExtraHeaders, sResult, vHeaderData, true);
+		break;
+	case HTTPClient::HTTP_METHOD_POST:
+		bOK = HTTPClient::POST(request.URL, request.PostData, ExtraHeaders, sResult, vHeaderData, true, true);
+		break;
+	case HTTPClient::HTTP_METHOD_PUT:
+		bOK = HTTPClient::PUT(request.URL, request.PostData, ExtraHeaders, sResult, vHeaderData, true);
+		break;
+	case HTTPClient::HTTP_METHOD_DELETE:
+		bOK = HTTPClient::Delete(request.URL, request.PostData, ExtraHeaders, sResult, vHeaderData, true);
+		break;
+	}
+
+	//headers of the last response (after redirects)
+	int status = 0;
+	std::string ETag, LastModified;
+	for (const auto & itt : vHeaderData)
+	{
+		if (itt.find("HTTP/") == 0)
+		{
+			size_t pos = itt.find(' ');
+			status = (pos != std::string::npos) ? atoi(itt.c_str() + pos + 1) : 0;
+			ETag.clear();
+			LastModified.clear();
+			continue;
+		}
+		size_t pos = itt.find(':');
+		if (pos == std::string::npos)
+			continue;
+		std::string name = itt.substr(0, pos);
+		std::string value = itt.substr(pos + 1);
+		stdlower(name);
+		if (name == "etag")
+			ETag = stdstring_trim(value);
+		else if (name == "last-modified")
+			LastModified = stdstring_trim(value);
+	}
+
+	int result = POLL_DELIVERED;
+	time_t atime = mytime(NULL);
+	if ((!bOK) || ((status != 304) && (sResult.empty())))
+	{
+		//the query string often holds an api key
+		_log.Log(LOG_ERROR, "%s: Error getting data from url \"%s\"", job.Name.c_str(), request.URL.substr(0, request.URL.find('?')).c_str());
+		job.ETag.clear();
+		job.LastModified.clear();
+		job.ResponseHash = 0;
+		result = POLL_FAILED;
+		try
+		{
+			job.Callback(false, sResult);
+		}
+		catch (...)
+		{
+			_log.Log(LOG_ERROR, "%s: Exception handling poll result", job.Name.c_str());
+		}
+	}
+	else
+	{
+		//the hardware is alive, also when nothing has to be delivered
+		if (job.pHardware != NULL)
+			job.pHardware->SetHeartbeatReceived();
+		bool bForce = (difftime(atime, job.LastDelivery) >= POLLER_FORCE_DELIVERY_SEC);
+		if (status == 304)
+		{
+			result = POLL_NOT_MODIFIED;
+			//nothing new to deliver, a forced delivery has to wait for the next full response
+			if (bForce)
+			{
+				job.ETag.clear();
+				job.LastModified.clear();
+			}
+		}
+		else
+		{
+			job.ETag = ETag;
+			job.LastModified = LastModified;
+			size_t hash = std::hash<std::string>()(sResult);
+			if ((hash == job.ResponseHash) && (!bForce) && (!request.bDeliverUnchanged))
+				result = POLL_UNCHANGED;
+			else
+			{
+				job.ResponseHash = hash;
+				job.LastDelivery = atime;
+				try
+				{
+					job.Callback(true, sResult);
+				}
+				catch (...)
+				{
+					_log.Log(LOG_ERROR, "%s: Exception handling poll result", job.Name.c_str());
+				}
+			}
+		}
+	}
+	_log.Debug(DEBUG_HARDWARE, "%s: poll status %d, result %d", job.Name.c_str(), status, result);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_stats.polls++;
+	switch (result)
+	{
+	case POLL_FAILED:
+		m_stats.failed++;
+		break;
+	case POLL_NOT_MODIFIED:
+		m_stats.not_modified++;
+		break;
+	case POLL_UNCHANGED:
+		m_stats.unchanged++;
+		break;
+	default:
+		m_stats.delivered++;
+		break;
+	}
+}
+
+CJsonPath::CJsonPath(const std::string &Path)
+{
+	size_t pos = 0;
+	while (pos < Path.size())
+	{
+		_tStep step;
+		if (Path[pos] == '[')
+		{
+			size_t epos = Path.find(']', pos);
+			if (epos == std::string::npos)
+				epos = Path.size();
+			step.bIndex = true;
+			step.Index = (Json::ArrayIndex)atoi(Path.substr(pos + 1, epos - pos - 1).c_str());
+			pos = epos + 1;
+		}
+		else
+		{
+			if (Path[pos] == '.')
+				pos++;
+			size_t epos = Path.find_first_of(".[", pos);
+			if (epos == std::string::npos)
+				epos = Path.size();
+			step.bIndex = false;
+			step.Key = Path.substr(pos, epos - pos);
+			step.Index = 0;
+			pos = epos;
+		}
+		m_steps.push_back(step);
+	}
+}
+
+const Json::Value &CJsonPath::Get(const Json::Value &root) const
+{
+	static const Json::Value null_value;
+	const Json::Value *pValue = &root;
+	for (const auto & itt : m_steps)
+	{
+		if (itt.bIndex)
+		{
+			if ((!pValue->isArray()) || (itt.Index >= pValue->size()))
+				return null_value;
+			pValue = &(*pValue)[itt.Index];
+		}
+		else
+		{
+			if ((!pValue->isObject()) || (!pValue->isMember(itt.Key)))
+				return null_value;
+			pValue = &(*pValue)[itt.Key];
+		}
+	}
+	return *pValue;
+}
+
+CPolledValueCache::CPolledValueCache(const int ForceIntervalSec) :
+	m_ForceIntervalSec(ForceIntervalSec)
+{
+}
+
+bool CPolledValueCache::Changed(const std::string &Key, const std::string &Value)
+{
+	time_t atime = mytime(NULL);
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::map<std::string, std::pair<std::string, time_t> >::iterator itt = m_values.find(Key);
+	if ((itt != m_values.end()) && (itt->second.first == Value) && (difftime(atime, itt->second.second) < m_ForceIntervalSec))
+		return false;
+	m_values[Key] = std::make_pair(Value, atime);
+	return true;
+}
+
+void CPolledValueCache::Clear()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_values.clear();
+}
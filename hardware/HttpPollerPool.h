@@ -0,0 +1,129 @@
+#pragma once
+
+#include "../httpclient/HTTPClient.h"
+#include "../json/json.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+class CDomoticzHardwareBase;
+
+//Delivery of an unchanged response (or value) is skipped, but not for longer than this
+#define POLLER_FORCE_DELIVERY_SEC 300
+
+/*
+ * Shared engine for hardware that polls a HTTP(S) JSON/XML API.
+ * The polls of all registered hardware are scheduled on a timer and performed by a small pool of
+ * workers, instead of every hardware sleeping in its own thread around a blocking HTTPClient call.
+ * GET requests are sent conditionally (If-None-Match/If-Modified-Since) and the callback of a poll
+ * is only called when the response changed, failed, or was not delivered for POLLER_FORCE_DELIVERY_SEC,
+ * unless the request asks for every response to be delivered.
+ * The pool also keeps the heartbeat of the registered hardware.
+ */
+class CHttpPollerPool
+{
+public:
+	struct _tRequest
+	{
+		HTTPClient::_eHTTPmethod Method = HTTPClient::HTTP_METHOD_GET;
+		std::string URL;
+		std::vector<std::string> ExtraHeaders;
+		std::string PostData;
+		bool bDeliverUnchanged = false;		//plain requests, the callback is called for every response
+	};
+	//Called on a pool worker, bOK is false when the request failed
+	typedef std::function<void(const bool bOK, const std::string &response)> tResponseCallback;
+
+	struct _tPoolStats
+	{
+		size_t jobs;
+		uint64_t polls;
+		uint64_t failed;
+		uint64_t not_modified;		//304 replies to conditional requests
+		uint64_t unchanged;			//responses identical to the previous one
+		uint64_t delivered;
+	};
+
+	static CHttpPollerPool &GetInstance();
+
+	//Returns the job id, the first poll is done after FirstPollSec
+	int Register(CDomoticzHardwareBase *pHardware, const std::string &Name, const _tRequest &request, const int IntervalSec, const tResponseCallback &callback, const int FirstPollSec = 5);
+	//Replace the request of a job (new url or authorization), the next response is always delivered
+	void SetRequest(const int JobID, const _tRequest &request);
+	//Waits for a running poll of the job, do not call it from the job's own callback
+	void Unregister(const int JobID);
+
+	void GetStats(_tPoolStats &stats);
+private:
+	struct _tJob
+	{
+		int ID;
+		CDomoticzHardwareBase *pHardware;
+		std::string Name;
+		_tRequest Request;
+		int IntervalSec;
+		tResponseCallback Callback;
+		uint64_t Generation = 0;		//schedule entries of an older generation are stale
+		bool bRunning = false;
+		bool bRemoved = false;
+		bool bResetCache = false;		//set by SetRequest, the fields below are only used by the worker running the job
+		std::string ETag;
+		std::string LastModified;
+		size_t ResponseHash = 0;
+		time_t LastDelivery = 0;
+	};
+	typedef std::pair<std::chrono::steady_clock::time_point, std::pair<int, uint64_t> > tScheduleItem;
+
+	CHttpPollerPool();
+	~CHttpPollerPool();
+	void Do_Work();
+	void Poll(_tJob &job, const _tRequest &request);
+	void ScheduleJob(_tJob &job, const int DelaySec);
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::condition_variable m_cvDone;
+	std::map<int, std::shared_ptr<_tJob> > m_jobs;
+	std::priority_queue<tScheduleItem, std::vector<tScheduleItem>, std::greater<tScheduleItem> > m_schedule;
+	std::vector<std::shared_ptr<std::thread> > m_workers;
+	std::chrono::steady_clock::time_point m_nextHeartbeat;
+	int m_NextJobID;
+	bool m_bStopRequested;
+	_tPoolStats m_stats;
+};
+
+//A path into a JSON document like "consumption[1].wNow", parsed once when the driver is created
+class CJsonPath
+{
+public:
+	CJsonPath() = default;
+	explicit CJsonPath(const std::string &Path);
+	//Returns a null value when the path does not exist
+	const Json::Value &Get(const Json::Value &root) const;
+private:
+	struct _tStep
+	{
+		bool bIndex;
+		std::string Key;
+		Json::ArrayIndex Index;
+	};
+	std::vector<_tStep> m_steps;
+};
+
+//Remembers the last value sent per key, so a poller only sends the values that changed
+class CPolledValueCache
+{
+public:
+	explicit CPolledValueCache(const int ForceIntervalSec = POLLER_FORCE_DELIVERY_SEC);
+	//Returns true (and remembers the value) when it differs from the last value or was last sent ForceIntervalSec ago
+	bool Changed(const std::string &Key, const std::string &Value);
+	void Clear();
+private:
+	std::mutex m_mutex;
+	std::map<std::string, std::pair<std::string, time_t> > m_values;
+	int m_ForceIntervalSec;
+};
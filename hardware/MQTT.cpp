@@ -35,6 +35,7 @@ mosqdz::mosquittodz(MQTTClientID.c_str())
 	m_HwdID=ID;
 	m_IsConnected = false;
 	m_bDoReconnect = false;
+	m_DeviceUpdateSubscription = 0;
 	mosqdz::lib_init();
 
 	m_usIPPort=usIPPort;
@@ -130,7 +131,7 @@ void MQTT::on_connect(int rc)
 			_log.Log(LOG_STATUS, "MQTT: connected to: %s:%d", m_szIPAddress.c_str(), m_usIPPort);
 			m_IsConnected = true;
 			sOnConnected(this);
-			m_sDeviceReceivedConnection = m_mainworker.sOnDeviceReceived.connect(boost::bind(&MQTT::SendDeviceInfo, this, _1, _2, _3, _4));
+			m_DeviceUpdateSubscription = m_mainworker.m_deviceupdates.Subscribe("MQTT", [this](const DeviceUpdatePtr &pUpdate) { SendDeviceInfo(pUpdate); });
 			m_sSwitchSceneConnection = m_mainworker.sOnSwitchScene.connect(boost::bind(&MQTT::SendSceneInfo, this, _1, _2));
 		}
 		subscribe(NULL, m_TopicIn.c_str());
@@ -453,7 +454,7 @@ void MQTT::on_message(const struct mosquitto_message *message)
 		else if (szCommand == "getdeviceinfo")
 		{
 			int HardwareID = atoi(result[0][0].c_str());
-			SendDeviceInfo(HardwareID, idx, "request device", NULL);
+			SendDeviceInfo(CDeviceUpdateBus::CreateSnapshot(HardwareID, idx, "request device", NULL));
 		}
 		else if (szCommand == "getsceneinfo")
 		{
@@ -605,8 +606,11 @@ void MQTT::Do_Work()
 	if (isConnected())
 		disconnect();
 
-	if (m_sDeviceReceivedConnection.connected())
-		m_sDeviceReceivedConnection.disconnect();
+	if (m_DeviceUpdateSubscription != 0)
+	{
+		m_mainworker.m_deviceupdates.Unsubscribe(m_DeviceUpdateSubscription);
+		m_DeviceUpdateSubscription = 0;
+	}
 	if (m_sSwitchSceneConnection.connected())
 		m_sSwitchSceneConnection.disconnect();
 
@@ -643,31 +647,28 @@ void MQTT::WriteInt(const std::string &sendStr)
 	SendMessage(m_TopicOut, sMessage);
 }
 
-void MQTT::SendDeviceInfo(const int HwdID, const uint64_t DeviceRowIdx, const std::string& /*DeviceName*/, const unsigned char* /*pRXCommand*/)
+void MQTT::SendDeviceInfo(const DeviceUpdatePtr &pUpdate)
 {
 	if (!m_IsConnected)
 		return;
-	std::vector<std::vector<std::string> > result;
-	result = m_sql.safe_query("SELECT HardwareID, DeviceID, Unit, Name, [Type], SubType, nValue, sValue, SwitchType, SignalLevel, BatteryLevel, Options, Description, LastLevel, Color FROM DeviceStatus WHERE (HardwareID==%d) AND (ID==%" PRIu64 ")", HwdID, DeviceRowIdx);
-	if (!result.empty())
+	if ((pUpdate->bHaveStatus) && (pUpdate->HardwareID == pUpdate->HwdID))
 	{
-		int iIndex = 0;
-		std::vector<std::string> sd = result[0];
-		std::string hwid = sd[iIndex++];
-		std::string did = sd[iIndex++];
-		int dunit = atoi(sd[iIndex++].c_str());
-		std::string name = sd[iIndex++];
-		int dType = atoi(sd[iIndex++].c_str());
-		int dSubType = atoi(sd[iIndex++].c_str());
-		int nvalue = atoi(sd[iIndex++].c_str());
-		std::string svalue = sd[iIndex++];
-		_eSwitchType switchType = (_eSwitchType)atoi(sd[iIndex++].c_str());
-		int RSSI = atoi(sd[iIndex++].c_str());
-		int BatteryLevel = atoi(sd[iIndex++].c_str());
-		std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(sd[iIndex++]);
-		std::string description = sd[iIndex++];
-		int LastLevel = atoi(sd[iIndex++].c_str());
-		std::string sColor = sd[iIndex++];
+		uint64_t DeviceRowIdx = pUpdate->DeviceRowIdx;
+		std::string hwid = std::to_string(pUpdate->HardwareID);
+		std::string did = pUpdate->DeviceID;
+		int dunit = pUpdate->Unit;
+		std::string name = pUpdate->Name;
+		int dType = pUpdate->Type;
+		int dSubType = pUpdate->SubType;
+		int nvalue = pUpdate->nValue;
+		std::string svalue = pUpdate->sValue;
+		_eSwitchType switchType = (_eSwitchType)pUpdate->SwitchType;
+		int RSSI = pUpdate->SignalLevel;
+		int BatteryLevel = pUpdate->BatteryLevel;
+		std::map<std::string, std::string> options = m_sql.BuildDeviceOptions(pUpdate->Options);
+		std::string description = pUpdate->Description;
+		int LastLevel = pUpdate->LastLevel;
+		std::string sColor = pUpdate->Color;
 
 		Json::Value root;
 
@@ -727,10 +728,11 @@ void MQTT::SendDeviceInfo(const int HwdID, const uint64_t DeviceRowIdx, const st
 		}
 
 		if (m_publish_topics & PT_floor_room) {
+			std::vector<std::vector<std::string> > result;
 			result = m_sql.safe_query("SELECT F.Name, P.Name, M.DeviceRowID FROM Plans as P, Floorplans as F, DeviceToPlansMap as M WHERE P.FloorplanID=F.ID and M.PlanID=P.ID and M.DeviceRowID=='%" PRIu64 "'", DeviceRowIdx);
 			for(size_t i=0 ; i<result.size(); i++)
 			{
-				sd = result[i];
+				std::vector<std::string> sd = result[i];
 				std::string floor = sd[0];
 				std::string room =  sd[1];
 				std::stringstream topic;
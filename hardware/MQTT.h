@@ -2,6 +2,7 @@
 
 #include "MySensorsBase.h"
 #include "../main/mosquitto_helper.h"
+#include "../main/DeviceUpdateBus.h"
 
 class MQTT : public MySensorsBase, mosqdz::mosquittodz
 {
@@ -28,7 +29,7 @@ public:
 private:
 	bool ConnectInt();
 	bool ConnectIntEx();
-	void SendDeviceInfo(const int HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand);
+	void SendDeviceInfo(const DeviceUpdatePtr &pUpdate);
 	void SendSceneInfo(const uint64_t SceneIdx, const std::string &SceneName);
 protected:
 	std::string m_szIPAddress;
@@ -46,7 +47,7 @@ protected:
 	virtual void SendHeartbeat();
 	void WriteInt(const std::string &sendStr) override;
 	std::shared_ptr<std::thread> m_thread;
-	boost::signals2::connection m_sDeviceReceivedConnection;
+	int m_DeviceUpdateSubscription;
 	boost::signals2::connection m_sSwitchSceneConnection;
 	enum _ePublishTopics {
 		PT_none 	  = 0x00,
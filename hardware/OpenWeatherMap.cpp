@@ -52,7 +52,8 @@ std::string ReadFile(std::string filename)
 COpenWeatherMap::COpenWeatherMap(const int ID, const std::string &APIKey, const std::string &Location) :
 	m_APIKey(APIKey),
 	m_Location(Location),
-	m_Language("en")
+	m_Language("en"),
+	m_PollJobID(0)
 {
 	m_HwdID=ID;
 
@@ -74,48 +75,49 @@ bool COpenWeatherMap::StartHardware()
 {
 	RequestStart();
 
-	m_thread = std::make_shared<std::thread>(&COpenWeatherMap::Do_Work, this);
-	SetThreadNameInt(m_thread->native_handle());
+	std::stringstream sURL;
+	sURL << "http://api.openweathermap.org/data/2.5/weather?";
+	if (!m_bHaveGPSCoordinated)
+		sURL << "q=";
+	sURL << m_Location << "&APPID=" << m_APIKey << "&units=metric" << "&lang=" << m_Language;
+
+	CHttpPollerPool::_tRequest request;
+	request.URL = sURL.str();
+
+	//polled by the shared poller pool, which also keeps our heartbeat
+	m_LastHeartbeat = mytime(NULL);
+	m_PollJobID = CHttpPollerPool::GetInstance().Register(this, "OpenWeatherMap", request, 600, std::bind(&COpenWeatherMap::OnResponse, this, std::placeholders::_1, std::placeholders::_2));
 	m_bIsStarted=true;
 	sOnConnected(this);
 	_log.Log(LOG_STATUS, "OpenWeatherMap: Started");
-	return (m_thread != nullptr);
+	return true;
 }
 
 bool COpenWeatherMap::StopHardware()
 {
-	if (m_thread)
+	if (m_PollJobID != 0)
 	{
 		RequestStop();
-		m_thread->join();
-		m_thread.reset();
+		CHttpPollerPool::GetInstance().Unregister(m_PollJobID);
+		m_PollJobID = 0;
+		_log.Log(LOG_STATUS, "OpenWeatherMap: Worker stopped...");
 	}
-    m_bIsStarted=false;
+	m_bIsStarted=false;
 	return true;
 }
 
-void COpenWeatherMap::Do_Work()
+void COpenWeatherMap::OnResponse(const bool bOK, const std::string &response)
 {
-	int sec_counter = 595;
-	while (!IsStopRequested(1000))
+	if (!bOK)
+		return;
+	try
 	{
-		sec_counter++;
-		if (sec_counter % 12 == 0) {
-			m_LastHeartbeat = mytime(NULL);
-		}
-		if (sec_counter % 600 == 0)
-		{
-			try
-			{
-				GetMeterDetails();
-			}
-			catch (...)
-			{
-				_log.Log(LOG_ERROR, "OpenWeatherMap: Error getting/parsing http data!");
-			}
-		}
+		GetMeterDetails(response);
+	}
+	catch (...)
+	{
+		_log.Log(LOG_ERROR, "OpenWeatherMap: Error parsing http data!");
 	}
-	_log.Log(LOG_STATUS,"OpenWeatherMap: Worker stopped...");
 }
 
 bool COpenWeatherMap::WriteToHardware(const char* /*pdata*/, const unsigned char /*length*/)
@@ -128,34 +130,8 @@ std::string COpenWeatherMap::GetForecastURL()
 	return m_ForecastURL;
 }
 
-void COpenWeatherMap::GetMeterDetails()
+void COpenWeatherMap::GetMeterDetails(const std::string &sResult)
 {
-	std::string sResult;
-	std::stringstream sURL;
-
-	sURL << "http://api.openweathermap.org/data/2.5/weather?";
-	if (!m_bHaveGPSCoordinated)
-		sURL << "q=";
-	sURL << m_Location << "&APPID=" << m_APIKey << "&units=metric" << "&lang=" << m_Language;
-
-#ifdef DEBUG_OPENWEATHERMAP
-	_log.Log(LOG_STATUS, "OpenWeatherMap: Get data from %s", sURL);
-#endif
-
-	try
-	{
-		if (!HTTPClient::GET(sURL.str(), sResult))
-		{
-			_log.Log(LOG_ERROR, "OpenWeatherMap: Error getting http data!");
-			return;
-		}
-	}
-	catch (...)
-	{
-		_log.Log(LOG_ERROR, "OpenWeatherMap: Error getting http data!");
-		return;
-	}
-
 #ifdef DEBUG_OPENWEATHERMAP_WRITE
 	SaveString2Disk(sResult, "E:\\OpenWeatherMap.json");
 #endif
@@ -4,6 +4,7 @@
 // by Fantom (szczukot@poczta.onet.pl)
 
 #include "DomoticzHardware.h"
+#include "HttpPollerPool.h"
 
 class COpenWeatherMap : public CDomoticzHardwareBase
 {
@@ -15,14 +16,14 @@ public:
 private:
 	bool StartHardware() override;
 	bool StopHardware() override;
-	void Do_Work();
-	void GetMeterDetails();
+	void OnResponse(const bool bOK, const std::string &response);
+	void GetMeterDetails(const std::string &sResult);
 private:
 	std::string m_APIKey;
 	std::string m_Location;
 	std::string m_ForecastURL;
 	std::string m_Language;
 	bool m_bHaveGPSCoordinated;
-	std::shared_ptr<std::thread> m_thread;
+	int m_PollJobID;
 };
 
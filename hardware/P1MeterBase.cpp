@@ -270,7 +270,9 @@ bool P1MeterBase::MatchLine()
 			if (difftime(atime, m_lastUpdateTime) >= m_ratelimit)
 			{
 				m_lastUpdateTime = atime;
-				sDecodeRXMessage(this, (const unsigned char*)& m_power, "Power", 255);
+				//all values of the telegram are queued at once
+				BeginRxBatch();
+				SendRxMessage((const unsigned char*)& m_power, "Power", 255);
 				if (m_voltagel1 != -1) {
 					SendVoltageSensor(0, 1, 255, m_voltagel1, "Voltage L1");
 				}
@@ -314,7 +316,7 @@ bool P1MeterBase::MatchLine()
 						// just accept it - we cannot sync to our clock
 						m_lastSharedSendGas = atime;
 						m_lastgasusage = m_gas.gasusage;
-						sDecodeRXMessage(this, (const unsigned char*)& m_gas, "Gas", 255);
+						SendRxMessage((const unsigned char*)& m_gas, "Gas", 255);
 					}
 					else if (atime >= m_gasoktime)
 					{
@@ -329,7 +331,7 @@ bool P1MeterBase::MatchLine()
 							m_lastSharedSendGas = atime;
 							m_lastgasusage = m_gas.gasusage;
 							m_gasoktime += 300;
-							sDecodeRXMessage(this, (const unsigned char*)& m_gas, "Gas", 255);
+							SendRxMessage((const unsigned char*)& m_gas, "Gas", 255);
 						}
 						else // gas clock is ahead
 						{
@@ -360,6 +362,7 @@ bool P1MeterBase::MatchLine()
 						}
 					}
 				}
+				EndRxBatch();
 			}
 			m_linecount = 0;
 			l_exclmarkfound = 0;
@@ -0,0 +1,300 @@
+#include "stdafx.h"
+#include "PingSweep.h"
+#include "../main/Logger.h"
+#include "../main/Noncopyable.h"
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+
+#include "pinger/icmp_header.h"
+#include "pinger/ipv4_header.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+
+namespace
+{
+	//every raw ICMP socket of the process receives all echo replies, the sequence
+	//numbers are shared so concurrent sweeps can tell their replies apart
+	std::atomic<unsigned short> s_sequence_number(0);
+
+	unsigned short get_identifier()
+	{
+#if defined(BOOST_WINDOWS)
+		return static_cast<unsigned short>(::GetCurrentProcessId());
+#else
+		return static_cast<unsigned short>(::getpid());
+#endif
+	}
+
+	class sweeper
+		: private domoticz::noncopyable
+	{
+	public:
+		sweeper(boost::asio::io_service& io_service, const int timeout_ms, const int max_tries)
+			: io_service_(io_service), socket_(io_service, boost::asio::ip::icmp::v4()), timer_(io_service),
+			timeout_ms_(timeout_ms), max_tries_(max_tries), remaining_(0), sent_(0), received_(0)
+		{
+		}
+
+		void add_target(const boost::asio::ip::icmp::endpoint &destination)
+		{
+			target t;
+			t.destination = destination;
+			t.resolved = true;
+			t.done = false;
+			t.alive = false;
+			t.sent = 0;
+			t.round_trip_ms = -1;
+			targets_.push_back(t);
+			remaining_++;
+		}
+
+		void add_unresolved()
+		{
+			target t;
+			t.resolved = false;
+			t.done = true;
+			t.alive = false;
+			t.sent = 0;
+			t.round_trip_ms = -1;
+			targets_.push_back(t);
+		}
+
+		//returns false when there is nothing to wait for
+		bool start()
+		{
+			if (remaining_ == 0)
+				return false;
+			for (size_t ii = 0; ii < targets_.size(); ii++)
+			{
+				if (targets_[ii].resolved)
+					send(ii);
+			}
+			start_receive();
+			schedule_timeout();
+			return true;
+		}
+
+		void get_results(std::vector<CPingSweep::_tResult> &results, CPingSweep::_tStats &stats)
+		{
+			results.clear();
+			stats.Alive = 0;
+			for (const auto & itt : targets_)
+			{
+				CPingSweep::_tResult result;
+				result.bAlive = itt.alive;
+				result.Sent = itt.sent;
+				result.RoundTripMs = itt.round_trip_ms;
+				results.push_back(result);
+				if (itt.alive)
+					stats.Alive++;
+			}
+			stats.Sent = sent_;
+			stats.Received = received_;
+		}
+	private:
+		struct target
+		{
+			boost::asio::ip::icmp::endpoint destination;
+			bool resolved;
+			bool done;
+			bool alive;
+			int sent;
+			int round_trip_ms;
+			std::chrono::steady_clock::time_point time_sent;
+		};
+
+		void send(const size_t idx)
+		{
+			target &t = targets_[idx];
+			unsigned short sequence_number = ++s_sequence_number;
+
+			std::string body("Domoticz");
+
+			// Create an ICMP header for an echo request.
+			icmp_header echo_request;
+			echo_request.type(icmp_header::echo_request);
+			echo_request.code(0);
+			echo_request.identifier(get_identifier());
+			echo_request.sequence_number(sequence_number);
+			compute_checksum(echo_request, body.begin(), body.end());
+
+			// Encode the request packet.
+			boost::asio::streambuf request_buffer;
+			std::ostream os(&request_buffer);
+			os << echo_request << body;
+
+			t.time_sent = std::chrono::steady_clock::now();
+			t.sent++;
+			pending_[sequence_number] = idx;
+			deadlines_.insert(std::make_pair(t.time_sent + std::chrono::milliseconds(timeout_ms_), idx));
+
+			//a failed send (network unreachable) is handled like an echo that was not answered
+			boost::system::error_code ec;
+			socket_.send_to(request_buffer.data(), t.destination, 0, ec);
+			sent_++;
+		}
+
+		void start_receive()
+		{
+			// Discard any data already in the buffer.
+			reply_buffer_.consume(reply_buffer_.size());
+
+			// Wait for a reply. We prepare the buffer to receive up to 64KB.
+			socket_.async_receive_from(reply_buffer_.prepare(65536), reply_sender_,
+				boost::bind(&sweeper::handle_receive, this, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+		}
+
+		void handle_receive(const boost::system::error_code& error, std::size_t length)
+		{
+			if (error)
+				return; //the timer finishes the sweep
+
+			reply_buffer_.commit(length);
+
+			// Decode the reply packet.
+			std::istream is(&reply_buffer_);
+			ipv4_header ipv4_hdr;
+			icmp_header icmp_hdr;
+			is >> ipv4_hdr >> icmp_hdr;
+
+			// All ICMP packets received by the host end up here (also our own echo requests
+			// when pinging the local host), only take the replies to our requests
+			if (is && icmp_hdr.type() == icmp_header::echo_reply && icmp_hdr.identifier() == get_identifier())
+			{
+				std::map<unsigned short, size_t>::const_iterator itt = pending_.find(icmp_hdr.sequence_number());
+				if (itt != pending_.end())
+				{
+					target &t = targets_[itt->second];
+					if ((!t.done) && (ipv4_hdr.source_address() == t.destination.address().to_v4()))
+					{
+						t.done = true;
+						t.alive = true;
+						t.round_trip_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t.time_sent).count();
+						received_++;
+						if (--remaining_ == 0)
+						{
+							finish();
+							return;
+						}
+					}
+				}
+			}
+			start_receive();
+		}
+
+		void schedule_timeout()
+		{
+			if (deadlines_.empty())
+				return;
+			std::chrono::steady_clock::duration wait = deadlines_.begin()->first - std::chrono::steady_clock::now();
+			long long wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(wait).count();
+			timer_.expires_from_now(boost::posix_time::milliseconds((wait_ms > 0) ? wait_ms : 0));
+			timer_.async_wait(boost::bind(&sweeper::handle_timeout, this, boost::asio::placeholders::error));
+		}
+
+		void handle_timeout(const boost::system::error_code& error)
+		{
+			if (error == boost::asio::error::operation_aborted)
+				return;
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			while ((!deadlines_.empty()) && (deadlines_.begin()->first <= now))
+			{
+				size_t idx = deadlines_.begin()->second;
+				deadlines_.erase(deadlines_.begin());
+				target &t = targets_[idx];
+				if (t.done)
+					continue;
+				if (t.sent < max_tries_)
+					send(idx);
+				else
+				{
+					t.done = true;
+					remaining_--;
+				}
+			}
+			if (remaining_ == 0)
+			{
+				finish();
+				return;
+			}
+			schedule_timeout();
+		}
+
+		void finish()
+		{
+			boost::system::error_code ec;
+			timer_.cancel(ec);
+			socket_.cancel(ec);
+			io_service_.stop();
+		}
+
+		boost::asio::io_service &io_service_;
+		boost::asio::ip::icmp::socket socket_;
+		boost::asio::deadline_timer timer_;
+		boost::asio::ip::icmp::endpoint reply_sender_;
+		boost::asio::streambuf reply_buffer_;
+		int timeout_ms_;
+		int max_tries_;
+
+		std::vector<target> targets_;
+		std::map<unsigned short, size_t> pending_;	//sequence number -> target
+		std::multimap<std::chrono::steady_clock::time_point, size_t> deadlines_;
+		int remaining_;
+		int sent_;
+		int received_;
+	};
+} // namespace
+
+bool CPingSweep::Sweep(const std::vector<std::string> &Hosts, const int TimeoutMs, const int MaxTries, std::vector<_tResult> &Results, _tStats &Stats)
+{
+	std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+	Stats.Hosts = (int)Hosts.size();
+	Stats.Unresolved = 0;
+	Stats.Sent = 0;
+	Stats.Received = 0;
+	Stats.Alive = 0;
+	Stats.DurationMs = 0;
+	Results.clear();
+
+	try
+	{
+		boost::asio::io_service io_service;
+		sweeper sweep(io_service, TimeoutMs, (MaxTries > 0) ? MaxTries : 1);
+
+		boost::asio::ip::icmp::resolver resolver(io_service);
+		for (const auto & itt : Hosts)
+		{
+			boost::system::error_code ec;
+			boost::asio::ip::icmp::resolver::query query(boost::asio::ip::icmp::v4(), itt, "");
+			boost::asio::ip::icmp::resolver::iterator iter = resolver.resolve(query, ec);
+			if ((ec) || (iter == boost::asio::ip::icmp::resolver::iterator()))
+			{
+				sweep.add_unresolved();
+				Stats.Unresolved++;
+				continue;
+			}
+			sweep.add_target(*iter);
+		}
+
+		if (sweep.start())
+			io_service.run();
+		sweep.get_results(Results, Stats);
+	}
+	catch (std::exception& e)
+	{
+		_log.Debug(DEBUG_HARDWARE, "Pinger: Sweep failed (%s)", e.what());
+		Results.assign(Hosts.size(), _tResult());
+		for (auto & itt : Results)
+		{
+			itt.bAlive = false;
+			itt.Sent = 0;
+			itt.RoundTripMs = -1;
+		}
+		return false;
+	}
+	Stats.DurationMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tStart).count();
+	return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*
+ * Pings a list of hosts at once. All echo requests go out over one raw ICMP socket,
+ * the replies are matched on identifier and sequence number and the retries of all
+ * hosts are driven by one timer, so a sweep takes at most MaxTries * TimeoutMs
+ * whatever the number of hosts.
+ */
+class CPingSweep
+{
+public:
+	struct _tResult
+	{
+		bool bAlive;
+		int Sent;			//echo requests sent to the host
+		int RoundTripMs;	//of the answered request, -1 when the host did not answer
+	};
+	struct _tStats
+	{
+		int Hosts;
+		int Unresolved;
+		int Sent;
+		int Received;
+		int Alive;
+		int DurationMs;
+	};
+
+	//Every host gets up to MaxTries echo requests, TimeoutMs apart, until it answers.
+	//Returns false when the ICMP socket could not be opened (raw sockets need extra rights)
+	static bool Sweep(const std::vector<std::string> &Hosts, const int TimeoutMs, const int MaxTries, std::vector<_tResult> &Results, _tStats &Stats);
+};
@@ -1,160 +1,21 @@
 #include "stdafx.h"
 #include "Pinger.h"
+#include "PingSweep.h"
 #include "../main/Helper.h"
 #include "../main/HTMLSanitizer.h"
 #include "../main/Logger.h"
 #include "../main/SQLHelper.h"
 #include "../main/RFXtrx.h"
 #include "../main/localtime_r.h"
-#include "../main/Noncopyable.h"
 #include "../main/WebServer.h"
 #include "../main/mainworker.h"
 #include "../webserver/cWebem.h"
 #include "../json/json.h"
 
-#include <boost/asio.hpp>
-
-#include "pinger/icmp_header.h"
-#include "pinger/ipv4_header.h"
-
-#include <iostream>
-
-#if BOOST_VERSION >= 107000
-#define GET_IO_SERVICE(s) ((boost::asio::io_context&)(s).get_executor().context())
-#else
-#define GET_IO_SERVICE(s) ((s).get_io_service())
-#endif
-
-class pinger
-	: private domoticz::noncopyable
-{
-public:
-	pinger(boost::asio::io_service& io_service, const char* destination, const int iPingTimeoutms)
-		: resolver_(io_service), socket_(io_service, boost::asio::ip::icmp::v4()),
-		timer_(io_service), sequence_number_(0), m_PingState(false), num_replies_(0)
-	{
-		boost::asio::ip::icmp::resolver::query query(boost::asio::ip::icmp::v4(), destination, "");
-		destination_ = *resolver_.resolve(query);
-
-		num_tries_ = 1;
-		PingTimeoutms_ = iPingTimeoutms;
-		start_send();
-		start_receive();
-	}
-	int num_replies_;
-	int num_tries_;
-	int PingTimeoutms_;
-	bool m_PingState;
-private:
-	void start_send()
-	{
-		std::string body("Domoticz");
-
-		// Create an ICMP header for an echo request.
-		icmp_header echo_request;
-		echo_request.type(icmp_header::echo_request);
-		echo_request.code(0);
-		echo_request.identifier(get_identifier());
-		echo_request.sequence_number(++sequence_number_);
-		compute_checksum(echo_request, body.begin(), body.end());
-
-		// Encode the request packet.
-		boost::asio::streambuf request_buffer;
-		std::ostream os(&request_buffer);
-		os << echo_request << body;
-
-		// Send the request.
-		time_sent_ = boost::posix_time::microsec_clock::universal_time();
-		socket_.send_to(request_buffer.data(), destination_);
-
-		num_replies_ = 0;
-		timer_.expires_at(time_sent_ + boost::posix_time::milliseconds(PingTimeoutms_));
-		timer_.async_wait(boost::bind(&pinger::handle_timeout, this, boost::asio::placeholders::error));
-	}
-
-	void handle_timeout(const boost::system::error_code& error)
-	{
-		if (error != boost::asio::error::operation_aborted)
-		{
-			if (num_replies_ == 0)
-			{
-				m_PingState = false;
-				timer_.expires_at(time_sent_ + boost::posix_time::milliseconds(PingTimeoutms_));
-				num_tries_++;
-				if (num_tries_ > 4)
-				{
-					GET_IO_SERVICE(resolver_).stop();
-				}
-				else
-				{
-					timer_.async_wait(boost::bind(&pinger::start_send, this));
-				}
-			}
-		}
-	}
-
-	void start_receive()
-	{
-		// Discard any data already in the buffer.
-		reply_buffer_.consume(reply_buffer_.size());
-
-		// Wait for a reply. We prepare the buffer to receive up to 64KB.
-		socket_.async_receive(reply_buffer_.prepare(65536),
-			boost::bind(&pinger::handle_receive, this, _2));
-	}
-
-	void handle_receive(std::size_t length)
-	{
-		// The actual number of bytes received is committed to the buffer so that we
-		// can extract it using a std::istream object.
-		reply_buffer_.commit(length);
-
-		// Decode the reply packet.
-		std::istream is(&reply_buffer_);
-		ipv4_header ipv4_hdr;
-		icmp_header icmp_hdr;
-		is >> ipv4_hdr >> icmp_hdr;
-
-		// We can receive all ICMP packets received by the host, so we need to
-		// filter out only the echo replies that match the our identifier and
-		// expected sequence number.
-		if (is && icmp_hdr.type() == icmp_header::echo_reply
-			&& icmp_hdr.identifier() == get_identifier()
-			&& icmp_hdr.sequence_number() == sequence_number_)
-		{
-			if (num_replies_++ == 0)
-				timer_.cancel();
-			m_PingState = true;
-			GET_IO_SERVICE(resolver_).stop();
-		}
-		else
-		{
-			// DD 2 possible 'invalid' replies that will be discarded are:
-			// Type 8: Echo request, happens when we ping ourselves (localhost)
-			// Type 3: Destination host unreachable.
-			start_receive();
-		}
-	}
-
-	static unsigned short get_identifier()
-	{
-#if defined(BOOST_WINDOWS)
-		return static_cast<unsigned short>(::GetCurrentProcessId());
-#else
-		return static_cast<unsigned short>(::getpid());
-#endif
-	}
-	boost::asio::ip::icmp::resolver resolver_;
-	boost::asio::ip::icmp::endpoint destination_;
-	boost::asio::ip::icmp::socket socket_;
-	boost::asio::deadline_timer timer_;
-	unsigned short sequence_number_;
-	boost::posix_time::ptime time_sent_;
-	boost::asio::streambuf reply_buffer_;
-};
+#include <map>
 
 CPinger::CPinger(const int ID, const int PollIntervalsec, const int PingTimeoutms) :
-	m_iThreadsRunning(0)
+	m_bSweepFailed(false)
 {
 	m_HwdID = ID;
 	m_bSkipReceiveCheck = true;
@@ -174,7 +35,7 @@ bool CPinger::StartHardware()
 
 	m_bIsStarted = true;
 	sOnConnected(this);
-	m_iThreadsRunning = 0;
+	m_bSweepFailed = false;
 
 	StartHeartbeatThread();
 
@@ -289,6 +150,11 @@ void CPinger::RemoveAllNodes()
 
 void CPinger::ReloadNodes()
 {
+	//keep the known state of the nodes, so a reload does not report them again
+	std::map<int, PingNode> oldnodes;
+	for (const auto & itt : m_nodes)
+		oldnodes[itt.ID] = itt;
+
 	m_nodes.clear();
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query("SELECT ID,Name,MacAddress,Timeout FROM WOLNodes WHERE (HardwareID==%d)",
@@ -305,88 +171,84 @@ void CPinger::ReloadNodes()
 			pnode.Name = sd[1];
 			pnode.IP = sd[2];
 			pnode.LastOK = mytime(NULL);
+			pnode.State = -1;
 
 			int SensorTimeoutSec = atoi(sd[3].c_str());
 			pnode.SensorTimeoutSec = (SensorTimeoutSec > 0) ? SensorTimeoutSec : 5;
+
+			std::map<int, PingNode>::const_iterator ittOld = oldnodes.find(pnode.ID);
+			if ((ittOld != oldnodes.end()) && (ittOld->second.IP == pnode.IP))
+			{
+				pnode.LastOK = ittOld->second.LastOK;
+				pnode.State = ittOld->second.State;
+			}
 			m_nodes.push_back(pnode);
 		}
 	}
 }
 
-void CPinger::Do_Ping_Worker(const PingNode &Node)
+void CPinger::UpdateNodeStatus(PingNode &Node, const bool bPingOK)
 {
-	bool bPingOK = false;
-	boost::asio::io_service io_service;
-	try
+	//Only report changes, a node is reported down after not answering for its timeout
+	time_t atime = mytime(NULL);
+	if (bPingOK)
 	{
-		pinger p(io_service, Node.IP.c_str(), m_iPingTimeoutms);
-		io_service.run();
-		if (p.m_PingState == true)
-		{
-			bPingOK = true;
-		}
-	}
-	catch (std::exception& e)
-	{
-		(void)e;
-		bPingOK = false;
+		Node.LastOK = atime;
+		if (Node.State == 1)
+			return;
+		Node.State = 1;
 	}
-	catch (...)
+	else
 	{
-		bPingOK = false;
+		if ((Node.State == 0) || (difftime(atime, Node.LastOK) < Node.SensorTimeoutSec))
+			return;
+		Node.State = 0;
 	}
-	UpdateNodeStatus(Node, bPingOK);
-	if (m_iThreadsRunning > 0) m_iThreadsRunning--;
+	SendSwitch(Node.ID, 1, 255, bPingOK, 0, Node.Name);
 }
 
-void CPinger::UpdateNodeStatus(const PingNode &Node, const bool bPingOK)
+void CPinger::DoPingHosts()
 {
-	//_log.Log(LOG_STATUS, "Pinger: %s = %s", Node.Name.c_str(), (bPingOK == true) ? "OK" : "Error");
-	if (!bPingOK)
+	//Sweep a copy of the nodes, so they can be edited while the hosts are pinged
+	std::vector<PingNode> nodes;
 	{
-		//_log.Log(LOG_STATUS, "Pinger: Could not ping host: %s", Node.Name.c_str());
+		std::lock_guard<std::mutex> l(m_mutex);
+		nodes = m_nodes;
 	}
+	if (nodes.empty())
+		return;
+
+	std::vector<std::string> hosts;
+	for (const auto & itt : nodes)
+		hosts.push_back(itt.IP);
 
-	//Find out node, and update it's status
-	std::vector<PingNode>::iterator itt;
-	for (itt = m_nodes.begin(); itt != m_nodes.end(); ++itt)
+	std::vector<CPingSweep::_tResult> results;
+	CPingSweep::_tStats stats;
+	if (!CPingSweep::Sweep(hosts, m_iPingTimeoutms, 4, results, stats))
 	{
-		if (itt->ID == Node.ID)
-		{
-			//Found it
-			time_t atime = mytime(NULL);
-			if (bPingOK)
-			{
-				itt->LastOK = atime;
-				SendSwitch(Node.ID, 1, 255, bPingOK, 0, Node.Name);
-			}
-			else
-			{
-				if (difftime(atime, itt->LastOK) >= Node.SensorTimeoutSec)
-				{
-					itt->LastOK = atime;
-					SendSwitch(Node.ID, 1, 255, bPingOK, 0, Node.Name);
-				}
-			}
-			break;
-		}
+		if (!m_bSweepFailed)
+			_log.Log(LOG_ERROR, "Pinger: Could not open an ICMP socket, raw sockets need root/administrator rights (or CAP_NET_RAW)");
+		m_bSweepFailed = true;
 	}
-}
+	else
+		m_bSweepFailed = false;
+	_log.Debug(DEBUG_HARDWARE, "Pinger: Swept %d hosts in %d ms (sent: %d, received: %d, alive: %d, unresolved: %d)",
+		stats.Hosts, stats.DurationMs, stats.Sent, stats.Received, stats.Alive, stats.Unresolved);
+
+	if (IsStopRequested(0))
+		return;
 
-void CPinger::DoPingHosts()
-{
 	std::lock_guard<std::mutex> l(m_mutex);
-	std::vector<PingNode>::const_iterator itt;
-	for (itt = m_nodes.begin(); itt != m_nodes.end(); ++itt)
+	for (size_t ii = 0; ii < nodes.size(); ii++)
 	{
-		if (IsStopRequested(0))
-			return;
-		if (m_iThreadsRunning < 1000)
+		for (auto & itt : m_nodes)
 		{
-			//m_iThreadsRunning++;
-			boost::thread t(boost::bind(&CPinger::Do_Ping_Worker, this, *itt));
-			SetThreadName(t.native_handle(), "PingerWorker");
-			t.join();
+			//the node could have been changed or removed during the sweep
+			if ((itt.ID == nodes[ii].ID) && (itt.IP == nodes[ii].IP))
+			{
+				UpdateNodeStatus(itt, (ii < results.size()) && results[ii].bAlive);
+				break;
+			}
 		}
 	}
 }
@@ -412,11 +274,6 @@ void CPinger::Do_Work()
 			}
 		}
 	}
-	//Make sure all our background workers are stopped
-	while (m_iThreadsRunning > 0)
-	{
-		sleep_milliseconds(150);
-	}
 	_log.Log(LOG_STATUS, "Pinger: Worker stopped...");
 }
 
@@ -13,6 +13,7 @@ class CPinger : public CDomoticzHardwareBase
 		std::string IP;
 		time_t LastOK;
 		int SensorTimeoutSec;
+		int State;	//last reported state, -1 when not reported yet
 	};
 public:
 	CPinger(const int ID, const int PollIntervalsec, const int PingTimeoutms);
@@ -28,11 +29,10 @@ private:
 	bool StartHardware() override;
 	bool StopHardware() override;
 	void DoPingHosts();
-	void Do_Ping_Worker(const PingNode &Node);
-	void UpdateNodeStatus(const PingNode &Node, const bool bPingOK);
+	void UpdateNodeStatus(PingNode &Node, const bool bPingOK);
 	void ReloadNodes();
 private:
-	int m_iThreadsRunning;
+	bool m_bSweepFailed;
 	int m_iPollInterval;
 	int m_iPingTimeoutms;
 	std::vector<PingNode> m_nodes;
@@ -20,7 +20,7 @@ void removeCharsFromString(std::string &str, const char* charsToRemove) {
 	}
 }
 
-CRtl433::CRtl433(const int ID, const std::string &cmdline) :
+CRtl433::CRtl433(const int ID, const std::string &cmdline, const int OutputFormat, const std::string &AllowedSensors) :
 	m_cmdline(cmdline)
 {
 	// Basic protection from malicious command line
@@ -28,6 +28,8 @@ CRtl433::CRtl433(const int ID, const std::string &cmdline) :
 	m_HwdID = ID;
 	m_hPipe = NULL;
 	m_time_last_received = 0;
+	m_OutputFormat = (OutputFormat == RTL433_FORMAT_JSON) ? RTL433_FORMAT_JSON : RTL433_FORMAT_CSV;
+	SetAllowedSensors(AllowedSensors);
 /*
 	#ifdef _DEBUG
 		std::string headerline = "time,msg,codes,model,button,id,channel,battery,temperature_C,mic,subtype,rid,humidity,state,status,brand,rain_rate,rain_rate_mm_h,rain_rate_in_h,rain_total,rain_mm,rain_in,gust,average,direction,wind_max_m_s,wind_avg_m_s,wind_dir_deg,pressure_hPa,uv,power_W,energy_kWh,unit,group_call,command,dim,dim_value,wind_speed,wind_gust,wind_direction,wind_avg_km_h,wind_max_km_h,dipswitch,rbutton,device,temperature_F,battery_ok,setpoint_C,switch,cmd,cmd_id,tristate,direction_deg,speed,rain,msg_type,signal,radio_clock,sensor_code,uv_status,uv_index,lux,wm,seq,rainfall_mm,wind_speed_ms,gust_speed_ms,current,interval,learn,sensor_id,battery_low,sequence_num,message_type,wind_speed_mph,wind_speed_kph,wind_avg_mi_h,rain_inch,rc,gust_speed_mph,wind_max_mi_h,wind_approach,flags,maybetemp,binding_countdown,depth,depth_cm,dev_id,power0,power1,power2,node,ct1,ct2,ct3,ct4,Vrms/batt,batt_Vrms,temp1_C,temp2_C,temp3_C,temp4_C,temp5_C,temp6_C,pulse,address,button1,button2,button3,button4,data,sid,group,transmit,moisture,type,pressure_PSI,battery_mV,pressure_kPa,pulses,energy,len,to,from,payload,event,heartbeat,temperature1_C,temperature2_C,temperature_1_C,temperature_2_C,test,probe,water,humidity_1,ptemperature_C,phumidity,newbattery,heating,heating_temp,uvi,light_lux,pm2_5_ug_m3,pm10_ug_m3,counter,code,alarm,repeat,maybe_battery,device_type,raw_message,switch1,switch2,switch3,switch4,switch5,extradata,house_id,module_id,sensor_type,sensor_count,alarms,sensor_value,battery_voltage,failed,class,alert,secret_knock,relay,wind_dev_deg,exposure_mins,transmit_s,device_id,button_id,button_name";
@@ -96,12 +98,119 @@ std::vector<std::string> CRtl433::ParseCSVLine(const char *input)
 	return line;
 }
 
-bool CRtl433::FindField(const std::map<std::string, std::string> &data, const std::string &field)
+void CRtl433::_tFrame::Clear()
 {
-	return (data.find(field) != data.end());
+	for (int ii = 0; ii < RTL433_FIELD_MAX; ii++)
+		values[ii][0] = 0;
 }
 
-bool CRtl433::ParseLine(const std::vector<std::string> &headers, const char *line)
+void CRtl433::_tFrame::Set(const _eField field, const char *pValue, const size_t length)
+{
+	size_t len = (length < sizeof(values[field]) - 1) ? length : sizeof(values[field]) - 1;
+	memcpy(values[field], pValue, len);
+	values[field][len] = 0;
+}
+
+CRtl433::_eField CRtl433::FindField(const char *key, const size_t length)
+{
+	//Sorted on key
+	static const struct
+	{
+		const char *szKey;
+		_eField field;
+	} fields[] = {
+		{ "average", RTL433_FIELD_AVERAGE },
+		{ "battery", RTL433_FIELD_BATTERY },
+		{ "battery_ok", RTL433_FIELD_BATTERY_OK },
+		{ "channel", RTL433_FIELD_CHANNEL },
+		{ "command", RTL433_FIELD_COMMAND },
+		{ "depth", RTL433_FIELD_DEPTH },
+		{ "depth_cm", RTL433_FIELD_DEPTH_CM },
+		{ "direction", RTL433_FIELD_DIRECTION },
+		{ "gust", RTL433_FIELD_GUST },
+		{ "humidity", RTL433_FIELD_HUMIDITY },
+		{ "id", RTL433_FIELD_ID },
+		{ "model", RTL433_FIELD_MODEL },
+		{ "moisture", RTL433_FIELD_MOISTURE },
+		{ "power_W", RTL433_FIELD_POWER_W },
+		{ "pressure_hPa", RTL433_FIELD_PRESSURE_HPA },
+		{ "rain", RTL433_FIELD_RAIN },
+		{ "rain_total", RTL433_FIELD_RAIN_TOTAL },
+		{ "rainfall_mm", RTL433_FIELD_RAINFALL_MM },
+		{ "rc", RTL433_FIELD_RC },
+		{ "state", RTL433_FIELD_STATE },
+		{ "temperature_C", RTL433_FIELD_TEMPERATURE_C },
+		{ "temperature_F", RTL433_FIELD_TEMPERATURE_F },
+		{ "unit", RTL433_FIELD_UNIT },
+		{ "wind_direction", RTL433_FIELD_WIND_DIRECTION },
+		{ "wind_gust", RTL433_FIELD_WIND_GUST },
+		{ "wind_speed", RTL433_FIELD_WIND_SPEED },
+		{ "winddirection", RTL433_FIELD_WINDDIRECTION },
+		{ "windstrength", RTL433_FIELD_WINDSTRENGTH },
+	};
+	int low = 0;
+	int high = (int)(sizeof(fields) / sizeof(fields[0])) - 1;
+	while (low <= high)
+	{
+		int mid = (low + high) / 2;
+		int cmp = strncmp(fields[mid].szKey, key, length);
+		if ((cmp == 0) && (fields[mid].szKey[length] != 0))
+			cmp = 1; //key is a prefix of this entry
+		if (cmp == 0)
+			return fields[mid].field;
+		if (cmp < 0)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+	return RTL433_FIELD_NONE;
+}
+
+void CRtl433::SetAllowedSensors(const std::string &AllowedSensors)
+{
+	m_AllowedSensors.clear();
+	std::vector<std::string> entries;
+	StringSplit(AllowedSensors, ",", entries);
+	for (auto & itt : entries)
+	{
+		std::string entry = itt;
+		stdstring_trim(entry);
+		if (entry.empty())
+			continue;
+		_tAllowedSensor sensor;
+		size_t pos = entry.find(':');
+		if (pos != std::string::npos)
+		{
+			sensor.model = entry.substr(0, pos);
+			sensor.id = entry.substr(pos + 1);
+			stdstring_trim(sensor.model);
+			stdstring_trim(sensor.id);
+		}
+		else
+			sensor.model = entry;
+		m_AllowedSensors.push_back(sensor);
+	}
+	std::sort(m_AllowedSensors.begin(), m_AllowedSensors.end(),
+		[](const _tAllowedSensor &a, const _tAllowedSensor &b) { return a.model < b.model; });
+}
+
+bool CRtl433::IsAllowed(const _tFrame &frame) const
+{
+	if (m_AllowedSensors.empty())
+		return true;
+	const char *szModel = frame.Get(RTL433_FIELD_MODEL);
+	const char *szID = frame.Have(RTL433_FIELD_ID) ? frame.Get(RTL433_FIELD_ID) : frame.Get(RTL433_FIELD_RC);
+	std::vector<_tAllowedSensor>::const_iterator itt = std::lower_bound(m_AllowedSensors.begin(), m_AllowedSensors.end(), szModel,
+		[](const _tAllowedSensor &a, const char *b) { return strcmp(a.model.c_str(), b) < 0; });
+	for (; (itt != m_AllowedSensors.end()) && (strcmp(itt->model.c_str(), szModel) == 0); ++itt)
+	{
+		if ((itt->id.empty()) || (strcmp(itt->id.c_str(), szID) == 0))
+			return true;
+	}
+	return false;
+}
+
+bool CRtl433::ParseLine(const std::vector<_eField> &fields, const char *line)
 {
 	time_t atime = time(NULL);
 	std::string slineRaw(line);
@@ -118,18 +227,155 @@ bool CRtl433::ParseLine(const std::vector<std::string> &headers, const char *lin
 	m_time_last_received = atime;
 	std::vector<std::string> values = ParseCSVLine(line);
 
-	if (values.size() != headers.size())
+	if (values.size() != fields.size())
 		return false; //should be equal
 
-	// load values into a map
-	std::map<std::string, std::string> data;
-	std::vector<std::string>::const_iterator h = headers.begin();
-	for (std::vector<std::string>::iterator vi = values.begin(); vi != values.end(); ++vi)
+	_tFrame frame;
+	frame.Clear();
+	for (size_t ii = 0; ii < values.size(); ii++)
 	{
-		if (!(*vi).empty())
-			data[*(h)] = *vi;
-		h++;
+		if ((fields[ii] != RTL433_FIELD_NONE) && (!values[ii].empty()))
+			frame.Set(fields[ii], values[ii].c_str(), values[ii].size());
 	}
+	if (!IsAllowed(frame))
+		return true;
+	return ProcessFrame(frame);
+}
+
+//Parses one line of 'rtl_433 -F json' output, a flat JSON object per message.
+//Only the fields from the key table are copied, everything else (and nested arrays/objects) is skipped.
+bool CRtl433::ParseJSONLine(const char *line)
+{
+	_tFrame frame;
+	frame.Clear();
+	const char *pDedup = NULL; //message content after the time, used to detect repeated RF frames
+
+	const char *s = line;
+	while (isspace((unsigned char)*s))
+		s++;
+	if (*s != '{')
+		return false;
+	s++;
+	while (true)
+	{
+		while (isspace((unsigned char)*s))
+			s++;
+		if (*s == '}')
+			break;
+		if (*s != '"')
+			return false;
+		const char *pKey = ++s;
+		while ((*s) && (*s != '"'))
+		{
+			if ((*s == '\\') && (s[1]))
+				s++;
+			s++;
+		}
+		if (!*s)
+			return false;
+		size_t keyLength = s - pKey;
+		s++;
+		while (isspace((unsigned char)*s))
+			s++;
+		if (*s != ':')
+			return false;
+		s++;
+		while (isspace((unsigned char)*s))
+			s++;
+
+		_eField field = FindField(pKey, keyLength);
+		if (*s == '"')
+		{
+			//string, rtl_433 only escapes quotes and backslashes, which we don't expect in the fields we use
+			const char *pValue = ++s;
+			while ((*s) && (*s != '"'))
+			{
+				if ((*s == '\\') && (s[1]))
+					s++;
+				s++;
+			}
+			if (!*s)
+				return false;
+			if (field != RTL433_FIELD_NONE)
+				frame.Set(field, pValue, s - pValue);
+			s++;
+		}
+		else if ((*s == '[') || (*s == '{'))
+		{
+			//skip nested value
+			int depth = 0;
+			bool bInString = false;
+			while (*s)
+			{
+				if (bInString)
+				{
+					if ((*s == '\\') && (s[1]))
+						s++;
+					else if (*s == '"')
+						bInString = false;
+				}
+				else if (*s == '"')
+					bInString = true;
+				else if ((*s == '[') || (*s == '{'))
+					depth++;
+				else if ((*s == ']') || (*s == '}'))
+				{
+					if (--depth == 0)
+					{
+						s++;
+						break;
+					}
+				}
+				s++;
+			}
+			if (depth != 0)
+				return false;
+		}
+		else
+		{
+			//number, true, false or null
+			const char *pValue = s;
+			while ((*s) && (*s != ',') && (*s != '}') && (!isspace((unsigned char)*s)))
+				s++;
+			size_t valueLength = s - pValue;
+			if ((field != RTL433_FIELD_NONE) && (valueLength > 0) && (!((valueLength == 4) && (strncmp(pValue, "null", 4) == 0))))
+			{
+				if ((valueLength == 4) && (strncmp(pValue, "true", 4) == 0))
+					frame.Set(field, "1", 1);
+				else if ((valueLength == 5) && (strncmp(pValue, "false", 5) == 0))
+					frame.Set(field, "0", 1);
+				else
+					frame.Set(field, pValue, valueLength);
+			}
+		}
+		if ((keyLength == 4) && (strncmp(pKey, "time", 4) == 0))
+			pDedup = s;
+
+		while (isspace((unsigned char)*s))
+			s++;
+		if (*s == ',')
+			s++;
+		else if (*s != '}')
+			return false;
+	}
+
+	//filter foreign sensors before anything else is done with the message
+	if (!IsAllowed(frame))
+		return true;
+
+	time_t atime = time(NULL);
+	if (pDedup == NULL)
+		pDedup = line;
+	if ((atime - m_time_last_received < 2) && (strcmp(m_sLastLine.c_str(), pDedup) == 0))
+		return true; //skip duplicate RF frames
+	m_sLastLine.assign(pDedup);
+	m_time_last_received = atime;
+
+	return ProcessFrame(frame);
+}
+
+bool CRtl433::ProcessFrame(const _tFrame &frame)
+{
 	int id = 0;
 
 	bool haveUnit = false;
@@ -174,174 +420,186 @@ bool CRtl433::ParseLine(const std::vector<std::string> &headers, const char *lin
 	bool havePower = false;
 	float power = 0;
 
-	if (!data["id"].empty())
+	if (frame.Have(RTL433_FIELD_ID))
 	{
-		id = atoi(data["id"].c_str());
+		id = atoi(frame.Get(RTL433_FIELD_ID));
 	}
-	else if (!data["rc"].empty())
+	else if (frame.Have(RTL433_FIELD_RC))
 	{
-		id = atoi(data["rc"].c_str());
+		id = atoi(frame.Get(RTL433_FIELD_RC));
 	}
 
 
-	if (FindField(data, "unit"))
+	if (frame.Have(RTL433_FIELD_UNIT))
 	{
-		unit = atoi(data["unit"].c_str());
+		unit = atoi(frame.Get(RTL433_FIELD_UNIT));
 		haveUnit = true;
 	}
-	if (FindField(data, "channel"))
+	if (frame.Have(RTL433_FIELD_CHANNEL))
 	{
-		channel = atoi(data["channel"].c_str());
+		channel = atoi(frame.Get(RTL433_FIELD_CHANNEL));
 		haveChannel = true;
 	}
-	if (FindField(data, "battery"))
+	if (frame.Have(RTL433_FIELD_BATTERY))
 	{
-		if (data["battery"] == "LOW") {
+		if (strcmp(frame.Get(RTL433_FIELD_BATTERY), "LOW") == 0) {
 			batterylevel = 10;
 			haveBattery = true;
 		}
-		else if (data["battery"] == "OK") {
+		else if (strcmp(frame.Get(RTL433_FIELD_BATTERY), "OK") == 0) {
 			batterylevel = 100;
 			haveBattery = true;
 		}
 	}
+	else if (frame.Have(RTL433_FIELD_BATTERY_OK))
+	{
+		//newer rtl_433 versions report 0 (low) or 1 (ok), some devices a fraction in between
+		double battery_ok = atof(frame.Get(RTL433_FIELD_BATTERY_OK));
+		if (battery_ok >= 1.0)
+			batterylevel = 100;
+		else if (battery_ok <= 0.1)
+			batterylevel = 10;
+		else
+			batterylevel = (int)(battery_ok * 100);
+		haveBattery = true;
+	}
 
-	if (FindField(data, "temperature_C"))
+	if (frame.Have(RTL433_FIELD_TEMPERATURE_C))
 	{
-		tempC = (float)atof(data["temperature_C"].c_str());
+		tempC = (float)atof(frame.Get(RTL433_FIELD_TEMPERATURE_C));
 		haveTemp = true;
 	}
-	else if (FindField(data, "temperature_F"))
+	else if (frame.Have(RTL433_FIELD_TEMPERATURE_F))
 	{
-		tempC = (float)ConvertToCelsius(atof(data["temperature_F"].c_str()));
+		tempC = (float)ConvertToCelsius(atof(frame.Get(RTL433_FIELD_TEMPERATURE_F)));
 		haveTemp = true;
 	}
 
-	if (FindField(data, "humidity"))
+	if (frame.Have(RTL433_FIELD_HUMIDITY))
 	{
-		if (data["humidity"] == "HH")
+		if (strcmp(frame.Get(RTL433_FIELD_HUMIDITY), "HH") == 0)
 		{
 			humidity = 90;
 			haveHumidity = true;
 		}
-		else if (data["humidity"] == "LL")
+		else if (strcmp(frame.Get(RTL433_FIELD_HUMIDITY), "LL") == 0)
 		{
 			humidity = 10;
 			haveHumidity = true;
 		}
 		else
 		{
-			humidity = atoi(data["humidity"].c_str());
+			humidity = atoi(frame.Get(RTL433_FIELD_HUMIDITY));
 			haveHumidity = true;
 		}
 	}
 
-	if (FindField(data, "pressure_hPa"))
+	if (frame.Have(RTL433_FIELD_PRESSURE_HPA))
 	{
-		pressure = (float)atof(data["pressure_hPa"].c_str());
+		pressure = (float)atof(frame.Get(RTL433_FIELD_PRESSURE_HPA));
 		havePressure = true;
 	}
 
-	if (FindField(data, "rain"))
+	if (frame.Have(RTL433_FIELD_RAIN))
 	{
-		rain = (float)atof(data["rain"].c_str());
+		rain = (float)atof(frame.Get(RTL433_FIELD_RAIN));
 		haveRain = true;
 	}
 
-	if (FindField(data, "rainfall_mm"))
+	if (frame.Have(RTL433_FIELD_RAINFALL_MM))
 	{
-		rain = (float)atof(data["rainfall_mm"].c_str());
+		rain = (float)atof(frame.Get(RTL433_FIELD_RAINFALL_MM));
 		haveRain = true;
 	}
 
-	if (FindField(data, "rain_total"))
+	if (frame.Have(RTL433_FIELD_RAIN_TOTAL))
 	{
-		rain = (float)atof(data["rain_total"].c_str());
+		rain = (float)atof(frame.Get(RTL433_FIELD_RAIN_TOTAL));
 		haveRain = true;
 	}
 
-	if (FindField(data, "depth_cm"))
+	if (frame.Have(RTL433_FIELD_DEPTH_CM))
 	{
-		depth_cm = (float)atof(data["depth_cm"].c_str());
+		depth_cm = (float)atof(frame.Get(RTL433_FIELD_DEPTH_CM));
 		haveDepth_CM = true;
 	}
 
-	if (FindField(data, "depth"))
+	if (frame.Have(RTL433_FIELD_DEPTH))
 	{
-		depth = (float)atof(data["depth"].c_str());
+		depth = (float)atof(frame.Get(RTL433_FIELD_DEPTH));
 		haveDepth = true;
 	}
 
-	if (FindField(data, "windstrength") || FindField(data, "wind_speed"))
+	if (frame.Have(RTL433_FIELD_WINDSTRENGTH) || frame.Have(RTL433_FIELD_WIND_SPEED))
 	{
 		//Based on current knowledge it's not possible to have both wind strength and wind_speed at the same time.
-		if (FindField(data, "windstrength"))
+		if (frame.Have(RTL433_FIELD_WINDSTRENGTH))
 		{
-			wind_strength = (float)atof(data["windstrength"].c_str());
+			wind_strength = (float)atof(frame.Get(RTL433_FIELD_WINDSTRENGTH));
 		}
-		else if (FindField(data, "wind_speed"))
+		else if (frame.Have(RTL433_FIELD_WIND_SPEED))
 		{
-			wind_strength = (float)atof(data["wind_speed"].c_str());
+			wind_strength = (float)atof(frame.Get(RTL433_FIELD_WIND_SPEED));
 		}
 		haveWind_Strength = true;
 	}
-	else if (FindField(data, "average"))
+	else if (frame.Have(RTL433_FIELD_AVERAGE))
 	{
-		wind_strength = (float)atof(data["average"].c_str());
+		wind_strength = (float)atof(frame.Get(RTL433_FIELD_AVERAGE));
 		haveWind_Strength = true;
 	}
 
-	if (FindField(data, "winddirection") || FindField(data, "wind_direction"))
+	if (frame.Have(RTL433_FIELD_WINDDIRECTION) || frame.Have(RTL433_FIELD_WIND_DIRECTION))
 	{
 		//Based on current knowledge it's not possible to have both wind direction and wind_direction at the same time.
-		if (FindField(data, "winddirection"))
+		if (frame.Have(RTL433_FIELD_WINDDIRECTION))
 		{
-			wind_dir = atoi(data["winddirection"].c_str());
+			wind_dir = atoi(frame.Get(RTL433_FIELD_WINDDIRECTION));
 		}
-		else if (FindField(data, "wind_direction"))
+		else if (frame.Have(RTL433_FIELD_WIND_DIRECTION))
 		{
-			wind_dir = atoi(data["wind_direction"].c_str());
+			wind_dir = atoi(frame.Get(RTL433_FIELD_WIND_DIRECTION));
 		}
 		haveWind_Dir = true;
 	}
-	else if (FindField(data, "direction"))
+	else if (frame.Have(RTL433_FIELD_DIRECTION))
 	{
-		wind_dir = atoi(data["direction"].c_str());
+		wind_dir = atoi(frame.Get(RTL433_FIELD_DIRECTION));
 		haveWind_Dir = true;
 	}
 
-	if (FindField(data, "wind_gust"))
+	if (frame.Have(RTL433_FIELD_WIND_GUST))
 	{
-		wind_gust = (float)atof(data["wind_gust"].c_str());
+		wind_gust = (float)atof(frame.Get(RTL433_FIELD_WIND_GUST));
 		haveWind_Gust = true;
 	}
-	else if (FindField(data, "gust"))
+	else if (frame.Have(RTL433_FIELD_GUST))
 	{
-		wind_gust = (float)atof(data["gust"].c_str());
+		wind_gust = (float)atof(frame.Get(RTL433_FIELD_GUST));
 		haveWind_Gust = true;
 	}
-	else if (FindField(data, "moisture"))
+	else if (frame.Have(RTL433_FIELD_MOISTURE))
 	{
-		moisture = atoi(data["moisture"].c_str());
+		moisture = atoi(frame.Get(RTL433_FIELD_MOISTURE));
 		haveMoisture = true;
 	}
-	else if (FindField(data, "power_W"))
+	else if (frame.Have(RTL433_FIELD_POWER_W))
 	{
-		power = (float)atof(data["power_W"].c_str());
+		power = (float)atof(frame.Get(RTL433_FIELD_POWER_W));
 		havePower = true;
 	}
 
-	std::string model = data["model"];
+	std::string model = frame.Get(RTL433_FIELD_MODEL);
 
-	bool hasstate = FindField(data, "state") || FindField(data, "command");
+	bool hasstate = frame.Have(RTL433_FIELD_STATE) || frame.Have(RTL433_FIELD_COMMAND);
 
 	if (hasstate)
 	{
 		bool state = false;
-		if (FindField(data, "state"))
-			state = data["state"] == "ON";
-		else if (FindField(data, "command"))
-			state = data["command"] == "On";
+		if (frame.Have(RTL433_FIELD_STATE))
+			state = strcmp(frame.Get(RTL433_FIELD_STATE), "ON") == 0;
+		else if (frame.Have(RTL433_FIELD_COMMAND))
+			state = strcmp(frame.Get(RTL433_FIELD_COMMAND), "On") == 0;
 		unsigned int switchidx = (id & 0xfffffff) | ((channel & 0xf) << 28);
 		SendSwitch(switchidx,
 			(const uint8_t)unit,
@@ -433,11 +691,11 @@ void CRtl433::Do_Work()
 	while (!IsStopRequested(0))
 	{
 		char line[2048];
-		std::vector<std::string> headers;
+		std::vector<_eField> fields;
 		std::string headerLine = "";
 		m_sLastLine = "";
 
-		std::string szFlags = "-F csv " + m_cmdline; // -f 433.92e6 -f 868.24e6 -H 60 -d 0
+		std::string szFlags = ((m_OutputFormat == RTL433_FORMAT_JSON) ? "-F json " : "-F csv ") + m_cmdline; // -f 433.92e6 -f 868.24e6 -H 60 -d 0
 #ifdef WIN32
 		std::string szCommand = "C:\\rtl_433.exe " + szFlags;
 		m_hPipe = _popen(szCommand.c_str(), "r");
@@ -483,14 +741,26 @@ void CRtl433::Do_Work()
 			{
 				bHaveReceivedData = true;
 
+				if (m_OutputFormat == RTL433_FORMAT_JSON)
+				{
+					if (!ParseJSONLine(line))
+					{
+						// this is also logged when parsed data is invalid
+						_log.Log(LOG_STATUS, "Rtl433: Unhandled sensor reading, please report: (%s)", line);
+					}
+					continue;
+				}
 				if (bFirstTime)
 				{
 					bFirstTime = false;
 					headerLine = line;
-					headers = ParseCSVLine(line);
+					std::vector<std::string> headers = ParseCSVLine(line);
+					fields.clear();
+					for (const auto & itt : headers)
+						fields.push_back(FindField(itt.c_str(), itt.size()));
 					continue;
 				}
-				if (!ParseLine(headers, line))
+				if (!ParseLine(fields, line))
 				{
 					// this is also logged when parsed data is invalid
 					_log.Log(LOG_STATUS, "Rtl433: Unhandled sensor reading, please report: (%s|%s)", headerLine.c_str(), line);
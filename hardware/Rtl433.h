@@ -5,21 +5,82 @@
 class CRtl433 : public CDomoticzHardwareBase
 {
 public:
-	explicit CRtl433(const int ID, const std::string &cmdline);
+	explicit CRtl433(const int ID, const std::string &cmdline, const int OutputFormat, const std::string &AllowedSensors);
 	virtual ~CRtl433();
 	bool WriteToHardware(const char *pdata, const unsigned char length) override;
 private:
+	enum _eOutputFormat
+	{
+		RTL433_FORMAT_CSV = 0,
+		RTL433_FORMAT_JSON
+	};
+	//Fields of a rtl_433 message we know how to handle
+	enum _eField
+	{
+		RTL433_FIELD_NONE = -1,
+		RTL433_FIELD_MODEL = 0,
+		RTL433_FIELD_ID,
+		RTL433_FIELD_RC,
+		RTL433_FIELD_UNIT,
+		RTL433_FIELD_CHANNEL,
+		RTL433_FIELD_BATTERY,
+		RTL433_FIELD_BATTERY_OK,
+		RTL433_FIELD_TEMPERATURE_C,
+		RTL433_FIELD_TEMPERATURE_F,
+		RTL433_FIELD_HUMIDITY,
+		RTL433_FIELD_PRESSURE_HPA,
+		RTL433_FIELD_RAIN,
+		RTL433_FIELD_RAINFALL_MM,
+		RTL433_FIELD_RAIN_TOTAL,
+		RTL433_FIELD_DEPTH_CM,
+		RTL433_FIELD_DEPTH,
+		RTL433_FIELD_WINDSTRENGTH,
+		RTL433_FIELD_WIND_SPEED,
+		RTL433_FIELD_AVERAGE,
+		RTL433_FIELD_WINDDIRECTION,
+		RTL433_FIELD_WIND_DIRECTION,
+		RTL433_FIELD_DIRECTION,
+		RTL433_FIELD_WIND_GUST,
+		RTL433_FIELD_GUST,
+		RTL433_FIELD_MOISTURE,
+		RTL433_FIELD_POWER_W,
+		RTL433_FIELD_STATE,
+		RTL433_FIELD_COMMAND,
+		RTL433_FIELD_MAX
+	};
+	//One received message, values are kept as text and only converted when used
+	struct _tFrame
+	{
+		char values[RTL433_FIELD_MAX][64];
+
+		void Clear();
+		void Set(const _eField field, const char *pValue, const size_t length);
+		bool Have(const _eField field) const { return values[field][0] != 0; };
+		const char *Get(const _eField field) const { return values[field]; };
+	};
+	struct _tAllowedSensor
+	{
+		std::string model;
+		std::string id;		//empty when all id's of the model are allowed
+	};
+
 	bool StartHardware() override;
 	bool StopHardware() override;
 	void Do_Work();
 	static std::vector<std::string> ParseCSVLine(const char *input);
-	bool ParseLine(const std::vector<std::string> &headers, const char *line);
-	bool FindField(const std::map<std::string, std::string> &data, const std::string &field);
+	static _eField FindField(const char *key, const size_t length);
+	bool ParseLine(const std::vector<_eField> &fields, const char *line);
+	bool ParseJSONLine(const char *line);
+	void SetAllowedSensors(const std::string &AllowedSensors);
+	bool IsAllowed(const _tFrame &frame) const;
+	bool ProcessFrame(const _tFrame &frame);
 private:
 	std::shared_ptr<std::thread> m_thread;
 	std::mutex m_pipe_mutex;
 	FILE *m_hPipe;
 	std::string m_cmdline;
+	_eOutputFormat m_OutputFormat;
+	std::vector<_tAllowedSensor> m_AllowedSensors;	//sorted on model, empty when all sensors are allowed
 	std::string m_sLastLine;
 	time_t m_time_last_received;
 };
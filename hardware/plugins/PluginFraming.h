@@ -0,0 +1,119 @@
+#pragma once
+
+#include <ctype.h>
+#include <stddef.h>
+#include <vector>
+
+#ifndef byte
+typedef unsigned char byte;
+#endif
+
+namespace Plugins {
+
+	//
+	//	Splitting of the retained stream data into messages for the Line and JSON protocols.
+	//	Scan() only looks at the data from iScanPos on (and moves it to the end), calls onFrame(iStart, iEnd)
+	//	for every complete message and returns the length of the data that is not needed anymore.
+	//	They do not depend on the plugin system, so they can also run on their own (see benchmark/)
+	//
+	class CLineFramer
+	{
+	private:
+		bool			m_bSkipLF;		// last line ended with '\r' at the end of a read, skip a '\n' starting the next one
+	public:
+		CLineFramer() : m_bSkipLF(false) {};
+
+		template <typename F>
+		size_t Scan(const std::vector<byte>& vData, size_t& iScanPos, F onFrame)
+		{
+			size_t	iStart = 0;
+			if (m_bSkipLF && !vData.empty())
+			{
+				if (vData[0] == '\n') iStart = 1;		//  Handle \r\n split over two reads
+				m_bSkipLF = false;
+			}
+			if (iScanPos < iStart) iScanPos = iStart;
+
+			size_t	iSize = vData.size();
+			for (size_t iPos = iScanPos; iPos < iSize; iPos++)
+			{
+				if (vData[iPos] != '\r')		//  Look for message terminator
+					continue;
+
+				onFrame(iStart, iPos);
+				if (iPos + 1 == iSize)
+					m_bSkipLF = true;
+				else if (vData[iPos + 1] == '\n')
+					iPos++;				//  Handle \r\n
+				iStart = iPos + 1;
+			}
+
+			// retain any residual for next time, it does not need to be scanned again
+			iScanPos = iSize;
+			return iStart;
+		}
+	};
+
+	class CJSONFramer
+	{
+	private:
+		// State of the scan up to the scan position
+		int				m_iDepth;
+		bool			m_bInString;
+		bool			m_bEscaped;
+	public:
+		CJSONFramer() : m_iDepth(0), m_bInString(false), m_bEscaped(false) {};
+
+		// nothing retained (or flushed), start a new scan
+		void Reset()
+		{
+			m_iDepth = 0;
+			m_bInString = false;
+			m_bEscaped = false;
+		}
+
+		//	Messages end when the outer '}' is found, braces inside strings are ignored
+		template <typename F>
+		size_t Scan(const std::vector<byte>& vData, size_t& iScanPos, F onFrame)
+		{
+			size_t	iStart = 0;
+			size_t	iSize = vData.size();
+			for (size_t iPos = iScanPos; iPos < iSize; iPos++)
+			{
+				byte	c = vData[iPos];
+				if (m_bInString)
+				{
+					if (m_bEscaped)
+						m_bEscaped = false;
+					else if (c == '\\')
+						m_bEscaped = true;
+					else if (c == '"')
+						m_bInString = false;
+					continue;
+				}
+				if (c == '"')
+					m_bInString = true;
+				else if (c == '{')
+					m_iDepth++;
+				else if ((c == '}') && (m_iDepth > 0) && (--m_iDepth == 0))
+				{
+					// whole message, skip separators between messages
+					while ((iStart < iPos) && isspace(vData[iStart]))
+						iStart++;
+					onFrame(iStart, iPos + 1);
+					iStart = iPos + 1;
+				}
+			}
+
+			// retain any residual for next time
+			iScanPos = iSize;
+			if (m_iDepth == 0)
+			{
+				// no message started yet, drop separators only
+				while ((iStart < iSize) && isspace(vData[iStart]))
+					iStart++;
+			}
+			return iStart;
+		}
+	};
+}
@@ -36,6 +36,9 @@
 
 #define MINIMUM_PYTHON_VERSION "3.4.0"
 
+// Callbacks running longer than this (seconds) are reported, they delay the other messages of their plugin
+#define PLUGIN_CALLBACK_BUDGET 10
+
 #define ATTRIBUTE_VALUE(pElement, Name, Value) \
 		{	\
 			Value = ""; \
@@ -66,8 +69,7 @@ namespace Plugins {
     // PyMODINIT_FUNC PyInit_DomoticzEvents(void);
 #endif // ENABLE_PYTHON
 
-	std::mutex PluginMutex;	// controls accessto the message queue and m_pPlugins map
-	std::queue<CPluginMessageBase*>	PluginMessageQueue;
+	std::mutex PluginMutex;	// controls access to the m_pPlugins map
 	boost::asio::io_service ios;
 
 	std::map<int, CDomoticzHardwareBase*>	CPluginSystem::m_pPlugins;
@@ -87,13 +89,7 @@ namespace Plugins {
 
 	bool CPluginSystem::StartPluginSystem()
 	{
-		// Flush the message queue (should already be empty)
 		std::lock_guard<std::mutex> l(PluginMutex);
-		while (!PluginMessageQueue.empty())
-		{
-			PluginMessageQueue.pop();
-		}
-
 		m_pPlugins.clear();
 
 		if (!Py_LoadLibrary())
@@ -171,19 +167,8 @@ namespace Plugins {
 			m_thread.reset();
 		}
 
-		// Hardware should already be stopped so just flush the queue (should already be empty)
+		// Hardware should already be stopped, the plugins flush their own message queues
 		std::lock_guard<std::mutex> l(PluginMutex);
-		while (!PluginMessageQueue.empty())
-		{
-			CPluginMessageBase* Message = PluginMessageQueue.front();
-			const CPlugin* pPlugin = Message->Plugin();
-			if (pPlugin)
-			{
-				_log.Log(LOG_NORM, "(" + pPlugin->m_Name + ") ' flushing " + std::string(Message->Name()) + "' queue entry");
-			}
-			PluginMessageQueue.pop();
-		}
-
 		m_pPlugins.clear();
 
 		if (Py_LoadLibrary() && m_InitialPythonThread)
@@ -331,58 +316,16 @@ namespace Plugins {
 			SetThreadName(bt->native_handle(), "Plugin_ASIO");
 		}
 
-		while (!IsStopRequested(50))
+		// Messages are processed by the plugins themselves, only watch for callbacks that take too long
+		while (!IsStopRequested(1000))
 		{
-			time_t	Now = time(0);
-			bool	bProcessed = true;
-			while (bProcessed)
+			std::lock_guard<std::mutex> l(PluginMutex);
+			for (const auto & itt : m_pPlugins)
 			{
-				CPluginMessageBase* Message = NULL;
-				bProcessed = false;
-
-				// Cycle once through the queue looking for the 1st message that is ready to process
+				if (itt.second)
 				{
-					std::lock_guard<std::mutex> l(PluginMutex);
-					for (size_t i = 0; i < PluginMessageQueue.size(); i++)
-					{
-						CPluginMessageBase* FrontMessage = PluginMessageQueue.front();
-						PluginMessageQueue.pop();
-						if (!FrontMessage->m_Delay || FrontMessage->m_When <= Now)
-						{
-							// Message is ready now or was already ready (this is the case for almost all messages)
-							Message = FrontMessage;
-							break;
-						}
-						// Message is for sometime in the future so requeue it (this happens when the 'Delay' parameter is used on a Send)
-						PluginMessageQueue.push(FrontMessage);
-					}
-				}
-
-				if (Message)
-				{
-					bProcessed = true;
-					try
-					{
-						const CPlugin* pPlugin = Message->Plugin();
-						if (pPlugin && (pPlugin->m_bDebug & PDM_QUEUE))
-						{
-							_log.Log(LOG_NORM, "(" + pPlugin->m_Name + ") Processing '" + std::string(Message->Name()) + "' message");
-						}
-						Message->Process();
-					}
-					catch(...)
-					{
-						_log.Log(LOG_ERROR, "PluginSystem: Exception processing message.");
-					}
-				}
-				// Free the memory for the message
-				if (Message)
-				{
-					std::lock_guard<std::mutex> l(PythonMutex); // Take mutex to guard access to CPluginTransport::m_pConnection inside the message
-					CPlugin* pPlugin = (CPlugin*)Message->Plugin();
-					pPlugin->RestoreThread();
-					delete Message;
-					pPlugin->ReleaseThread();
+					CPlugin*	pPlugin = reinterpret_cast<CPlugin*>(itt.second);
+					pPlugin->CheckCallbackBudget(PLUGIN_CALLBACK_BUDGET);
 				}
 			}
 		}
@@ -559,6 +502,45 @@ namespace http {
 			return sRetVal;
 		}
 
+		void CWebServer::Cmd_GetPluginStats(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetPluginStats";
+
+			bool bReset = (request::findValue(&req, "reset") == "1");
+			std::lock_guard<std::mutex> l(Plugins::PluginMutex);
+			Plugins::CPluginSystem Plugins;
+			std::map<int, CDomoticzHardwareBase*>*	PluginHwd = Plugins.GetHardware();
+			int ii = 0;
+			for (const auto & itt : *PluginHwd)
+			{
+				Plugins::CPlugin*	pPlugin = (Plugins::CPlugin*)itt.second;
+				if (!pPlugin)
+					continue;
+				Plugins::CPlugin::_tMessageStats stats;
+				pPlugin->GetMessageStats(stats);
+				root["result"][ii]["idx"] = itt.first;
+				root["result"][ii]["name"] = pPlugin->m_Name;
+				root["result"][ii]["queue_size"] = (Json::UInt64)stats.QueueSize;
+				root["result"][ii]["queue_peak"] = (Json::UInt64)stats.PeakQueueSize;
+				root["result"][ii]["processed"] = (Json::UInt64)stats.Processed;
+				root["result"][ii]["avg_ms"] = (Json::UInt64)stats.AvgProcessMs;
+				root["result"][ii]["max_ms"] = (Json::UInt64)stats.MaxProcessMs;
+				root["result"][ii]["max_message"] = stats.MaxProcessMessage;
+				root["result"][ii]["budget_exceeded"] = (Json::UInt64)stats.BudgetExceeded;
+				root["result"][ii]["current_message"] = stats.CurrentMessage;
+				root["result"][ii]["current_ms"] = (Json::UInt64)stats.CurrentRunningMs;
+				if (bReset)
+					pPlugin->ResetMessageStats();
+				ii++;
+			}
+		}
+
 		void CWebServer::Cmd_PluginCommand(WebEmSession & session, const request& req, Json::Value &root)
 		{
 			std::string sIdx = request::findValue(&req, "idx");
@@ -38,6 +38,7 @@ namespace Plugins {
 		void	 DeregisterPlugin(const int HwdID);
 		bool	StopPluginSystem();
 		void	AllPluginsStarted() { m_bAllPluginsStarted = true; };
+		bool	IsAllPluginsStarted() { return m_bAllPluginsStarted; };
 		static void LoadSettings();
 		void	DeviceModified(uint64_t ID);
 		void*	PythonThread() { return m_InitialPythonThread; };
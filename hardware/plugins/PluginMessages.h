@@ -9,8 +9,6 @@ typedef unsigned char byte;
 
 namespace Plugins {
 
-	extern std::mutex PythonMutex;			// controls access to Python
-
 	class CPluginMessageBase
 	{
 	public:
@@ -35,7 +33,7 @@ namespace Plugins {
 		virtual const CPlugin*	Plugin() { return m_pPlugin; };
 		virtual void Process()
 		{
-			std::lock_guard<std::mutex> l(PythonMutex);
+			// Only the plugin's GIL, Python gives it up while the plugin blocks (sleep, I/O) so other plugins keep running
 			m_pPlugin->RestoreThread();
 			ProcessLocked();
 			m_pPlugin->ReleaseThread();
@@ -280,6 +278,11 @@ static std::string get_utf8_from_ansi(const std::string &utf8, int codepage)
 			m_Name = __func__;
 			m_Buffer = Buffer;
 		};
+		onMessageCallback(CPlugin* pPlugin, PyObject* Connection, const byte* pData, const size_t Length) : CCallbackBase(pPlugin, "onMessage"), CHasConnection(Connection), m_Data(NULL)
+		{
+			m_Name = __func__;
+			m_Buffer.assign(pData, pData + Length);
+		};
 		onMessageCallback(CPlugin* pPlugin, PyObject* Connection, PyObject*	pData) : CCallbackBase(pPlugin, "onMessage"), CHasConnection(Connection)
 		{
 			m_Name = __func__;
@@ -352,15 +355,22 @@ static std::string get_utf8_from_ansi(const std::string &utf8, int codepage)
 	{
 	public:
 		onStopCallback(CPlugin* pPlugin) : CCallbackBase(pPlugin, "onStop") { m_Name = __func__; };
+		virtual void Process()
+		{
+			CCallbackBase::Process();
+			// Ending the interpreter also removes the transport thread state
+			std::lock_guard<std::mutex> l(PythonMutex);
+			m_pPlugin->RestoreThread();
+			m_pPlugin->Stop();
+		};
 	protected:
 		virtual void ProcessLocked()
 		{
 			Callback(NULL);
-			m_pPlugin->Stop();
 		};
 	};
 
-	// Base directive message class
+	// Base directive message class, directives work on the transports so they also take PythonMutex
 	class CDirectiveBase : public CPluginMessageBase
 	{
 	protected:
@@ -451,13 +461,19 @@ static std::string get_utf8_from_ansi(const std::string &utf8, int codepage)
 		virtual void ProcessLocked() { m_pPlugin->Notifier(m_NotifierName); };
 	};
 
-	// Base event message class
+	// Base event message class, events work on the transports so they also take PythonMutex
 	class CEventBase : public CPluginMessageBase
 	{
 	protected:
 		virtual void ProcessLocked() = 0;
 	public:
 		CEventBase(CPlugin* pPlugin) : CPluginMessageBase(pPlugin) {};
+		virtual void Process() {
+			std::lock_guard<std::mutex> l(PythonMutex);
+			m_pPlugin->RestoreThread();
+			ProcessLocked();
+			m_pPlugin->ReleaseThread();
+		};
 	};
 
 	class ReadEvent : public CEventBase, public CHasConnection
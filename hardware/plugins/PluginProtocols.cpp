@@ -87,6 +87,29 @@ namespace Plugins {
 			pPlugin->MessagePlugin(new onMessageCallback(pPlugin, pConnection, m_sRetainedData));
 			m_sRetainedData.clear();
 		}
+		m_iScanPos = 0;
+	}
+
+	void CPluginProtocol::AppendInbound(const ReadEvent* Message)
+	{
+		m_sRetainedData.insert(m_sRetainedData.end(), Message->m_Buffer.begin(), Message->m_Buffer.end());
+	}
+
+	void CPluginProtocol::DeliverFrame(const ReadEvent* Message, const size_t iStart, const size_t iEnd)
+	{
+		// Copied once, straight from the retained data into the message
+		const byte*	pData = m_sRetainedData.empty() ? NULL : &m_sRetainedData[0];
+		Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, pData + iStart, iEnd - iStart));
+	}
+
+	void CPluginProtocol::ConsumeRetained(const size_t iLength)
+	{
+		// Drop the processed frames in one go, only the partial frame (if any) is moved
+		if (iLength >= m_sRetainedData.size())
+			m_sRetainedData.clear();
+		else if (iLength)
+			m_sRetainedData.erase(m_sRetainedData.begin(), m_sRetainedData.begin() + iLength);
+		m_iScanPos = (m_iScanPos > iLength) ? m_iScanPos - iLength : 0;
 	}
 
 	void CPluginProtocolLine::ProcessInbound(const ReadEvent* Message)
@@ -94,21 +117,8 @@ namespace Plugins {
 		//
 		//	Handles the cases where a read contains a partial message or multiple messages
 		//
-		std::vector<byte>	vData = m_sRetainedData;										// if there was some data left over from last time add it back in
-		vData.insert(vData.end(), Message->m_Buffer.begin(), Message->m_Buffer.end());		// add the new data
-
-		std::string		sData(vData.begin(), vData.end());
-		int iPos = sData.find_first_of('\r');		//  Look for message terminator
-		while (iPos != std::string::npos)
-		{
-			Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, std::vector<byte>(&sData[0], &sData[iPos])));
-
-			if (sData[iPos + 1] == '\n') iPos++;				//  Handle \r\n
-			sData = sData.substr(iPos + 1);
-			iPos = sData.find_first_of('\r');
-		}
-
-		m_sRetainedData.assign(sData.c_str(), sData.c_str() + sData.length()); // retain any residual for next time
+		AppendInbound(Message);
+		ConsumeRetained(m_Framer.Scan(m_sRetainedData, m_iScanPos, [&](const size_t iStart, const size_t iEnd) { DeliverFrame(Message, iStart, iEnd); }));
 	}
 
 	static void AddBytesToDict(PyObject* pDict, const char* key, const std::string& value)
@@ -309,57 +319,33 @@ namespace Plugins {
 		return sJson;
 	}
 
+	void CPluginProtocolJSON::DeliverJSON(const ReadEvent* Message, const size_t iStart, const size_t iEnd)
+	{
+		Json::Value		root;
+		std::string		sMessage((const char*)&m_sRetainedData[iStart], iEnd - iStart);
+		bool bRet = ParseJSon(sMessage, root);
+		if ((!bRet) || (!root.isObject()))
+		{
+			_log.Log(LOG_ERROR, "JSON Protocol: Parse Error on '%s'", sMessage.c_str());
+			Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, sMessage));
+		}
+		else
+		{
+			PyObject* pMessage = JSONtoPython(&root);
+			Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, pMessage));
+		}
+	}
+
 	void CPluginProtocolJSON::ProcessInbound(const ReadEvent* Message)
 	{
 		//
 		//	Handles the cases where a read contains a partial message or multiple messages
+		//	Only the new data is scanned, the state of the scan of the partial message is kept between reads
 		//
-		std::vector<byte>	vData = m_sRetainedData;										// if there was some data left over from last time add it back in
-		vData.insert(vData.end(), Message->m_Buffer.begin(), Message->m_Buffer.end());		// add the new data
-
-		std::string		sData(vData.begin(), vData.end());
-		int iPos = 1;
-		while (iPos) {
-			Json::Value		root;
-			iPos = sData.find("}{", 0) + 1;		//  Look for message separater in case there is more than one
-			if (!iPos) // no, just one or part of one
-			{
-				if ((sData.substr(sData.length() - 1, 1) == "}") &&
-					(std::count(sData.begin(), sData.end(), '{') == std::count(sData.begin(), sData.end(), '}'))) // whole message so queue the whole buffer
-				{
-					bool bRet = ParseJSon(sData, root);
-					if ((!bRet) || (!root.isObject()))
-					{
-						_log.Log(LOG_ERROR, "JSON Protocol: Parse Error on '%s'", sData.c_str());
-						Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, sData));
-					}
-					else
-					{
-						PyObject* pMessage = JSONtoPython(&root);
-						Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, pMessage));
-					}
-					sData.clear();
-				}
-			}
-			else  // more than one message so queue the first one
-			{
-				std::string sMessage = sData.substr(0, iPos);
-				sData = sData.substr(iPos);
-				bool bRet = ParseJSon(sMessage, root);
-				if ((!bRet) || (!root.isObject()))
-				{
-					_log.Log(LOG_ERROR, "JSON Protocol: Parse Error on '%s'", sData.c_str());
-					Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, sMessage));
-				}
-				else
-				{
-					PyObject* pMessage = JSONtoPython(&root);
-					Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, pMessage));
-				}
-			}
-		}
-
-		m_sRetainedData.assign(sData.c_str(), sData.c_str() + sData.length()); // retain any residual for next time
+		if (!m_iScanPos)
+			m_Framer.Reset();
+		AppendInbound(Message);
+		ConsumeRetained(m_Framer.Scan(m_sRetainedData, m_iScanPos, [&](const size_t iStart, const size_t iEnd) { DeliverJSON(Message, iStart, iEnd); }));
 	}
 
 	void CPluginProtocolXML::ProcessInbound(const ReadEvent* Message)
@@ -368,66 +354,68 @@ namespace Plugins {
 		//	Only returns whole XML messages. Does not handle <tag /> as the top level tag
 		//	Handles the cases where a read contains a partial message or multiple messages
 		//
-		std::vector<byte>	vData = m_sRetainedData;										// if there was some data left over from last time add it back in
-		vData.insert(vData.end(), Message->m_Buffer.begin(), Message->m_Buffer.end());		// add the new data
+		AppendInbound(Message);
 
-		std::string		sData(vData.begin(), vData.end());
-		try
+		const byte*	pBegin = m_sRetainedData.empty() ? NULL : &m_sRetainedData[0];
+		const byte*	pEnd = pBegin + m_sRetainedData.size();
+		const byte*	pStart = pBegin;
+		while (pStart < pEnd)
 		{
-			while (true)
+			//
+			//	Find the top level tag name if it is not set
+			//
+			if (!m_Tag.length())
 			{
-				//
-				//	Find the top level tag name if it is not set
-				//
-				if (!m_Tag.length())
+				const byte*	pTag = std::find(pStart, pEnd, '<');
+				if (pTag == pEnd)
 				{
-					if (sData.find("<?xml") != std::string::npos)	// step over '<?xml version="1.0" encoding="utf-8"?>' if present
-					{
-						int iEnd = sData.find("?>");
-						sData = sData.substr(iEnd + 2);
-					}
-
-					int iStart = sData.find_first_of('<');
-					if (iStart == std::string::npos)
-					{
-						// start of a tag not found so discard
-						m_sRetainedData.clear();
-						break;
-					}
-					if (iStart) sData = sData.substr(iStart);		// remove any leading data
-					int iEnd = sData.find_first_of(" >");
-					if (iEnd != std::string::npos)
-					{
-						m_Tag = sData.substr(1, (iEnd - 1));
-					}
+					// start of a tag not found so discard
+					pStart = pEnd;
+					break;
 				}
+				pStart = pTag;		// remove any leading data
+				static const std::string sDecl = "<?xml";
+				if ((size_t)(pEnd - pStart) < sDecl.length())
+					break;			// wait for more data
+				if (std::equal(sDecl.begin(), sDecl.end(), pStart))	// step over '<?xml version="1.0" encoding="utf-8"?>' if present
+				{
+					static const std::string sDeclEnd = "?>";
+					const byte*	pDeclEnd = std::search(pStart, pEnd, sDeclEnd.begin(), sDeclEnd.end());
+					if (pDeclEnd == pEnd)
+						break;		// wait for the rest of the declaration
+					pStart = pDeclEnd + 2;
+					continue;
+				}
+				const byte*	pTagEnd = pStart + 1;
+				while ((pTagEnd < pEnd) && (*pTagEnd != ' ') && (*pTagEnd != '>'))
+					pTagEnd++;
+				if (pTagEnd == pEnd)
+					break;			// wait for the rest of the tag
+				m_Tag.assign((const char*)pStart + 1, pTagEnd - pStart - 1);
+				m_iScanPos = pStart - pBegin;
+			}
 
-				int	iPos = sData.find("</" + m_Tag + ">");
-				if (iPos != std::string::npos)
-				{
-					int iEnd = iPos + m_Tag.length() + 3;
-					Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, sData.substr(0, iEnd)));
+			// Only search the data that has not been searched before for the closing tag
+			std::string	sClose = "</" + m_Tag + ">";
+			const byte*	pSearch = pBegin + m_iScanPos;
+			if (pSearch - pStart >= (ptrdiff_t)sClose.length())
+				pSearch -= sClose.length() - 1;
+			else
+				pSearch = pStart;
+			const byte*	pClose = std::search(pSearch, pEnd, sClose.begin(), sClose.end());
+			if (pClose == pEnd)
+				break;
 
-					if (iEnd == sData.length())
-					{
-						sData.clear();
-					}
-					else
-					{
-						sData = sData.substr(++iEnd);
-					}
-					m_Tag = "";
-				}
-				else
-					break;
-			}
-		}
-		catch (std::exception const& exc)
-		{
-			_log.Log(LOG_ERROR, "(CPluginProtocolXML::ProcessInbound) Unexpected exception thrown '%s', Data '%s'.", exc.what(), sData.c_str());
+			const byte*	pFrameEnd = pClose + sClose.length();
+			DeliverFrame(Message, pStart - pBegin, pFrameEnd - pBegin);
+			pStart = (pFrameEnd < pEnd) ? pFrameEnd + 1 : pEnd;		// skip the character that follows the message
+			m_iScanPos = pStart - pBegin;
+			m_Tag = "";
 		}
 
-		m_sRetainedData.assign(sData.c_str(), sData.c_str() + sData.length()); // retain any residual for next time
+		// retain any residual for next time
+		m_iScanPos = m_sRetainedData.size();
+		ConsumeRetained(pStart - pBegin);
 	}
 
 	void CPluginProtocolHTTP::ExtractHeaders(std::string* pData)
@@ -506,7 +494,12 @@ namespace Plugins {
 		if (Message->m_Buffer.size())
 		{
 			m_sRetainedData.insert(m_sRetainedData.end(), Message->m_Buffer.begin(), Message->m_Buffer.end());
+
+			// Body is still incomplete
+			if (m_ExpectedLength && (m_sRetainedData.size() < m_ExpectedLength))
+				return;
 		}
+		m_ExpectedLength = 0;
 
 		// HTML is non binary so use strings
 		std::string		sData(m_sRetainedData.begin(), m_sRetainedData.end());
@@ -591,6 +584,10 @@ namespace Plugins {
 						Message->m_pPlugin->MessagePlugin(new onMessageCallback(Message->m_pPlugin, Message->m_pConnection, pDataDict));
 						m_sRetainedData.clear();
 					}
+					else if ((m_ContentLength > 0) && ((size_t)m_ContentLength > sData.length()))
+					{
+						m_ExpectedLength = m_sRetainedData.size() - sData.length() + m_ContentLength;
+					}
 				}
 				else
 				{
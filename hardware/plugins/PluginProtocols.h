@@ -1,5 +1,7 @@
 #pragma once
 
+#include "PluginFraming.h"
+
 namespace Plugins {
 
 	class CPluginMessage;
@@ -8,10 +10,16 @@ namespace Plugins {
 	{
 	protected:
 		std::vector<byte>	m_sRetainedData;
+		size_t				m_iScanPos;			// framing protocols: data before this position has been scanned for the end of the frame
 		bool				m_Secure;
 
+		// Helpers for protocols that split the stream into frames, avoid copying retained data on every read
+		void				AppendInbound(const ReadEvent* Message);
+		void				DeliverFrame(const ReadEvent* Message, const size_t iStart, const size_t iEnd);
+		void				ConsumeRetained(const size_t iLength);
+
 	public:
-		CPluginProtocol() : m_Secure(false) {};
+		CPluginProtocol() : m_iScanPos(0), m_Secure(false) {};
 		virtual void				ProcessInbound(const ReadEvent* Message);
 		virtual std::vector<byte>	ProcessOutbound(const WriteDirective* WriteMessage);
 		virtual void				Flush(CPlugin* pPlugin, PyObject* pConnection);
@@ -23,6 +31,9 @@ namespace Plugins {
 
 	class CPluginProtocolLine : CPluginProtocol
 	{
+	private:
+		CLineFramer		m_Framer;
+	public:
 		virtual void	ProcessInbound(const ReadEvent* Message);
 	};
 
@@ -36,6 +47,9 @@ namespace Plugins {
 
 	class CPluginProtocolJSON : CPluginProtocol
 	{
+	private:
+		CJSONFramer		m_Framer;
+		void			DeliverJSON(const ReadEvent* Message, const size_t iStart, const size_t iEnd);
 	protected:
 		PyObject* JSONtoPython(Json::Value* pJSON);
 	public:
@@ -52,11 +66,12 @@ namespace Plugins {
 		void*			m_Headers;
 		bool			m_Chunked;
 		size_t			m_RemainingChunk;
+		size_t			m_ExpectedLength;		// size of the complete response once known, avoids parsing it again for every read
 	protected:
 		void			ExtractHeaders(std::string*	pData);
 		void			Flush(CPlugin* pPlugin, PyObject* pConnection);
 	public:
-		CPluginProtocolHTTP(bool Secure) : m_ContentLength(0), m_Headers(NULL), m_Chunked(false), m_RemainingChunk(0) { m_Secure = Secure; };
+		CPluginProtocolHTTP(bool Secure) : m_ContentLength(0), m_Headers(NULL), m_Chunked(false), m_RemainingChunk(0), m_ExpectedLength(0) { m_Secure = Secure; };
 		virtual void				ProcessInbound(const ReadEvent* Message);
 		virtual std::vector<byte>	ProcessOutbound(const WriteDirective* WriteMessage);
 	};
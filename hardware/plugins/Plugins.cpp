@@ -43,10 +43,7 @@ extern MainWorker m_mainworker;
 
 namespace Plugins {
 
-	extern std::mutex PluginMutex;	// controls access to the message queue
-	extern std::queue<CPluginMessageBase*>	PluginMessageQueue;
-
-	std::mutex PythonMutex;			// controls access to Python
+	std::mutex PythonMutex;			// controls access to the transports and connection objects, see AccessPython
 
 	//
 	//	Holds per plugin state details, specifically plugin object, read using PyModule_GetState(PyObject *module)
@@ -549,6 +546,35 @@ namespace Plugins {
 		return pConfig;
 	}
 
+	static PyObject*	PyDomoticz_UpdateDevices(PyObject *self, PyObject *args)
+	{
+		module_state*	pModState = ((struct module_state*)PyModule_GetState(self));
+		if (!pModState)
+		{
+			_log.Log(LOG_ERROR, "CPlugin:%s, unable to obtain module state.", __func__);
+		}
+		else if (!pModState->pPlugin)
+		{
+			_log.Log(LOG_ERROR, "CPlugin:%s, illegal operation, Plugin has not started yet.", __func__);
+		}
+		else
+		{
+			PyObject*	pUpdates;
+			if (!PyArg_ParseTuple(args, "O", &pUpdates))
+			{
+				_log.Log(LOG_ERROR, "(%s) failed to parse parameters, list of updates expected.", pModState->pPlugin->m_Name.c_str());
+				LogPythonException(pModState->pPlugin, std::string(__func__));
+			}
+			else
+			{
+				return CDevice_updatemany(pModState->pPlugin, pUpdates);
+			}
+		}
+
+		Py_INCREF(Py_None);
+		return Py_None;
+	}
+
 	static PyMethodDef DomoticzMethods[] = {
 		{ "Debug", PyDomoticz_Debug, METH_VARARGS, "Write a message to Domoticz log only if verbose logging is turned on." },
 		{ "Log", PyDomoticz_Log, METH_VARARGS, "Write a message to Domoticz log." },
@@ -559,6 +585,7 @@ namespace Plugins {
 		{ "Notifier", PyDomoticz_Notifier, METH_VARARGS, "Enable notification handling with supplied name." },
 		{ "Trace", PyDomoticz_Trace, METH_VARARGS, "Enable/Disable line level Python tracing." },
 		{ "Configuration", (PyCFunction)PyDomoticz_Configuration, METH_VARARGS | METH_KEYWORDS, "Retrieve and Store structured plugin configuration." },
+		{ "UpdateDevices", PyDomoticz_UpdateDevices, METH_VARARGS, "Update the values of multiple devices in a single database transaction." },
 		{ NULL, NULL, 0, NULL }
 	};
 
@@ -625,20 +652,26 @@ namespace Plugins {
 		m_Notifier(NULL),
 		m_bDebug(PDM_NONE),
 		m_PyInterpreter(NULL),
+		m_PyTransportThread(NULL),
 		m_PyModule(NULL),
 		m_DeviceDict(NULL),
 		m_ImageDict(NULL),
-		m_SettingsDict(NULL)
+		m_SettingsDict(NULL),
+		m_bStopMessages(false)
 	{
 		m_HwdID = HwdID;
 		m_Name = sName;
 		m_bIsStarted = false;
 		m_bIsStarting = false;
 		m_bTracing = false;
+		m_CurrentStart = std::chrono::steady_clock::now();
+		m_bCurrentReported = false;
+		ResetMessageStats();
 	}
 
 	CPlugin::~CPlugin(void)
 	{
+		StopMessageThread();
 		m_bIsStarted = false;
 	}
 
@@ -883,6 +916,7 @@ namespace Plugins {
 		if (m_bIsStarted) StopHardware();
 
 		RequestStart();
+		StartMessageThread();
 
 		//	Add start command to message queue
 		m_bIsStarting = true;
@@ -895,31 +929,161 @@ namespace Plugins {
 
 	void CPlugin::ClearMessageQueue()
 	{
-		// Copy the event queue to a temporary one, then copy back the events for other plugins
-		std::lock_guard<std::mutex> l(PluginMutex);
-		std::queue<CPluginMessageBase*>	TempMessageQueue(PluginMessageQueue);
-		while (!PluginMessageQueue.empty())
-			PluginMessageQueue.pop();
+		std::lock_guard<std::mutex> l(m_QueueMutex);
+		while (!m_MessageQueue.empty())
+		{
+			CPluginMessageBase* FrontMessage = m_MessageQueue.front();
+			m_MessageQueue.pop_front();
+			// log events that will not be processed
+			CCallbackBase* pCallback = dynamic_cast<CCallbackBase*>(FrontMessage);
+			if (pCallback)
+				_log.Log(LOG_ERROR, "(%s) Callback event '%s' (Python call '%s') discarded.", m_Name.c_str(), FrontMessage->Name(), pCallback->PythonName());
+			else
+				_log.Log(LOG_ERROR, "(%s) Non-callback event '%s' discarded.", m_Name.c_str(), FrontMessage->Name());
+		}
+	}
+
+	void CPlugin::StartMessageThread()
+	{
+		if (m_MessageThread)
+			return;
+		m_bStopMessages = false;
+		m_MessageThread = std::make_shared<std::thread>(&CPlugin::Do_Messages, this);
+		std::string sThreadName = "Plugin_" + std::to_string(m_HwdID);
+		SetThreadName(m_MessageThread->native_handle(), sThreadName.c_str());
+	}
 
-		while (!TempMessageQueue.empty())
+	void CPlugin::StopMessageThread()
+	{
+		if (!m_MessageThread)
+			return;
+		{
+			std::lock_guard<std::mutex> l(m_QueueMutex);
+			m_bStopMessages = true;
+		}
+		m_QueueCondition.notify_all();
+		m_MessageThread->join();
+		m_MessageThread.reset();
+		ClearMessageQueue();
+	}
+
+	void CPlugin::Do_Messages()
+	{
+		// Plugins are only serviced when all of them have been started
+		while (!m_mainworker.m_pluginsystem.IsAllPluginsStarted())
 		{
-			CPluginMessageBase* FrontMessage = TempMessageQueue.front();
-			TempMessageQueue.pop();
-			if (FrontMessage->m_pPlugin == this)
 			{
-				// log events that will not be processed
-				CCallbackBase* pCallback = dynamic_cast<CCallbackBase*>(FrontMessage);
-				if (pCallback)
-					_log.Log(LOG_ERROR, "(%s) Callback event '%s' (Python call '%s') discarded.", m_Name.c_str(), FrontMessage->Name(), pCallback->PythonName());
-				else
-					_log.Log(LOG_ERROR, "(%s) Non-callback event '%s' discarded.", m_Name.c_str(), FrontMessage->Name());
+				std::lock_guard<std::mutex> l(m_QueueMutex);
+				if (m_bStopMessages)
+					return;
 			}
-			else
+			sleep_milliseconds(500);
+		}
+
+		while (true)
+		{
+			CPluginMessageBase* Message = NULL;
+			{
+				std::unique_lock<std::mutex> l(m_QueueMutex);
+				if (m_bStopMessages)
+					break;
+
+				// Look for the 1st message that is ready to process, messages with a 'Delay' stay queued in order
+				time_t	Now = time(0);
+				for (std::deque<CPluginMessageBase*>::iterator itt = m_MessageQueue.begin(); itt != m_MessageQueue.end(); ++itt)
+				{
+					if (!(*itt)->m_Delay || (*itt)->m_When <= Now)
+					{
+						Message = *itt;
+						m_MessageQueue.erase(itt);
+						break;
+					}
+				}
+				if (!Message)
+				{
+					m_QueueCondition.wait_for(l, std::chrono::milliseconds(50));
+					continue;
+				}
+				m_CurrentMessage = Message->Name();
+				m_CurrentStart = std::chrono::steady_clock::now();
+				m_bCurrentReported = false;
+			}
+
+			try
 			{
-				// Message is for a different plugin so requeue it
-				_log.Log(LOG_NORM, "(%s) requeuing '%s' message for '%s'", m_Name.c_str(), FrontMessage->Name(), FrontMessage->Plugin()->m_Name.c_str());
-				PluginMessageQueue.push(FrontMessage);
+				if (m_bDebug & PDM_QUEUE)
+				{
+					_log.Log(LOG_NORM, "(" + m_Name + ") Processing '" + std::string(Message->Name()) + "' message");
+				}
+				Message->Process();
+			}
+			catch (...)
+			{
+				_log.Log(LOG_ERROR, "(%s) Exception processing '%s' message.", m_Name.c_str(), Message->Name());
 			}
+
+			{
+				std::lock_guard<std::mutex> l(m_QueueMutex);
+				uint64_t iProcessMs = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_CurrentStart).count();
+				m_MessagesProcessed++;
+				m_TotalProcessMs += iProcessMs;
+				if (iProcessMs > m_MaxProcessMs)
+				{
+					m_MaxProcessMs = iProcessMs;
+					m_MaxProcessMessage = m_CurrentMessage;
+				}
+				m_CurrentMessage.clear();
+			}
+
+			// Free the memory for the message
+			{
+				std::lock_guard<std::mutex> l(PythonMutex); // Take mutex to guard access to CPluginTransport::m_pConnection inside the message
+				RestoreThread();
+				delete Message;
+				ReleaseThread();
+			}
+		}
+	}
+
+	void CPlugin::GetMessageStats(_tMessageStats &stats)
+	{
+		std::lock_guard<std::mutex> l(m_QueueMutex);
+		stats.QueueSize = m_MessageQueue.size();
+		stats.PeakQueueSize = m_PeakQueueSize;
+		stats.Processed = m_MessagesProcessed;
+		stats.AvgProcessMs = (m_MessagesProcessed > 0) ? m_TotalProcessMs / m_MessagesProcessed : 0;
+		stats.MaxProcessMs = m_MaxProcessMs;
+		stats.MaxProcessMessage = m_MaxProcessMessage;
+		stats.BudgetExceeded = m_BudgetExceeded;
+		stats.CurrentMessage = m_CurrentMessage;
+		stats.CurrentRunningMs = 0;
+		if (!m_CurrentMessage.empty())
+			stats.CurrentRunningMs = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_CurrentStart).count();
+	}
+
+	void CPlugin::ResetMessageStats()
+	{
+		std::lock_guard<std::mutex> l(m_QueueMutex);
+		m_PeakQueueSize = m_MessageQueue.size();
+		m_MessagesProcessed = 0;
+		m_TotalProcessMs = 0;
+		m_MaxProcessMs = 0;
+		m_MaxProcessMessage.clear();
+		m_BudgetExceeded = 0;
+	}
+
+	void CPlugin::CheckCallbackBudget(const int iBudgetSeconds)
+	{
+		std::lock_guard<std::mutex> l(m_QueueMutex);
+		if (m_CurrentMessage.empty() || m_bCurrentReported)
+			return;
+		int64_t iRunning = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - m_CurrentStart).count();
+		if (iRunning >= iBudgetSeconds)
+		{
+			// reported once per message
+			_log.Log(LOG_ERROR, "(%s) '%s' message has been running for more than %d seconds, other plugins are waiting for it to complete (%d messages queued).", m_Name.c_str(), m_CurrentMessage.c_str(), iBudgetSeconds, (int)m_MessageQueue.size());
+			m_bCurrentReported = true;
+			m_BudgetExceeded++;
 		}
 	}
 
@@ -942,8 +1106,8 @@ namespace Plugins {
 				// If we have connections queue disconnects
 				if (m_Transports.size())
 				{
-					std::lock_guard<std::mutex> lPython(PythonMutex); // Take mutex to guard access to CPluginTransport::m_pConnection
-					                                                  // TODO: Must take before m_TransportsMutex to avoid deadlock, try to improve to allow only taking when needed
+					AccessPython	Guard(this); // Guard access to CPluginTransport::m_pConnection
+					                             // TODO: Must take before m_TransportsMutex to avoid deadlock, try to improve to allow only taking when needed
 					std::lock_guard<std::mutex> lTransports(m_TransportsMutex);
 					for (std::vector<CPluginTransport*>::iterator itt = m_Transports.begin(); itt != m_Transports.end(); itt++)
 					{
@@ -977,6 +1141,8 @@ namespace Plugins {
 				m_thread.reset();
 			}
 
+			StopMessageThread();
+
 			if (m_Notifier)
 			{
 				delete m_Notifier;
@@ -1011,8 +1177,8 @@ namespace Plugins {
 			// Check all connections are still valid, vector could be affected by a disconnect on another thread
 			try
 			{
-				std::lock_guard<std::mutex> lPython(PythonMutex); // Take mutex to guard access to CPluginTransport::m_pConnection
-				                                                  // TODO: Must take before m_TransportsMutex to avoid deadlock, try to improve to allow only taking when needed
+				AccessPython	Guard(this); // Guard access to CPluginTransport::m_pConnection
+				                             // TODO: Must take before m_TransportsMutex to avoid deadlock, try to improve to allow only taking when needed
 				std::lock_guard<std::mutex> lTransports(m_TransportsMutex);
 				if (m_Transports.size())
 				{
@@ -1046,6 +1212,8 @@ namespace Plugins {
 				_log.Log(LOG_ERROR, "(%s) failed to create interpreter.", m_PluginKey.c_str());
 				goto Error;
 			}
+			// Transports and the work loop run on other threads, they need their own thread state in this interpreter
+			m_PyTransportThread = PyThreadState_New(((PyThreadState*)m_PyInterpreter)->interp);
 
 			// Prepend plugin directory to path so that python will search it early when importing
 	#ifdef WIN32
@@ -1686,8 +1854,13 @@ Error:
 		}
 
 		// Add message to queue
-		std::lock_guard<std::mutex> l(PluginMutex);
-		PluginMessageQueue.push(pMessage);
+		{
+			std::lock_guard<std::mutex> l(m_QueueMutex);
+			m_MessageQueue.push_back(pMessage);
+			if (m_MessageQueue.size() > m_PeakQueueSize)
+				m_PeakQueueSize = m_MessageQueue.size();
+		}
+		m_QueueCondition.notify_one();
 	}
 
 	void CPlugin::DeviceAdded(int Unit)
@@ -1762,11 +1935,35 @@ Error:
 			PyEval_SaveThread();
 	}
 
+	void CPlugin::RestoreTransportThread()
+	{
+		if (m_PyTransportThread)
+			PyEval_RestoreThread((PyThreadState*)m_PyTransportThread);
+	}
+
+	void CPlugin::ReleaseTransportThread()
+	{
+		if (m_PyTransportThread)
+			PyEval_SaveThread();
+	}
+
+	AccessPython::AccessPython(CPlugin* pPlugin) : m_Lock(PythonMutex), m_pPlugin(pPlugin)
+	{
+		if (m_pPlugin)
+			m_pPlugin->RestoreTransportThread();
+	}
+
+	AccessPython::~AccessPython()
+	{
+		if (m_pPlugin)
+			m_pPlugin->ReleaseTransportThread();
+	}
+
 	void CPlugin::Callback(std::string sHandler, void * pParams)
 	{
 		try
 		{
-			// Callbacks MUST already have taken the PythonMutex lock otherwise bad things will happen
+			// Callbacks MUST already hold the plugin's GIL (RestoreThread) otherwise bad things will happen
 			if (m_PyModule && !sHandler.empty())
 			{
 				PyObject*	pFunc = PyObject_GetAttrString((PyObject*)m_PyModule, sHandler.c_str());
@@ -1807,6 +2004,13 @@ Error:
 			if (m_DeviceDict) Py_XDECREF(m_DeviceDict);
 			if (m_ImageDict) Py_XDECREF(m_ImageDict);
 			if (m_SettingsDict) Py_XDECREF(m_SettingsDict);
+			if (m_PyTransportThread)
+			{
+				// Caller holds PythonMutex so no other thread is using it
+				PyThreadState_Clear((PyThreadState*)m_PyTransportThread);
+				PyThreadState_Delete((PyThreadState*)m_PyTransportThread);
+				m_PyTransportThread = NULL;
+			}
 			if (m_PyInterpreter) Py_EndInterpreter((PyThreadState*)m_PyInterpreter);
 			Py_XDECREF(m_PyModule);
 			PyEval_ReleaseLock();
@@ -3,6 +3,9 @@
 #include "../DomoticzHardware.h"
 #include "../hardwaretypes.h"
 #include "../../notifications/NotificationBase.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 
 #ifndef byte
 typedef unsigned char byte;
@@ -36,6 +39,7 @@ namespace Plugins {
 		int				m_iPollInterval;
 
 		void*			m_PyInterpreter;
+		void*			m_PyTransportThread;	// thread state for the transports and work loop, only used while holding PythonMutex
 		void*			m_PyModule;
 
 		std::string		m_Version;
@@ -48,8 +52,29 @@ namespace Plugins {
 
 		std::shared_ptr<std::thread> m_thread;
 
+		// Messages for this plugin, processed in order by its own worker thread
+		std::mutex	m_QueueMutex;
+		std::condition_variable	m_QueueCondition;
+		std::deque<CPluginMessageBase*>	m_MessageQueue;
+		std::shared_ptr<std::thread> m_MessageThread;
+		bool		m_bStopMessages;
+
+		// Message processing statistics (guarded by m_QueueMutex)
+		size_t		m_PeakQueueSize;
+		uint64_t	m_MessagesProcessed;
+		uint64_t	m_TotalProcessMs;
+		uint64_t	m_MaxProcessMs;
+		std::string	m_MaxProcessMessage;
+		uint64_t	m_BudgetExceeded;
+		std::string	m_CurrentMessage;
+		std::chrono::steady_clock::time_point	m_CurrentStart;
+		bool		m_bCurrentReported;
+
 		bool StartHardware() override;
 		void Do_Work();
+		void Do_Messages();
+		void StartMessageThread();
+		void StopMessageThread();
 		bool StopHardware() override;
 		void ClearMessageQueue();
 
@@ -57,9 +82,26 @@ namespace Plugins {
 		void LogPythonException(const std::string &);
 
 	public:
+		struct _tMessageStats
+		{
+			size_t		QueueSize;
+			size_t		PeakQueueSize;
+			uint64_t	Processed;
+			uint64_t	AvgProcessMs;
+			uint64_t	MaxProcessMs;
+			std::string	MaxProcessMessage;
+			uint64_t	BudgetExceeded;
+			std::string	CurrentMessage;		// empty when idle
+			uint64_t	CurrentRunningMs;
+		};
+
 		CPlugin(const int HwdID, const std::string &Name, const std::string &PluginKey);
 		~CPlugin(void);
 
+		void	GetMessageStats(_tMessageStats &stats);
+		void	ResetMessageStats();
+		void	CheckCallbackBudget(const int iBudgetSeconds);
+
 		int		PollInterval(int Interval = -1);
 		void*	PythonModule() { return m_PyModule; };
 		void	Notifier(std::string Notifier = "");
@@ -79,6 +121,8 @@ namespace Plugins {
 		void	Callback(std::string sHandler, void* pParams);
 		void	RestoreThread();
 		void	ReleaseThread();
+		void	RestoreTransportThread();
+		void	ReleaseTransportThread();
 		void	Stop();
 
 		void	WriteDebugBuffer(const std::vector<byte>& Buffer, bool Incoming);
@@ -107,6 +151,19 @@ namespace Plugins {
 		bool				m_bTracing;
 	};
 
+	extern std::mutex PythonMutex;			// controls access to the transports and connection objects
+
+	// Takes PythonMutex and the plugin's GIL, for threads other than the plugin's message thread (transports, work loop)
+	class AccessPython
+	{
+	public:
+		AccessPython(CPlugin* pPlugin);
+		~AccessPython();
+	private:
+		std::lock_guard<std::mutex>	m_Lock;
+		CPlugin*	m_pPlugin;
+	};
+
 	class CPluginNotifier : public CNotificationBase
 	{
 	private:
@@ -770,6 +770,7 @@ namespace Plugins {
 						if (result.size())
 						{
 							self->ID = atoi(result[0][0].c_str());
+							m_sql.RescheduleSensorTimeout(self->ID);
 
 							PyObject*	pKey = PyLong_FromLong(self->Unit);
 							if (PyDict_SetItem((PyObject*)self->pPlugin->m_DeviceDict, pKey, (PyObject*)self) == -1)
@@ -824,6 +825,31 @@ namespace Plugins {
 		return Py_None;
 	}
 
+	static void UpdateSecurityPanelStatus(const int nValue)
+	{
+		switch (nValue)
+		{
+		case sStatusArmHome:
+		case sStatusArmHomeDelayed:
+			m_sql.UpdatePreferencesVar("SecStatus", SECSTATUS_ARMEDHOME);
+			m_mainworker.UpdateDomoticzSecurityStatus(SECSTATUS_ARMEDHOME);
+			break;
+		case sStatusArmAway:
+		case sStatusArmAwayDelayed:
+			m_sql.UpdatePreferencesVar("SecStatus", SECSTATUS_ARMEDAWAY);
+			m_mainworker.UpdateDomoticzSecurityStatus(SECSTATUS_ARMEDAWAY);
+			break;
+		case sStatusDisarm:
+		case sStatusNormal:
+		case sStatusNormalDelayed:
+		case sStatusNormalTamper:
+		case sStatusNormalDelayedTamper:
+			m_sql.UpdatePreferencesVar("SecStatus", SECSTATUS_DISARMED);
+			m_mainworker.UpdateDomoticzSecurityStatus(SECSTATUS_DISARMED);
+			break;
+		}
+	}
+
 	PyObject* CDevice_update(CDevice *self, PyObject *args, PyObject *kwds)
 	{
 		if (self->pPlugin)
@@ -915,6 +941,7 @@ namespace Plugins {
 			if (iUsed != self->Used)
 			{
 				m_sql.UpdateDeviceValue("Used", iUsed, sID);
+				m_sql.RescheduleSensorTimeout(self->ID);
 			}
 
 			// Color change
@@ -979,31 +1006,11 @@ namespace Plugins {
 				// if this is an internal Security Panel then there are some extra updates required if state has changed
 				if ((self->Type == pTypeSecurity1) && (self->SubType == sTypeDomoticzSecurity) && (self->nValue != nValue))
 				{
-					switch (nValue)
-					{
-					case sStatusArmHome:
-					case sStatusArmHomeDelayed:
-						m_sql.UpdatePreferencesVar("SecStatus", SECSTATUS_ARMEDHOME);
-						m_mainworker.UpdateDomoticzSecurityStatus(SECSTATUS_ARMEDHOME);
-						break;
-					case sStatusArmAway:
-					case sStatusArmAwayDelayed:
-						m_sql.UpdatePreferencesVar("SecStatus", SECSTATUS_ARMEDAWAY);
-						m_mainworker.UpdateDomoticzSecurityStatus(SECSTATUS_ARMEDAWAY);
-						break;
-					case sStatusDisarm:
-					case sStatusNormal:
-					case sStatusNormalDelayed:
-					case sStatusNormalTamper:
-					case sStatusNormalDelayedTamper:
-						m_sql.UpdatePreferencesVar("SecStatus", SECSTATUS_DISARMED);
-						m_mainworker.UpdateDomoticzSecurityStatus(SECSTATUS_DISARMED);
-						break;
-					}
+					UpdateSecurityPanelStatus(nValue);
 				}
 
 				// Notify MQTT and various push mechanisms and notifications
-				m_mainworker.sOnDeviceReceived(self->pPlugin->m_HwdID, self->ID, self->pPlugin->m_Name, NULL);
+				m_mainworker.m_deviceupdates.Publish(self->pPlugin->m_HwdID, self->ID, self->pPlugin->m_Name, NULL);
 				m_notifications.CheckAndHandleNotification(DevRowIdx, self->HwdID, sDeviceID, sName, self->Unit, iType, iSubType, nValue, sValue);
 
 				// Trigger any associated scene / groups
@@ -1021,6 +1028,125 @@ namespace Plugins {
 		return Py_None;
 	}
 
+	struct _tDeviceBatchUpdate
+	{
+		CDevice*	pDevice;
+		uint64_t	DevRowIdx;
+		std::string	sDeviceID;
+		std::string	sName;
+		int			Unit;
+		int			Type;
+		int			SubType;
+		int			nValue;
+		std::string	sValue;
+		int			SignalLevel;
+		int			BatteryLevel;
+		bool		bSecurityStatusChanged;
+	};
+
+	PyObject* CDevice_updatemany(CPlugin* pPlugin, PyObject* pUpdates)
+	{
+		if (!PyList_Check(pUpdates))
+		{
+			_log.Log(LOG_ERROR, "(%s) %s: List of (Unit, nValue, sValue[, SignalLevel, BatteryLevel]) tuples expected.", pPlugin->m_Name.c_str(), __func__);
+			Py_INCREF(Py_None);
+			return Py_None;
+		}
+
+		// Collect everything that is needed from the Python objects while holding the GIL
+		std::vector<_tDeviceBatchUpdate> updates;
+		Py_ssize_t iCount = PyList_Size(pUpdates);
+		updates.reserve(iCount);
+		for (Py_ssize_t i = 0; i < iCount; i++)
+		{
+			PyObject*	pItem = PyList_GetItem(pUpdates, i);
+			int			iUnit;
+			int			nValue;
+			char*		sValue = NULL;
+			int			iSignalLevel = -1;
+			int			iBatteryLevel = -1;
+			if (!PyTuple_Check(pItem) || !PyArg_ParseTuple(pItem, "iis|ii", &iUnit, &nValue, &sValue, &iSignalLevel, &iBatteryLevel))
+			{
+				_log.Log(LOG_ERROR, "(%s) %s: Failed to parse item %d, (Unit, nValue, sValue[, SignalLevel, BatteryLevel]) expected.", pPlugin->m_Name.c_str(), __func__, (int)i);
+				LogPythonException(pPlugin, __func__);
+				continue;
+			}
+
+			PyObject*	pKey = PyLong_FromLong(iUnit);
+			CDevice*	pDevice = (CDevice*)PyDict_GetItem((PyObject*)pPlugin->m_DeviceDict, pKey);
+			Py_DECREF(pKey);
+			if (!pDevice || (pDevice->ID == -1))
+			{
+				_log.Log(LOG_ERROR, "(%s) %s: Unit %d does not represent a device in Domoticz.", pPlugin->m_Name.c_str(), __func__, iUnit);
+				continue;
+			}
+
+			_tDeviceBatchUpdate update;
+			update.pDevice = pDevice;
+			update.DevRowIdx = 0;
+			update.sDeviceID = PyUnicode_AsUTF8(pDevice->DeviceID);
+			update.sName = PyUnicode_AsUTF8(pDevice->Name);
+			update.Unit = pDevice->Unit;
+			update.Type = pDevice->Type;
+			update.SubType = pDevice->SubType;
+			update.nValue = nValue;
+			update.sValue = sValue;
+			update.SignalLevel = (iSignalLevel == -1) ? pDevice->SignalLevel : iSignalLevel;
+			update.BatteryLevel = (iBatteryLevel == -1) ? pDevice->BatteryLevel : iBatteryLevel;
+			update.bSecurityStatusChanged = (pDevice->Type == pTypeSecurity1) && (pDevice->SubType == sTypeDomoticzSecurity) && (pDevice->nValue != nValue);
+
+			if (pPlugin->m_bDebug & PDM_DEVICE)
+			{
+				_log.Log(LOG_NORM, "(%s) Updating device from %d:'%s' to have values %d:'%s'.", update.sName.c_str(), pDevice->nValue, PyUnicode_AsUTF8(pDevice->sValue), nValue, sValue);
+			}
+			Py_INCREF(pDevice);
+			updates.push_back(update);
+		}
+
+		// Write all values in a single transaction without holding the GIL, other plugins can continue meanwhile
+		std::string sLastUpdate;
+		Py_BEGIN_ALLOW_THREADS
+		m_sql.ExecuteInTransaction([&]() {
+			for (auto & itt : updates)
+			{
+				itt.DevRowIdx = m_sql.UpdateValue(pPlugin->m_HwdID, itt.sDeviceID.c_str(), (const unsigned char)itt.Unit, (const unsigned char)itt.Type, (const unsigned char)itt.SubType,
+					(const unsigned char)itt.SignalLevel, (const unsigned char)itt.BatteryLevel, itt.nValue, itt.sValue.c_str(), itt.sName, true);
+			}
+		});
+		sLastUpdate = TimeToString(NULL, TF_DateTime);
+
+		for (const auto & itt : updates)
+		{
+			if (itt.bSecurityStatusChanged)
+				UpdateSecurityPanelStatus(itt.nValue);
+
+			// Notify MQTT and various push mechanisms and notifications
+			m_mainworker.m_deviceupdates.Publish(pPlugin->m_HwdID, itt.DevRowIdx, pPlugin->m_Name, NULL);
+			m_notifications.CheckAndHandleNotification(itt.DevRowIdx, pPlugin->m_HwdID, itt.sDeviceID, itt.sName, itt.Unit, itt.Type, itt.SubType, itt.nValue, itt.sValue);
+
+			// Trigger any associated scene / groups
+			m_mainworker.CheckSceneCode(itt.DevRowIdx, (const unsigned char)itt.Type, (const unsigned char)itt.SubType, itt.nValue, itt.sValue.c_str());
+		}
+		Py_END_ALLOW_THREADS
+
+		// Update the Python objects with the values just written instead of reading them back
+		for (const auto & itt : updates)
+		{
+			CDevice* pDevice = itt.pDevice;
+			pDevice->nValue = itt.nValue;
+			Py_XDECREF(pDevice->sValue);
+			pDevice->sValue = PyUnicode_FromString(itt.sValue.c_str());
+			pDevice->SignalLevel = itt.SignalLevel;
+			pDevice->BatteryLevel = itt.BatteryLevel;
+			Py_XDECREF(pDevice->LastUpdate);
+			pDevice->LastUpdate = PyUnicode_FromString(sLastUpdate.c_str());
+			Py_DECREF(pDevice);
+		}
+
+		Py_INCREF(Py_None);
+		return Py_None;
+	}
+
 	PyObject* CDevice_delete(CDevice* self)
 	{
 		if (self->pPlugin)
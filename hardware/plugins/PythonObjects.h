@@ -111,6 +111,7 @@ namespace Plugins {
 	PyObject* CDevice_refresh(CDevice* self);
 	PyObject* CDevice_insert(CDevice* self);
 	PyObject* CDevice_update(CDevice *self, PyObject *args, PyObject *kwds);
+	PyObject* CDevice_updatemany(CPlugin* pPlugin, PyObject* pUpdates);
 	PyObject* CDevice_delete(CDevice* self);
 	PyObject* CDevice_touch(CDevice* self);
 	PyObject* CDevice_str(CDevice* self);
@@ -2,10 +2,17 @@
 #include "HTTPClient.h"
 #include <curl/curl.h>
 #include "../main/Logger.h"
+#include "../main/Helper.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #ifndef O_LARGEFILE
 	#define O_LARGEFILE 0
@@ -51,6 +58,24 @@ size_t write_curl_data_file(void *contents, size_t size, size_t nmemb, void *use
 	return realsize;
 }
 
+struct _tStreamData
+{
+	const HTTPClient::tStreamCallback *pCallback;
+	bool bStopped;
+};
+
+size_t write_curl_data_stream(void *contents, size_t size, size_t nmemb, void *userp)
+{
+	size_t realsize = size * nmemb;
+	_tStreamData *pStream = (_tStreamData*)userp;
+	if (!(*pStream->pCallback)((const unsigned char*)contents, realsize))
+	{
+		pStream->bStopped = true;
+		return 0; //ends the transfer
+	}
+	return realsize;
+}
+
 size_t write_curl_data_single_line(void *contents, size_t size, size_t nmemb, void *userp)
 {
 	size_t realsize = size * nmemb;
@@ -68,6 +93,335 @@ size_t write_curl_data_single_line(void *contents, size_t size, size_t nmemb, vo
 }
 
 
+/************************************************************************
+ *									*
+ * Connection pool							*
+ *									*
+ * Easy handles are kept after a request so their connections stay	*
+ * alive, and all handles share one DNS, TLS session, connection and	*
+ * cookie cache. The asynchronous requests are driven by a multi	*
+ * handle on their own thread.						*
+ *									*
+ ************************************************************************/
+
+#define HTTP_POOL_MAX_IDLE_HANDLES 16
+#define HTTP_ASYNC_MAX_PENDING 1000
+#define HTTP_ASYNC_MAX_RUNNING 16
+#define HTTP_ASYNC_MAX_HOST_CONNECTIONS 4
+
+struct _tAsyncRequest
+{
+	HTTPClient::_eHTTPmethod method;
+	std::string url;
+	std::string data;
+	std::vector<std::string> ExtraHeaders;
+	HTTPClient::tAsyncCallback callback;
+	long TimeOut;
+
+	CURL *curl;
+	struct curl_slist *headers;
+	std::vector<unsigned char> response;
+};
+
+static std::mutex			s_poolMutex;
+static CURLSH				*s_share = NULL;
+static std::mutex			s_shareMutex[CURL_LOCK_DATA_LAST];
+static std::vector<CURL*>	s_idleHandles;
+static HTTPClient::_tPoolStats	s_poolStats;
+
+static std::mutex			s_asyncMutex;
+static std::condition_variable	s_asyncCondition;
+static std::deque<std::shared_ptr<_tAsyncRequest> >	s_asyncQueue;
+static std::shared_ptr<std::thread>	s_asyncThread;
+static bool					s_bAsyncStopRequested = false;
+
+static void curl_share_lock(CURL * /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void * /*userptr*/)
+{
+	s_shareMutex[data].lock();
+}
+
+static void curl_share_unlock(CURL * /*handle*/, curl_lock_data data, void * /*userptr*/)
+{
+	s_shareMutex[data].unlock();
+}
+
+//Called after every request, keeps track of the connection reuse and writes the cookie jar
+static void curl_request_done(CURL *curl)
+{
+	long connects = 0;
+	curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+	curl_easy_setopt(curl, CURLOPT_COOKIELIST, "FLUSH");
+
+	std::unique_lock<std::mutex> lock(s_poolMutex);
+	s_poolStats.requests++;
+	if (connects > 0)
+		s_poolStats.connections_new += connects;
+	else
+		s_poolStats.connections_reused++;
+}
+
+static CURLcode curl_perform(CURL *curl)
+{
+	CURLcode res = curl_easy_perform(curl);
+	curl_request_done(curl);
+	return res;
+}
+
+void *HTTPClient::GetHandle()
+{
+	if (!CheckIfGlobalInitDone())
+		return NULL;
+	CURL *curl = NULL;
+	{
+		std::unique_lock<std::mutex> lock(s_poolMutex);
+		if (!s_idleHandles.empty())
+		{
+			curl = s_idleHandles.back();
+			s_idleHandles.pop_back();
+		}
+	}
+	if (!curl)
+	{
+		curl = curl_easy_init();
+		if (!curl)
+			return NULL;
+		std::unique_lock<std::mutex> lock(s_poolMutex);
+		s_poolStats.handles_created++;
+	}
+	if (s_share)
+		curl_easy_setopt(curl, CURLOPT_SHARE, s_share);
+	return curl;
+}
+
+void HTTPClient::ReleaseHandle(void *curlobj)
+{
+	CURL *curl = (CURL *)curlobj;
+	if (!curl)
+		return;
+	//resets the options, but keeps the connections and caches
+	curl_easy_reset(curl);
+	{
+		std::unique_lock<std::mutex> lock(s_poolMutex);
+		if ((m_bCurlGlobalInitialized) && (s_idleHandles.size() < HTTP_POOL_MAX_IDLE_HANDLES))
+		{
+			s_idleHandles.push_back(curl);
+			return;
+		}
+	}
+	curl_easy_cleanup(curl);
+}
+
+static bool curl_async_setup(const std::shared_ptr<_tAsyncRequest> &pRequest)
+{
+	CURL *curl = pRequest->curl;
+	if (pRequest->TimeOut != -1)
+		curl_easy_setopt(curl, CURLOPT_TIMEOUT, pRequest->TimeOut);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&pRequest->response);
+	curl_easy_setopt(curl, CURLOPT_URL, pRequest->url.c_str());
+	curl_easy_setopt(curl, CURLOPT_PRIVATE, (void *)pRequest.get());
+	switch (pRequest->method)
+	{
+	case HTTPClient::HTTP_METHOD_GET:
+		break;
+	case HTTPClient::HTTP_METHOD_POST:
+		curl_easy_setopt(curl, CURLOPT_POST, 1);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, pRequest->data.c_str());
+		break;
+	case HTTPClient::HTTP_METHOD_PUT:
+		curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, pRequest->data.c_str());
+		break;
+	case HTTPClient::HTTP_METHOD_DELETE:
+		curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, pRequest->data.c_str());
+		break;
+	default:
+		return false;
+	}
+	for (const auto & itt : pRequest->ExtraHeaders)
+		pRequest->headers = curl_slist_append(pRequest->headers, itt.c_str());
+	if (pRequest->headers != NULL)
+		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, pRequest->headers);
+	return true;
+}
+
+void HTTPClient::Do_AsyncWork()
+{
+	CURLM *multi = curl_multi_init();
+	if (!multi)
+	{
+		_log.Log(LOG_ERROR, "HTTPClient: could not create the asynchronous request handler!");
+		return;
+	}
+	curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)HTTP_ASYNC_MAX_HOST_CONNECTIONS);
+	curl_multi_setopt(multi, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+
+	std::map<_tAsyncRequest*, std::shared_ptr<_tAsyncRequest> > running;
+	while (true)
+	{
+		std::vector<std::shared_ptr<_tAsyncRequest> > starting;
+		{
+			std::unique_lock<std::mutex> lock(s_asyncMutex);
+			if (running.empty())
+			{
+				while ((s_asyncQueue.empty()) && (!s_bAsyncStopRequested))
+					s_asyncCondition.wait(lock);
+			}
+			if (s_bAsyncStopRequested)
+				break;
+			while ((!s_asyncQueue.empty()) && (running.size() + starting.size() < HTTP_ASYNC_MAX_RUNNING))
+			{
+				starting.push_back(s_asyncQueue.front());
+				s_asyncQueue.pop_front();
+			}
+		}
+		for (const auto & pRequest : starting)
+		{
+			pRequest->curl = (CURL *)GetHandle();
+			if (pRequest->curl)
+			{
+				SetGlobalOptions(pRequest->curl);
+				if (curl_async_setup(pRequest))
+				{
+					curl_multi_add_handle(multi, pRequest->curl);
+					running[pRequest.get()] = pRequest;
+					continue;
+				}
+				ReleaseHandle(pRequest->curl);
+			}
+			if (pRequest->headers != NULL)
+				curl_slist_free_all(pRequest->headers);
+			if (pRequest->callback)
+				pRequest->callback(false, 0, pRequest->response);
+		}
+
+		int still_running = 0;
+		curl_multi_perform(multi, &still_running);
+
+		CURLMsg *msg;
+		int msgs_left = 0;
+		while ((msg = curl_multi_info_read(multi, &msgs_left)) != NULL)
+		{
+			if (msg->msg != CURLMSG_DONE)
+				continue;
+			CURL *curl = msg->easy_handle;
+			CURLcode res = msg->data.result;
+			_tAsyncRequest *pPrivate = NULL;
+			curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&pPrivate);
+			std::map<_tAsyncRequest*, std::shared_ptr<_tAsyncRequest> >::iterator itt = running.find(pPrivate);
+
+			long http_code = 0;
+			curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+			bool bOK = ((res == CURLE_OK) && (http_code) && (http_code < 400));
+			if (res != CURLE_OK)
+				_log.Debug(DEBUG_NORM, "HTTPClient: %s", curl_easy_strerror(res));
+			else if (!bOK)
+				LogError(http_code);
+
+			curl_multi_remove_handle(multi, curl);
+			curl_request_done(curl);
+			ReleaseHandle(curl);
+			if (itt == running.end())
+				continue;
+			std::shared_ptr<_tAsyncRequest> pRequest = itt->second;
+			running.erase(itt);
+			if (pRequest->headers != NULL)
+				curl_slist_free_all(pRequest->headers);
+			if (pRequest->callback)
+			{
+				try
+				{
+					pRequest->callback(bOK, http_code, pRequest->response);
+				}
+				catch (...)
+				{
+					_log.Log(LOG_ERROR, "HTTPClient: exception in asynchronous request callback (%s)", pRequest->url.c_str());
+				}
+			}
+		}
+		{
+			std::unique_lock<std::mutex> lock(s_poolMutex);
+			s_poolStats.async_running = running.size();
+		}
+		if (!running.empty())
+			curl_multi_wait(multi, NULL, 0, 100, NULL);
+	}
+
+	//stop requested, abort what is still running
+	for (auto & itt : running)
+	{
+		curl_multi_remove_handle(multi, itt.second->curl);
+		ReleaseHandle(itt.second->curl);
+		if (itt.second->headers != NULL)
+			curl_slist_free_all(itt.second->headers);
+	}
+	running.clear();
+	curl_multi_cleanup(multi);
+}
+
+bool HTTPClient::SendAsync(const _eHTTPmethod method, const std::string &url, const std::string &data, const std::vector<std::string> &ExtraHeaders, const tAsyncCallback &callback, const long TimeOut)
+{
+	if (!CheckIfGlobalInitDone())
+		return false;
+
+	std::shared_ptr<_tAsyncRequest> pRequest = std::make_shared<_tAsyncRequest>();
+	pRequest->method = method;
+	pRequest->url = url;
+	pRequest->data = data;
+	pRequest->ExtraHeaders = ExtraHeaders;
+	pRequest->callback = callback;
+	pRequest->TimeOut = TimeOut;
+	pRequest->curl = NULL;
+	pRequest->headers = NULL;
+
+	{
+		std::unique_lock<std::mutex> lock(s_asyncMutex);
+		if (s_bAsyncStopRequested)
+			return false;
+		if (s_asyncQueue.size() >= HTTP_ASYNC_MAX_PENDING)
+		{
+			lock.unlock();
+			std::unique_lock<std::mutex> plock(s_poolMutex);
+			if (s_poolStats.async_dropped % 100 == 0)
+				_log.Log(LOG_ERROR, "HTTPClient: too many pending asynchronous requests, dropping request!");
+			s_poolStats.async_dropped++;
+			return false;
+		}
+		s_asyncQueue.push_back(pRequest);
+		if (!s_asyncThread)
+		{
+			s_asyncThread = std::make_shared<std::thread>(&HTTPClient::Do_AsyncWork);
+			SetThreadName(s_asyncThread->native_handle(), "HTTPClientAsync");
+		}
+	}
+	s_asyncCondition.notify_one();
+
+	std::unique_lock<std::mutex> lock(s_poolMutex);
+	s_poolStats.async_requests++;
+	return true;
+}
+
+void HTTPClient::GetPoolStats(_tPoolStats &stats)
+{
+	size_t pending;
+	{
+		std::unique_lock<std::mutex> lock(s_asyncMutex);
+		pending = s_asyncQueue.size();
+	}
+	std::unique_lock<std::mutex> lock(s_poolMutex);
+	stats = s_poolStats;
+	stats.handles_idle = s_idleHandles.size();
+	stats.async_pending = pending;
+}
+
+void HTTPClient::ResetPoolStats()
+{
+	std::unique_lock<std::mutex> lock(s_poolMutex);
+	size_t running = s_poolStats.async_running;
+	s_poolStats = HTTPClient::_tPoolStats();
+	s_poolStats.async_running = running;
+}
+
 /************************************************************************
  *									*
  * Private functions							*
@@ -76,11 +430,24 @@ size_t write_curl_data_single_line(void *contents, size_t size, size_t nmemb, vo
 
 bool HTTPClient::CheckIfGlobalInitDone()
 {
+	std::unique_lock<std::mutex> lock(s_poolMutex);
 	if (!m_bCurlGlobalInitialized)
 	{
 		CURLcode res = curl_global_init(CURL_GLOBAL_ALL);
 		if (res != CURLE_OK)
 			return false;
+		s_share = curl_share_init();
+		if (s_share)
+		{
+			curl_share_setopt(s_share, CURLSHOPT_LOCKFUNC, curl_share_lock);
+			curl_share_setopt(s_share, CURLSHOPT_UNLOCKFUNC, curl_share_unlock);
+			curl_share_setopt(s_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+			curl_share_setopt(s_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+			curl_share_setopt(s_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
+#if LIBCURL_VERSION_NUM >= 0x073900
+			curl_share_setopt(s_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+		}
 		m_bCurlGlobalInitialized = true;
 	}
 	return true;
@@ -88,9 +455,36 @@ bool HTTPClient::CheckIfGlobalInitDone()
 
 void HTTPClient::Cleanup()
 {
+	{
+		std::unique_lock<std::mutex> lock(s_asyncMutex);
+		s_bAsyncStopRequested = true;
+		s_asyncQueue.clear();
+	}
+	s_asyncCondition.notify_all();
+	if (s_asyncThread)
+	{
+		s_asyncThread->join();
+		s_asyncThread.reset();
+	}
+
+	std::vector<CURL*> handles;
+	{
+		std::unique_lock<std::mutex> lock(s_poolMutex);
+		handles.swap(s_idleHandles);
+	}
+	for (auto & itt : handles)
+		curl_easy_cleanup(itt);
+
+	std::unique_lock<std::mutex> lock(s_poolMutex);
 	if (m_bCurlGlobalInitialized)
 	{
+		if (s_share)
+		{
+			curl_share_cleanup(s_share);
+			s_share = NULL;
+		}
 		curl_global_cleanup();
+		m_bCurlGlobalInitialized = false;
 	}
 }
 
@@ -235,7 +629,7 @@ bool HTTPClient::GETBinary(const std::string &url, const std::vector<std::string
 	{
 		if (!CheckIfGlobalInitDone())
 			return false;
-		CURL *curl = curl_easy_init();
+		CURL *curl = (CURL *)GetHandle();
 		if (!curl)
 			return false;
 
@@ -259,7 +653,7 @@ bool HTTPClient::GETBinary(const std::string &url, const std::vector<std::string
 		curl_easy_setopt(curl, CURLOPT_HEADERDATA, &vHeaderData);
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
 		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-		res = curl_easy_perform(curl);
+		res = curl_perform(curl);
 
 		bool bOK = false;
 		if (res == CURLE_OK)
@@ -284,7 +678,7 @@ bool HTTPClient::GETBinary(const std::string &url, const std::vector<std::string
 			}
 		}
 
-		curl_easy_cleanup(curl);
+		ReleaseHandle(curl);
 
 		if (headers != NULL) {
 			curl_slist_free_all(headers); /* free the header list */
@@ -306,7 +700,7 @@ bool HTTPClient::POSTBinary(const std::string &url, const std::string &postdata,
 	{
 		if (!CheckIfGlobalInitDone())
 			return false;
-		CURL *curl = curl_easy_init();
+		CURL *curl = (CURL *)GetHandle();
 		if (!curl)
 			return false;
 
@@ -335,7 +729,7 @@ bool HTTPClient::POSTBinary(const std::string &url, const std::string &postdata,
 		}
 
 		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postdata.c_str());
-		res = curl_easy_perform(curl);
+		res = curl_perform(curl);
 
 		if (res != CURLE_OK)
 		{
@@ -355,7 +749,7 @@ bool HTTPClient::POSTBinary(const std::string &url, const std::string &postdata,
 			}
 		}
 
-		curl_easy_cleanup(curl);
+		ReleaseHandle(curl);
 
 		if (headers != NULL)
 		{
@@ -377,7 +771,7 @@ std::vector<std::string> &vHeaderData, const long TimeOut)
 	{
 		if (!CheckIfGlobalInitDone())
 			return false;
-		CURL *curl = curl_easy_init();
+		CURL *curl = (CURL *)GetHandle();
 		if (!curl)
 			return false;
 
@@ -403,7 +797,7 @@ std::vector<std::string> &vHeaderData, const long TimeOut)
 		}
 
 		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, putdata.c_str());
-		res = curl_easy_perform(curl);
+		res = curl_perform(curl);
 
 		if (res != CURLE_OK)
 		{
@@ -423,7 +817,7 @@ std::vector<std::string> &vHeaderData, const long TimeOut)
 			}
 		}
 
-		curl_easy_cleanup(curl);
+		ReleaseHandle(curl);
 
 		if (headers != NULL)
 		{
@@ -445,7 +839,7 @@ std::vector<std::string> &vHeaderData, const long TimeOut)
 	{
 		if (!CheckIfGlobalInitDone())
 			return false;
-		CURL *curl = curl_easy_init();
+		CURL *curl = (CURL *)GetHandle();
 		if (!curl)
 			return false;
 
@@ -471,7 +865,7 @@ std::vector<std::string> &vHeaderData, const long TimeOut)
 		}
 
 		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, putdata.c_str());
-		res = curl_easy_perform(curl);
+		res = curl_perform(curl);
 
 		if (res != CURLE_OK)
 		{
@@ -491,7 +885,7 @@ std::vector<std::string> &vHeaderData, const long TimeOut)
 			}
 		}
 
-		curl_easy_cleanup(curl);
+		ReleaseHandle(curl);
 
 		if (headers != NULL)
 		{
@@ -525,7 +919,7 @@ bool HTTPClient::GETBinarySingleLine(const std::string &url, const std::vector<s
 	{
 		if (!CheckIfGlobalInitDone())
 			return false;
-		CURL *curl = curl_easy_init();
+		CURL *curl = (CURL *)GetHandle();
 		if (!curl)
 			return false;
 
@@ -550,7 +944,7 @@ bool HTTPClient::GETBinarySingleLine(const std::string &url, const std::vector<s
 		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_curl_data_single_line);
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
 		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-		res = curl_easy_perform(curl);
+		res = curl_perform(curl);
 
 		if (
 			(res == CURLE_WRITE_ERROR) &&
@@ -573,7 +967,90 @@ bool HTTPClient::GETBinarySingleLine(const std::string &url, const std::vector<s
 			}
 		}
 
-		curl_easy_cleanup(curl);
+		ReleaseHandle(curl);
+
+		if (headers != NULL) {
+			curl_slist_free_all(headers); /* free the header list */
+		}
+		return bOK;
+	}
+	catch (...)
+	{
+		return false;
+	}
+	return false;
+}
+
+/************************************************************************
+ *									*
+ * streaming methods							*
+ *									*
+ ************************************************************************/
+
+bool HTTPClient::GETStream(const std::string &url, const std::vector<std::string> &ExtraHeaders, const tStreamCallback &callback, const long StallTime)
+{
+	try
+	{
+		if (!CheckIfGlobalInitDone())
+			return false;
+		CURL *curl = (CURL *)GetHandle();
+		if (!curl)
+			return false;
+
+		CURLcode res;
+		SetGlobalOptions(curl);
+		//a stream has no end, only abort it when it stalls
+		curl_easy_setopt(curl, CURLOPT_TIMEOUT, 0L);
+		curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+		curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, StallTime);
+		if (StallTime < m_iConnectionTimeout)
+			curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, StallTime);
+
+		struct curl_slist *headers = NULL;
+		if (ExtraHeaders.size() > 0)
+		{
+			std::vector<std::string>::const_iterator itt;
+			for (itt = ExtraHeaders.begin(); itt != ExtraHeaders.end(); ++itt)
+			{
+				headers = curl_slist_append(headers, (*itt).c_str());
+			}
+			curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+		}
+
+		_tStreamData stream;
+		stream.pCallback = &callback;
+		stream.bStopped = false;
+
+		//errors are reported by the status code, so no error pages end up in the callback
+		curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_curl_data_stream);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&stream);
+		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+		res = curl_perform(curl);
+
+		if ((res == CURLE_WRITE_ERROR) && (stream.bStopped))
+			res = CURLE_OK;
+
+		bool bOK = false;
+		if (res == CURLE_OK)
+		{
+			long http_code = 0;
+			curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+
+			bOK = ((http_code) && (http_code < 400));
+			if (!bOK)
+			{
+				LogError(http_code);
+			}
+		}
+		else if (res == CURLE_HTTP_RETURNED_ERROR)
+		{
+			long http_code = 0;
+			curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+			LogError(http_code);
+		}
+
+		ReleaseHandle(curl);
 
 		if (headers != NULL) {
 			curl_slist_free_all(headers); /* free the header list */
@@ -731,7 +1208,7 @@ bool HTTPClient::GETBinaryToFile(const std::string &url, const std::string &outp
 		if (!outfile.is_open())
 			return false;
 
-		CURL *curl = curl_easy_init();
+		CURL *curl = (CURL *)GetHandle();
 		if (!curl)
 			return false;
 
@@ -740,8 +1217,8 @@ bool HTTPClient::GETBinaryToFile(const std::string &url, const std::string &outp
 		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_curl_data_file);
 		curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&outfile);
 		curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-		res = curl_easy_perform(curl);
-		curl_easy_cleanup(curl);
+		res = curl_perform(curl);
+		ReleaseHandle(curl);
 
 		outfile.close();
 
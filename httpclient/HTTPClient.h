@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 class HTTPClient
 {
 	// give MainWorker acces to the protected Cleanup() function
@@ -10,7 +12,27 @@ public:
 	enum _eHTTPmethod
 	{
 		HTTP_METHOD_GET,
-		HTTP_METHOD_POST
+		HTTP_METHOD_POST,
+		HTTP_METHOD_PUT,
+		HTTP_METHOD_DELETE
+	};
+
+	//Called from the asynchronous request thread when a request completed (or failed)
+	typedef std::function<void(const bool bOK, const long http_code, const std::vector<unsigned char> &response)> tAsyncCallback;
+	//Called for every block of data of a streamed response, return false to end the transfer
+	typedef std::function<bool(const unsigned char *pData, const size_t Length)> tStreamCallback;
+
+	struct _tPoolStats
+	{
+		uint64_t requests;
+		uint64_t connections_new;		//requests that had to set up a new connection
+		uint64_t connections_reused;	//requests that were sent over a kept-alive connection
+		uint64_t handles_created;
+		size_t handles_idle;
+		uint64_t async_requests;
+		uint64_t async_dropped;			//requests refused because the asynchronous queue was full
+		size_t async_pending;
+		size_t async_running;
 	};
 
 
@@ -106,8 +128,46 @@ std::vector<std::string> &vHeaderData, const long TimeOut = -1);
 std::vector<std::string> &vHeaderData, const long TimeOut = -1);
 
 
+	/************************************************************************
+	 *									*
+	 * streaming methods							*
+	 *   - use for responses that do not end by themselves (MJPEG camera	*
+	 *     streams), the data is passed to the callback as it comes in	*
+	 *   - the transfer is aborted when no data is received for StallTime	*
+	 *     seconds, returns true when it ended or was ended by the callback	*
+	 *									*
+	 ************************************************************************/
+
+	static bool GETStream(const std::string &url, const std::vector<std::string> &ExtraHeaders, const tStreamCallback &callback, const long StallTime = 10);
+
+
+	/************************************************************************
+	 *									*
+	 * asynchronous methods							*
+	 *   - use for fire-and-forget requests (push services, notifications)	*
+	 *     the request is queued and performed together with other		*
+	 *     requests on the asynchronous request thread			*
+	 *   - returns false if the request could not be queued		*
+	 *									*
+	 ************************************************************************/
+
+	static bool SendAsync(const _eHTTPmethod method, const std::string &url, const std::string &data, const std::vector<std::string> &ExtraHeaders, const tAsyncCallback &callback = nullptr, const long TimeOut = -1);
+
+
+	/************************************************************************
+	 *									*
+	 * connection pool statistics						*
+	 *									*
+	 ************************************************************************/
+
+	static void GetPoolStats(_tPoolStats &stats);
+	static void ResetPoolStats();
+
 
 private:
+	static void *GetHandle();
+	static void ReleaseHandle(void *curlobj);
+	static void Do_AsyncWork();
 	static void SetGlobalOptions(void *curlobj);
 	static bool CheckIfGlobalInitDone();
 	static void LogError(const long response_code);
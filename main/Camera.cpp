@@ -15,20 +15,152 @@
 #include "../json/json.h"
 
 #define CAMERA_POLL_INTERVAL 30
+#define CAMERA_FETCH_TIMEOUT 10			//seconds a requester waits for an image
+#define CAMERA_STREAM_IDLE_TIMEOUT 10	//an MJPEG stream is closed when no image was requested for this many seconds
+#define CAMERA_MAX_IMAGE_SIZE (16 * 1024 * 1024)
 
 extern std::string szUserDataFolder;
 
+namespace
+{
+	//Splits a stream of JPEG images (an MJPEG stream or a single snapshot) in images.
+	//The marker segments are skipped by their length up to the start of scan, so FF D8/FF D9 bytes
+	//inside them (EXIF thumbnails, ICC profiles) are not taken for image boundaries.
+	//In the entropy coded data a 0xFF byte is always followed by 0x00, a restart marker or a real marker.
+	class CJPEGSplitter
+	{
+	public:
+		CJPEGSplitter() : m_ScanPos(0), m_ImageStart(0), m_State(JS_SOI) {}
+
+		void Add(const unsigned char *pData, const size_t Length)
+		{
+			m_buffer.insert(m_buffer.end(), pData, pData + Length);
+		}
+
+		//Returns true when a complete image was found, call again until it returns false
+		bool GetImage(std::vector<unsigned char> &image)
+		{
+			while (m_ScanPos + 1 < m_buffer.size())
+			{
+				if (m_State == JS_SOI)
+				{
+					//skip the multipart headers up to the start of image
+					if ((m_buffer[m_ScanPos] == 0xFF) && (m_buffer[m_ScanPos + 1] == 0xD8))
+					{
+						m_ImageStart = m_ScanPos;
+						m_ScanPos += 2;
+						m_State = JS_SEGMENT;
+					}
+					else
+						m_ScanPos++;
+					continue;
+				}
+				if (m_buffer[m_ScanPos] != 0xFF)
+				{
+					if (m_State == JS_SEGMENT)
+					{
+						//not a marker, lost track of the image, look for the next one
+						m_State = JS_SOI;
+					}
+					m_ScanPos++;
+					continue;
+				}
+				unsigned char marker = m_buffer[m_ScanPos + 1];
+				if (marker == 0xFF)
+				{
+					//fill byte
+					m_ScanPos++;
+					continue;
+				}
+				if (marker == 0xD9)
+				{
+					//end of image
+					m_ScanPos += 2;
+					image.assign(m_buffer.begin() + m_ImageStart, m_buffer.begin() + m_ScanPos);
+					m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_ScanPos);
+					m_ScanPos = 0;
+					m_State = JS_SOI;
+					return true;
+				}
+				if ((marker == 0x00) || (marker == 0x01) || ((marker >= 0xD0) && (marker <= 0xD7)))
+				{
+					//stuffed byte or a marker without a length (restart markers in the scan)
+					m_ScanPos += 2;
+					continue;
+				}
+				if (marker == 0xD8)
+				{
+					//start of a new image before the end of this one, start over with the new one
+					m_ImageStart = m_ScanPos;
+					m_ScanPos += 2;
+					m_State = JS_SEGMENT;
+					continue;
+				}
+				//marker segment, the length includes its own two bytes
+				if (m_ScanPos + 4 > m_buffer.size())
+					break;
+				size_t SegmentLength = (m_buffer[m_ScanPos + 2] << 8) | m_buffer[m_ScanPos + 3];
+				if (SegmentLength < 2)
+				{
+					m_State = JS_SOI;
+					m_ScanPos += 2;
+					continue;
+				}
+				if (m_ScanPos + 2 + SegmentLength > m_buffer.size())
+					break;
+				m_ScanPos += 2 + SegmentLength;
+				//after the start of scan header the entropy coded data follows (a progressive image has more scans)
+				m_State = (marker == 0xDA) ? JS_SCAN : JS_SEGMENT;
+			}
+			if (m_State == JS_SOI)
+			{
+				//no image started yet (multipart headers), what was scanned is not needed anymore
+				m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_ScanPos);
+				m_ScanPos = 0;
+			}
+			else if (m_buffer.size() > CAMERA_MAX_IMAGE_SIZE)
+			{
+				//lost track of the image boundaries, start over
+				m_buffer.clear();
+				m_ScanPos = 0;
+				m_State = JS_SOI;
+			}
+			return false;
+		}
+	private:
+		enum _eJPEGState
+		{
+			JS_SOI = 0,		//looking for the start of image
+			JS_SEGMENT,		//at the next marker segment
+			JS_SCAN			//in the entropy coded data
+		};
+		std::vector<unsigned char> m_buffer;
+		size_t m_ScanPos;
+		size_t m_ImageStart;
+		_eJPEGState m_State;
+	};
+} // namespace
+
 CCameraHandler::CCameraHandler(void)
 {
 	m_seconds_counter = 0;
+	m_SnapshotMaxAgeMs = 1000;
 }
 
 CCameraHandler::~CCameraHandler(void)
 {
+	StopStreams();
 }
 
 void CCameraHandler::ReloadCameras()
 {
+	//the camera addresses could have changed
+	StopStreams();
+
+	int SnapshotMaxAgeMs = 1000;
+	m_sql.GetPreferencesVar("CameraSnapshotMaxAge", SnapshotMaxAgeMs);
+	SetSnapshotMaxAge(SnapshotMaxAgeMs);
+
 	std::vector<std::string> _AddedCameras;
 	std::lock_guard<std::mutex> l(m_mutex);
 	m_cameradevices.clear();
@@ -161,6 +293,7 @@ bool CCameraHandler::TakeSnapshot(const std::string &CamID, std::vector<unsigned
 
 bool CCameraHandler::TakeRaspberrySnapshot(std::vector<unsigned char> &camimage)
 {
+	std::lock_guard<std::mutex> l(m_captureMutex);
 	std::string raspparams = "-w 800 -h 600 -t 1";
 	m_sql.GetPreferencesVar("RaspCamParams", raspparams);
 
@@ -203,6 +336,7 @@ bool CCameraHandler::TakeRaspberrySnapshot(std::vector<unsigned char> &camimage)
 
 bool CCameraHandler::TakeUVCSnapshot(const std::string &device, std::vector<unsigned char> &camimage)
 {
+	std::lock_guard<std::mutex> l(m_captureMutex);
 	std::string uvcparams = "-S80 -B128 -C128 -G80 -x800 -y600 -q100";
 	m_sql.GetPreferencesVar("UVCParams", uvcparams);
 
@@ -246,24 +380,153 @@ bool CCameraHandler::TakeUVCSnapshot(const std::string &device, std::vector<unsi
 
 bool CCameraHandler::TakeSnapshot(const uint64_t CamID, std::vector<unsigned char> &camimage)
 {
-	std::lock_guard<std::mutex> l(m_mutex);
+	CameraFramePtr pFrame;
+	if (!TakeSnapshot(CamID, pFrame))
+		return false;
+	camimage = *pFrame;
+	return true;
+}
 
-	cameraDevice *pCamera = GetCamera(CamID);
-	if (pCamera == NULL)
+bool CCameraHandler::TakeSnapshot(const uint64_t CamID, CameraFramePtr &pFrame)
+{
+	std::string szURL;
+	std::string ImageURL;
+	std::string Username;
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		cameraDevice *pCamera = GetCamera(CamID);
+		if (pCamera == NULL)
+			return false;
+
+		szURL = GetCameraURL(pCamera);
+		szURL += "/" + pCamera->ImageURL;
+		stdreplace(szURL, "#USERNAME", pCamera->Username);
+		stdreplace(szURL, "#PASSWORD", pCamera->Password);
+		ImageURL = pCamera->ImageURL;
+		Username = pCamera->Username;
+	}
+
+	std::unique_lock<std::mutex> lock(m_streamMutex);
+	std::shared_ptr<cameraStream> &pEntry = m_streams[CamID];
+	if (!pEntry)
+	{
+		pEntry = std::make_shared<cameraStream>();
+		pEntry->FrameNr = 0;
+		pEntry->bFetching = false;
+		pEntry->bStopRequested = false;
+	}
+	std::shared_ptr<cameraStream> pStream = pEntry;
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	pStream->tLastRequest = now;
+	if ((pStream->pFrame) && (now - pStream->tFrame <= std::chrono::milliseconds(m_SnapshotMaxAgeMs)))
+	{
+		pFrame = pStream->pFrame;
+		return true;
+	}
+
+	uint64_t FrameNr = pStream->FrameNr;
+	if (!pStream->bFetching)
+	{
+		//the previous fetch has finished (it does not need the lock anymore)
+		if (pStream->pThread)
+		{
+			pStream->pThread->join();
+			pStream->pThread.reset();
+		}
+		pStream->bFetching = true;
+		pStream->pThread = std::make_shared<std::thread>(&CCameraHandler::Do_Fetch, this, pStream, szURL, ImageURL, Username);
+		SetThreadName(pStream->pThread->native_handle(), "CameraFetch");
+	}
+
+	//wait for the next image
+	pStream->cvFrame.wait_for(lock, std::chrono::seconds(CAMERA_FETCH_TIMEOUT), [&pStream, FrameNr] {
+		return ((pStream->FrameNr != FrameNr) || (!pStream->bFetching) || (pStream->bStopRequested));
+	});
+	if (pStream->FrameNr == FrameNr)
 		return false;
+	pFrame = pStream->pFrame;
+	return true;
+}
+
+void CCameraHandler::Do_Fetch(std::shared_ptr<cameraStream> pStream, const std::string &szURL, const std::string &ImageURL, const std::string &Username)
+{
+	std::vector<unsigned char> image;
+	bool bOK = false;
+	if (ImageURL == "raspberry.cgi")
+		bOK = TakeRaspberrySnapshot(image);
+	else if (ImageURL == "uvccapture.cgi")
+		bOK = TakeUVCSnapshot(Username, image);
+	else
+	{
+		CJPEGSplitter splitter;
+		std::vector<unsigned char> frame;
+		int frames = 0;
+		std::vector<std::string> ExtraHeaders;
+		bOK = HTTPClient::GETStream(szURL, ExtraHeaders, [&](const unsigned char *pData, const size_t Length) -> bool
+		{
+			//the complete response is used for images that are not JPEG
+			if (frames == 0)
+			{
+				if (image.size() + Length > CAMERA_MAX_IMAGE_SIZE)
+					return false;
+				image.insert(image.end(), pData, pData + Length);
+			}
+			splitter.Add(pData, Length);
+
+			std::lock_guard<std::mutex> l(m_streamMutex);
+			while (splitter.GetImage(frame))
+			{
+				if (frames++ == 0)
+					std::vector<unsigned char>().swap(image);
+				PublishFrame(pStream.get(), frame);
+			}
+			if (pStream->bStopRequested)
+				return false;
+			//a camera that keeps sending images (MJPEG) is only read as long as its images are requested
+			return ((frames == 0) || (std::chrono::steady_clock::now() - pStream->tLastRequest < std::chrono::seconds(CAMERA_STREAM_IDLE_TIMEOUT)));
+		}, 5);
+	}
 
-	std::string szURL = GetCameraURL(pCamera);
-	szURL += "/" + pCamera->ImageURL;
-	stdreplace(szURL, "#USERNAME", pCamera->Username);
-	stdreplace(szURL, "#PASSWORD", pCamera->Password);
+	std::lock_guard<std::mutex> l(m_streamMutex);
+	if ((bOK) && (!image.empty()))
+		PublishFrame(pStream.get(), image);
+	pStream->bFetching = false;
+	pStream->cvFrame.notify_all();
+}
+
+void CCameraHandler::PublishFrame(cameraStream *pStream, std::vector<unsigned char> &image)
+{
+	pStream->pFrame = std::make_shared<const std::vector<unsigned char> >(std::move(image));
+	image.clear();
+	pStream->tFrame = std::chrono::steady_clock::now();
+	pStream->FrameNr++;
+	pStream->cvFrame.notify_all();
+}
 
-	if (pCamera->ImageURL == "raspberry.cgi")
-		return TakeRaspberrySnapshot(camimage);
-	else if (pCamera->ImageURL == "uvccapture.cgi")
-		return TakeUVCSnapshot(pCamera->Username, camimage);
+void CCameraHandler::SetSnapshotMaxAge(const int MaxAgeMs)
+{
+	std::lock_guard<std::mutex> l(m_streamMutex);
+	m_SnapshotMaxAgeMs = (MaxAgeMs > 0) ? MaxAgeMs : 0;
+}
 
-	std::vector<std::string> ExtraHeaders;
-	return HTTPClient::GETBinary(szURL, ExtraHeaders, camimage, 5);
+void CCameraHandler::StopStreams()
+{
+	std::vector<std::shared_ptr<std::thread> > threads;
+	{
+		std::lock_guard<std::mutex> l(m_streamMutex);
+		for (auto & itt : m_streams)
+		{
+			itt.second->bStopRequested = true;
+			itt.second->cvFrame.notify_all();
+			if (itt.second->pThread)
+				threads.push_back(itt.second->pThread);
+		}
+		m_streams.clear();
+	}
+	//joined outside the lock, the fetches need it to finish
+	for (auto & itt : threads)
+		itt->join();
 }
 
 std::string WrapBase64(const std::string &szSource, const size_t lsize = 72)
@@ -336,15 +599,12 @@ bool CCameraHandler::EmailCameraSnapshot(const std::string &CamIdx, const std::s
 
 	for (const auto & camIt : splitresults)
 	{
-		std::vector<unsigned char> camimage;
+		CameraFramePtr pFrame;
 
-		if (!TakeSnapshot(camIt, camimage))
+		if (!TakeSnapshot(std::stoull(camIt), pFrame))
 			return false;
 
-		std::vector<char> filedata;
-		filedata.insert(filedata.begin(), camimage.begin(), camimage.end());
-		std::string imgstring;
-		imgstring.insert(imgstring.end(), filedata.begin(), filedata.end());
+		std::string imgstring(pFrame->begin(), pFrame->end());
 		imgstring = base64_encode(imgstring);
 		imgstring = WrapBase64(imgstring);
 
@@ -449,15 +709,15 @@ namespace http {
 
 		void CWebServer::GetCameraSnapshot(WebEmSession & session, const request& req, reply & rep)
 		{
-			std::vector<unsigned char> camimage;
+			CameraFramePtr pFrame;
 			std::string idx = request::findValue(&req, "idx");
 			if (idx == "") {
 				return;
 			}
-			if (!m_mainworker.m_cameras.TakeSnapshot(idx, camimage)) {
+			if (!m_mainworker.m_cameras.TakeSnapshot(std::stoull(idx), pFrame)) {
 				return;
 			}
-			reply::set_content(&rep, camimage.begin(), camimage.end());
+			reply::set_content(&rep, pFrame->begin(), pFrame->end());
 			reply::add_header_attachment(&rep, "snapshot.jpg");
 		}
 
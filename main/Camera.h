@@ -1,6 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+
+//A camera image, shared by everyone that requested it
+typedef std::shared_ptr<const std::vector<unsigned char> > CameraFramePtr;
 
 class CCameraHandler
 {
@@ -29,6 +38,21 @@ class CCameraHandler
 		std::string ImageURL;
 		std::vector<cameraActiveDevice> mActiveDevices;
 	};
+
+	//Latest image of a camera. Only one fetch per camera runs at a time, requesters
+	//that arrive while it runs wait for its image. For cameras that send an MJPEG
+	//stream the fetch keeps reading frames as long as they are being requested.
+	struct cameraStream
+	{
+		CameraFramePtr pFrame;
+		uint64_t FrameNr;
+		std::chrono::steady_clock::time_point tFrame;
+		std::chrono::steady_clock::time_point tLastRequest;
+		bool bFetching;
+		bool bStopRequested;
+		std::shared_ptr<std::thread> pThread;
+		std::condition_variable cvFrame;
+	};
 public:
 	CCameraHandler(void);
 	~CCameraHandler(void);
@@ -37,6 +61,10 @@ public:
 
 	bool TakeSnapshot(const uint64_t CamID, std::vector<unsigned char> &camimage);
 	bool TakeSnapshot(const std::string &CamID, std::vector<unsigned char> &camimage);
+	//Returns the cached image when it is not older than the snapshot max age
+	bool TakeSnapshot(const uint64_t CamID, CameraFramePtr &pFrame);
+	void SetSnapshotMaxAge(const int MaxAgeMs);
+	void StopStreams();
 	bool TakeRaspberrySnapshot(std::vector<unsigned char> &camimage);
 	bool TakeUVCSnapshot(const std::string &device, std::vector<unsigned char> &camimage);
 	cameraDevice* GetCamera(const uint64_t CamID);
@@ -50,8 +78,14 @@ public:
 	std::string GetCameraURL(const uint64_t CamID);
 private:
 	void ReloadCameraActiveDevices(const std::string &CamID);
+	void Do_Fetch(std::shared_ptr<cameraStream> pStream, const std::string &szURL, const std::string &ImageURL, const std::string &Username);
+	void PublishFrame(cameraStream *pStream, std::vector<unsigned char> &image);
 
 	std::mutex m_mutex;
+	std::mutex m_captureMutex;
+	std::mutex m_streamMutex;
+	std::map<uint64_t, std::shared_ptr<cameraStream> > m_streams;
+	int m_SnapshotMaxAgeMs;
 	unsigned char m_seconds_counter;
 	std::vector<cameraDevice> m_cameradevices;
 };
@@ -0,0 +1,120 @@
+#include "stdafx.h"
+#include "DeviceTimeoutTracker.h"
+
+CDeviceTimeoutTracker::CDeviceTimeoutTracker() :
+	m_Generation(0)
+{
+}
+
+CDeviceTimeoutTracker::~CDeviceTimeoutTracker()
+{
+}
+
+void CDeviceTimeoutTracker::Push(const uint64_t DeviceRowIdx, const _eTimeoutType Type, const time_t Deadline)
+{
+	_tDeadline entry;
+	entry.Deadline = Deadline;
+	entry.DeviceRowIdx = DeviceRowIdx;
+	entry.Type = Type;
+	entry.Generation = ++m_Generation;
+	m_heap.push(entry);
+
+	_tPending &pending = m_pending[tDeadlineKey(DeviceRowIdx, Type)];
+	pending.Deadline = Deadline;
+	pending.Generation = entry.Generation;
+
+	//devices that report often leave a lot of stale entries behind
+	if (m_heap.size() > (m_pending.size() * 4) + 64)
+		Compact();
+}
+
+void CDeviceTimeoutTracker::Compact()
+{
+	std::vector<_tDeadline> entries;
+	entries.reserve(m_pending.size());
+	for (const auto & itt : m_pending)
+	{
+		_tDeadline entry;
+		entry.Deadline = itt.second.Deadline;
+		entry.DeviceRowIdx = itt.first.first;
+		entry.Type = itt.first.second;
+		entry.Generation = itt.second.Generation;
+		entries.push_back(entry);
+	}
+	m_heap = std::priority_queue<_tDeadline, std::vector<_tDeadline>, std::greater<_tDeadline> >(std::greater<_tDeadline>(), entries);
+}
+
+void CDeviceTimeoutTracker::Schedule(const uint64_t DeviceRowIdx, const _eTimeoutType Type, const time_t Deadline)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (Deadline == 0)
+	{
+		m_pending.erase(tDeadlineKey(DeviceRowIdx, Type));
+		return;
+	}
+	std::map<tDeadlineKey, _tPending>::const_iterator itt = m_pending.find(tDeadlineKey(DeviceRowIdx, Type));
+	if ((itt != m_pending.end()) && (itt->second.Deadline == Deadline))
+		return;
+	Push(DeviceRowIdx, Type, Deadline);
+}
+
+void CDeviceTimeoutTracker::ScheduleIfIdle(const uint64_t DeviceRowIdx, const _eTimeoutType Type, const time_t Deadline)
+{
+	if (Deadline == 0)
+		return;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_pending.find(tDeadlineKey(DeviceRowIdx, Type)) != m_pending.end())
+		return;
+	Push(DeviceRowIdx, Type, Deadline);
+}
+
+void CDeviceTimeoutTracker::Remove(const uint64_t DeviceRowIdx)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_pending.erase(tDeadlineKey(DeviceRowIdx, TIMEOUT_SENSOR));
+	m_pending.erase(tDeadlineKey(DeviceRowIdx, TIMEOUT_NOTIFICATION));
+}
+
+void CDeviceTimeoutTracker::Clear(const _eTimeoutType Type)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::map<tDeadlineKey, _tPending>::iterator itt = m_pending.begin();
+	while (itt != m_pending.end())
+	{
+		if (itt->first.second == Type)
+			itt = m_pending.erase(itt);
+		else
+			++itt;
+	}
+	Compact();
+}
+
+bool CDeviceTimeoutTracker::PopDue(const time_t Now, uint64_t &DeviceRowIdx, _eTimeoutType &Type)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_heap.empty())
+	{
+		const _tDeadline &top = m_heap.top();
+		std::map<tDeadlineKey, _tPending>::iterator itt = m_pending.find(tDeadlineKey(top.DeviceRowIdx, top.Type));
+		if ((itt == m_pending.end()) || (itt->second.Generation != top.Generation))
+		{
+			//rescheduled or removed
+			m_heap.pop();
+			continue;
+		}
+		if (top.Deadline > Now)
+			return false;
+		DeviceRowIdx = top.DeviceRowIdx;
+		Type = top.Type;
+		m_pending.erase(itt);
+		m_heap.pop();
+		return true;
+	}
+	return false;
+}
+
+size_t CDeviceTimeoutTracker::Count()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_pending.size();
+}
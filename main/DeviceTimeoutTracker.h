@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+/*
+ * Keeps the next moment a device has to be looked at (sensor timeout, last update
+ * notification) in a min-heap, so the main worker only handles the devices that are
+ * due instead of scanning all devices and notifications.
+ * Rescheduling a device does not search the heap, the old entry is left behind and
+ * skipped when it is popped.
+ */
+class CDeviceTimeoutTracker
+{
+public:
+	enum _eTimeoutType
+	{
+		TIMEOUT_SENSOR = 0,		//sensor did not report within the SensorTimeout
+		TIMEOUT_NOTIFICATION,	//last update notification rules of the device
+	};
+
+	CDeviceTimeoutTracker();
+	~CDeviceTimeoutTracker();
+
+	//Sets the deadline of a device, replacing a pending one (Deadline 0 removes it)
+	void Schedule(const uint64_t DeviceRowIdx, const _eTimeoutType Type, const time_t Deadline);
+	//Only sets the deadline when the device has none pending
+	void ScheduleIfIdle(const uint64_t DeviceRowIdx, const _eTimeoutType Type, const time_t Deadline);
+	void Remove(const uint64_t DeviceRowIdx);
+	void Clear(const _eTimeoutType Type);
+
+	//Returns true and removes the earliest deadline when it is due
+	bool PopDue(const time_t Now, uint64_t &DeviceRowIdx, _eTimeoutType &Type);
+
+	size_t Count();
+private:
+	struct _tDeadline
+	{
+		time_t Deadline;
+		uint64_t DeviceRowIdx;
+		_eTimeoutType Type;
+		uint64_t Generation;
+		bool operator>(const _tDeadline &other) const
+		{
+			return Deadline > other.Deadline;
+		}
+	};
+	typedef std::pair<uint64_t, _eTimeoutType> tDeadlineKey;
+	struct _tPending
+	{
+		time_t Deadline;
+		uint64_t Generation;
+	};
+
+	void Push(const uint64_t DeviceRowIdx, const _eTimeoutType Type, const time_t Deadline);
+	void Compact();
+
+	std::mutex m_mutex;
+	std::priority_queue<_tDeadline, std::vector<_tDeadline>, std::greater<_tDeadline> > m_heap;
+	std::map<tDeadlineKey, _tPending> m_pending;
+	uint64_t m_Generation;
+};
@@ -0,0 +1,284 @@
+#include "stdafx.h"
+#include "DeviceUpdateBus.h"
+#include "Helper.h"
+#include "Logger.h"
+#include "SQLHelper.h"
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+
+CDeviceUpdateBus::CSubscriber::CSubscriber(const std::string &Name, const tHandler &handler, const size_t MaxQueueSize, const _eQueuePolicy Policy) :
+	m_Name(Name),
+	m_handler(handler),
+	m_MaxQueueSize((MaxQueueSize > 0) ? MaxQueueSize : 1),
+	m_Policy(Policy),
+	m_bStopRequested(false)
+{
+	ResetStats();
+}
+
+CDeviceUpdateBus::CSubscriber::~CSubscriber()
+{
+	Stop();
+}
+
+void CDeviceUpdateBus::CSubscriber::Start()
+{
+	//the thread keeps the subscriber alive, it can be unsubscribed from within its own handler
+	m_thread = std::make_shared<std::thread>(&CDeviceUpdateBus::CSubscriber::Do_Work, this, shared_from_this());
+	std::string tname = "DevUpd_" + m_Name;
+	SetThreadName(m_thread->native_handle(), tname.substr(0, 15).c_str());
+}
+
+void CDeviceUpdateBus::CSubscriber::Stop()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_bStopRequested = true;
+		m_queue.clear();
+	}
+	m_cvNotEmpty.notify_all();
+	m_cvNotFull.notify_all();
+	if (m_thread)
+	{
+		if (m_thread->get_id() == std::this_thread::get_id())
+			m_thread->detach(); //unsubscribing from within the handler
+		else
+			m_thread->join();
+		m_thread.reset();
+	}
+}
+
+void CDeviceUpdateBus::CSubscriber::Push(const DeviceUpdatePtr &pUpdate)
+{
+	_tQueueItem item;
+	item.pUpdate = pUpdate;
+	item.tPublished = std::chrono::steady_clock::now();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_bStopRequested)
+		return;
+	if (m_queue.size() >= m_MaxQueueSize)
+	{
+		if (m_Policy == QPOLICY_BLOCK)
+		{
+			while ((m_queue.size() >= m_MaxQueueSize) && (!m_bStopRequested))
+				m_cvNotFull.wait(lock);
+			if (m_bStopRequested)
+				return;
+		}
+		else
+		{
+			if (m_Dropped % 1000 == 0)
+				_log.Log(LOG_ERROR, "DeviceUpdates: %s can not keep up, dropping updates (queue size: %d)", m_Name.c_str(), (int)m_MaxQueueSize);
+			m_queue.pop_front();
+			m_Dropped++;
+		}
+	}
+	m_queue.push_back(item);
+	if (m_queue.size() > m_PeakQueueSize)
+		m_PeakQueueSize = m_queue.size();
+	lock.unlock();
+	m_cvNotEmpty.notify_one();
+}
+
+void CDeviceUpdateBus::CSubscriber::Do_Work(std::shared_ptr<CSubscriber> self)
+{
+	while (true)
+	{
+		_tQueueItem item;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_queue.empty() && (!m_bStopRequested))
+				m_cvNotEmpty.wait(lock);
+			if (m_bStopRequested)
+				break;
+			item = m_queue.front();
+			m_queue.pop_front();
+		}
+		m_cvNotFull.notify_one();
+
+		std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+		try
+		{
+			m_handler(item.pUpdate);
+		}
+		catch (const std::exception &e)
+		{
+			_log.Log(LOG_ERROR, "DeviceUpdates: %s: exception handling update of device %" PRIu64 ": %s", m_Name.c_str(), item.pUpdate->DeviceRowIdx, e.what());
+		}
+		catch (...)
+		{
+			_log.Log(LOG_ERROR, "DeviceUpdates: %s: exception handling update of device %" PRIu64, m_Name.c_str(), item.pUpdate->DeviceRowIdx);
+		}
+		std::chrono::steady_clock::time_point tEnd = std::chrono::steady_clock::now();
+
+		uint64_t lag = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(tStart - item.tPublished).count();
+		uint64_t handle = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(tEnd - tStart).count();
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_Delivered++;
+		m_TotalLagMs += lag;
+		if (lag > m_MaxLagMs)
+			m_MaxLagMs = lag;
+		m_TotalHandleMs += handle;
+		if (handle > m_MaxHandleMs)
+			m_MaxHandleMs = handle;
+	}
+}
+
+void CDeviceUpdateBus::CSubscriber::GetStats(_tSubscriberStats &stats)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	stats.Name = m_Name;
+	stats.Policy = m_Policy;
+	stats.QueueSize = m_queue.size();
+	stats.MaxQueueSize = m_MaxQueueSize;
+	stats.PeakQueueSize = m_PeakQueueSize;
+	stats.Delivered = m_Delivered;
+	stats.Dropped = m_Dropped;
+	stats.AvgLagMs = (m_Delivered > 0) ? m_TotalLagMs / m_Delivered : 0;
+	stats.MaxLagMs = m_MaxLagMs;
+	stats.AvgHandleMs = (m_Delivered > 0) ? m_TotalHandleMs / m_Delivered : 0;
+	stats.MaxHandleMs = m_MaxHandleMs;
+}
+
+void CDeviceUpdateBus::CSubscriber::ResetStats()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_PeakQueueSize = m_queue.size();
+	m_Delivered = 0;
+	m_Dropped = 0;
+	m_TotalLagMs = 0;
+	m_MaxLagMs = 0;
+	m_TotalHandleMs = 0;
+	m_MaxHandleMs = 0;
+}
+
+CDeviceUpdateBus::CDeviceUpdateBus() :
+	m_NextSubscriptionID(1)
+{
+}
+
+CDeviceUpdateBus::~CDeviceUpdateBus()
+{
+	std::map<int, std::shared_ptr<CSubscriber> > subscribers;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		subscribers.swap(m_subscribers);
+	}
+	for (auto & itt : subscribers)
+		itt.second->Stop();
+}
+
+int CDeviceUpdateBus::Subscribe(const std::string &Name, const tHandler &handler, const size_t MaxQueueSize, const _eQueuePolicy Policy)
+{
+	std::shared_ptr<CSubscriber> pSubscriber = std::make_shared<CSubscriber>(Name, handler, MaxQueueSize, Policy);
+	pSubscriber->Start();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	int SubscriptionID = m_NextSubscriptionID++;
+	m_subscribers[SubscriptionID] = pSubscriber;
+	return SubscriptionID;
+}
+
+void CDeviceUpdateBus::Unsubscribe(const int SubscriptionID)
+{
+	std::shared_ptr<CSubscriber> pSubscriber;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		std::map<int, std::shared_ptr<CSubscriber> >::iterator itt = m_subscribers.find(SubscriptionID);
+		if (itt == m_subscribers.end())
+			return;
+		pSubscriber = itt->second;
+		m_subscribers.erase(itt);
+	}
+	//stopped outside the lock, the subscriber could be publishing or (un)subscribing itself
+	pSubscriber->Stop();
+}
+
+DeviceUpdatePtr CDeviceUpdateBus::CreateSnapshot(const int HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const uint8_t *pRXCommand)
+{
+	std::shared_ptr<_tDeviceUpdate> pUpdate = std::make_shared<_tDeviceUpdate>();
+	pUpdate->HwdID = HwdID;
+	pUpdate->DeviceRowIdx = DeviceRowIdx;
+	pUpdate->DeviceName = DeviceName;
+	if (pRXCommand != NULL)
+		pUpdate->RXCommand.assign(pRXCommand, pRXCommand + pRXCommand[0] + 1);
+
+	std::vector<std::vector<std::string> > result;
+	result = m_sql.safe_query(
+		"SELECT HardwareID, DeviceID, Unit, Name, [Type], SubType, SwitchType, nValue, sValue, SignalLevel, BatteryLevel, Options, Description, LastLevel, Color, LastUpdate, strftime('%%s', LastUpdate) "
+		"FROM DeviceStatus WHERE (ID==%" PRIu64 ")", DeviceRowIdx);
+	pUpdate->bHaveStatus = !result.empty();
+	if (pUpdate->bHaveStatus)
+	{
+		const std::vector<std::string> &sd = result[0];
+		pUpdate->HardwareID = atoi(sd[0].c_str());
+		pUpdate->DeviceID = sd[1];
+		pUpdate->Unit = atoi(sd[2].c_str());
+		pUpdate->Name = sd[3];
+		pUpdate->Type = atoi(sd[4].c_str());
+		pUpdate->SubType = atoi(sd[5].c_str());
+		pUpdate->SwitchType = atoi(sd[6].c_str());
+		pUpdate->nValue = atoi(sd[7].c_str());
+		pUpdate->sValue = sd[8];
+		pUpdate->SignalLevel = atoi(sd[9].c_str());
+		pUpdate->BatteryLevel = atoi(sd[10].c_str());
+		pUpdate->Options = sd[11];
+		pUpdate->Description = sd[12];
+		pUpdate->LastLevel = atoi(sd[13].c_str());
+		pUpdate->Color = sd[14];
+		pUpdate->LastUpdate = sd[15];
+		pUpdate->LastUpdateSeconds = std::strtoll(sd[16].c_str(), nullptr, 10);
+	}
+	else
+	{
+		pUpdate->HardwareID = HwdID;
+		pUpdate->Unit = 0;
+		pUpdate->Type = 0;
+		pUpdate->SubType = 0;
+		pUpdate->SwitchType = 0;
+		pUpdate->nValue = 0;
+		pUpdate->SignalLevel = 0;
+		pUpdate->BatteryLevel = 0;
+		pUpdate->LastLevel = 0;
+		pUpdate->LastUpdateSeconds = 0;
+	}
+	return pUpdate;
+}
+
+void CDeviceUpdateBus::Publish(const int HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const uint8_t *pRXCommand)
+{
+	std::vector<std::shared_ptr<CSubscriber> > subscribers;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_subscribers.empty())
+			return;
+		subscribers.reserve(m_subscribers.size());
+		for (const auto & itt : m_subscribers)
+			subscribers.push_back(itt.second);
+	}
+
+	DeviceUpdatePtr pUpdate = CreateSnapshot(HwdID, DeviceRowIdx, DeviceName, pRXCommand);
+	for (const auto & itt : subscribers)
+		itt->Push(pUpdate);
+}
+
+void CDeviceUpdateBus::GetStats(std::vector<_tSubscriberStats> &stats)
+{
+	stats.clear();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (const auto & itt : m_subscribers)
+	{
+		_tSubscriberStats sstats;
+		itt.second->GetStats(sstats);
+		stats.push_back(sstats);
+	}
+}
+
+void CDeviceUpdateBus::ResetStats()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (const auto & itt : m_subscribers)
+		itt.second->ResetStats();
+}
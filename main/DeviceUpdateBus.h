@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//Immutable snapshot of a device right after it has been updated, shared by all subscribers
+struct _tDeviceUpdate
+{
+	int HwdID;						//hardware that reported the update
+	uint64_t DeviceRowIdx;
+	std::string DeviceName;			//name as passed by the publisher
+	std::vector<uint8_t> RXCommand;	//received message, empty when the device was not updated by a received message
+
+	bool bHaveStatus;				//false when the device could not be found in DeviceStatus
+	int HardwareID;
+	std::string DeviceID;
+	int Unit;
+	std::string Name;
+	int Type;
+	int SubType;
+	int SwitchType;
+	int nValue;
+	std::string sValue;
+	int SignalLevel;
+	int BatteryLevel;
+	std::string Options;
+	std::string Description;
+	int LastLevel;
+	std::string Color;
+	std::string LastUpdate;
+	long long LastUpdateSeconds;	//strftime('%s', LastUpdate), as used by the push services
+};
+typedef std::shared_ptr<const _tDeviceUpdate> DeviceUpdatePtr;
+
+/*
+ * Delivers device updates to the subscribers (MQTT, push services, websockets, ...).
+ * Publishing only reads the device once and queues the snapshot, every subscriber
+ * runs on its own thread with a bounded queue so a slow subscriber does not stall
+ * the RX message processing or the other subscribers.
+ */
+class CDeviceUpdateBus
+{
+public:
+	enum _eQueuePolicy
+	{
+		QPOLICY_DROP_OLDEST = 0,	//drop the oldest queued update when the queue is full
+		QPOLICY_BLOCK,				//the publisher waits until there is room in the queue
+	};
+	typedef std::function<void(const DeviceUpdatePtr &pUpdate)> tHandler;
+
+	struct _tSubscriberStats
+	{
+		std::string Name;
+		_eQueuePolicy Policy;
+		size_t QueueSize;
+		size_t MaxQueueSize;
+		size_t PeakQueueSize;
+		uint64_t Delivered;
+		uint64_t Dropped;
+		uint64_t AvgLagMs;			//time between publishing and handling an update
+		uint64_t MaxLagMs;
+		uint64_t AvgHandleMs;		//time spent in the handler
+		uint64_t MaxHandleMs;
+	};
+
+	CDeviceUpdateBus();
+	~CDeviceUpdateBus();
+
+	//Returns the subscription id, needed to unsubscribe
+	int Subscribe(const std::string &Name, const tHandler &handler, const size_t MaxQueueSize = 1000, const _eQueuePolicy Policy = QPOLICY_DROP_OLDEST);
+	//Stops the subscriber thread, updates still in its queue are discarded
+	void Unsubscribe(const int SubscriptionID);
+
+	void Publish(const int HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const uint8_t *pRXCommand);
+
+	//Reads the current state of a device (for subscribers that are asked for a device outside an update)
+	static DeviceUpdatePtr CreateSnapshot(const int HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const uint8_t *pRXCommand);
+
+	void GetStats(std::vector<_tSubscriberStats> &stats);
+	void ResetStats();
+private:
+	struct _tQueueItem
+	{
+		DeviceUpdatePtr pUpdate;
+		std::chrono::steady_clock::time_point tPublished;
+	};
+	class CSubscriber : public std::enable_shared_from_this<CSubscriber>
+	{
+	public:
+		CSubscriber(const std::string &Name, const tHandler &handler, const size_t MaxQueueSize, const _eQueuePolicy Policy);
+		~CSubscriber();
+		void Start();
+		void Stop();
+		void Push(const DeviceUpdatePtr &pUpdate);
+		void GetStats(_tSubscriberStats &stats);
+		void ResetStats();
+	private:
+		void Do_Work(std::shared_ptr<CSubscriber> self);
+
+		std::string m_Name;
+		tHandler m_handler;
+		size_t m_MaxQueueSize;
+		_eQueuePolicy m_Policy;
+
+		std::mutex m_mutex;
+		std::condition_variable m_cvNotEmpty;
+		std::condition_variable m_cvNotFull;
+		std::deque<_tQueueItem> m_queue;
+		bool m_bStopRequested;
+		std::shared_ptr<std::thread> m_thread;
+
+		size_t m_PeakQueueSize;
+		uint64_t m_Delivered;
+		uint64_t m_Dropped;
+		uint64_t m_TotalLagMs;
+		uint64_t m_MaxLagMs;
+		uint64_t m_TotalHandleMs;
+		uint64_t m_MaxHandleMs;
+	};
+
+	std::mutex m_mutex;
+	std::map<int, std::shared_ptr<CSubscriber> > m_subscribers;
+	int m_NextSubscriptionID;
+};
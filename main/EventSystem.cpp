@@ -182,6 +182,14 @@ void CEventSystem::StopEventSystem()
 #ifdef ENABLE_PYTHON
 	Plugins::PythonEventsStop();
 #endif
+	CdzVents::GetInstance()->CloseLuaState();
+
+	boost::unique_lock<boost::shared_mutex> eventsMutexLock(m_eventsMutex);
+	if (m_blockly_state != NULL)
+	{
+		lua_close(m_blockly_state);
+		m_blockly_state = NULL;
+	}
 }
 
 void CEventSystem::SetEnabled(const bool bEnabled)
@@ -211,10 +219,25 @@ void CEventSystem::LoadEvents()
 	dzvents->m_scriptsDir = szUserDataFolder + "scripts/dzVents/scripts/";
 	dzvents->m_runtimeDir = szStartupFolder + "dzVents/runtime/";
 #endif
+	//shared modules, the runtime is restarted when they change
+	std::vector<std::string> dzv_ModuleDirs;
+#ifdef WIN32
+	dzv_ModuleDirs.push_back(dzvents->m_scriptsDir + "modules\\");
+	dzv_ModuleDirs.push_back(szUserDataFolder + "scripts\\dzVents\\modules\\");
+#else
+	dzv_ModuleDirs.push_back(dzvents->m_scriptsDir + "modules/");
+	dzv_ModuleDirs.push_back(szUserDataFolder + "scripts/dzVents/modules/");
+#endif
+	dzvents->m_scripts.SetFolders(dzvents->m_scriptsDir, dzv_Dir, dzv_ModuleDirs);
 
 	boost::unique_lock<boost::shared_mutex> eventsMutexLock(m_eventsMutex);
 	_log.Log(LOG_STATUS, "EventSystem: reset all events...");
 	m_events.clear();
+	if (m_blockly_state != NULL)
+	{
+		lua_close(m_blockly_state);
+		m_blockly_state = NULL;
+	}
 
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query(
@@ -238,6 +261,8 @@ void CEventSystem::LoadEvents()
 			eitem.Actions = sd[3];
 			eitem.EventStatus = atoi(sd[4].c_str());
 			eitem.SequenceNo = atoi(sd[5].c_str());
+			if (eitem.Interpreter == "Blockly")
+				CompileBlocklyEvent(eitem);
 			m_events.push_back(eitem);
 		}
 	}
@@ -295,6 +320,8 @@ void CEventSystem::LoadEvents()
 			}
 		}
 	}
+	//the watcher would notice too, but the runtime could be started before its events arrive
+	dzvents->m_scripts.Invalidate();
 #ifdef _DEBUG
 	_log.Log(LOG_STATUS, "EventSystem: Events (re)loaded");
 #endif
@@ -1579,23 +1606,8 @@ void CEventSystem::EvaluateEvent(const std::vector<_tEventQueue> &items)
 	if (!m_sql.m_bDisableDzVentsSystem)
 	{
 		CdzVents* dzvents = CdzVents::GetInstance();
-		if (dzvents->m_bdzVentsExist)
+		if ((dzvents->m_bdzVentsExist) || (dzvents->m_scripts.HaveScripts()))
 			EvaluateLua(items, dzvents->m_runtimeDir + "dzVents.lua", "");
-		else
-		{
-			DirectoryListing(FileEntries, dzvents->m_scriptsDir, false, true);
-			for (itt2 = FileEntries.begin(); itt2 != FileEntries.end(); ++itt2)
-			{
-				filename = *itt2;
-				if (filename.length() > 4 &&
-					filename.compare(filename.length() - 4, 4, ".lua") == 0)
-				{
-					EvaluateLua(items, dzvents->m_runtimeDir + "dzVents.lua", "");
-					break;
-				}
-			}
-			FileEntries.clear();
-		}
 	}
 
 	bool bDeviceFileFound = false;
@@ -1724,6 +1736,12 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 	lua_pushcfunction(lua_state, l_domoticz_print);
 	lua_setglobal(lua_state, "print");
 
+	return lua_state;
+}
+
+//(Re)sets the device, variable and measurement tables the Blockly conditions are evaluated against
+void CEventSystem::ExportBlocklyStates(lua_State *lua_state)
+{
 	boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
 	lua_createtable(lua_state, (int)m_devicestates.size(), 0);
 
@@ -1779,6 +1797,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "temperaturedevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "temperaturedevice");
+	}
 	if (m_dewValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_dewValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1790,6 +1813,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "dewpointdevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "dewpointdevice");
+	}
 	if (m_humValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_humValuesByID.size(), 0);
 		std::map<uint64_t, int>::iterator p;
@@ -1801,6 +1829,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "humiditydevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "humiditydevice");
+	}
 	if (m_baroValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_baroValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1812,6 +1845,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "barometerdevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "barometerdevice");
+	}
 	if (m_utilityValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_utilityValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1823,6 +1861,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "utilitydevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "utilitydevice");
+	}
 	if (m_weatherValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_weatherValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1834,6 +1877,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "weatherdevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "weatherdevice");
+	}
 	if (m_rainValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_rainValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1845,6 +1893,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "raindevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "raindevice");
+	}
 	if (m_rainLastHourValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_rainLastHourValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1856,6 +1909,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "rainlasthourdevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "rainlasthourdevice");
+	}
 	if (m_uvValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_uvValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1867,6 +1925,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "uvdevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "uvdevice");
+	}
 	if (m_winddirValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_winddirValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1878,6 +1941,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "winddirdevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "winddirdevice");
+	}
 	if (m_windspeedValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_windspeedValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1889,6 +1957,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "windspeeddevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "windspeeddevice");
+	}
 	if (m_windgustValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_windgustValuesByID.size(), 0);
 		std::map<uint64_t, float>::iterator p;
@@ -1900,6 +1973,11 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "windgustdevice");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "windgustdevice");
+	}
 	if (m_zwaveAlarmValuesByID.size() > 0) {
 		lua_createtable(lua_state, (int)m_zwaveAlarmValuesByID.size(), 0);
 		std::map<uint64_t, int>::iterator p;
@@ -1911,43 +1989,89 @@ lua_State *CEventSystem::CreateBlocklyLuaState()
 		}
 		lua_setglobal(lua_state, "zwavealarms");
 	}
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "zwavealarms");
+	}
 
 	lua_pushnumber(lua_state, (lua_Number)m_SecStatus);
 	lua_setglobal(lua_state, "securitystatus");
 
-	return lua_state;
+	//@Sunrise and @Sunset placeholders in the conditions
+	lua_pushinteger(lua_state, getSunRiseSunSetMinutes("Sunrise"));
+	lua_setglobal(lua_state, "blockly_sunrise");
+	lua_pushinteger(lua_state, getSunRiseSunSetMinutes("Sunset"));
+	lua_setglobal(lua_state, "blockly_sunset");
 }
 
-lua_State *CEventSystem::ParseBlocklyLua(lua_State *lua_state, const _tEventItem &item)
+//Collects the numbers of all "<prefix>[<number>]" occurrences, as the trigger filter used to search for them in the conditions
+static void GetBracketedIndexes(const std::string &conditions, const std::string &prefix, std::set<uint64_t> &indexes)
 {
-	std::string conditions = item.Conditions;
-	// Replace Sunrise and sunset placeholder with actual time for query
-	if (conditions.find("@Sunrise") != std::string::npos)
+	std::string search = prefix + "[";
+	size_t pos = 0;
+	while ((pos = conditions.find(search, pos)) != std::string::npos)
 	{
-		stdreplace(conditions, "@Sunrise", std::to_string(getSunRiseSunSetMinutes("Sunrise")));
+		pos += search.size();
+		size_t epos = conditions.find_first_not_of("0123456789", pos);
+		if ((epos == std::string::npos) || (epos == pos) || (conditions[epos] != ']'))
+			continue;
+		std::string snum = conditions.substr(pos, epos - pos);
+		uint64_t idx = std::strtoull(snum.c_str(), nullptr, 10);
+		if ((idx > 0) && (std::to_string(idx) == snum))
+			indexes.insert(idx);
 	}
-	if (conditions.find("@Sunset") != std::string::npos)
+}
+
+void CEventSystem::CompileBlocklyEvent(_tEventItem &item)
+{
+	GetBracketedIndexes(item.Conditions, "", item.TriggerDevices);
+	GetBracketedIndexes(item.Conditions, "variable", item.TriggerVariables);
+	item.bTriggerSecurity = (item.Conditions.find("securitystatus") != std::string::npos);
+	// time rules will only run when time or date based criteria are found
+	item.bTriggerTime = ((item.Conditions.find("timeofday") != std::string::npos) || (item.Conditions.find("weekday") != std::string::npos));
+
+	CompileBlocklyActions(item.Actions, item.BlocklyActions);
+
+	if (m_blockly_state == NULL)
 	{
-		stdreplace(conditions, "@Sunset", std::to_string(getSunRiseSunSetMinutes("Sunset")));
+		m_blockly_state = CreateBlocklyLuaState();
+		if (m_blockly_state == NULL)
+		{
+			_log.Log(LOG_ERROR, "EventSystem: Could not create Lua state for Blockly events");
+			return;
+		}
 	}
 
+	std::string conditions = item.Conditions;
+	// Sunrise and sunset placeholders are set by ExportBlocklyStates
+	stdreplace(conditions, "@Sunrise", "blockly_sunrise");
+	stdreplace(conditions, "@Sunset", "blockly_sunset");
+
 	std::string ifCondition = "result = 0; weekday = os.date('*t')['wday']; timeofday = ((os.date('*t')['hour']*60)+os.date('*t')['min']); if " + conditions + " then result = 1 end; return result";
 
-	if (lua_state == NULL)
+	if (luaL_loadstring(m_blockly_state, ifCondition.c_str()) != LUA_OK)
 	{
-		lua_state = CreateBlocklyLuaState();
-		if (lua_state == NULL)
-			return NULL;
+		_log.Log(LOG_ERROR, "EventSystem: Lua script error (Blockly), Name: %s => %s", item.Name.c_str(), lua_tostring(m_blockly_state, -1));
+		lua_settop(m_blockly_state, 0);
+		return;
 	}
+	item.BlocklyCondition = luaL_ref(m_blockly_state, LUA_REGISTRYINDEX);
+}
+
+void CEventSystem::EvaluateBlockly(const _tEventItem &item)
+{
+	if ((m_blockly_state == NULL) || (item.BlocklyCondition == LUA_NOREF))
+		return;
 
-	//_log.Log(LOG_STATUS,"EventSystem: ifc: %s",ifCondition.c_str());
-	if (luaL_dostring(lua_state, ifCondition.c_str()))
+	lua_rawgeti(m_blockly_state, LUA_REGISTRYINDEX, item.BlocklyCondition);
+	if (lua_pcall(m_blockly_state, 0, 1, 0) != LUA_OK)
 	{
-		_log.Log(LOG_ERROR, "EventSystem: Lua script error (Blockly), Name: %s => %s", item.Name.c_str(), lua_tostring(lua_state, -1));
+		_log.Log(LOG_ERROR, "EventSystem: Lua script error (Blockly), Name: %s => %s", item.Name.c_str(), lua_tostring(m_blockly_state, -1));
 	}
 	else
 	{
-		lua_Number ruleTrue = lua_tonumber(lua_state, -1);
+		lua_Number ruleTrue = lua_tonumber(m_blockly_state, -1);
 		if (ruleTrue != 0)
 		{
 			if (m_sql.m_bLogEventScriptTrigger)
@@ -1955,12 +2079,12 @@ lua_State *CEventSystem::ParseBlocklyLua(lua_State *lua_state, const _tEventItem
 			parseBlocklyActions(item);
 		}
 	}
-	return lua_state;
+	lua_settop(m_blockly_state, 0);
 }
 
 void CEventSystem::EvaluateDatabaseEvents(const _tEventQueue &item)
 {
-	lua_State *lua_state = NULL;
+	bool bStatesExported = false;
 
 	boost::shared_lock<boost::shared_mutex> eventsMutexLock(m_eventsMutex);
 	std::vector<_tEventItem>::const_iterator it;
@@ -1975,36 +2099,25 @@ void CEventSystem::EvaluateDatabaseEvents(const _tEventQueue &item)
 			{
 				if (it->Interpreter == "Blockly")
 				{
-					std::size_t found = std::string::npos;
+					bool bTriggered = false;
 					if ((item.reason == REASON_DEVICE) && (item.id > 0))
-					{
-						std::stringstream sstr;
-						sstr << "[" << item.id << "]";
-						found = it->Conditions.find(sstr.str());
-					}
+						bTriggered = (it->TriggerDevices.find(item.id) != it->TriggerDevices.end());
 					else if (item.reason == REASON_SECURITY)
-					{
-						// security status change
-						std::stringstream sstr;
-						sstr << "securitystatus";
-						found = it->Conditions.find(sstr.str());
-					}
+						bTriggered = it->bTriggerSecurity;
 					else if (item.reason == REASON_TIME)
-					{
-						// time rules will only run when time or date based criteria are found
-						found = it->Conditions.find("timeofday");
-						if (found == std::string::npos)
-							found = it->Conditions.find("weekday");
-					}
+						bTriggered = it->bTriggerTime;
 					else if ((item.reason == REASON_USERVARIABLE) && (item.id > 0))
+						bTriggered = (it->TriggerVariables.find(item.id) != it->TriggerVariables.end());
+
+					if ((bTriggered) && (m_blockly_state != NULL))
 					{
-						std::stringstream sstr;
-						sstr << "variable[" << item.id << "]";
-						found = it->Conditions.find(sstr.str());
+						if (!bStatesExported)
+						{
+							ExportBlocklyStates(m_blockly_state);
+							bStatesExported = true;
+						}
+						EvaluateBlockly(*it);
 					}
-
-					if (found != std::string::npos)
-						lua_state = ParseBlocklyLua(lua_state, *it);
 				}
 				else if (it->Interpreter == "Lua")
 					EvaluateLua(item, it->Name, it->Actions);
@@ -2025,9 +2138,8 @@ void CEventSystem::EvaluateDatabaseEvents(const _tEventQueue &item)
 	{
 		_log.Log(LOG_ERROR, "EventSystem: Exception processing database scripts");
 	}
-
-	if (lua_state != NULL)
-		lua_close(lua_state);
+	if (m_blockly_state != NULL)
+		lua_settop(m_blockly_state, 0);
 }
 
 static inline long long GetIndexFromDevice(std::string devline)
@@ -2215,16 +2327,11 @@ std::string CEventSystem::ParseBlocklyString(const std::string &oString)
 	return retString;
 }
 
-bool CEventSystem::parseBlocklyActions(const _tEventItem &item)
+void CEventSystem::CompileBlocklyActions(const std::string &Actions, std::vector<_tBlocklyAction> &BlocklyActions)
 {
-	if (isEventscheduled(item.Name))
-	{
-		//_log.Log(LOG_NORM,"Already scheduled this event, skipping");
-		return false;
-	}
-	bool actionsDone = false;
+	BlocklyActions.clear();
 	std::string csubstr;
-	std::string tmpstr(item.Actions);
+	std::string tmpstr(Actions);
 	size_t sPos = 0, ePos;
 	do
 	{
@@ -2239,73 +2346,185 @@ bool CEventSystem::parseBlocklyActions(const _tEventItem &item)
 			csubstr = tmpstr;
 			tmpstr.clear();
 		}
-		sPos = csubstr.find_first_of("[");
-		ePos = csubstr.find_first_of("]");
 
-		if ((sPos == std::string::npos) || (ePos == std::string::npos))
-		{
-			_log.Log(LOG_ERROR, "EventSystem: Malformed action sequence!");
-			break;
-		}
+		_tBlocklyAction action;
+		action.Type = BLOCKLY_MALFORMED;
 
+		sPos = csubstr.find_first_of("[");
+		ePos = csubstr.find_first_of("]");
 		size_t eQPos = csubstr.find_first_of("=");
-		if (eQPos == std::string::npos) {
-			_log.Log(LOG_ERROR, "EventSystem: Malformed action sequence!");
+		if ((sPos == std::string::npos) || (ePos == std::string::npos) || (eQPos == std::string::npos))
+		{
+			BlocklyActions.push_back(action);
 			break;
 		}
-		std::string doWhat = csubstr.substr(eQPos + 1);
-		StripQuotes(doWhat);
+		action.doWhat = csubstr.substr(eQPos + 1);
+		StripQuotes(action.doWhat);
 
 		std::string deviceName = csubstr.substr(sPos + 1, ePos - sPos - 1);
 		if (deviceName.empty())
 		{
-			_log.Log(LOG_ERROR, "EventSystem: Malformed action sequence!");
+			BlocklyActions.push_back(action);
 			break;
 		}
+		action.Target = deviceName;
 
 		int deviceNo = atoi(deviceName.c_str());
 		if (deviceNo)
+		{
+			action.Type = BLOCKLY_DEVICE;
+			action.idx = deviceNo;
+		}
+		else if ((deviceName.find("Scene:") == 0) || (deviceName.find("Group:") == 0))
+		{
+			action.Type = BLOCKLY_SCENEGROUP;
+			action.sceneType = (deviceName.find("Group:") == 0) ? 2 : 1;
+			action.idx = atoi(deviceName.substr(6).c_str());
+			if (!action.idx)
+				continue;
+		}
+		else if (deviceName.find("Variable:") == 0)
+		{
+			action.Type = BLOCKLY_VARIABLE;
+			action.Target = deviceName.substr(9);
+			action.ParseResult.fAfterSec = 0;
+			ParseActionString(action.doWhat, action.ParseResult);
+			StripQuotes(action.ParseResult.sCommand);
+		}
+		else if (deviceName.find("Text:") == 0)
+		{
+			action.Type = BLOCKLY_TEXT;
+			action.Target = deviceName.substr(5);
+			action.ParseResult.fAfterSec = 0;
+			ParseActionString(action.doWhat, action.ParseResult);
+			StripQuotes(action.ParseResult.sCommand);
+		}
+		else if (deviceName.find("SendCamera:") == 0)
+		{
+			if (!atoi(deviceName.substr(11).c_str()))
+				continue;
+			action.Type = BLOCKLY_SENDCAMERA;
+		}
+		else if (deviceName.find("SetSetpoint:") == 0)
+		{
+			action.Type = BLOCKLY_SETSETPOINT;
+			action.idx = atoi(deviceName.substr(12).c_str());
+			StringSplit(action.doWhat, "#", action.Params);
+		}
+		else if (deviceName.find("SendEmail") != std::string::npos)
+		{
+			action.Type = BLOCKLY_SENDEMAIL;
+			StringSplit(action.doWhat, "#", action.Params);
+		}
+		else if (deviceName.find("SendSMS") != std::string::npos)
+			action.Type = BLOCKLY_SENDSMS;
+		else if (deviceName.find("TriggerIFTTT") != std::string::npos)
+		{
+			action.Type = BLOCKLY_TRIGGERIFTTT;
+			StringSplit(action.doWhat, "#", action.Params);
+		}
+		else if (deviceName.find("OpenURL") != std::string::npos)
+		{
+			action.Type = BLOCKLY_OPENURL;
+			action.ParseResult.fAfterSec = 0.2f;
+			ParseActionString(action.doWhat, action.ParseResult);
+		}
+		else if (deviceName.find("StartScript") != std::string::npos)
+		{
+			action.Type = BLOCKLY_STARTSCRIPT;
+			if (action.doWhat.empty())
+			{
+				//reported when the event fires
+				BlocklyActions.push_back(action);
+				break;
+			}
+			std::string sPath = action.doWhat;
+			size_t tpos = sPath.find('$');
+			if (tpos != std::string::npos)
+			{
+				sPath = sPath.substr(0, tpos);
+				action.Params.push_back(action.doWhat.substr(tpos + 1));
+			}
+#if !defined WIN32
+			if (sPath.find("/") != 0)
+				sPath = szUserDataFolder + "scripts/" + sPath;
+#endif
+			action.Target = sPath;
+		}
+		else if (deviceName.find("WriteToLog") != std::string::npos)
+		{
+			action.Type = BLOCKLY_WRITETOLOG;
+			action.Target = deviceName.substr(1, deviceName.size() - 2);
+		}
+		else if (deviceName.find("SendNotification") != std::string::npos)
+		{
+			action.Type = BLOCKLY_SENDNOTIFICATION;
+			StringSplit(action.doWhat, "#", action.Params);
+		}
+		else if (deviceName.find("CustomCommand:") == 0)
+		{
+			action.Type = BLOCKLY_CUSTOMCOMMAND;
+			action.idx = atoi(deviceName.substr(14).c_str());
+			action.ParseResult.fAfterSec = 0;
+			ParseActionString(action.doWhat, action.ParseResult);
+		}
+		else
+		{
+			action.Type = BLOCKLY_UNKNOWN;
+			action.Target = csubstr;
+			BlocklyActions.push_back(action);
+			break;
+		}
+		BlocklyActions.push_back(action);
+	} while ((sPos = tmpstr.find("commandArray[")) == 0);
+}
+
+bool CEventSystem::parseBlocklyActions(const _tEventItem &item)
+{
+	if (isEventscheduled(item.Name))
+	{
+		//_log.Log(LOG_NORM,"Already scheduled this event, skipping");
+		return false;
+	}
+	bool actionsDone = false;
+	for (const auto & action : item.BlocklyActions)
+	{
+		if (action.Type == BLOCKLY_MALFORMED)
+		{
+			_log.Log(LOG_ERROR, "EventSystem: Malformed action sequence!");
+			break;
+		}
+		else if (action.Type == BLOCKLY_UNKNOWN)
+		{
+			_log.Log(LOG_ERROR, "EventSystem: Unknown action sequence! (%s)", action.Target.c_str());
+			break;
+		}
+		else if (action.Type == BLOCKLY_DEVICE)
 		{
 			boost::shared_lock<boost::shared_mutex> devicestatesMutexLock(m_devicestatesMutex);
-			if (m_devicestates.count(deviceNo)) {
+			if (m_devicestates.count(action.idx)) {
 				devicestatesMutexLock.unlock(); // Unlock to avoid recursive lock (because the ScheduleEvent function locks again)
-				if (ScheduleEvent(deviceNo, doWhat, false, item.Name, 0)) {
+				if (ScheduleEvent(action.idx, action.doWhat, false, item.Name, 0)) {
 					actionsDone = true;
 				}
 			}
 			else {
-				reportMissingDevice(deviceNo, item);
+				devicestatesMutexLock.unlock();
+				reportMissingDevice(action.idx, item);
 			}
-			continue;
 		}
-
-		if ((deviceName.find("Scene:") == 0) || (deviceName.find("Group:") == 0))
+		else if (action.Type == BLOCKLY_SCENEGROUP)
 		{
-			int sceneType = 1;
-			if (deviceName.find("Group:") == 0)
-			{
-				sceneType = 2;
-			}
-			deviceNo = atoi(deviceName.substr(6).c_str());
-			if (deviceNo)
+			if (ScheduleEvent(action.idx, action.doWhat, true, item.Name, action.sceneType))
 			{
-				if (ScheduleEvent(deviceNo, doWhat, true, item.Name, sceneType))
-				{
-					actionsDone = true;
-				}
+				actionsDone = true;
 			}
-			continue;
 		}
-		else if (deviceName.find("Variable:") == 0)
+		else if (action.Type == BLOCKLY_VARIABLE)
 		{
-			std::string variableNo = deviceName.substr(9);
-			_tActionParseResults parseResult;
-			parseResult.fAfterSec = 0;
-			ParseActionString(doWhat, parseResult);
-			StripQuotes(parseResult.sCommand);
-
-			doWhat = ProcessVariableArgument(parseResult.sCommand);
-			if (parseResult.fAfterSec < (1. / timer_resolution_hz / 2))
+			const std::string &variableNo = action.Target;
+			std::string doWhat = ProcessVariableArgument(action.ParseResult.sCommand);
+			if (action.ParseResult.fAfterSec < (1. / timer_resolution_hz / 2))
 			{
 				std::vector<std::vector<std::string> > result;
 				result = m_sql.safe_query("SELECT Name, ValueType FROM UserVariables WHERE (ID == '%q')", variableNo.c_str());
@@ -2320,40 +2539,29 @@ bool CEventSystem::parseBlocklyActions(const _tEventItem &item)
 				}
 			}
 			else
-				m_sql.AddTaskItem(_tTaskItem::SetVariable(parseResult.fAfterSec, (const uint64_t)atol(variableNo.c_str()), doWhat, false));
+				m_sql.AddTaskItem(_tTaskItem::SetVariable(action.ParseResult.fAfterSec, (const uint64_t)atol(variableNo.c_str()), doWhat, false));
 
 			actionsDone = true;
-			continue;
 		}
-		else if (deviceName.find("Text:") == 0)
+		else if (action.Type == BLOCKLY_TEXT)
 		{
-			std::string variableName = deviceName.substr(5);
-			_tActionParseResults parseResult;
-			parseResult.fAfterSec = 0;
-			ParseActionString(doWhat, parseResult);
-			StripQuotes(parseResult.sCommand);
-
-			if (parseResult.fAfterSec < (1. / timer_resolution_hz / 2))
-				m_mainworker.UpdateDevice(std::stoi(variableName.c_str()), 0, parseResult.sCommand, 12, 255, false);
+			std::string sValue = action.ParseResult.sCommand;
+			if (action.ParseResult.fAfterSec < (1. / timer_resolution_hz / 2))
+				m_mainworker.UpdateDevice(std::stoi(action.Target.c_str()), 0, sValue, 12, 255, false);
 			else
-				m_sql.AddTaskItem(_tTaskItem::UpdateDevice(parseResult.fAfterSec, std::stoull(variableName.c_str()), 0, parseResult.sCommand, false, false));
+				m_sql.AddTaskItem(_tTaskItem::UpdateDevice(action.ParseResult.fAfterSec, std::stoull(action.Target.c_str()), 0, action.ParseResult.sCommand, false, false));
 
 			actionsDone = true;
 		}
-		else if (deviceName.find("SendCamera:") == 0)
+		else if (action.Type == BLOCKLY_SENDCAMERA)
 		{
-			if (!atoi(deviceName.substr(11).c_str()))
-				continue;
-			ScheduleEvent(deviceName, doWhat, item.Name);
+			ScheduleEvent(action.Target, action.doWhat, item.Name);
 			actionsDone = true;
-			continue;
 		}
-		else if (deviceName.find("SetSetpoint:") == 0)
+		else if (action.Type == BLOCKLY_SETSETPOINT)
 		{
-			int idx = atoi(deviceName.substr(12).c_str());
+			const std::vector<std::string> &aParam = action.Params;
 			std::string temp, mode, until;
-			std::vector<std::string> aParam;
-			StringSplit(doWhat, "#", aParam);
 			switch (aParam.size()) {
 			case 3:
 				until = ParseBlocklyString(aParam[2]);
@@ -2361,7 +2569,7 @@ bool CEventSystem::parseBlocklyActions(const _tEventItem &item)
 				mode = ParseBlocklyString(aParam[1]);
 			case 1:
 				temp = ParseBlocklyString(aParam[0]);
-				m_sql.AddTaskItem(_tTaskItem::SetSetPoint(0.5f, idx, temp, mode, until));
+				m_sql.AddTaskItem(_tTaskItem::SetSetPoint(0.5f, action.idx, temp, mode, until));
 				actionsDone = true;
 				break;
 
@@ -2370,44 +2578,36 @@ bool CEventSystem::parseBlocklyActions(const _tEventItem &item)
 				_log.Log(LOG_ERROR, "EventSystem: SetPoint, not enough parameters!");
 				break;
 			}
-			continue;
 		}
-		else if (deviceName.find("SendEmail") != std::string::npos)
+		else if (action.Type == BLOCKLY_SENDEMAIL)
 		{
-			std::string subject, body, to;
-			std::vector<std::string> aParam;
-			StringSplit(doWhat, "#", aParam);
+			const std::vector<std::string> &aParam = action.Params;
 			if (aParam.size() != 3)
 			{
 				//Invalid
 				_log.Log(LOG_ERROR, "EventSystem: SendEmail, not enough parameters!");
 				continue;
 			}
-			subject = ParseBlocklyString(aParam[0]);
-			body = ParseBlocklyString(aParam[1]);
+			std::string subject = ParseBlocklyString(aParam[0]);
+			std::string body = ParseBlocklyString(aParam[1]);
 			stdreplace(body, "\\n", "<br>");
-			to = aParam[2];
-			m_sql.AddTaskItem(_tTaskItem::SendEmailTo(1, subject, body, to));
+			m_sql.AddTaskItem(_tTaskItem::SendEmailTo(1, subject, body, aParam[2]));
 			actionsDone = true;
-			continue;
 		}
-		else if (deviceName.find("SendSMS") != std::string::npos)
+		else if (action.Type == BLOCKLY_SENDSMS)
 		{
-			if (doWhat.empty())
+			if (action.doWhat.empty())
 			{
 				//Invalid
 				_log.Log(LOG_ERROR, "EventSystem: SendSMS, not enough parameters!");
 				continue;
 			}
-			doWhat = ParseBlocklyString(doWhat);
-			m_sql.AddTaskItem(_tTaskItem::SendSMS(1, doWhat));
+			m_sql.AddTaskItem(_tTaskItem::SendSMS(1, ParseBlocklyString(action.doWhat)));
 			actionsDone = true;
-			continue;
 		}
-		else if (deviceName.find("TriggerIFTTT") != std::string::npos)
+		else if (action.Type == BLOCKLY_TRIGGERIFTTT)
 		{
-			std::vector<std::string> aParam;
-			StringSplit(doWhat, "#", aParam);
+			const std::vector<std::string> &aParam = action.Params;
 			if ((aParam.empty()) || (aParam.size() > 4))
 			{
 				//Invalid
@@ -2424,55 +2624,41 @@ bool CEventSystem::parseBlocklyActions(const _tEventItem &item)
 				sValue3 = ParseBlocklyString(aParam[3]);
 			m_sql.AddTaskItem(_tTaskItem::SendIFTTTTrigger(1, sID, sValue1, sValue2, sValue3));
 			actionsDone = true;
-			continue;
 		}
-		else if (deviceName.find("OpenURL") != std::string::npos)
+		else if (action.Type == BLOCKLY_OPENURL)
 		{
-			_tActionParseResults parseResult;
-			parseResult.fAfterSec = 0.2f;
-			ParseActionString(doWhat, parseResult);
-			OpenURL(parseResult.fAfterSec, parseResult.sCommand);
+			OpenURL(action.ParseResult.fAfterSec, action.ParseResult.sCommand);
 			actionsDone = true;
-			continue;
 		}
-		else if (deviceName.find("StartScript") != std::string::npos)
+		else if (action.Type == BLOCKLY_STARTSCRIPT)
 		{
-			if (doWhat.empty())
+			if (action.doWhat.empty())
 			{
 				//Invalid
 				_log.Log(LOG_ERROR, "EventSystem: StartScript, not enough parameters!");
 				break;
 			}
-			std::string sPath = doWhat;
 			std::string sParam = "";
-			size_t tpos = sPath.find('$');
-			if (tpos != std::string::npos)
-			{
-				sPath = sPath.substr(0, tpos);
-				sParam = doWhat.substr(tpos + 1);
-				sParam = ParseBlocklyString(sParam);
-			}
-#if !defined WIN32
-			if (sPath.find("/") != 0)
-				sPath = szUserDataFolder + "scripts/" + sPath;
-#endif
-
-			m_sql.AddTaskItem(_tTaskItem::ExecuteScript(0.2f, sPath, sParam));
+			if (!action.Params.empty())
+				sParam = ParseBlocklyString(action.Params[0]);
+			m_sql.AddTaskItem(_tTaskItem::ExecuteScript(0.2f, action.Target, sParam));
 			actionsDone = true;
-			continue;
 		}
-		else if (deviceName.find("WriteToLog") != std::string::npos)
+		else if (action.Type == BLOCKLY_WRITETOLOG)
 		{
-			std::string devNameNoQuotes = deviceName.substr(1, deviceName.size() - 2);
-			WriteToLog(devNameNoQuotes, doWhat);
+			WriteToLog(action.Target, action.doWhat);
 			actionsDone = true;
-			continue;
 		}
-		else if (deviceName.find("SendNotification") != std::string::npos)
+		else if (action.Type == BLOCKLY_SENDNOTIFICATION)
 		{
+			const std::vector<std::string> &aParam = action.Params;
+			if (aParam.empty())
+			{
+				//Invalid
+				_log.Log(LOG_ERROR, "EventSystem: SendNotification, not enough parameters!");
+				continue;
+			}
 			std::string subject, body, priority("0"), sound, subsystem;
-			std::vector<std::string> aParam;
-			StringSplit(doWhat, "#", aParam);
 			subject = body = aParam[0];
 			if (aParam.size() > 1)
 			{
@@ -2502,24 +2688,13 @@ bool CEventSystem::parseBlocklyActions(const _tEventItem &item)
 			}
 			m_sql.AddTaskItem(_tTaskItem::SendNotification(0, subject, body, std::string(""), atoi(priority.c_str()), sound, subsystem));
 			actionsDone = true;
-			continue;
 		}
-		else if (deviceName.find("CustomCommand:") == 0)
+		else if (action.Type == BLOCKLY_CUSTOMCOMMAND)
 		{
-			int idx = atoi(deviceName.substr(14).c_str());
-			_tActionParseResults parseResult;
-			parseResult.fAfterSec = 0;
-			ParseActionString(doWhat, parseResult);
-			m_sql.AddTaskItem(_tTaskItem::CustomCommand(parseResult.fAfterSec, idx, doWhat));
+			m_sql.AddTaskItem(_tTaskItem::CustomCommand(action.ParseResult.fAfterSec, action.idx, action.doWhat));
 			actionsDone = true;
-			continue;
-		}
-		else
-		{
-			_log.Log(LOG_ERROR, "EventSystem: Unknown action sequence! (%s)", csubstr.c_str());
-			break;
 		}
-	} while ((sPos = tmpstr.find("commandArray[")) == 0);
+	}
 	return actionsDone;
 }
 
@@ -3170,32 +3345,47 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 {
 	std::lock_guard<std::mutex> l(luaMutex);
 
-	lua_State *lua_state;
-	lua_state = luaL_newstate();
+	CdzVents* dzvents = CdzVents::GetInstance();
+	const bool bdzVents = (!m_sql.m_bDisableDzVentsSystem && filename == dzvents->m_runtimeDir + "dzVents.lua");
 
-	// load Lua libraries
-	static const luaL_Reg lualibs[] =
+	lua_State *lua_state;
+	bool bNewState = true;
+	if (bdzVents)
 	{
-		{ "base", luaopen_base },
-		{ "io", luaopen_io },
-		{ "table", luaopen_table },
-		{ "string", luaopen_string },
-		{ "math", luaopen_math },
-		{ NULL, NULL }
-	};
-
-	const luaL_Reg *lib = lualibs;
-	for (; lib->func != NULL; lib++)
+		//reused between runs, the runtime and the scripts are only loaded again when they change
+		lua_state = dzvents->AcquireLuaState(bNewState);
+	}
+	else
 	{
-		lib->func(lua_state);
-		lua_settop(lua_state, 0);
+		lua_state = luaL_newstate();
+
+		// load Lua libraries
+		static const luaL_Reg lualibs[] =
+		{
+			{ "base", luaopen_base },
+			{ "io", luaopen_io },
+			{ "table", luaopen_table },
+			{ "string", luaopen_string },
+			{ "math", luaopen_math },
+			{ NULL, NULL }
+		};
+
+		const luaL_Reg *lib = lualibs;
+		for (; lib->func != NULL; lib++)
+		{
+			lib->func(lua_state);
+			lua_settop(lua_state, 0);
+		}
 	}
 
-	lua_pushcfunction(lua_state, l_domoticz_applyJsonPath);
-	lua_setglobal(lua_state, "domoticz_applyJsonPath");
+	if (bNewState)
+	{
+		lua_pushcfunction(lua_state, l_domoticz_applyJsonPath);
+		lua_setglobal(lua_state, "domoticz_applyJsonPath");
 
-	lua_pushcfunction(lua_state, l_domoticz_applyXPath);
-	lua_setglobal(lua_state, "domoticz_applyXPath");
+		lua_pushcfunction(lua_state, l_domoticz_applyXPath);
+		lua_setglobal(lua_state, "domoticz_applyXPath");
+	}
 
 #ifdef _DEBUG
 	_log.Log(LOG_STATUS, "EventSystem: script %s trigger (%s)", m_szReason[items[0].reason].c_str(), filename.c_str());
@@ -3285,8 +3475,7 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 
 	int secstatus = 0;
 	m_sql.GetPreferencesVar("SecStatus", secstatus);
-	CdzVents* dzvents = CdzVents::GetInstance();
-	if (!m_sql.m_bDisableDzVentsSystem && filename == dzvents->m_runtimeDir + "dzVents.lua")
+	if (bdzVents)
 		dzvents->EvaluateDzVents(lua_state, items, secstatus);
 	else
 		EvaluateLuaClassic(lua_state, items[0], secstatus);
@@ -3301,7 +3490,7 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 	{
 		lua_sethook(lua_state, luaStop, LUA_MASKCOUNT, 10000000);
 
-		boost::thread luaThread(boost::bind(&CEventSystem::luaThread, this, lua_state, filename));
+		boost::thread luaThread(boost::bind(&CEventSystem::luaThread, this, lua_state, filename, bdzVents));
 		SetThreadName(luaThread.native_handle(), "luaThread");
 
 		if (!luaThread.timed_join(boost::posix_time::seconds(10)))
@@ -3316,7 +3505,10 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 	else
 	{
 		report_errors(lua_state, status, filename);
-		lua_close(lua_state);
+		if (bdzVents)
+			dzvents->ReleaseLuaState(lua_state);
+		else
+			lua_close(lua_state);
 		return;
 	}
 
@@ -3352,9 +3544,12 @@ void CEventSystem::EvaluateLua(const std::vector<_tEventQueue> &items, const std
 	*/
 }
 
-void CEventSystem::luaThread(lua_State *lua_state, const std::string &filename)
+void CEventSystem::luaThread(lua_State *lua_state, const std::string &filename, const bool bdzVents)
 {
 	int status;
+	//a reused (dzVents) state still has the commandArray of its previous run, it must not be executed again when this run fails early
+	lua_pushnil(lua_state);
+	lua_setglobal(lua_state, "commandArray");
 	status = lua_pcall(lua_state, 0, LUA_MULTRET, 0);
 	report_errors(lua_state, status, filename);
 
@@ -3379,7 +3574,10 @@ void CEventSystem::luaThread(lua_State *lua_state, const std::string &filename)
 			_log.Log(LOG_STATUS, "EventSystem: Script event triggered: %s", filename.c_str());
 	}
 
-	lua_close(lua_state);
+	if (bdzVents)
+		CdzVents::GetInstance()->ReleaseLuaState(lua_state);
+	else
+		lua_close(lua_state);
 
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <set>
 #include <string>
 #include <boost/thread/shared_mutex.hpp>
 
@@ -26,6 +27,49 @@ class CEventSystem : public CLuaCommon, StoppableTask
 	friend class CLuaHandler;
 	typedef struct lua_State lua_State;
 
+	struct _tActionParseResults
+	{
+		std::string sCommand;
+		float fForSec = 0;
+		float fAfterSec = 0;
+		float fRandomSec = 0;
+		int iRepeat = 1;
+		float fRepeatSec = 0;
+		bool bEventTrigger = false;
+	};
+
+	enum _eBlocklyActionType
+	{
+		BLOCKLY_DEVICE = 0,
+		BLOCKLY_SCENEGROUP,
+		BLOCKLY_VARIABLE,
+		BLOCKLY_TEXT,
+		BLOCKLY_SENDCAMERA,
+		BLOCKLY_SETSETPOINT,
+		BLOCKLY_SENDEMAIL,
+		BLOCKLY_SENDSMS,
+		BLOCKLY_TRIGGERIFTTT,
+		BLOCKLY_OPENURL,
+		BLOCKLY_STARTSCRIPT,
+		BLOCKLY_WRITETOLOG,
+		BLOCKLY_SENDNOTIFICATION,
+		BLOCKLY_CUSTOMCOMMAND,
+		BLOCKLY_MALFORMED,		//ends the action sequence with an error
+		BLOCKLY_UNKNOWN,		//ends the action sequence with an error
+	};
+
+	//One commandArray[...] entry of a Blockly event, parsed when the events are loaded
+	struct _tBlocklyAction
+	{
+		_eBlocklyActionType Type;
+		int idx = 0;						//device, scene/group (sceneType), setpoint or custom command idx
+		int sceneType = 0;
+		std::string Target;					//text between the brackets, or the script path for StartScript
+		std::string doWhat;
+		std::vector<std::string> Params;	//doWhat split on '#'
+		_tActionParseResults ParseResult;
+	};
+
 	struct _tEventItem
 	{
 		uint64_t ID;
@@ -37,17 +81,13 @@ class CEventSystem : public CLuaCommon, StoppableTask
 		int SequenceNo;
 		int EventStatus;
 
-	};
-
-	struct _tActionParseResults
-	{
-		std::string sCommand;
-		float fForSec = 0;
-		float fAfterSec = 0;
-		float fRandomSec = 0;
-		int iRepeat = 1;
-		float fRepeatSec = 0;
-		bool bEventTrigger = false;
+		//Blockly only, filled by CompileBlocklyEvent
+		std::set<uint64_t> TriggerDevices;		//device idx of every [idx] in the conditions
+		std::set<uint64_t> TriggerVariables;	//variable idx of every variable[idx] in the conditions
+		bool bTriggerSecurity = false;
+		bool bTriggerTime = false;
+		int BlocklyCondition = LUA_NOREF;		//compiled condition in the registry of m_blockly_state
+		std::vector<_tBlocklyAction> BlocklyActions;
 	};
 public:
 	enum _eReason
@@ -205,7 +245,9 @@ private:
 	std::string UpdateSingleState(const uint64_t ulDevID, const std::string &devname, const int nValue, const char* sValue, const unsigned char devType, const unsigned char subType, const _eSwitchType switchType, const std::string &lastUpdate, const unsigned char lastLevel, const std::map<std::string, std::string> & options);
 	void EvaluateEvent(const std::vector<_tEventQueue> &items);
 	void EvaluateDatabaseEvents(const _tEventQueue &item);
-	lua_State *ParseBlocklyLua(lua_State *lua_state, const _tEventItem &item);
+	void CompileBlocklyEvent(_tEventItem &item);
+	void CompileBlocklyActions(const std::string &Actions, std::vector<_tBlocklyAction> &BlocklyActions);
+	void EvaluateBlockly(const _tEventItem &item);
 	bool parseBlocklyActions(const _tEventItem &item);
 	std::string ProcessVariableArgument(const std::string &Argument);
 #ifdef ENABLE_PYTHON
@@ -214,7 +256,7 @@ private:
 #endif
 	void EvaluateLua(const _tEventQueue &item, const std::string &filename, const std::string &LuaString);
 	void EvaluateLua(const std::vector<_tEventQueue> &items, const std::string &filename, const std::string &LuaString);
-	void luaThread(lua_State *lua_state, const std::string &filename);
+	void luaThread(lua_State *lua_state, const std::string &filename, const bool bdzVents);
 	static void luaStop(lua_State *L, lua_Debug *ar);
 	std::string nValueToWording(const uint8_t dType, const uint8_t dSubType, const _eSwitchType switchtype, const int nValue, const std::string &sValue, const std::map<std::string, std::string> & options);
 	static int l_domoticz_print(lua_State* lua_state);
@@ -223,6 +265,7 @@ private:
 	bool ScheduleEvent(int deviceID, const std::string &Action, bool isScene, const std::string &eventName, int sceneType);
 	bool ScheduleEvent(std::string ID, const std::string &Action, const std::string &eventName);
 	lua_State *CreateBlocklyLuaState();
+	void ExportBlocklyStates(lua_State *lua_state);
 
 	std::string ParseBlocklyString(const std::string &oString);
 	void ParseActionString( const std::string &oAction_, _tActionParseResults &oResults_ );
@@ -234,6 +277,8 @@ private:
 
 	//std::string reciprocalAction (std::string Action);
 	std::vector<_tEventItem> m_events;
+	//holds the compiled Blockly conditions, replaced by LoadEvents (under m_eventsMutex) and only evaluated by the event queue thread
+	lua_State *m_blockly_state = NULL;
 
 
 	std::map<uint64_t, _tDeviceStatus> m_devicestates;
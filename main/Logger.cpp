@@ -6,7 +6,7 @@
 #include <algorithm>
 #include "localtime_r.h"
 #include "Helper.h"
-#include "mainworker.h"
+#include "WorkerServices.h"
 
 #ifndef WIN32
 #include <syslog.h>
@@ -221,7 +221,7 @@ void CLogger::Log(const _eLogLevel level, const char* logline, ...)
 			m_notification_log.push_back(_tLogLineStruct(level, szIntLog));
 			if ((m_notification_log.size() == 1) && (mytime(NULL) - m_LastLogNotificationsSend >= 5))
 			{
-				m_mainworker.ForceLogNotificationCheck();
+				g_pWorkerServices->ForceLogNotificationCheck();
 			}
 		}
 
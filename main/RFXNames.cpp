@@ -5,6 +5,7 @@
 #include "../hardware/hardwaretypes.h"
 #include "Helper.h"
 #include "Logger.h"
+#include <unordered_map>
 
 typedef struct _STR_TABLE_SINGLE {
 	unsigned long    id;
@@ -48,6 +49,79 @@ const char* findTableID1ID2(const _STR_TABLE_ID1_ID2* t, const unsigned long id1
 	return "Unknown";
 }
 
+//Lookup index over a table, built once on first use (function local static)
+//Ids below MAX_DIRECT_TABLE_ID are directly indexed, larger ids fall back to a hash map.
+//Like the linear search, the first entry of a duplicated id wins and the scan ends at the first entry without the wanted string
+#define MAX_DIRECT_TABLE_ID 1024
+
+class CTableIndexSingle
+{
+public:
+	CTableIndexSingle(const STR_TABLE_SINGLE* t, const int snum)
+	{
+		for (; (snum == 1) ? (t->str1 != NULL) : (t->str2 != NULL); t++)
+		{
+			const char *str = (snum == 1) ? t->str1 : t->str2;
+			if (t->id < MAX_DIRECT_TABLE_ID)
+			{
+				if (t->id >= m_direct.size())
+					m_direct.resize(t->id + 1, NULL);
+				if (m_direct[t->id] == NULL)
+					m_direct[t->id] = str;
+			}
+			else
+				m_hashed.insert(std::make_pair(t->id, str));
+		}
+	}
+	const char* find(const unsigned long id) const
+	{
+		if (id < MAX_DIRECT_TABLE_ID)
+			return ((id < m_direct.size()) && (m_direct[id] != NULL)) ? m_direct[id] : "Unknown";
+		std::unordered_map<unsigned long, const char*>::const_iterator itt = m_hashed.find(id);
+		return (itt != m_hashed.end()) ? itt->second : "Unknown";
+	}
+private:
+	std::vector<const char*> m_direct;
+	std::unordered_map<unsigned long, const char*> m_hashed;
+};
+
+class CTableIndexID1ID2
+{
+public:
+	explicit CTableIndexID1ID2(const STR_TABLE_ID1_ID2* t)
+	{
+		for (; t->str1 != NULL; t++)
+		{
+			if ((t->id1 < 256) && (t->id2 < 256))
+			{
+				if (t->id1 >= m_direct.size())
+					m_direct.resize(t->id1 + 1);
+				std::vector<const char*> &subtypes = m_direct[t->id1];
+				if (t->id2 >= subtypes.size())
+					subtypes.resize(t->id2 + 1, NULL);
+				if (subtypes[t->id2] == NULL)
+					subtypes[t->id2] = t->str1;
+			}
+			else
+				m_hashed.insert(std::make_pair(((uint64_t)t->id1 << 32) | t->id2, t->str1));
+		}
+	}
+	const char* find(const unsigned long id1, const unsigned long id2) const
+	{
+		if ((id1 < 256) && (id2 < 256))
+		{
+			if ((id1 < m_direct.size()) && (id2 < m_direct[id1].size()) && (m_direct[id1][id2] != NULL))
+				return m_direct[id1][id2];
+			return "Unknown";
+		}
+		std::unordered_map<uint64_t, const char*>::const_iterator itt = m_hashed.find(((uint64_t)id1 << 32) | id2);
+		return (itt != m_hashed.end()) ? itt->second : "Unknown";
+	}
+private:
+	std::vector<std::vector<const char*> > m_direct;
+	std::unordered_map<uint64_t, const char*> m_hashed;
+};
+
 const char* RFX_Humidity_Status_Desc(const unsigned char status)
 {
 	static const STR_TABLE_SINGLE	Table[] =
@@ -284,18 +358,18 @@ static const STR_TABLE_SINGLE	HardwareTypeTable[] =
 
 const char* Hardware_Type_Desc(int hType)
 {
-	return findTableIDSingle1(HardwareTypeTable, hType);
+	static const CTableIndexSingle Index(HardwareTypeTable, 1);
+	return Index.find(hType);
 }
 
 const char* Hardware_Short_Desc(int hType)
 {
-	return findTableIDSingle2(HardwareTypeTable, hType);
+	static const CTableIndexSingle Index(HardwareTypeTable, 2);
+	return Index.find(hType);
 }
 
-const char* Switch_Type_Desc(const _eSwitchType sType)
+static const STR_TABLE_SINGLE	SwitchTypeTable[] =
 {
-	static const STR_TABLE_SINGLE	Table[] =
-	{
 		{ STYPE_OnOff, "On/Off" },
 	{ STYPE_Doorbell, "Doorbell" },
 	{ STYPE_Contact, "Contact" },
@@ -318,8 +392,12 @@ const char* Switch_Type_Desc(const _eSwitchType sType)
 	{ STYPE_DoorLock, "Door Lock" },
 	{ STYPE_DoorLockInverted, "Door Lock Inverted" },
 	{ 0, NULL, NULL }
-	};
-	return findTableIDSingle1(Table, sType);
+};
+
+const char* Switch_Type_Desc(const _eSwitchType sType)
+{
+	static const CTableIndexSingle Index(SwitchTypeTable, 1);
+	return Index.find(sType);
 }
 
 const char* Meter_Type_Desc(const _eMeterType sType)
@@ -463,10 +541,8 @@ const char* BMP_Forecast_Desc(const unsigned char Forecast)
 	return findTableIDSingle1(Table, Forecast);
 }
 
-const char* RFX_Type_Desc(const unsigned char i, const unsigned char snum)
+static const STR_TABLE_SINGLE	RFXTypeTable[] =
 {
-	static const STR_TABLE_SINGLE	Table[] =
-	{
 		{ pTypeInterfaceControl, "Interface Control", "unknown" },
 	{ pTypeInterfaceMessage, "Interface Message", "unknown" },
 	{ pTypeRecXmitMessage, "Receiver/Transmitter Message", "unknown" },
@@ -534,17 +610,20 @@ const char* RFX_Type_Desc(const unsigned char i, const unsigned char snum)
 	{ pTypeSOLAR, "Solar" , "solar" },
 	{ pTypeHunter, "Hunter" , "Hunter" },
 	{ 0, NULL, NULL }
-	};
+};
+
+const char* RFX_Type_Desc(const unsigned char i, const unsigned char snum)
+{
+	static const CTableIndexSingle Index1(RFXTypeTable, 1);
+	static const CTableIndexSingle Index2(RFXTypeTable, 2);
 	if (snum == 1)
-		return findTableIDSingle1(Table, i);
+		return Index1.find(i);
 
-	return findTableIDSingle2(Table, i);
+	return Index2.find(i);
 }
 
-const char* RFX_Type_SubType_Desc(const unsigned char dType, const unsigned char sType)
+static const STR_TABLE_ID1_ID2	RFXTypeSubTypeTable[] =
 {
-	static const STR_TABLE_ID1_ID2	Table[] =
-	{
 		{ pTypeTEMP, sTypeTEMP1, "THR128/138, THC138" },
 	{ pTypeTEMP, sTypeTEMP2, "THC238/268, THN132, THWR288, THRN122, THN122, AW129/131" },
 	{ pTypeTEMP, sTypeTEMP3, "THWR800" },
@@ -954,8 +1033,12 @@ const char* RFX_Type_SubType_Desc(const unsigned char dType, const unsigned char
 	{ pTypeGeneralSwitch, sSwitchTypeDrayton, "Drayton" },
 	{ pTypeGeneralSwitch, sSwitchTypeV2Phoenix, "V2Phoenix" },
 	{ 0,0,NULL }
-	};
-	return findTableID1ID2(Table, dType, sType);
+};
+
+const char* RFX_Type_SubType_Desc(const unsigned char dType, const unsigned char sType)
+{
+	static const CTableIndexID1ID2 Index(RFXTypeSubTypeTable);
+	return Index.find(dType, sType);
 }
 
 const char* Media_Player_States(const _eMediaStatus Status)
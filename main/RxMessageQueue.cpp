@@ -0,0 +1,296 @@
+#include "stdafx.h"
+#include "RxMessageQueue.h"
+#include "concurrent_queue.h"
+#include "Logger.h"
+#include <string.h>
+
+CRxMessageQueue::CRxMessageQueue(const size_t MaxSlots) :
+	m_MaxSlots((MaxSlots > 0) ? MaxSlots : 1),
+	m_AllocatedSlots(0),
+	m_bStopRequested(false)
+{
+}
+
+CRxMessageQueue::~CRxMessageQueue()
+{
+	for (auto & itt : m_queues)
+	{
+		for (auto & itt2 : itt.second.messages)
+			delete itt2;
+	}
+	for (auto & itt : m_freeSlots)
+		delete itt;
+}
+
+CRxMessageQueue::_tMessage *CRxMessageQueue::AllocateSlot()
+{
+	if (!m_freeSlots.empty())
+	{
+		_tMessage *pMessage = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		return pMessage;
+	}
+	//the slot limit is checked by Enqueue, unbounded queues and the consumer may go over it
+	m_AllocatedSlots++;
+	return new _tMessage;
+}
+
+void CRxMessageQueue::FreeSlot(_tMessage *pMessage)
+{
+	pMessage->trigger = NULL;
+	m_freeSlots.push_back(pMessage);
+}
+
+void CRxMessageQueue::DropMessage(_tMessage *pMessage)
+{
+	//someone is waiting for this message, let it continue
+	if (pMessage->trigger != NULL)
+		pMessage->trigger->popped();
+	FreeSlot(pMessage);
+}
+
+void CRxMessageQueue::ResetHardwareStats(_tHardwareQueue &queue)
+{
+	queue.PeakQueueSize = queue.messages.size();
+	queue.Pushed = 0;
+	queue.Processed = 0;
+	queue.Dropped = 0;
+	queue.Blocked = 0;
+	queue.TotalAgeMs = 0;
+	queue.MaxAgeMs = 0;
+}
+
+void CRxMessageQueue::SetConsumerThread()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_consumerThread = std::this_thread::get_id();
+}
+
+CRxMessageQueue::_tHardwareQueue &CRxMessageQueue::GetHardwareQueue(const int HwdID, const size_t MaxQueueSize, const _eRxQueuePolicy Policy, const int Weight)
+{
+	std::map<int, _tHardwareQueue>::iterator itt = m_queues.find(HwdID);
+	if (itt == m_queues.end())
+	{
+		_tHardwareQueue queue;
+		queue.Served = 0;
+		queue.bScheduled = false;
+		ResetHardwareStats(queue);
+		itt = m_queues.insert(std::make_pair(HwdID, queue)).first;
+	}
+	_tHardwareQueue &queue = itt->second;
+	queue.MaxQueueSize = MaxQueueSize;
+	queue.Policy = Policy;
+	queue.Weight = (Weight > 0) ? Weight : 1;
+	return queue;
+}
+
+bool CRxMessageQueue::Enqueue(std::unique_lock<std::mutex> &lock, _tHardwareQueue &queue, const int HwdID, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel,
+	const unsigned long rxMessageIdx, queue_element_trigger *trigger)
+{
+	//messages someone waits for are never dropped, but the consumer can not wait for itself and goes over the limits instead
+	bool bMustQueue = (queue.Policy == RXQ_POLICY_BLOCK) || (trigger != NULL);
+	bool bMayBlock = bMustQueue && (std::this_thread::get_id() != m_consumerThread);
+	bool bBlocked = false;
+	while ((queue.MaxQueueSize > 0) && ((queue.messages.size() >= queue.MaxQueueSize) || ((m_freeSlots.empty()) && (m_AllocatedSlots >= m_MaxSlots))))
+	{
+		if (bMayBlock)
+		{
+			if (!bBlocked)
+			{
+				bBlocked = true;
+				queue.Blocked++;
+			}
+			//messages of a batch queued before this one are not announced yet
+			m_cvNotEmpty.notify_one();
+			m_cvNotFull.wait(lock);
+			if (m_bStopRequested)
+				return false;
+			continue;
+		}
+		if (bMustQueue)
+			break;
+		if (queue.Policy == RXQ_POLICY_DROP_OLDEST)
+		{
+			//evict the oldest message nobody waits for
+			std::deque<_tMessage*>::iterator itt = queue.messages.begin();
+			while ((itt != queue.messages.end()) && ((*itt)->trigger != NULL))
+				++itt;
+			if (itt != queue.messages.end())
+			{
+				if (queue.Dropped % 1000 == 0)
+					_log.Log(LOG_ERROR, "RxQueue: hardware %d can not keep up, dropping oldest messages (queue size: %d)", HwdID, (int)queue.MaxQueueSize);
+				DropMessage(*itt);
+				queue.messages.erase(itt);
+				queue.Dropped++;
+				continue;
+			}
+		}
+		if (queue.Dropped % 1000 == 0)
+			_log.Log(LOG_ERROR, "RxQueue: hardware %d can not keep up, dropping new messages (queue size: %d)", HwdID, (int)queue.MaxQueueSize);
+		queue.Dropped++;
+		return false;
+	}
+
+	_tMessage *pMessage = AllocateSlot();
+	pMessage->HwdID = HwdID;
+	pMessage->BatteryLevel = BatteryLevel;
+	pMessage->rxMessageIdx = rxMessageIdx;
+	if (defaultName != NULL)
+		pMessage->Name.assign(defaultName);
+	else
+		pMessage->Name.clear();
+	memcpy(pMessage->RXCommand, pRXCommand, pRXCommand[0] + 1);
+	pMessage->trigger = trigger;
+	pMessage->tQueued = std::chrono::steady_clock::now();
+
+	queue.messages.push_back(pMessage);
+	queue.Pushed++;
+	if (queue.messages.size() > queue.PeakQueueSize)
+		queue.PeakQueueSize = queue.messages.size();
+	if (!queue.bScheduled)
+	{
+		queue.bScheduled = true;
+		queue.Served = 0;
+		m_roundRobin.push_back(HwdID);
+	}
+	return true;
+}
+
+bool CRxMessageQueue::Push(const int HwdID, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel, const unsigned long rxMessageIdx, queue_element_trigger *trigger,
+	const size_t MaxQueueSize, const _eRxQueuePolicy Policy, const int Weight)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_bStopRequested)
+		return false;
+
+	_tHardwareQueue &queue = GetHardwareQueue(HwdID, MaxQueueSize, Policy, Weight);
+	if (!Enqueue(lock, queue, HwdID, pRXCommand, defaultName, BatteryLevel, rxMessageIdx, trigger))
+		return false;
+	lock.unlock();
+	m_cvNotEmpty.notify_one();
+	return true;
+}
+
+size_t CRxMessageQueue::PushBatch(const int HwdID, const std::vector<_tRxBatchMessage> &messages, const unsigned long FirstMessageIdx,
+	const size_t MaxQueueSize, const _eRxQueuePolicy Policy, const int Weight)
+{
+	if (messages.empty())
+		return 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_bStopRequested)
+		return 0;
+
+	_tHardwareQueue &queue = GetHardwareQueue(HwdID, MaxQueueSize, Policy, Weight);
+	size_t pushed = 0;
+	unsigned long rxMessageIdx = FirstMessageIdx;
+	for (const auto & itt : messages)
+	{
+		if (Enqueue(lock, queue, HwdID, itt.RXCommand, itt.Name.c_str(), itt.BatteryLevel, rxMessageIdx++, NULL))
+			pushed++;
+		else if (m_bStopRequested)
+			break;
+	}
+	lock.unlock();
+	if (pushed > 0)
+		m_cvNotEmpty.notify_one();
+	return pushed;
+}
+
+CRxMessageQueue::_tMessage *CRxMessageQueue::Pop(const std::chrono::milliseconds &timeout)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (!m_cvNotEmpty.wait_for(lock, timeout, [this] { return (!m_roundRobin.empty()) || (m_bStopRequested); }))
+		return NULL;
+	if (m_bStopRequested)
+		return NULL;
+
+	int HwdID = m_roundRobin.front();
+	_tHardwareQueue &queue = m_queues[HwdID];
+	_tMessage *pMessage = queue.messages.front();
+	queue.messages.pop_front();
+	queue.Served++;
+	if (queue.messages.empty())
+	{
+		m_roundRobin.pop_front();
+		queue.bScheduled = false;
+		queue.Served = 0;
+	}
+	else if (queue.Served >= queue.Weight)
+	{
+		m_roundRobin.pop_front();
+		m_roundRobin.push_back(HwdID);
+		queue.Served = 0;
+	}
+
+	uint64_t age = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - pMessage->tQueued).count();
+	queue.Processed++;
+	queue.TotalAgeMs += age;
+	if (age > queue.MaxAgeMs)
+		queue.MaxAgeMs = age;
+	lock.unlock();
+	m_cvNotFull.notify_all();
+	return pMessage;
+}
+
+void CRxMessageQueue::Release(_tMessage *pMessage)
+{
+	if (pMessage == NULL)
+		return;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		FreeSlot(pMessage);
+	}
+	m_cvNotFull.notify_all();
+}
+
+void CRxMessageQueue::Stop()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_bStopRequested = true;
+		for (auto & itt : m_queues)
+		{
+			//waiting pushers stop waiting themselves when the server stops
+			for (auto & itt2 : itt.second.messages)
+				FreeSlot(itt2);
+			itt.second.messages.clear();
+			itt.second.bScheduled = false;
+		}
+		m_roundRobin.clear();
+	}
+	m_cvNotEmpty.notify_all();
+	m_cvNotFull.notify_all();
+}
+
+void CRxMessageQueue::GetStats(std::vector<_tHardwareStats> &stats)
+{
+	stats.clear();
+	std::chrono::steady_clock::time_point tNow = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (const auto & itt : m_queues)
+	{
+		const _tHardwareQueue &queue = itt.second;
+		_tHardwareStats hstats;
+		hstats.HwdID = itt.first;
+		hstats.Policy = queue.Policy;
+		hstats.QueueSize = queue.messages.size();
+		hstats.MaxQueueSize = queue.MaxQueueSize;
+		hstats.PeakQueueSize = queue.PeakQueueSize;
+		hstats.Weight = queue.Weight;
+		hstats.Pushed = queue.Pushed;
+		hstats.Processed = queue.Processed;
+		hstats.Dropped = queue.Dropped;
+		hstats.Blocked = queue.Blocked;
+		hstats.AvgAgeMs = (queue.Processed > 0) ? queue.TotalAgeMs / queue.Processed : 0;
+		hstats.MaxAgeMs = queue.MaxAgeMs;
+		hstats.OldestAgeMs = (!queue.messages.empty()) ? (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(tNow - queue.messages.front()->tQueued).count() : 0;
+		stats.push_back(hstats);
+	}
+}
+
+void CRxMessageQueue::ResetStats()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (auto & itt : m_queues)
+		ResetHardwareStats(itt.second);
+}
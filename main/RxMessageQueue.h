@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class queue_element_trigger;
+
+enum _eRxQueuePolicy
+{
+	RXQ_POLICY_DROP_OLDEST = 0,	//drop the oldest queued message of the hardware when its queue is full
+	RXQ_POLICY_DROP_NEWEST,		//drop the message that is pushed when the queue of the hardware is full
+	RXQ_POLICY_BLOCK,			//the hardware waits until there is room in its queue
+};
+
+//A received message collected by a hardware for a batch push (see CDomoticzHardwareBase::BeginRxBatch)
+struct _tRxBatchMessage
+{
+	int BatteryLevel;
+	std::string Name;
+	uint8_t RXCommand[256];		//first byte is the length of the message (excluding itself)
+};
+
+/*
+ * Queue of received messages waiting to be decoded by the MainWorker.
+ * Every hardware has its own queue, the queues are drained round robin
+ * (a hardware with weight N gets N messages per turn) so one busy or misbehaving
+ * hardware can not starve the others. Messages are stored in pooled fixed size slots.
+ * A queue of size 0 is unbounded, a bounded queue overflows according to its policy.
+ * Messages someone waits for (a trigger) are never dropped: they are not evicted by
+ * RXQ_POLICY_DROP_OLDEST, and their pusher blocks for room instead.
+ * The consumer thread is never blocked, its messages go over the limits instead.
+ */
+class CRxMessageQueue
+{
+public:
+	struct _tMessage
+	{
+		int HwdID;
+		int BatteryLevel;
+		unsigned long rxMessageIdx;
+		std::string Name;
+		uint8_t RXCommand[256];		//first byte is the length of the message (excluding itself)
+		queue_element_trigger *trigger;
+		std::chrono::steady_clock::time_point tQueued;
+	};
+
+	struct _tHardwareStats
+	{
+		int HwdID;
+		_eRxQueuePolicy Policy;
+		size_t QueueSize;
+		size_t MaxQueueSize;
+		size_t PeakQueueSize;
+		int Weight;
+		uint64_t Pushed;
+		uint64_t Processed;
+		uint64_t Dropped;
+		uint64_t Blocked;			//pushes that had to wait for room in the queue
+		uint64_t AvgAgeMs;			//time between queueing and processing a message
+		uint64_t MaxAgeMs;
+		uint64_t OldestAgeMs;		//age of the oldest message still in the queue
+	};
+
+	explicit CRxMessageQueue(const size_t MaxSlots = 10000);
+	~CRxMessageQueue();
+
+	//Returns false when the message was dropped (queue full, or stopping). MaxQueueSize 0 is unbounded
+	bool Push(const int HwdID, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel, const unsigned long rxMessageIdx, queue_element_trigger *trigger,
+		const size_t MaxQueueSize, const _eRxQueuePolicy Policy, const int Weight);
+	//Pushes the messages of one reading in order with a single wakeup of the consumer, they get rxMessageIdx FirstMessageIdx and up.
+	//Returns the number of messages queued
+	size_t PushBatch(const int HwdID, const std::vector<_tRxBatchMessage> &messages, const unsigned long FirstMessageIdx,
+		const size_t MaxQueueSize, const _eRxQueuePolicy Policy, const int Weight);
+	//Waits for the next message, returns NULL on timeout or when stopped. The message has to be given back with Release
+	_tMessage *Pop(const std::chrono::milliseconds &timeout);
+	void Release(_tMessage *pMessage);
+	//Wakes up Pop and blocked Push calls, queued messages are discarded
+	void Stop();
+	//Marks the calling thread as the consumer, it is never blocked when it pushes a message itself
+	void SetConsumerThread();
+
+	void GetStats(std::vector<_tHardwareStats> &stats);
+	void ResetStats();
+private:
+	struct _tHardwareQueue
+	{
+		std::deque<_tMessage*> messages;
+		size_t MaxQueueSize;
+		_eRxQueuePolicy Policy;
+		int Weight;
+		int Served;					//messages taken in the current round robin turn
+		bool bScheduled;			//hardware is in the round robin list
+
+		size_t PeakQueueSize;
+		uint64_t Pushed;
+		uint64_t Processed;
+		uint64_t Dropped;
+		uint64_t Blocked;
+		uint64_t TotalAgeMs;
+		uint64_t MaxAgeMs;
+	};
+	_tHardwareQueue &GetHardwareQueue(const int HwdID, const size_t MaxQueueSize, const _eRxQueuePolicy Policy, const int Weight);
+	//Called with the lock held, does not wake up the consumer
+	bool Enqueue(std::unique_lock<std::mutex> &lock, _tHardwareQueue &queue, const int HwdID, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel,
+		const unsigned long rxMessageIdx, queue_element_trigger *trigger);
+	_tMessage *AllocateSlot();
+	void FreeSlot(_tMessage *pMessage);
+	void DropMessage(_tMessage *pMessage);
+	static void ResetHardwareStats(_tHardwareQueue &queue);
+
+	std::mutex m_mutex;
+	std::condition_variable m_cvNotEmpty;
+	std::condition_variable m_cvNotFull;
+	std::map<int, _tHardwareQueue> m_queues;
+	std::deque<int> m_roundRobin;	//hardware with queued messages, in serving order
+	std::vector<_tMessage*> m_freeSlots;
+	size_t m_MaxSlots;
+	size_t m_AllocatedSlots;
+	bool m_bStopRequested;
+	std::thread::id m_consumerThread;
+};
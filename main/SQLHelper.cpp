@@ -34,7 +34,7 @@
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
-#define DB_VERSION 138
+#define DB_VERSION 140
 
 extern http::server::CWebServerHelper m_webservers;
 extern std::string szWWWFolder;
@@ -194,7 +194,8 @@ const char *sqlCreateMultiMeter =
 "[Value4] BIGINT DEFAULT 0, "
 "[Value5] BIGINT DEFAULT 0, "
 "[Value6] BIGINT DEFAULT 0, "
-"[Date] DATETIME DEFAULT (datetime('now','localtime')));";
+"[Date] DATETIME DEFAULT (datetime('now','localtime')), "
+"[Unchanged] INTEGER DEFAULT 0);";
 
 const char *sqlCreateMultiMeter_Calendar =
 "CREATE TABLE IF NOT EXISTS [MultiMeter_Calendar] ("
@@ -242,7 +243,9 @@ const char *sqlCreateHardware =
 "[Mode5] CHAR DEFAULT 0, "
 "[Mode6] CHAR DEFAULT 0, "
 "[DataTimeout] INTEGER DEFAULT 0, "
-"[Configuration] TEXT DEFAULT (''));";
+"[Configuration] TEXT DEFAULT (''), "
+"[RxQueueSize] INTEGER DEFAULT 0, "
+"[RxQueuePolicy] INTEGER DEFAULT 2);";
 
 const char *sqlCreateUsers =
 "CREATE TABLE IF NOT EXISTS [Users] ("
@@ -259,7 +262,8 @@ const char *sqlCreateMeter =
 "[DeviceRowID] BIGINT NOT NULL, "
 "[Value] REAL NOT NULL, "
 "[Usage] REAL DEFAULT 0, "
-"[Date] DATETIME DEFAULT (datetime('now','localtime')));";
+"[Date] DATETIME DEFAULT (datetime('now','localtime')), "
+"[Unchanged] INTEGER DEFAULT 0);";
 
 const char *sqlCreateMeter_Calendar =
 "CREATE TABLE IF NOT EXISTS [Meter_Calendar] ("
@@ -631,11 +635,18 @@ const char *sqlCreateMobileDevices =
 
 extern std::string szUserDataFolder;
 
+//Called by SQLite for every inserted/updated/deleted row of the connection
+static void sqlite_update_hook(void *pUser, int op, const char * /*dbname*/, const char *table, sqlite3_int64 /*rowid*/)
+{
+	if ((op == SQLITE_DELETE) && (strcmp(table, "DeviceStatus") == 0))
+		(*((std::atomic<uint64_t>*)pUser))++;
+}
+
 CSQLHelper::CSQLHelper(void)
 {
 	m_LastSwitchRowID = 0;
 	m_dbase = NULL;
-	m_sensortimeoutcounter = 0;
+	m_DeviceDeleteGeneration = 0;
 	m_bAcceptNewHardware = true;
 	m_bAllowWidgetOrdering = true;
 	m_ActiveTimerPlan = 0;
@@ -651,6 +662,10 @@ CSQLHelper::CSQLHelper(void)
 	m_ShortLogInterval = 5;
 	m_bPreviousAcceptNewHardware = false;
 	m_bLogEventScriptTrigger = false;
+	m_bPreferencesLoaded = false;
+	m_PreferencesGeneration = 0;
+	m_bSceneGraphLoaded = false;
+	m_SceneGraphGeneration = 0;
 
 	SetDatabaseName("domoticz.db");
 }
@@ -679,6 +694,11 @@ bool CSQLHelper::OpenDatabase()
 	sqlite3_exec(m_dbase, "PRAGMA journal_mode=DELETE", NULL, NULL, NULL);
 #endif
 	sqlite3_exec(m_dbase, "PRAGMA foreign_keys = ON;", NULL, NULL, NULL);
+	//a (restored) database invalidates all cached device row ids
+	m_DeviceDeleteGeneration++;
+	sqlite3_update_hook(m_dbase, sqlite_update_hook, &m_DeviceDeleteGeneration);
+	ClearPreferencesCache();
+	ReloadSceneGraph();
 	std::vector<std::vector<std::string> > result = query("SELECT name FROM sqlite_master WHERE type='table' AND name='DeviceStatus'");
 	bool bNewInstall = (result.size() == 0);
 	int dbversion = 0;
@@ -2738,6 +2758,20 @@ bool CSQLHelper::OpenDatabase()
 			query("ALTER TABLE SharedDevices ADD COLUMN [Favorite] INTEGER DEFAULT 0");
 			query("UPDATE SharedDevices SET Favorite = 1 WHERE DeviceRowID IN (SELECT ID FROM DeviceStatus WHERE (Favorite=1))");
 		}
+		if (dbversion < 139)
+		{
+			//Unchanged meter readings are stored as runs, the last row of a run is flagged
+			query("ALTER TABLE Meter ADD COLUMN [Unchanged] INTEGER DEFAULT 0");
+			query("ALTER TABLE MultiMeter ADD COLUMN [Unchanged] INTEGER DEFAULT 0");
+			//remove the rows inside the existing runs
+			CompactShortLogRuns();
+		}
+		if (dbversion < 140)
+		{
+			//Received messages queue of the hardware, unbounded by default
+			query("ALTER TABLE Hardware ADD COLUMN [RxQueueSize] INTEGER DEFAULT 0");
+			query("ALTER TABLE Hardware ADD COLUMN [RxQueuePolicy] INTEGER DEFAULT 2");
+		}
 	} 
 	else if (bNewInstall)
 	{
@@ -2746,6 +2780,8 @@ bool CSQLHelper::OpenDatabase()
 		// Add hardware for internal use
 		m_sql.safe_query("INSERT INTO Hardware (Name, Enabled, Type, Address, Port, Username, Password, Mode1, Mode2, Mode3, Mode4, Mode5, Mode6) VALUES ('Domoticz Internal',1, %d,'',1,'','',0,0,0,0,0,0)", HTYPE_DomoticzInternal);
 	}
+	//Upgrades could have modified the Preferences table directly
+	ClearPreferencesCache();
 	UpdatePreferencesVar("DB_Version", DB_VERSION);
 
 	//Make sure we have some default preferences
@@ -2806,6 +2842,10 @@ bool CSQLHelper::OpenDatabase()
 	{
 		UpdatePreferencesVar("SensorTimeout", 60);
 	}
+	if (!GetPreferencesVar("CameraSnapshotMaxAge", nValue))
+	{
+		UpdatePreferencesVar("CameraSnapshotMaxAge", 1000); //milliseconds a camera image is reused
+	}
 	if (!GetPreferencesVar("SensorTimeoutNotification", nValue))
 	{
 		UpdatePreferencesVar("SensorTimeoutNotification", 0); //default disabled
@@ -3604,6 +3644,59 @@ void CSQLHelper::safe_exec_no_return(const char *fmt, ...)
 	sqlite3_free(zQuery);
 }
 
+//Executes a batch of (already escaped) queries in a single transaction
+void CSQLHelper::ExecuteTransaction(const std::vector<std::string> &queries)
+{
+	if (!m_dbase)
+		return;
+	if (queries.empty())
+		return;
+
+	std::lock_guard<std::mutex> t(m_sqlTransactionMutex);
+	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+
+	sqlite3_exec(m_dbase, "BEGIN TRANSACTION", NULL, NULL, NULL);
+	for (const auto & itt : queries)
+	{
+		char *errorMessage = NULL;
+		if (sqlite3_exec(m_dbase, itt.c_str(), NULL, NULL, &errorMessage) != SQLITE_OK)
+		{
+			_log.Log(LOG_ERROR, "SQL Query(\"%s\") : %s", itt.c_str(), (errorMessage) ? errorMessage : "");
+			sqlite3_free(errorMessage);
+		}
+	}
+	sqlite3_exec(m_dbase, "COMMIT TRANSACTION", NULL, NULL, NULL);
+}
+
+//Runs func (that uses the normal query functions) in a single transaction, to batch multiple device updates.
+//Only BEGIN/COMMIT are done under the query lock, func is not: device updates call into the preferences,
+//scene graph, event system and hardware, whose locks are held by other threads while they run queries.
+//Queries other threads make meanwhile become part of this transaction and are committed with it.
+void CSQLHelper::ExecuteInTransaction(const std::function<void()> &func)
+{
+	if (!m_dbase)
+		return;
+
+	std::lock_guard<std::mutex> t(m_sqlTransactionMutex);
+	{
+		std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+		sqlite3_exec(m_dbase, "BEGIN TRANSACTION", NULL, NULL, NULL);
+	}
+	try
+	{
+		func();
+	}
+	catch (...)
+	{
+		//a rollback would also discard the writes of other threads, keep what was done
+		std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+		sqlite3_exec(m_dbase, "COMMIT TRANSACTION", NULL, NULL, NULL);
+		throw;
+	}
+	std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+	sqlite3_exec(m_dbase, "COMMIT TRANSACTION", NULL, NULL, NULL);
+}
+
 bool CSQLHelper::safe_UpdateBlobInTableWithID(const std::string &Table, const std::string &Column, const std::string &sID, const std::string &BlobData)
 {
 	if (!m_dbase)
@@ -4033,6 +4126,7 @@ uint64_t CSQLHelper::CreateDevice(const int HardwareID, const int SensorType, co
 	if (DeviceRowIdx != (uint64_t)-1)
 	{
 		m_sql.safe_query("UPDATE DeviceStatus SET Used=1 WHERE (ID==%" PRIu64 ")", DeviceRowIdx);
+		RescheduleSensorTimeout(DeviceRowIdx);
 		m_mainworker.m_eventsystem.GetCurrentStates();
 	}
 
@@ -4438,6 +4532,7 @@ uint64_t CSQLHelper::UpdateValueInt(const int HardwareID, const char* ID, const
 						shortLog = true;
 					}
 					UpdateCalendarMeter(HardwareID, ID, unit, devType, subType, shortLog, atoll(parts[0].c_str()), atoll(parts[1].c_str()), parts[2].c_str());
+					ScheduleSensorTimeout(ulID, devType, now);
 					return ulID;
 				}
 			}
@@ -4452,6 +4547,8 @@ uint64_t CSQLHelper::UpdateValueInt(const int HardwareID, const char* ID, const
 		}
 	}
 
+	ScheduleSensorTimeout(ulID, devType, mytime(NULL));
+
 	if (bSameDeviceStatusValue)
 		return ulID; //status has not changed, no need to process further
 
@@ -4851,49 +4948,103 @@ void CSQLHelper::UpdatePreferencesVar(const std::string &Key, const int nValue,
 	if (!m_dbase)
 		return;
 
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT ROWID FROM Preferences WHERE (Key='%q')",
-		Key.c_str());
-	if (result.empty())
+	//writers are serialized, so a key can not be inserted twice
+	std::lock_guard<std::mutex> w(m_preferencesWriteMutex);
+	bool bExists;
+	{
+		std::unique_lock<std::mutex> lock(m_preferencesMutex);
+		LoadPreferences(lock);
+		bExists = (m_preferences.find(Key) != m_preferences.end());
+	}
+
+	if (!bExists)
 	{
 		//Insert
-		result = safe_query("INSERT INTO Preferences (Key, nValue, sValue) VALUES ('%q', %d,'%q')",
+		safe_query("INSERT INTO Preferences (Key, nValue, sValue) VALUES ('%q', %d,'%q')",
 			Key.c_str(), nValue, sValue.c_str());
 	}
 	else
 	{
 		//Update
-		result = safe_query("UPDATE Preferences SET Key='%q', nValue=%d, sValue='%q' WHERE (ROWID = '%q')",
-			Key.c_str(), nValue, sValue.c_str(), result[0][0].c_str());
+		safe_query("UPDATE Preferences SET nValue=%d, sValue='%q' WHERE (Key='%q')",
+			nValue, sValue.c_str(), Key.c_str());
+	}
+
+	std::unique_lock<std::mutex> lock(m_preferencesMutex);
+	m_PreferencesGeneration++;
+	if (!m_bPreferencesLoaded)
+		return; //cleared meanwhile, the next load reads the new value from the table
+	_tPreferenceValue &pref = m_preferences[Key];
+	pref.nValue = nValue;
+	pref.sValue = sValue;
+	pref.fValue = atof(sValue.c_str());
+}
+
+/*
+ * Preferences are read from memory, the table is loaded once and kept up to date by UpdatePreferencesVar/DeletePreferencesVar
+ * (lock holds m_preferencesMutex, it is released while the table is read)
+ */
+void CSQLHelper::LoadPreferences(std::unique_lock<std::mutex> &lock)
+{
+	while (!m_bPreferencesLoaded)
+	{
+		uint64_t generation = m_PreferencesGeneration;
+		lock.unlock();
+
+		std::map<std::string, _tPreferenceValue> preferences;
+		std::vector<std::vector<std::string> > result;
+		result = safe_query("SELECT Key, nValue, sValue FROM Preferences");
+		for (const auto & sd : result)
+		{
+			_tPreferenceValue &pref = preferences[sd[0]];
+			pref.nValue = atoi(sd[1].c_str());
+			pref.sValue = sd[2];
+			pref.fValue = atof(sd[2].c_str());
+		}
+
+		lock.lock();
+		//the table was changed (or the cache cleared) while reading, read it again
+		if (generation != m_PreferencesGeneration)
+			continue;
+		m_preferences.swap(preferences);
+		m_bPreferencesLoaded = true;
 	}
 }
 
+void CSQLHelper::ClearPreferencesCache()
+{
+	std::unique_lock<std::mutex> lock(m_preferencesMutex);
+	m_PreferencesGeneration++;
+	m_preferences.clear();
+	m_bPreferencesLoaded = false;
+}
+
 bool CSQLHelper::GetPreferencesVar(const std::string &Key, std::string &sValue)
 {
 	if (!m_dbase)
 		return false;
 
-
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT sValue FROM Preferences WHERE (Key='%q')",
-		Key.c_str());
-	if (result.empty())
+	std::unique_lock<std::mutex> lock(m_preferencesMutex);
+	LoadPreferences(lock);
+	std::map<std::string, _tPreferenceValue>::const_iterator itt = m_preferences.find(Key);
+	if (itt == m_preferences.end())
 		return false;
-	std::vector<std::string> sd = result[0];
-	sValue = sd[0];
+	sValue = itt->second.sValue;
 	return true;
 }
 
 bool CSQLHelper::GetPreferencesVar(const std::string &Key, double &Value)
 {
-
-	std::string sValue;
-	int nValue;
 	Value = 0;
-	bool res = GetPreferencesVar(Key, nValue, sValue);
-	if (!res)
+	if (!m_dbase)
+		return false;
+
+	std::unique_lock<std::mutex> lock(m_preferencesMutex);
+	LoadPreferences(lock);
+	std::map<std::string, _tPreferenceValue>::const_iterator itt = m_preferences.find(Key);
+	if (itt == m_preferences.end())
 		return false;
-	Value = atof(sValue.c_str());
+	Value = itt->second.fValue;
 	return true;
 }
 bool CSQLHelper::GetPreferencesVar(const std::string &Key, int &nValue, std::string &sValue)
@@ -4901,33 +5052,47 @@ bool CSQLHelper::GetPreferencesVar(const std::string &Key, int &nValue, std::str
 	if (!m_dbase)
 		return false;
 
-	std::vector<std::vector<std::string> > result;
-	result = safe_query("SELECT nValue, sValue FROM Preferences WHERE (Key='%q')",
-		Key.c_str());
-	if (result.empty())
+	std::unique_lock<std::mutex> lock(m_preferencesMutex);
+	LoadPreferences(lock);
+	std::map<std::string, _tPreferenceValue>::const_iterator itt = m_preferences.find(Key);
+	if (itt == m_preferences.end())
 		return false;
-	std::vector<std::string> sd = result[0];
-	nValue = atoi(sd[0].c_str());
-	sValue = sd[1];
+	nValue = itt->second.nValue;
+	sValue = itt->second.sValue;
 	return true;
 }
 
 bool CSQLHelper::GetPreferencesVar(const std::string &Key, int &nValue)
 {
-	std::string sValue;
-	return GetPreferencesVar(Key, nValue, sValue);
+	if (!m_dbase)
+		return false;
+
+	std::unique_lock<std::mutex> lock(m_preferencesMutex);
+	LoadPreferences(lock);
+	std::map<std::string, _tPreferenceValue>::const_iterator itt = m_preferences.find(Key);
+	if (itt == m_preferences.end())
+		return false;
+	nValue = itt->second.nValue;
+	return true;
 }
 void CSQLHelper::DeletePreferencesVar(const std::string &Key)
 {
-	std::string sValue;
 	if (!m_dbase)
 		return;
 
-	//if found, delete
-	if (GetPreferencesVar(Key, sValue) == true)
+	std::lock_guard<std::mutex> w(m_preferencesWriteMutex);
 	{
-		safe_query("DELETE FROM Preferences WHERE (Key='%q')", Key.c_str());
+		std::unique_lock<std::mutex> lock(m_preferencesMutex);
+		LoadPreferences(lock);
+		//if found, delete
+		if (m_preferences.find(Key) == m_preferences.end())
+			return;
 	}
+	safe_query("DELETE FROM Preferences WHERE (Key='%q')", Key.c_str());
+
+	std::unique_lock<std::mutex> lock(m_preferencesMutex);
+	m_PreferencesGeneration++;
+	m_preferences.erase(Key);
 }
 
 
@@ -5552,6 +5717,225 @@ bool CSQLHelper::UpdateCalendarMeter(
 	return true;
 }
 
+//Meter devices that log an instant value (daily MIN/MAX/AVG), all other Meter devices are counters (daily MIN/MAX)
+static bool IsInstantMeterType(const unsigned char devType, const unsigned char subType)
+{
+	return (
+		(devType == pTypeAirQuality) ||
+		(devType == pTypeRFXSensor) ||
+		((devType == pTypeGeneral) && (subType == sTypeVisibility)) ||
+		((devType == pTypeGeneral) && (subType == sTypeDistance)) ||
+		((devType == pTypeGeneral) && (subType == sTypeSolarRadiation)) ||
+		((devType == pTypeGeneral) && (subType == sTypeSoilMoisture)) ||
+		((devType == pTypeGeneral) && (subType == sTypeLeafWetness)) ||
+		((devType == pTypeGeneral) && (subType == sTypeVoltage)) ||
+		((devType == pTypeGeneral) && (subType == sTypeCurrent)) ||
+		((devType == pTypeGeneral) && (subType == sTypePressure)) ||
+		((devType == pTypeGeneral) && (subType == sTypeSoundLevel)) ||
+		(devType == pTypeLux) ||
+		(devType == pTypeWEIGHT) ||
+		(devType == pTypeUsage)
+		);
+}
+
+/*
+ * Unchanged Meter/MultiMeter readings are stored as runs, only the first and the last row of a run are kept.
+ * When a reading repeats the previous two rows, the date of the last row is moved forward instead of inserting a new row,
+ * and the row is flagged as Unchanged: the reading was logged every shortlog interval since the row before it.
+ * Runs never cross midnight so the daily MIN/MAX of the calendar tables stay exact.
+ * Returns true when the last row has been extended, otherwise the caller has to insert a new row with date szDateNow
+ */
+bool CSQLHelper::ExtendShortLogRun(const char *szTable, std::map<uint64_t, _tShortLogRun> &runs, const uint64_t ID, const std::string &sValues, const time_t now, const char *szDateNow)
+{
+	std::map<uint64_t, _tShortLogRun>::iterator itt = runs.find(ID);
+	if (itt == runs.end())
+	{
+		_tShortLogRun run;
+		run.sValues = sValues;
+		run.sDate = szDateNow;
+		run.tDate = now;
+		run.bOpen = false;
+		runs[ID] = run;
+		return false;
+	}
+	_tShortLogRun &run = itt->second;
+	bool bSameValues = (run.sValues == sValues);
+	bool bExtended = false;
+	bool bLost = false;
+
+	if (
+		bSameValues
+		&& run.bOpen
+		&& (run.sDate.compare(0, 10, szDateNow, 10) == 0)
+		&& (difftime(now, run.tDate) <= 2 * 60 * m_ShortLogInterval) //no gap (sensor timeout) inside a run
+		)
+	{
+		//Only move the row when it is still the last one of this device (it could have been deleted or another row inserted after it)
+		char *zQuery = sqlite3_mprintf(
+			"UPDATE %q SET Date='%q', Unchanged=1 WHERE (DeviceRowID=%" PRIu64 ") AND (Date='%q') AND (Date=(SELECT MAX(Date) FROM %q WHERE (DeviceRowID=%" PRIu64 ")))",
+			szTable, szDateNow, ID, run.sDate.c_str(), szTable, ID);
+		if (zQuery)
+		{
+			std::lock_guard<std::mutex> l(m_sqlQueryMutex);
+			if ((m_dbase != NULL) && (sqlite3_exec(m_dbase, zQuery, NULL, NULL, NULL) == SQLITE_OK))
+				bExtended = (sqlite3_changes(m_dbase) == 1);
+			sqlite3_free(zQuery);
+		}
+		bLost = !bExtended;
+	}
+
+	//a newly inserted row opens a run when it repeats the row before it
+	run.bOpen = bExtended || (bSameValues && !bLost);
+	run.sValues = sValues;
+	run.sDate = szDateNow;
+	run.tDate = now;
+	return bExtended;
+}
+
+/*
+ * Reconstructs the readings of unchanged Meter/MultiMeter runs (see ExtendShortLogRun) for a result
+ * that is ordered by date, by repeating the first row of the run every shortlog interval.
+ * Only rows flagged as Unchanged (UnchangedColumn) are expanded, equal readings around a gap are left alone.
+ * The value columns are the ones before DateColumn
+ */
+void CSQLHelper::ExpandShortLogRuns(std::vector<std::vector<std::string> > &result, const size_t DateColumn, const size_t UnchangedColumn)
+{
+	if (result.size() < 2)
+		return;
+	const int interval = ((m_ShortLogInterval > 0) ? m_ShortLogInterval : 5) * 60;
+
+	std::vector<std::vector<std::string> > expanded;
+	bool bExpanded = false;
+	for (size_t ii = 0; ii < result.size(); ii++)
+	{
+		if (ii > 0)
+		{
+			const std::vector<std::string> &prev = result[ii - 1];
+			const std::vector<std::string> &sd = result[ii];
+			if (
+				(sd.size() > UnchangedColumn)
+				&& (sd[UnchangedColumn] == "1")
+				&& (prev.size() == sd.size())
+				&& (prev[DateColumn].compare(0, 10, sd[DateColumn], 0, 10) == 0)
+				&& std::equal(prev.begin(), prev.begin() + DateColumn, sd.begin())
+				)
+			{
+				time_t tStart, tEnd;
+				struct tm ntime;
+				if (
+					ParseSQLdatetime(tStart, ntime, prev[DateColumn], -1)
+					&& ParseSQLdatetime(tEnd, ntime, sd[DateColumn], -1)
+					&& (tEnd - tStart > interval + interval / 2)
+					)
+				{
+					if (!bExpanded)
+					{
+						expanded.reserve(result.size() + (size_t)((tEnd - tStart) / interval));
+						expanded.insert(expanded.end(), result.begin(), result.begin() + ii);
+						bExpanded = true;
+					}
+					for (time_t tPoint = tStart + interval; tPoint + interval / 2 < tEnd; tPoint += interval)
+					{
+						char szDate[40];
+						struct tm ltime;
+						localtime_r(&tPoint, &ltime);
+						strftime(szDate, sizeof(szDate), "%Y-%m-%d %H:%M:%S", &ltime);
+						expanded.push_back(prev);
+						expanded.back()[DateColumn] = szDate;
+					}
+				}
+			}
+		}
+		if (bExpanded)
+			expanded.push_back(result[ii]);
+	}
+	if (bExpanded)
+		result.swap(expanded);
+}
+
+/*
+ * One time compaction of the Meter/MultiMeter shortlog, removes the rows inside runs of unchanged readings
+ * and flags the last row of each run. Like ExtendShortLogRun, a run does not span a gap of more than two intervals.
+ */
+void CSQLHelper::CompactShortLogRuns()
+{
+	int interval = 5;
+	GetPreferencesVar("ShortLogInterval", interval);
+	if (interval < 1)
+		interval = 5;
+	const int MaxGap = 2 * 60 * interval;
+
+	std::vector<std::vector<std::string> > resultdevices;
+	resultdevices = safe_query("SELECT ID, Type, SubType FROM DeviceStatus WHERE (ID IN (SELECT DISTINCT(DeviceRowID) FROM Meter)) OR (ID IN (SELECT DISTINCT(DeviceRowID) FROM MultiMeter))");
+	size_t totRemoved = 0;
+	for (const auto & itt : resultdevices)
+	{
+		const std::vector<std::string> &sddev = itt;
+		uint64_t ID = std::strtoull(sddev[0].c_str(), nullptr, 10);
+		unsigned char devType = atoi(sddev[1].c_str());
+		unsigned char subType = atoi(sddev[2].c_str());
+
+		std::vector<std::vector<std::string> > result;
+		if ((devType == pTypeP1Power) || (devType == pTypeCURRENT) || (devType == pTypeCURRENTENERGY))
+			result = safe_query("SELECT ROWID, Value1, Value2, Value3, Value4, Value5, Value6, Date FROM MultiMeter WHERE (DeviceRowID=%" PRIu64 ") ORDER BY Date ASC", ID);
+		else if (!IsInstantMeterType(devType, subType))
+			result = safe_query("SELECT ROWID, Value, [Usage], Date FROM Meter WHERE (DeviceRowID=%" PRIu64 ") ORDER BY Date ASC", ID);
+		if (result.size() < 3)
+			continue;
+		const std::string szTable = (result[0].size() == 8) ? "MultiMeter" : "Meter";
+		const size_t DateColumn = result[0].size() - 1;
+
+		std::vector<time_t> dates(result.size(), 0);
+		for (size_t ii = 0; ii < result.size(); ii++)
+		{
+			struct tm ntime;
+			if (!ParseSQLdatetime(dates[ii], ntime, result[ii][DateColumn], -1))
+				dates[ii] = 0;
+		}
+
+		std::vector<std::string> queries;
+		bool bPrevRemoved = false;
+		for (size_t ii = 1; ii < result.size(); ii++)
+		{
+			const std::vector<std::string> &prev = result[ii - 1];
+			const std::vector<std::string> &sd = result[ii];
+			//column 0 is the ROWID
+			bool bSameRun = (
+				(dates[ii - 1] != 0)
+				&& (dates[ii] != 0)
+				&& (difftime(dates[ii], dates[ii - 1]) <= MaxGap)
+				&& (sd[DateColumn].compare(0, 10, prev[DateColumn], 0, 10) == 0)
+				&& std::equal(prev.begin() + 1, prev.begin() + DateColumn, sd.begin() + 1)
+				);
+			bool bRemove = false;
+			if ((bSameRun) && (ii + 1 < result.size()))
+			{
+				const std::vector<std::string> &next = result[ii + 1];
+				bRemove = (
+					(dates[ii + 1] != 0)
+					&& (difftime(dates[ii + 1], dates[ii]) <= MaxGap)
+					&& (next[DateColumn].compare(0, 10, sd[DateColumn], 0, 10) == 0)
+					&& std::equal(sd.begin() + 1, sd.begin() + DateColumn, next.begin() + 1)
+					);
+			}
+			if (bRemove)
+			{
+				queries.push_back("DELETE FROM " + szTable + " WHERE (ROWID=" + sd[0] + ")");
+				totRemoved++;
+			}
+			else if (bPrevRemoved)
+			{
+				//last row of the run
+				queries.push_back("UPDATE " + szTable + " SET Unchanged=1 WHERE (ROWID=" + sd[0] + ")");
+			}
+			bPrevRemoved = bRemove;
+		}
+		ExecuteTransaction(queries);
+	}
+	if (totRemoved > 0)
+		_log.Log(LOG_STATUS, "Compacted meter shortlog, removed %d unchanged readings", (int)totRemoved);
+}
+
 void CSQLHelper::UpdateMeter()
 {
 	time_t now = mytime(NULL);
@@ -5560,6 +5944,9 @@ void CSQLHelper::UpdateMeter()
 	struct tm tm1;
 	localtime_r(&now, &tm1);
 
+	char szDateNow[40];
+	strftime(szDateNow, sizeof(szDateNow), "%Y-%m-%d %H:%M:%S", &tm1);
+
 	int SensorTimeOut = 60;
 	GetPreferencesVar("SensorTimeout", SensorTimeOut);
 
@@ -5789,13 +6176,22 @@ void CSQLHelper::UpdateMeter()
 			float MeterValue = atof(sValue.c_str());
 			float MeterUsage = atof(susage.c_str());
 
+			//unchanged counter readings only extend the last row
+			if (!IsInstantMeterType(dType, dSubType))
+			{
+				sprintf(szTmp, "%.2f;%.2f", MeterValue, MeterUsage);
+				if (ExtendShortLogRun("Meter", m_MeterRuns, ID, szTmp, now, szDateNow))
+					continue;
+			}
+
 			//insert record
 			safe_query(
-				"INSERT INTO Meter (DeviceRowID, Value, [Usage]) "
-				"VALUES ('%" PRIu64 "', '%.2f', '%.2f')",
+				"INSERT INTO Meter (DeviceRowID, Value, [Usage], Date) "
+				"VALUES ('%" PRIu64 "', '%.2f', '%.2f', '%q')",
 				ID,
 				MeterValue,
-				MeterUsage
+				MeterUsage,
+				szDateNow
 			);
 		}
 	}
@@ -5809,6 +6205,9 @@ void CSQLHelper::UpdateMultiMeter()
 	struct tm tm1;
 	localtime_r(&now, &tm1);
 
+	char szDateNow[40];
+	strftime(szDateNow, sizeof(szDateNow), "%Y-%m-%d %H:%M:%S", &tm1);
+
 	int SensorTimeOut = 60;
 	GetPreferencesVar("SensorTimeout", SensorTimeOut);
 
@@ -5888,17 +6287,24 @@ void CSQLHelper::UpdateMultiMeter()
 			else
 				continue;//don't know you (yet)
 
+			//unchanged readings only extend the last row
+			char szValues[200];
+			sprintf(szValues, "%llu;%llu;%llu;%llu;%llu;%llu", value1, value2, value3, value4, value5, value6);
+			if (ExtendShortLogRun("MultiMeter", m_MultiMeterRuns, ID, szValues, now, szDateNow))
+				continue;
+
 			//insert record
 			safe_query(
-				"INSERT INTO MultiMeter (DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6) "
-				"VALUES ('%" PRIu64 "', '%llu', '%llu', '%llu', '%llu', '%llu', '%llu')",
+				"INSERT INTO MultiMeter (DeviceRowID, Value1, Value2, Value3, Value4, Value5, Value6, Date) "
+				"VALUES ('%" PRIu64 "', '%llu', '%llu', '%llu', '%llu', '%llu', '%llu', '%q')",
 				ID,
 				value1,
 				value2,
 				value3,
 				value4,
 				value5,
-				value6
+				value6,
+				szDateNow
 			);
 		}
 	}
@@ -6263,22 +6669,7 @@ void CSQLHelper::AddCalendarUpdateMeter()
 			double total_max = (double)atof(sd[1].c_str());
 			double avg_value = (double)atof(sd[2].c_str());
 
-			if (
-				(devType != pTypeAirQuality) &&
-				(devType != pTypeRFXSensor) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeVisibility))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeDistance))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeSolarRadiation))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeSoilMoisture))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeLeafWetness))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeVoltage))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeCurrent))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypePressure))) &&
-				(!((devType == pTypeGeneral) && (subType == sTypeSoundLevel))) &&
-				(devType != pTypeLux) &&
-				(devType != pTypeWEIGHT) &&
-				(devType != pTypeUsage)
-				)
+			if (!IsInstantMeterType(devType, subType))
 			{
 				double total_real = total_max - total_min;
 				double counter = total_max;
@@ -6871,6 +7262,7 @@ void CSQLHelper::DeleteDevices(const std::string &idx)
 #endif
 	{
 		//Avoid mutex deadlock here
+		std::lock_guard<std::mutex> t(m_sqlTransactionMutex);
 		std::lock_guard<std::mutex> l(m_sqlQueryMutex);
 
 		char* errorMessage;
@@ -6928,6 +7320,7 @@ void CSQLHelper::DeleteDevices(const std::string &idx)
 	}
 #endif
 
+	ReloadSceneGraph();
 	m_notifications.ReloadNotifications();
 }
 
@@ -6940,6 +7333,7 @@ void CSQLHelper::DeleteScenes(const std::string& idx)
 		return;
 	{
 		//Avoid mutex deadlock here
+		std::lock_guard<std::mutex> t(m_sqlTransactionMutex);
 		std::lock_guard<std::mutex> l(m_sqlQueryMutex);
 
 		char* errorMessage;
@@ -6958,6 +7352,7 @@ void CSQLHelper::DeleteScenes(const std::string& idx)
 		sqlite3_exec(m_dbase, "COMMIT TRANSACTION", NULL, NULL, &errorMessage);
 	}
 
+	ReloadSceneGraph();
 	m_notifications.ReloadNotifications();
 }
 
@@ -7151,14 +7546,57 @@ void CSQLHelper::CheckSceneStatusWithDevice(const std::string &DevIdx)
 
 void CSQLHelper::CheckSceneStatusWithDevice(const uint64_t DevIdx)
 {
-	std::vector<std::vector<std::string> > result;
-
-	result = safe_query("SELECT SceneRowID FROM SceneDevices WHERE (DeviceRowID == %" PRIu64 ")", DevIdx);
-	for (const auto & itt : result)
+	std::unique_lock<std::mutex> w(m_sceneGraphWriteMutex);
 	{
-		std::vector<std::string> sd = itt;
-		CheckSceneStatus(sd[0]);
+		std::unique_lock<std::mutex> lock(m_sceneGraphMutex);
+		LoadSceneGraph(lock);
+		if (m_sceneGraphDevices.find(DevIdx) == m_sceneGraphDevices.end())
+			return; //not part of a scene/group
+	}
+
+	std::vector<std::vector<std::string> > result;
+	result = safe_query("SELECT Type, SubType, SwitchType, nValue, sValue FROM DeviceStatus WHERE (ID == %" PRIu64 ")", DevIdx);
+	if (result.empty())
+		return;
+	const std::vector<std::string> &sd = result[0];
+	bool bIsOn = IsSceneDeviceOn(
+		(unsigned char)atoi(sd[0].c_str()), (unsigned char)atoi(sd[1].c_str()), (_eSwitchType)atoi(sd[2].c_str()),
+		atoi(sd[3].c_str()), sd[4]);
+
+	std::vector<std::pair<uint64_t, int> > changedScenes;
+	{
+		std::unique_lock<std::mutex> lock(m_sceneGraphMutex);
+		std::map<uint64_t, _tSceneGraphDevice>::iterator itt = m_sceneGraphDevices.find(DevIdx);
+		if (itt == m_sceneGraphDevices.end())
+			return; //the graph was reloaded meanwhile, it has read the current state
+		_tSceneGraphDevice &device = itt->second;
+		bool bStateChanged = (bIsOn != device.bIsOn);
+		device.bIsOn = bIsOn;
+		for (const auto & itt2 : device.scenes)
+		{
+			std::map<uint64_t, _tSceneGraphScene>::iterator itt3 = m_sceneGraphScenes.find(itt2.first);
+			if (itt3 == m_sceneGraphScenes.end())
+				continue;
+			_tSceneGraphScene &scene = itt3->second;
+			if (bStateChanged)
+			{
+				//the device can be added multiple times to the same scene/group
+				if (bIsOn)
+					scene.totOn += itt2.second;
+				else
+					scene.totOn -= itt2.second;
+			}
+			if (UpdateSceneGraphValue(scene))
+				changedScenes.push_back(std::make_pair(itt2.first, scene.nValue));
+		}
 	}
+	if (changedScenes.empty())
+		return;
+	for (const auto & itt : changedScenes)
+		StoreSceneGraphValue(itt.first, itt.second);
+	w.unlock();
+	if (m_sql.m_bEnableEventSystem)  // Only when eventSystem is active
+		m_mainworker.m_eventsystem.GetCurrentScenesGroups();
 }
 
 void CSQLHelper::CheckSceneStatus(const std::string &Idx)
@@ -7169,59 +7607,110 @@ void CSQLHelper::CheckSceneStatus(const std::string &Idx)
 
 void CSQLHelper::CheckSceneStatus(const uint64_t Idx)
 {
-	std::vector<std::vector<std::string> > result;
+	std::unique_lock<std::mutex> w(m_sceneGraphWriteMutex);
+	int nValue;
+	{
+		std::unique_lock<std::mutex> lock(m_sceneGraphMutex);
+		LoadSceneGraph(lock);
 
-	result = safe_query("SELECT nValue FROM Scenes WHERE (ID == %" PRIu64 ")", Idx);
-	if (result.empty())
-		return; //not found
+		std::map<uint64_t, _tSceneGraphScene>::iterator itt = m_sceneGraphScenes.find(Idx);
+		if (itt == m_sceneGraphScenes.end())
+			return; //not found
+		if (!UpdateSceneGraphValue(itt->second))
+			return;
+		nValue = itt->second.nValue;
+	}
+	StoreSceneGraphValue(Idx, nValue);
+	w.unlock();
+	if (m_sql.m_bEnableEventSystem)  // Only when eventSystem is active
+		m_mainworker.m_eventsystem.GetCurrentScenesGroups();
+}
 
-	unsigned char orgValue = (unsigned char)atoi(result[0][0].c_str());
-	unsigned char newValue = orgValue;
+bool CSQLHelper::IsSceneDeviceOn(const unsigned char dType, const unsigned char dSubType, const _eSwitchType switchtype, const int nValue, const std::string &sValue)
+{
+	std::string lstatus = "";
+	int llevel = 0;
+	bool bHaveDimmer = false;
+	bool bHaveGroupCmd = false;
+	int maxDimLevel = 0;
+
+	GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
+	return IsLightSwitchOn(lstatus);
+}
 
-	result = safe_query("SELECT a.ID, a.DeviceID, a.Unit, a.Type, a.SubType, a.SwitchType, a.nValue, a.sValue FROM DeviceStatus AS a, SceneDevices as b WHERE (a.ID == b.DeviceRowID) AND (b.SceneRowID == %" PRIu64 ")",
-		Idx);
-	if (result.empty())
-		return; //no devices in scene
+/*
+ * Scene/group status is derived from the on/off state of its devices. The membership (in both directions) and
+ * the number of members that are on are kept in memory, so a device update only touches the scenes/groups it belongs to.
+ * (lock holds m_sceneGraphMutex, it is released while the tables are read)
+ */
+void CSQLHelper::LoadSceneGraph(std::unique_lock<std::mutex> &lock)
+{
+	while (!m_bSceneGraphLoaded)
+	{
+		uint64_t generation = m_SceneGraphGeneration;
+		lock.unlock();
 
-	std::vector<bool> _DeviceStatusResults;
+		std::map<uint64_t, _tSceneGraphScene> scenes;
+		std::map<uint64_t, _tSceneGraphDevice> devices;
+		std::vector<std::vector<std::string> > result;
+		result = safe_query("SELECT ID, nValue FROM Scenes");
+		for (const auto & itt : result)
+		{
+			const std::vector<std::string> &sd = itt;
+			_tSceneGraphScene &scene = scenes[std::strtoull(sd[0].c_str(), nullptr, 10)];
+			scene.nValue = atoi(sd[1].c_str());
+			scene.totMembers = 0;
+			scene.totOn = 0;
+		}
 
-	for (const auto & itt : result)
-	{
-		std::vector<std::string> sd = itt;
-		int nValue = atoi(sd[6].c_str());
-		std::string sValue = sd[7];
-		//unsigned char Unit=atoi(sd[2].c_str());
-		unsigned char dType = atoi(sd[3].c_str());
-		unsigned char dSubType = atoi(sd[4].c_str());
-		_eSwitchType switchtype = (_eSwitchType)atoi(sd[5].c_str());
+		result = safe_query("SELECT b.SceneRowID, a.ID, a.Type, a.SubType, a.SwitchType, a.nValue, a.sValue FROM DeviceStatus AS a, SceneDevices as b WHERE (a.ID == b.DeviceRowID)");
+		for (const auto & itt : result)
+		{
+			const std::vector<std::string> &sd = itt;
+			uint64_t SceneIdx = std::strtoull(sd[0].c_str(), nullptr, 10);
+			uint64_t DevIdx = std::strtoull(sd[1].c_str(), nullptr, 10);
+			std::map<uint64_t, _tSceneGraphScene>::iterator itt2 = scenes.find(SceneIdx);
+			if (itt2 == scenes.end())
+				continue; //orphaned scene device
 
-		std::string lstatus = "";
-		int llevel = 0;
-		bool bHaveDimmer = false;
-		bool bHaveGroupCmd = false;
-		int maxDimLevel = 0;
+			std::map<uint64_t, _tSceneGraphDevice>::iterator itt3 = devices.find(DevIdx);
+			if (itt3 == devices.end())
+			{
+				_tSceneGraphDevice device;
+				device.bIsOn = IsSceneDeviceOn(
+					(unsigned char)atoi(sd[2].c_str()), (unsigned char)atoi(sd[3].c_str()), (_eSwitchType)atoi(sd[4].c_str()),
+					atoi(sd[5].c_str()), sd[6]);
+				itt3 = devices.insert(std::make_pair(DevIdx, device)).first;
+			}
+			itt3->second.scenes[SceneIdx]++;
+			itt2->second.totMembers++;
+			if (itt3->second.bIsOn)
+				itt2->second.totOn++;
+		}
 
-		GetLightStatus(dType, dSubType, switchtype, nValue, sValue, lstatus, llevel, bHaveDimmer, maxDimLevel, bHaveGroupCmd);
-		_DeviceStatusResults.push_back(IsLightSwitchOn(lstatus));
+		lock.lock();
+		//scenes/groups were changed while reading, read them again
+		if (generation != m_SceneGraphGeneration)
+			continue;
+		m_sceneGraphScenes.swap(scenes);
+		m_sceneGraphDevices.swap(devices);
+		m_bSceneGraphLoaded = true;
 	}
+}
 
-	//Check if all on/off
-	size_t totOn = 0;
-	size_t totOff = 0;
+//Returns true when the scene/group status has changed (m_sceneGraphMutex has to be locked)
+bool CSQLHelper::UpdateSceneGraphValue(_tSceneGraphScene &scene)
+{
+	if (scene.totMembers == 0)
+		return false; //no devices in scene
 
-	for (const auto & itt2 : _DeviceStatusResults)
-	{
-		if (itt2 == true)
-			totOn++;
-		else
-			totOff++;
-	}
-	if (totOn == _DeviceStatusResults.size())
+	int newValue;
+	if (scene.totOn == scene.totMembers)
 	{
 		//All are on
 		newValue = 1;
 	}
-	else if (totOff == _DeviceStatusResults.size())
+	else if (scene.totOn == 0)
 	{
 		//All are Off
 		newValue = 0;
@@ -7231,14 +7720,36 @@ void CSQLHelper::CheckSceneStatus(const uint64_t Idx)
 		//Some are on, some are off
 		newValue = 2;
 	}
-	if (newValue != orgValue)
-	{
-		//Set new Scene status
-		safe_query("UPDATE Scenes SET nValue=%d WHERE (ID == %" PRIu64 ")",
-			int(newValue), Idx);
-		if (m_sql.m_bEnableEventSystem)  // Only when eventSystem is active
-			m_mainworker.m_eventsystem.GetCurrentScenesGroups(); 
-	}
+	if (newValue == scene.nValue)
+		return false;
+	scene.nValue = newValue;
+	return true;
+}
+
+//Set new Scene status (m_sceneGraphWriteMutex has to be locked, m_sceneGraphMutex not)
+void CSQLHelper::StoreSceneGraphValue(const uint64_t Idx, const int nValue)
+{
+	safe_query("UPDATE Scenes SET nValue=%d WHERE (ID == %" PRIu64 ")",
+		nValue, Idx);
+}
+
+//Needs to be called when scenes/groups or their devices are added/removed
+void CSQLHelper::ReloadSceneGraph()
+{
+	std::unique_lock<std::mutex> lock(m_sceneGraphMutex);
+	m_SceneGraphGeneration++;
+	m_sceneGraphScenes.clear();
+	m_sceneGraphDevices.clear();
+	m_bSceneGraphLoaded = false;
+}
+
+//Scene/group status set by switching the scene/group itself
+void CSQLHelper::SetSceneGraphValue(const uint64_t Idx, const int nValue)
+{
+	std::unique_lock<std::mutex> lock(m_sceneGraphMutex);
+	std::map<uint64_t, _tSceneGraphScene>::iterator itt = m_sceneGraphScenes.find(Idx);
+	if (itt != m_sceneGraphScenes.end())
+		itt->second.nValue = nValue;
 }
 
 void CSQLHelper::DeleteDataPoint(const char *ID, const std::string &Date)
@@ -7742,81 +8253,145 @@ void CSQLHelper::CheckBatteryLow()
 	}
 }
 
-//Executed every hour
-void CSQLHelper::CheckDeviceTimeout()
+//Switches are not expected to report on their own
+static bool HasSensorTimeout(const int devType)
 {
+	switch (devType)
+	{
+	case pTypeLighting1:
+	case pTypeLighting2:
+	case pTypeLighting3:
+	case pTypeLighting4:
+	case pTypeLighting5:
+	case pTypeLighting6:
+	case pTypeFan:
+	case pTypeRadiator1:
+	case pTypeColorSwitch:
+	case pTypeSecurity1:
+	case pTypeCurtain:
+	case pTypeBlinds:
+	case pTypeRFY:
+	case pTypeChime:
+	case pTypeThermostat2:
+	case pTypeThermostat3:
+	case pTypeThermostat4:
+	case pTypeRemote:
+	case pTypeGeneralSwitch:
+	case pTypeHomeConfort:
+	case pTypeFS20:
+	case pTypeHunter:
+		return false;
+	}
+	return true;
+}
+
+//Called from the update path, the timeout of the sensor restarts
+void CSQLHelper::ScheduleSensorTimeout(const uint64_t DeviceRowIdx, const int devType, const time_t LastUpdate)
+{
+	if (!HasSensorTimeout(devType))
+		return;
 	int TimeoutCheckInterval = 1;
 	GetPreferencesVar("SensorTimeoutNotification", TimeoutCheckInterval);
-
 	if (TimeoutCheckInterval == 0)
 		return;
-	m_sensortimeoutcounter += 1;
-	if (m_sensortimeoutcounter < TimeoutCheckInterval)
+	int SensorTimeOut = 60;
+	GetPreferencesVar("SensorTimeout", SensorTimeOut);
+	m_mainworker.m_devicetimeouts.Schedule(DeviceRowIdx, CDeviceTimeoutTracker::TIMEOUT_SENSOR, LastUpdate + (SensorTimeOut * 60));
+}
+
+//Called when the Used flag of a device changed, a used device times out from its last update, an unused one not at all
+void CSQLHelper::RescheduleSensorTimeout(const uint64_t DeviceRowIdx)
+{
+	std::vector<std::vector<std::string> > result;
+	result = safe_query("SELECT Type, Used, LastUpdate FROM DeviceStatus WHERE (ID==%" PRIu64 ")", DeviceRowIdx);
+	if ((result.empty()) || (atoi(result[0][1].c_str()) == 0))
+	{
+		m_mainworker.m_devicetimeouts.Schedule(DeviceRowIdx, CDeviceTimeoutTracker::TIMEOUT_SENSOR, 0);
+		return;
+	}
+	const std::vector<std::string> &sd = result[0];
+
+	time_t now = mytime(NULL);
+	struct tm tm1;
+	localtime_r(&now, &tm1);
+	struct tm ntime;
+	time_t lastupdate;
+	ParseSQLdatetime(lastupdate, ntime, sd[2], tm1.tm_isdst);
+	ScheduleSensorTimeout(DeviceRowIdx, atoi(sd[0].c_str()), lastupdate);
+}
+
+//(Re)loads the sensor timeouts of all used devices, at startup and when the timeout settings change
+void CSQLHelper::LoadDeviceTimeouts()
+{
+	m_mainworker.m_devicetimeouts.Clear(CDeviceTimeoutTracker::TIMEOUT_SENSOR);
+
+	int TimeoutCheckInterval = 1;
+	GetPreferencesVar("SensorTimeoutNotification", TimeoutCheckInterval);
+	if (TimeoutCheckInterval == 0)
 		return;
-	m_sensortimeoutcounter = 0;
+
+	time_t now = mytime(NULL);
+	struct tm tm1;
+	localtime_r(&now, &tm1);
+
+	std::vector<std::vector<std::string> > result;
+	result = safe_query("SELECT ID, Type, LastUpdate FROM DeviceStatus WHERE (Used!=0)");
+	for (const auto & itt : result)
+	{
+		const std::vector<std::string> &sd = itt;
+		struct tm ntime;
+		time_t lastupdate;
+		ParseSQLdatetime(lastupdate, ntime, sd[2], tm1.tm_isdst);
+		ScheduleSensorTimeout(std::strtoull(sd[0].c_str(), nullptr, 10), atoi(sd[1].c_str()), lastupdate);
+	}
+}
+
+//Called by the device timeout tracker when the sensor timeout of a device expired,
+//returns when the device has to be checked again (0 = not anymore)
+time_t CSQLHelper::HandleSensorTimeout(const uint64_t DeviceRowIdx, const time_t now)
+{
+	int TimeoutCheckInterval = 1;
+	GetPreferencesVar("SensorTimeoutNotification", TimeoutCheckInterval);
+	if (TimeoutCheckInterval == 0)
+		return 0;
 
 	int SensorTimeOut = 60;
 	GetPreferencesVar("SensorTimeout", SensorTimeOut);
-	time_t now = mytime(NULL);
-	struct tm stoday;
-	localtime_r(&now, &stoday);
-	now -= (SensorTimeOut * 60);
-	struct tm ltime;
-	localtime_r(&now, &ltime);
 
 	std::vector<std::vector<std::string> > result;
-	result = safe_query(
-		"SELECT ID, Name, LastUpdate FROM DeviceStatus WHERE (Used!=0 AND LastUpdate<='%04d-%02d-%02d %02d:%02d:%02d' "
-		"AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d "
-		"AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d AND Type!=%d) "
-		"ORDER BY Name",
-		ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday, ltime.tm_hour, ltime.tm_min, ltime.tm_sec,
-		pTypeLighting1,
-		pTypeLighting2,
-		pTypeLighting3,
-		pTypeLighting4,
-		pTypeLighting5,
-		pTypeLighting6,
-		pTypeFan,
-		pTypeRadiator1,
-		pTypeColorSwitch,
-		pTypeSecurity1,
-		pTypeCurtain,
-		pTypeBlinds,
-		pTypeRFY,
-		pTypeChime,
-		pTypeThermostat2,
-		pTypeThermostat3,
-		pTypeThermostat4,
-		pTypeRemote,
-		pTypeGeneralSwitch,
-		pTypeHomeConfort,
-		pTypeFS20,
-		pTypeHunter
-	);
+	result = safe_query("SELECT Name, Type, Used, LastUpdate FROM DeviceStatus WHERE (ID==%" PRIu64 ")", DeviceRowIdx);
 	if (result.empty())
-		return;
+		return 0;
+	const std::vector<std::string> &sd = result[0];
+	if ((atoi(sd[2].c_str()) == 0) || (!HasSensorTimeout(atoi(sd[1].c_str()))))
+		return 0;
+
+	struct tm stoday;
+	localtime_r(&now, &stoday);
+	struct tm ntime;
+	time_t lastupdate;
+	ParseSQLdatetime(lastupdate, ntime, sd[3], stoday.tm_isdst);
+	time_t deadline = lastupdate + (SensorTimeOut * 60);
+	if (deadline > now)
+		return deadline; //updated without passing the update path (scripts, API)
 
 	//check if last timeout_notification is not sent today and if true, send notification
-	for (const auto & itt : result)
+	bool bDoSend = true;
+	std::map<uint64_t, int>::const_iterator sitt;
+	sitt = m_timeoutlastsend.find(DeviceRowIdx);
+	if (sitt != m_timeoutlastsend.end())
 	{
-		std::vector<std::string> sd = itt;
-		uint64_t ulID = std::strtoull(sd[0].c_str(), nullptr, 10);
-		bool bDoSend = true;
-		std::map<uint64_t, int>::const_iterator sitt;
-		sitt = m_timeoutlastsend.find(ulID);
-		if (sitt != m_timeoutlastsend.end())
-		{
-			bDoSend = (stoday.tm_mday != sitt->second);
-		}
-		if (bDoSend)
-		{
-			char szTmp[300];
-			sprintf(szTmp, "Sensor Timeout: %s, Last Received: %s", sd[1].c_str(), sd[2].c_str());
-			m_notifications.SendMessageEx(0, std::string(""), NOTIFYALL, szTmp, szTmp, std::string(""), 1, std::string(""), true);
-			m_timeoutlastsend[ulID] = stoday.tm_mday;
-		}
+		bDoSend = (stoday.tm_mday != sitt->second);
+	}
+	if (bDoSend)
+	{
+		char szTmp[300];
+		sprintf(szTmp, "Sensor Timeout: %s, Last Received: %s", sd[0].c_str(), sd[3].c_str());
+		m_notifications.SendMessageEx(0, std::string(""), NOTIFYALL, szTmp, szTmp, std::string(""), 1, std::string(""), true);
+		m_timeoutlastsend[DeviceRowIdx] = stoday.tm_mday;
 	}
+	//as long as the sensor stays silent, look again every SensorTimeoutNotification hours
+	return now + (TimeoutCheckInterval * 3600);
 }
 
 void CSQLHelper::FixDaylightSavingTableSimple(const std::string &TableName)
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <functional>
+#include <atomic>
 #include "RFXNames.h"
 #include "../hardware/hardwaretypes.h"
 #include "Helper.h"
@@ -348,11 +350,14 @@ public:
 	void CheckSceneStatus(const std::string &Idx);
 	void CheckSceneStatusWithDevice(const uint64_t DevIdx);
 	void CheckSceneStatusWithDevice(const std::string &DevIdx);
+	void ReloadSceneGraph();
+	void SetSceneGraphValue(const uint64_t Idx, const int nValue);
 
 	void ScheduleShortlog();
 	void ScheduleDay();
 
 	void ClearShortLog();
+	void ExpandShortLogRuns(std::vector<std::vector<std::string> > &result, const size_t DateColumn, const size_t UnchangedColumn);
 	void VacuumDatabase();
 	void OptimizeDatabase(sqlite3 *dbase);
 
@@ -377,7 +382,10 @@ public:
 
 	void SetUnitsAndScale();
 
-	void CheckDeviceTimeout();
+	void LoadDeviceTimeouts();
+	void ScheduleSensorTimeout(const uint64_t DeviceRowIdx, const int devType, const time_t LastUpdate);
+	void RescheduleSensorTimeout(const uint64_t DeviceRowIdx);
+	time_t HandleSensorTimeout(const uint64_t DeviceRowIdx, const time_t now);
 	void CheckBatteryLow();
 
 	bool HandleOnOffAction(const bool bIsOn, const std::string &OnAction, const std::string &OffAction);
@@ -385,6 +393,8 @@ public:
 	std::vector<std::vector<std::string> > safe_query(const char *fmt, ...);
 	std::vector<std::vector<std::string> > safe_queryBlob(const char *fmt, ...);
 	void safe_exec_no_return(const char *fmt, ...);
+	void ExecuteTransaction(const std::vector<std::string> &queries);
+	void ExecuteInTransaction(const std::function<void()> &func);
 	bool safe_UpdateBlobInTableWithID(const std::string &Table, const std::string &Column, const std::string &sID, const std::string &BlobData);
 	bool DoesColumnExistsInTable(const std::string &columnname, const std::string &tablename);
 
@@ -414,6 +424,9 @@ public:
 	bool SetDeviceOptions(const uint64_t idx, const std::map<std::string, std::string> & options);
 
 	float GetCounterDivider(const int metertype, const int dType, const float DefaultValue);
+
+	//Increased whenever a row is deleted from DeviceStatus (by anyone), caches of device row ids compare it to drop stale entries
+	uint64_t GetDeviceDeleteGeneration() const { return m_DeviceDeleteGeneration; }
 public:
 	std::string m_LastSwitchID;	//for learning command
 	uint64_t m_LastSwitchRowID;
@@ -436,15 +449,63 @@ public:
 	bool		m_bDisableDzVentsSystem;
 private:
 	std::mutex		m_sqlQueryMutex;
+	std::mutex		m_sqlTransactionMutex;
 	sqlite3			*m_dbase;
 	std::string		m_dbase_name;
-	unsigned char	m_sensortimeoutcounter;
+	std::atomic<uint64_t> m_DeviceDeleteGeneration;
 	std::map<uint64_t, int> m_timeoutlastsend;
 	std::map<uint64_t, int> m_batterylowlastsend;
 	bool			m_bAcceptHardwareTimerActive;
 	float			m_iAcceptHardwareTimerCounter;
 	bool			m_bPreviousAcceptNewHardware;
 
+	//Last shortlog row written per device, for storing unchanged meter readings as runs
+	struct _tShortLogRun
+	{
+		std::string sValues;
+		std::string sDate;
+		time_t tDate;
+		bool bOpen; //the last row repeats the row before it and can be moved forward
+	};
+	std::map<uint64_t, _tShortLogRun> m_MeterRuns;
+	std::map<uint64_t, _tShortLogRun> m_MultiMeterRuns;
+
+	struct _tPreferenceValue
+	{
+		int nValue;
+		std::string sValue;
+		double fValue;
+	};
+	std::mutex m_preferencesMutex;		//guards the cached values only, no queries run while it is held
+	std::mutex m_preferencesWriteMutex;	//serializes the Preferences table writes
+	std::map<std::string, _tPreferenceValue> m_preferences;
+	bool m_bPreferencesLoaded;
+	uint64_t m_PreferencesGeneration;	//changed on every write/clear, a load that overlapped one is repeated
+	void LoadPreferences(std::unique_lock<std::mutex> &lock);
+	void ClearPreferencesCache();
+
+	struct _tSceneGraphScene
+	{
+		int nValue;
+		size_t totMembers;
+		size_t totOn;
+	};
+	struct _tSceneGraphDevice
+	{
+		bool bIsOn;
+		std::map<uint64_t, size_t> scenes; //scene idx, number of times the device is part of the scene
+	};
+	std::mutex m_sceneGraphMutex;		//guards the graph only, no queries run while it is held
+	std::mutex m_sceneGraphWriteMutex;	//serializes the status updates, so they reach the Scenes table in order
+	std::map<uint64_t, _tSceneGraphScene> m_sceneGraphScenes;
+	std::map<uint64_t, _tSceneGraphDevice> m_sceneGraphDevices;
+	bool m_bSceneGraphLoaded;
+	uint64_t m_SceneGraphGeneration;	//changed on every reload, a load that overlapped one is repeated
+	void LoadSceneGraph(std::unique_lock<std::mutex> &lock);
+	bool UpdateSceneGraphValue(_tSceneGraphScene &scene);
+	void StoreSceneGraphValue(const uint64_t Idx, const int nValue);
+	static bool IsSceneDeviceOn(const unsigned char dType, const unsigned char dSubType, const _eSwitchType switchtype, const int nValue, const std::string &sValue);
+
 	std::vector<_tTaskItem> m_background_task_queue;
 	std::shared_ptr<std::thread> m_thread;
 	std::mutex m_background_task_mutex;
@@ -481,6 +542,8 @@ private:
 	void UpdateRainLog();
 	void UpdateWindLog();
 	void UpdateUVLog();
+	bool ExtendShortLogRun(const char *szTable, std::map<uint64_t, _tShortLogRun> &runs, const uint64_t ID, const std::string &sValues, const time_t now, const char *szDateNow);
+	void CompactShortLogRuns();
 	void UpdateMeter();
 	void UpdateMultiMeter();
 	void UpdatePercentageLog();
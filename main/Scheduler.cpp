@@ -25,6 +25,8 @@ CScheduler::CScheduler(void)
 	m_tNautTwEnd = 0;
 	m_tAstTwStart = 0;
 	m_tAstTwEnd = 0;
+	m_bWakeUp = false;
+	m_nRandomTimerFrame = 15;
 	srand((int)mytime(NULL));
 }
 
@@ -43,6 +45,11 @@ void CScheduler::StopScheduler()
 	if (m_thread)
 	{
 		RequestStop();
+		{
+			std::lock_guard<std::mutex> l(m_mutex);
+			m_bWakeUp = true;
+		}
+		m_cvWakeUp.notify_one();
 		m_thread->join();
 		m_thread.reset();
 	}
@@ -62,6 +69,11 @@ void CScheduler::ReloadSchedules()
 	std::lock_guard<std::mutex> l(m_mutex);
 	m_scheduleitems.clear();
 
+	m_nRandomTimerFrame = 15;
+	m_sql.GetPreferencesVar("RandomTimerFrame", m_nRandomTimerFrame);
+	if (m_nRandomTimerFrame == 0)
+		m_nRandomTimerFrame = 15;
+
 	std::vector<std::vector<std::string> > result;
 
 	time_t atime = mytime(NULL);
@@ -347,11 +359,55 @@ void CScheduler::ReloadSchedules()
 				m_scheduleitems.push_back(titem);
 		}
 	}
+
+	RebuildScheduleQueue();
+}
+
+void CScheduler::RebuildScheduleQueue()
+{
+	m_schedulequeue = decltype(m_schedulequeue)();
+	for (size_t ii = 0; ii < m_scheduleitems.size(); ii++)
+	{
+		if (m_scheduleitems[ii].bEnabled)
+			m_schedulequeue.push(tScheduleQueueItem(m_scheduleitems[ii].startTime, ii));
+	}
+	m_bWakeUp = true;
+	m_cvWakeUp.notify_one();
+}
+
+bool CScheduler::IsSunTimer(const _eTimerType timerType)
+{
+	switch (timerType)
+	{
+	case TTYPE_BEFORESUNRISE:
+	case TTYPE_AFTERSUNRISE:
+	case TTYPE_BEFORESUNSET:
+	case TTYPE_AFTERSUNSET:
+	case TTYPE_BEFORESUNATSOUTH:
+	case TTYPE_AFTERSUNATSOUTH:
+	case TTYPE_BEFORECIVTWSTART:
+	case TTYPE_AFTERCIVTWSTART:
+	case TTYPE_BEFORECIVTWEND:
+	case TTYPE_AFTERCIVTWEND:
+	case TTYPE_BEFORENAUTTWSTART:
+	case TTYPE_AFTERNAUTTWSTART:
+	case TTYPE_BEFORENAUTTWEND:
+	case TTYPE_AFTERNAUTTWEND:
+	case TTYPE_BEFOREASTTWSTART:
+	case TTYPE_AFTERASTTWSTART:
+	case TTYPE_BEFOREASTTWEND:
+	case TTYPE_AFTERASTTWEND:
+		return true;
+	default:
+		break;
+	}
+	return false;
 }
 
 void CScheduler::SetSunRiseSetTimers(const std::string &sSunRise, const std::string &sSunSet, const std::string &sSunAtSouth, const std::string &sCivTwStart, const std::string &sCivTwEnd, const std::string &sNautTwStart, const std::string &sNautTwEnd, const std::string &sAstTwStart, const std::string &sAstTwEnd)
 {
 	bool bReloadSchedules = false;
+	bool bSunTimesChanged = false;
 
 	{	//needed private scope for the lock
 		std::lock_guard<std::mutex> l(m_mutex);
@@ -376,9 +432,38 @@ void CScheduler::SetSunRiseSetTimers(const std::string &sSunRise, const std::str
 			{
 				if (*allTimes[a] == 0)
 					bReloadSchedules = true;
+				else
+					bSunTimesChanged = true;
 				*allTimes[a] = temptime;
 			}
 		}
+
+		if ((bSunTimesChanged) && (!bReloadSchedules))
+		{
+			//only the items relative to the sun need a new start time
+			for (size_t ii = 0; ii < m_scheduleitems.size(); ii++)
+			{
+				tScheduleItem &item = m_scheduleitems[ii];
+				if ((!item.bEnabled) || (!IsSunTimer(item.timerType)))
+					continue;
+				tScheduleItem titem = item;
+				if (!AdjustScheduleItem(&titem, false))
+					continue;
+				//do not fire twice on the same day when the sun moved past an item that already fired
+				if ((item.lastFired != 0) && (titem.startTime - item.lastFired < 12 * 3600))
+				{
+					if (!AdjustScheduleItem(&titem, true))
+						continue;
+				}
+				if (titem.startTime != item.startTime)
+				{
+					item.startTime = titem.startTime;
+					m_schedulequeue.push(tScheduleQueueItem(item.startTime, ii));
+				}
+			}
+			m_bWakeUp = true;
+			m_cvWakeUp.notify_one();
+		}
 	}
 
 	if (bReloadSchedules)
@@ -401,32 +486,11 @@ bool CScheduler::AdjustScheduleItem(tScheduleItem *pItem, bool bForceAddDay)
 
 	unsigned long HourMinuteOffset = (pItem->startHour * 3600) + (pItem->startMin * 60);
 
-	int nRandomTimerFrame = 15;
-	m_sql.GetPreferencesVar("RandomTimerFrame", nRandomTimerFrame);
-	if (nRandomTimerFrame == 0)
-		nRandomTimerFrame = 15;
+	int nRandomTimerFrame = m_nRandomTimerFrame;
 	int roffset = 0;
 	if (pItem->bUseRandomness)
 	{
-		if ((pItem->timerType == TTYPE_BEFORESUNRISE) ||
-			(pItem->timerType == TTYPE_AFTERSUNRISE) ||
-			(pItem->timerType == TTYPE_BEFORESUNSET) ||
-			(pItem->timerType == TTYPE_AFTERSUNSET) ||
-
-			(pItem->timerType == TTYPE_BEFORESUNATSOUTH) ||
-			(pItem->timerType == TTYPE_AFTERSUNATSOUTH) ||
-			(pItem->timerType == TTYPE_BEFORECIVTWSTART) ||
-			(pItem->timerType == TTYPE_AFTERCIVTWSTART) ||
-			(pItem->timerType == TTYPE_BEFORECIVTWEND) ||
-			(pItem->timerType == TTYPE_AFTERCIVTWEND) ||
-			(pItem->timerType == TTYPE_BEFORENAUTTWSTART) ||
-			(pItem->timerType == TTYPE_AFTERNAUTTWSTART) ||
-			(pItem->timerType == TTYPE_BEFORENAUTTWEND) ||
-			(pItem->timerType == TTYPE_AFTERNAUTTWEND) ||
-			(pItem->timerType == TTYPE_BEFOREASTTWSTART) ||
-			(pItem->timerType == TTYPE_AFTERASTTWSTART) ||
-			(pItem->timerType == TTYPE_BEFOREASTTWEND) ||
-			(pItem->timerType == TTYPE_AFTERASTTWEND))
+		if (IsSunTimer(pItem->timerType))
 			roffset = rand() % (nRandomTimerFrame);
 		else
 			roffset = rand() % (nRandomTimerFrame * 2) - nRandomTimerFrame;
@@ -699,22 +763,32 @@ bool CScheduler::AdjustScheduleItem(tScheduleItem *pItem, bool bForceAddDay)
 
 void CScheduler::Do_Work()
 {
-	while (!IsStopRequested(1000))
+	time_t tLastHeartbeat = 0;
+	time_t tLastMinute = mytime(NULL) / 60;
+	while (!IsStopRequested(0))
 	{
 		time_t atime = mytime(NULL);
-		struct tm ltime;
-		localtime_r(&atime, &ltime);
-
 
-		if (ltime.tm_sec % 12 == 0) {
+		if (atime - tLastHeartbeat >= 12) {
 			m_mainworker.HeartbeatUpdate("Scheduler");
+			tLastHeartbeat = atime;
 		}
 
 		CheckSchedules();
 
-		if (ltime.tm_sec == 0) {
+		if (atime / 60 != tLastMinute) {
+			tLastMinute = atime / 60;
 			DeleteExpiredTimers();
 		}
+
+		//sleep until the first item is due (they fire the second after their start time),
+		//the next heartbeat or the next minute, whichever comes first
+		std::unique_lock<std::mutex> lock(m_mutex);
+		time_t tWakeUp = std::min(tLastHeartbeat + 12, (tLastMinute + 1) * 60);
+		if ((!m_schedulequeue.empty()) && (m_schedulequeue.top().first + 1 < tWakeUp))
+			tWakeUp = m_schedulequeue.top().first + 1;
+		m_cvWakeUp.wait_until(lock, std::chrono::system_clock::from_time_t(tWakeUp), [this] { return m_bWakeUp; });
+		m_bWakeUp = false;
 	}
 	_log.Log(LOG_STATUS, "Scheduler stopped...");
 }
@@ -727,9 +801,16 @@ void CScheduler::CheckSchedules()
 	struct tm ltime;
 	localtime_r(&atime, &ltime);
 
-	for (auto & itt : m_scheduleitems)
+	while (!m_schedulequeue.empty())
 	{
-		if ((itt.bEnabled) && (atime > itt.startTime))
+		tScheduleQueueItem qitem = m_schedulequeue.top();
+		if (qitem.first >= atime)
+			break; //nothing due yet
+		m_schedulequeue.pop();
+
+		//skip entries of items that were rescheduled or disabled in the meantime
+		tScheduleItem &itt = m_scheduleitems[qitem.second];
+		if ((itt.bEnabled) && (itt.startTime == qitem.first))
 		{
 			//check if we are on a valid day
 			bool bOkToFire = false;
@@ -805,6 +886,7 @@ void CScheduler::CheckSchedules()
 			}
 			if (bOkToFire)
 			{
+				itt.lastFired = atime;
 				char ltimeBuf[30];
 				strftime(ltimeBuf, sizeof(ltimeBuf), "%Y-%m-%d %H:%M:%S", &ltime);
 
@@ -924,6 +1006,8 @@ void CScheduler::CheckSchedules()
 					itt.bEnabled = false;
 				}
 			}
+			if ((itt.bEnabled) && (itt.startTime > atime))
+				m_schedulequeue.push(tScheduleQueueItem(itt.startTime, qitem.second));
 		}
 	}
 }
@@ -2,6 +2,8 @@
 
 #include "RFXNames.h"
 #include "../hardware/hardwaretypes.h"
+#include <condition_variable>
+#include <queue>
 #include <string>
 #include "StoppableTask.h"
 
@@ -30,6 +32,7 @@ struct tScheduleItem
 	int Occurence;
 	//internal
 	time_t startTime;
+	time_t lastFired;
 
 	tScheduleItem() {
 		bEnabled = false;
@@ -53,6 +56,7 @@ struct tScheduleItem
 		Occurence = 0;
 		//internal
 		startTime = 0;
+		lastFired = 0;
 	}
 
 	bool operator==(const tScheduleItem &comp) const {
@@ -88,11 +92,21 @@ private:
 	time_t m_tAstTwStart;
 	time_t m_tAstTwEnd;
 	std::mutex m_mutex;
+	std::condition_variable m_cvWakeUp;
+	bool m_bWakeUp;
 	std::shared_ptr<std::thread> m_thread;
 	std::vector<tScheduleItem> m_scheduleitems;
+	int m_nRandomTimerFrame;
+
+	//start time and index of the schedule items, earliest first
+	//entries of items that were rescheduled are skipped when their start time does not match anymore
+	typedef std::pair<time_t, size_t> tScheduleQueueItem;
+	std::priority_queue<tScheduleQueueItem, std::vector<tScheduleQueueItem>, std::greater<tScheduleQueueItem> > m_schedulequeue;
 
 	//our thread
 	void Do_Work();
+	void RebuildScheduleQueue();
+	static bool IsSunTimer(const _eTimerType timerType);
 
 	//will set the new/next startTime
 	//returns false if timer is invalid (like no sunset/sunrise known yet)
@@ -0,0 +1,223 @@
+#include "stdafx.h"
+#include "UserSessionCache.h"
+#include "localtime_r.h"
+#include "Logger.h"
+#include "SQLHelper.h"
+#ifdef WITH_EXTERNAL_SQLITE
+#include <sqlite3.h>
+#else
+#include "../sqlite/sqlite3.h"
+#endif
+#include "../webserver/Base64.h"
+
+//Maximum time (in seconds) a modified session is kept in memory before it is written to the database
+#define SESSION_FLUSH_INTERVAL 30
+
+namespace http {
+	namespace server {
+
+		CUserSessionCache m_usersessions;
+
+		CUserSessionCache::CUserSessionCache() :
+			m_bLoaded(false),
+			m_LastFlush(0)
+		{
+		}
+
+		CUserSessionCache::~CUserSessionCache()
+		{
+		}
+
+		void CUserSessionCache::LoadSessions()
+		{
+			if (m_bLoaded)
+				return;
+			m_bLoaded = true;
+			m_LastFlush = mytime(NULL);
+
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT SessionID, Username, AuthToken, ExpirationDate, RemoteHost FROM UserSessions");
+			for (const auto & sd : result)
+			{
+				WebEmStoredSession session;
+				session.id = sd[0];
+				session.username = base64_decode(sd[1]);
+				session.auth_token = sd[2];
+				struct tm tExpirationDate;
+				ParseSQLdatetime(session.expires, tExpirationDate, sd[3]);
+				session.remote_host = sd[4];
+				m_sessions[session.id] = session;
+				m_expiry.push(tExpiryItem(session.expires, session.id));
+			}
+		}
+
+		/**
+		 * Retrieve a session from memory, returns false if the session is unknown
+		 */
+		bool CUserSessionCache::GetSession(const std::string &sessionId, WebEmStoredSession &session)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			LoadSessions();
+			std::map<std::string, WebEmStoredSession>::const_iterator itt = m_sessions.find(sessionId);
+			if (itt == m_sessions.end())
+				return false;
+			session = itt->second;
+			return true;
+		}
+
+		/**
+		 * Insert or update a session, the database is updated on the next flush
+		 */
+		void CUserSessionCache::StoreSession(const WebEmStoredSession &session)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			LoadSessions();
+
+			std::map<std::string, WebEmStoredSession>::iterator itt = m_sessions.find(session.id);
+			if (itt == m_sessions.end())
+			{
+				m_sessions[session.id] = session;
+				m_expiry.push(tExpiryItem(session.expires, session.id));
+			}
+			else
+			{
+				// Username is not updated, same as before
+				if (itt->second.expires != session.expires)
+					m_expiry.push(tExpiryItem(session.expires, session.id));
+				itt->second.auth_token = session.auth_token;
+				itt->second.expires = session.expires;
+				itt->second.remote_host = session.remote_host;
+			}
+			m_removed.erase(session.id);
+			m_dirty.insert(session.id);
+
+			if (mytime(NULL) - m_LastFlush >= SESSION_FLUSH_INTERVAL)
+				FlushInt();
+		}
+
+		void CUserSessionCache::RemoveSessionInt(const std::string &sessionId)
+		{
+			m_sessions.erase(sessionId);
+			m_dirty.erase(sessionId);
+			m_removed.insert(sessionId);
+		}
+
+		void CUserSessionCache::RemoveSession(const std::string &sessionId)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			LoadSessions();
+			RemoveSessionInt(sessionId);
+		}
+
+		/**
+		 * Remove all sessions of a user (username as stored in the database), except one
+		 */
+		void CUserSessionCache::RemoveUsersSessions(const std::string &hashedUsername, const std::string &exceptSessionId)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			LoadSessions();
+
+			std::vector<std::string> ssids;
+			for (const auto & itt : m_sessions)
+			{
+				if ((itt.first != exceptSessionId) && (base64_encode(itt.second.username) == hashedUsername))
+					ssids.push_back(itt.first);
+			}
+			for (const auto & ssid : ssids)
+				RemoveSessionInt(ssid);
+			FlushInt();
+		}
+
+		/**
+		 * Remove all expired sessions and write pending changes to the database
+		 */
+		void CUserSessionCache::CleanSessions()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			LoadSessions();
+
+			time_t now = mytime(NULL);
+			while (!m_expiry.empty() && (m_expiry.top().first < now))
+			{
+				tExpiryItem item = m_expiry.top();
+				m_expiry.pop();
+				std::map<std::string, WebEmStoredSession>::const_iterator itt = m_sessions.find(item.second);
+				// Skip stale heap entries (session removed or its expiration date has been extended)
+				if ((itt == m_sessions.end()) || (itt->second.expires != item.first))
+					continue;
+				RemoveSessionInt(item.second);
+			}
+			FlushInt();
+		}
+
+		void CUserSessionCache::Flush()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			FlushInt();
+		}
+
+		/**
+		 * Forget all cached sessions (without flushing), they are reloaded from the database on next access
+		 */
+		void CUserSessionCache::Clear()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_sessions.clear();
+			m_dirty.clear();
+			m_removed.clear();
+			m_expiry = std::priority_queue<tExpiryItem, std::vector<tExpiryItem>, std::greater<tExpiryItem> >();
+			m_bLoaded = false;
+		}
+
+		void CUserSessionCache::FlushInt()
+		{
+			m_LastFlush = mytime(NULL);
+			if (m_dirty.empty() && m_removed.empty())
+				return;
+
+			std::vector<std::string> queries;
+			for (const auto & ssid : m_removed)
+			{
+				char *zQuery = sqlite3_mprintf("DELETE FROM UserSessions WHERE SessionID = '%q'", ssid.c_str());
+				if (zQuery)
+				{
+					queries.push_back(zQuery);
+					sqlite3_free(zQuery);
+				}
+			}
+			for (const auto & ssid : m_dirty)
+			{
+				std::map<std::string, WebEmStoredSession>::const_iterator itt = m_sessions.find(ssid);
+				if (itt == m_sessions.end())
+					continue;
+				const WebEmStoredSession &session = itt->second;
+
+				char szExpires[30];
+				struct tm ltime;
+				localtime_r(&session.expires, &ltime);
+				strftime(szExpires, sizeof(szExpires), "%Y-%m-%d %H:%M:%S", &ltime);
+
+				std::string remote_host = (session.remote_host.size() <= 50) ? // IPv4 : 15, IPv6 : (39|45)
+					session.remote_host : session.remote_host.substr(0, 50);
+
+				char *zQuery = sqlite3_mprintf(
+					"INSERT OR REPLACE INTO UserSessions (SessionID, Username, AuthToken, ExpirationDate, RemoteHost, LastUpdate) VALUES ('%q', '%q', '%q', '%q', '%q', datetime('now', 'localtime'))",
+					session.id.c_str(),
+					base64_encode(session.username).c_str(),
+					session.auth_token.c_str(),
+					szExpires,
+					remote_host.c_str());
+				if (zQuery)
+				{
+					queries.push_back(zQuery);
+					sqlite3_free(zQuery);
+				}
+			}
+			_log.Debug(DEBUG_WEBSERVER, "SessionStore : flushing %d updated and %d removed sessions", (int)m_dirty.size(), (int)m_removed.size());
+			m_sql.ExecuteTransaction(queries);
+			m_dirty.clear();
+			m_removed.clear();
+		}
+
+	} // namespace server
+} // namespace http
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <set>
+#include <queue>
+#include <mutex>
+#include "../webserver/session_store.hpp"
+
+namespace http {
+	namespace server {
+
+		/**
+		 * Write-behind cache in front of the UserSessions table.
+		 *
+		 * Lookups are served from memory, changes are collected and flushed to the database
+		 * in one transaction, and expired sessions are taken from a min-heap ordered on expiry time.
+		 * The cache is shared by all webserver instances (HTTP/SSL share the same cookies).
+		 */
+		class CUserSessionCache
+		{
+			typedef std::pair<time_t, std::string> tExpiryItem;
+		public:
+			CUserSessionCache();
+			~CUserSessionCache();
+
+			bool GetSession(const std::string &sessionId, WebEmStoredSession &session);
+			void StoreSession(const WebEmStoredSession &session);
+			void RemoveSession(const std::string &sessionId);
+			void RemoveUsersSessions(const std::string &hashedUsername, const std::string &exceptSessionId);
+			void CleanSessions();
+
+			void Flush();
+			void Clear();
+		private:
+			void LoadSessions();
+			void RemoveSessionInt(const std::string &sessionId);
+			void FlushInt();
+
+			std::mutex m_mutex;
+			bool m_bLoaded;
+			time_t m_LastFlush;
+			std::map<std::string, WebEmStoredSession> m_sessions;
+			std::set<std::string> m_dirty;
+			std::set<std::string> m_removed;
+			std::priority_queue<tExpiryItem, std::vector<tExpiryItem>, std::greater<tExpiryItem> > m_expiry;
+		};
+
+		extern CUserSessionCache m_usersessions;
+
+	} // namespace server
+} // namespace http
@@ -10,6 +10,7 @@
 #include "EventSystem.h"
 #include "HTMLSanitizer.h"
 #include "dzVents.h"
+#include "UserSessionCache.h"
 #include "../httpclient/HTTPClient.h"
 #include "../hardware/hardwaretypes.h"
 #include "../hardware/1Wire.h"
@@ -388,6 +389,14 @@ namespace http {
 			RegisterCommandCode("clearlog", boost::bind(&CWebServer::Cmd_ClearLog, this, _1, _2, _3));
 			RegisterCommandCode("getauth", boost::bind(&CWebServer::Cmd_GetAuth, this, _1, _2, _3), true);
 			RegisterCommandCode("getuptime", boost::bind(&CWebServer::Cmd_GetUptime, this, _1, _2, _3), true);
+			RegisterCommandCode("getwebserverstats", boost::bind(&CWebServer::Cmd_GetWebServerStats, this, _1, _2, _3));
+			RegisterCommandCode("getdeviceupdatestats", boost::bind(&CWebServer::Cmd_GetDeviceUpdateStats, this, _1, _2, _3));
+			RegisterCommandCode("gethttpclientstats", boost::bind(&CWebServer::Cmd_GetHTTPClientStats, this, _1, _2, _3));
+			RegisterCommandCode("getrxqueuestats", boost::bind(&CWebServer::Cmd_GetRxQueueStats, this, _1, _2, _3));
+			RegisterCommandCode("setrxqueueoptions", boost::bind(&CWebServer::Cmd_SetRxQueueOptions, this, _1, _2, _3));
+#ifdef ENABLE_PYTHON
+			RegisterCommandCode("getpluginstats", boost::bind(&CWebServer::Cmd_GetPluginStats, this, _1, _2, _3));
+#endif
 
 
 			RegisterCommandCode("gethardwaretypes", boost::bind(&CWebServer::Cmd_GetHardwareTypes, this, _1, _2, _3));
@@ -706,6 +715,7 @@ namespace http {
 				}
 				delete m_pWebEm;
 				m_pWebEm = NULL;
+				m_usersessions.Flush();
 			}
 			catch (...)
 			{
@@ -2660,6 +2670,200 @@ namespace http {
 			root["seconds"] = seconds;
 		}
 
+		void CWebServer::Cmd_GetWebServerStats(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			if (m_pWebEm == NULL)
+				return;
+
+			server_stats &stats = m_pWebEm->GetServerStats();
+			std::string sEnable = request::findValue(&req, "enable");
+			if (!sEnable.empty())
+				stats.enable(sEnable == "1");
+
+			time_t uptime = stats.uptime();
+			if (uptime < 1)
+				uptime = 1;
+
+			root["status"] = "OK";
+			root["title"] = "GetWebServerStats";
+			root["server"] = m_server_alias;
+			root["enabled"] = stats.enabled();
+			root["seconds"] = (Json::UInt64)uptime;
+
+			uint64_t opened, reused;
+			stats.get_connections(opened, reused);
+			root["connections"] = (Json::UInt64)opened;
+			root["keepalive_requests"] = (Json::UInt64)reused;
+
+			int ii = 0;
+			for (int cat = 0; cat < server_stats::category_max; cat++)
+			{
+				server_stats::category_snapshot snapshot;
+				stats.get((server_stats::request_category)cat, snapshot);
+				root["result"][ii]["category"] = server_stats::category_name((server_stats::request_category)cat);
+				root["result"][ii]["requests"] = (Json::UInt64)snapshot.requests;
+				root["result"][ii]["req_per_sec"] = (double)snapshot.requests / uptime;
+				root["result"][ii]["bytes_out"] = (Json::UInt64)snapshot.bytes_out;
+				root["result"][ii]["avg_usec"] = (Json::UInt64)snapshot.avg_usec;
+				root["result"][ii]["p50_usec"] = (Json::UInt64)snapshot.p50_usec;
+				root["result"][ii]["p90_usec"] = (Json::UInt64)snapshot.p90_usec;
+				root["result"][ii]["p99_usec"] = (Json::UInt64)snapshot.p99_usec;
+				root["result"][ii]["max_usec"] = (Json::UInt64)snapshot.max_usec;
+				ii++;
+			}
+
+			if (request::findValue(&req, "reset") == "1")
+				stats.reset();
+		}
+
+		void CWebServer::Cmd_GetDeviceUpdateStats(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetDeviceUpdateStats";
+
+			std::vector<CDeviceUpdateBus::_tSubscriberStats> stats;
+			m_mainworker.m_deviceupdates.GetStats(stats);
+			int ii = 0;
+			for (const auto & itt : stats)
+			{
+				root["result"][ii]["name"] = itt.Name;
+				root["result"][ii]["policy"] = (itt.Policy == CDeviceUpdateBus::QPOLICY_BLOCK) ? "block" : "drop_oldest";
+				root["result"][ii]["queue_size"] = (Json::UInt64)itt.QueueSize;
+				root["result"][ii]["queue_max"] = (Json::UInt64)itt.MaxQueueSize;
+				root["result"][ii]["queue_peak"] = (Json::UInt64)itt.PeakQueueSize;
+				root["result"][ii]["delivered"] = (Json::UInt64)itt.Delivered;
+				root["result"][ii]["dropped"] = (Json::UInt64)itt.Dropped;
+				root["result"][ii]["avg_lag_ms"] = (Json::UInt64)itt.AvgLagMs;
+				root["result"][ii]["max_lag_ms"] = (Json::UInt64)itt.MaxLagMs;
+				root["result"][ii]["avg_handle_ms"] = (Json::UInt64)itt.AvgHandleMs;
+				root["result"][ii]["max_handle_ms"] = (Json::UInt64)itt.MaxHandleMs;
+				ii++;
+			}
+
+			if (request::findValue(&req, "reset") == "1")
+				m_mainworker.m_deviceupdates.ResetStats();
+		}
+
+		void CWebServer::Cmd_GetHTTPClientStats(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetHTTPClientStats";
+
+			HTTPClient::_tPoolStats stats;
+			HTTPClient::GetPoolStats(stats);
+			uint64_t connections = stats.connections_new + stats.connections_reused;
+			root["requests"] = (Json::UInt64)stats.requests;
+			root["connections_new"] = (Json::UInt64)stats.connections_new;
+			root["connections_reused"] = (Json::UInt64)stats.connections_reused;
+			root["reuse_percentage"] = (connections > 0) ? (double)stats.connections_reused * 100.0 / connections : 0.0;
+			root["handles_created"] = (Json::UInt64)stats.handles_created;
+			root["handles_idle"] = (Json::UInt64)stats.handles_idle;
+			root["async_requests"] = (Json::UInt64)stats.async_requests;
+			root["async_dropped"] = (Json::UInt64)stats.async_dropped;
+			root["async_pending"] = (Json::UInt64)stats.async_pending;
+			root["async_running"] = (Json::UInt64)stats.async_running;
+
+			if (request::findValue(&req, "reset") == "1")
+				HTTPClient::ResetPoolStats();
+		}
+
+		void CWebServer::Cmd_GetRxQueueStats(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			root["status"] = "OK";
+			root["title"] = "GetRxQueueStats";
+
+			std::vector<CRxMessageQueue::_tHardwareStats> stats;
+			m_mainworker.m_rxMessageQueue.GetStats(stats);
+			int ii = 0;
+			for (const auto & itt : stats)
+			{
+				CDomoticzHardwareBase *pHardware = m_mainworker.GetHardware(itt.HwdID);
+				root["result"][ii]["hardware_id"] = itt.HwdID;
+				root["result"][ii]["name"] = (pHardware != NULL) ? pHardware->m_Name : "";
+				switch (itt.Policy)
+				{
+				case RXQ_POLICY_DROP_NEWEST:
+					root["result"][ii]["policy"] = "drop_newest";
+					break;
+				case RXQ_POLICY_BLOCK:
+					root["result"][ii]["policy"] = "block";
+					break;
+				default:
+					root["result"][ii]["policy"] = "drop_oldest";
+					break;
+				}
+				root["result"][ii]["weight"] = itt.Weight;
+				root["result"][ii]["queue_size"] = (Json::UInt64)itt.QueueSize;
+				root["result"][ii]["queue_max"] = (Json::UInt64)itt.MaxQueueSize;
+				root["result"][ii]["queue_peak"] = (Json::UInt64)itt.PeakQueueSize;
+				root["result"][ii]["pushed"] = (Json::UInt64)itt.Pushed;
+				root["result"][ii]["processed"] = (Json::UInt64)itt.Processed;
+				root["result"][ii]["dropped"] = (Json::UInt64)itt.Dropped;
+				root["result"][ii]["blocked"] = (Json::UInt64)itt.Blocked;
+				root["result"][ii]["avg_age_ms"] = (Json::UInt64)itt.AvgAgeMs;
+				root["result"][ii]["max_age_ms"] = (Json::UInt64)itt.MaxAgeMs;
+				root["result"][ii]["oldest_age_ms"] = (Json::UInt64)itt.OldestAgeMs;
+				ii++;
+			}
+
+			if (request::findValue(&req, "reset") == "1")
+				m_mainworker.m_rxMessageQueue.ResetStats();
+		}
+
+		//Received messages queue of a hardware: size (0 = unbounded) and overflow policy (0 = drop oldest, 1 = drop newest, 2 = block)
+		void CWebServer::Cmd_SetRxQueueOptions(WebEmSession & session, const request& req, Json::Value &root)
+		{
+			if (session.rights != 2)
+			{
+				session.reply_status = reply::forbidden;
+				return; //Only admin user allowed
+			}
+			std::string idx = request::findValue(&req, "idx");
+			std::string ssize = request::findValue(&req, "size");
+			std::string spolicy = request::findValue(&req, "policy");
+			if (idx.empty() || ssize.empty() || spolicy.empty())
+				return;
+			int iSize = atoi(ssize.c_str());
+			int iPolicy = atoi(spolicy.c_str());
+			if ((iSize < 0) || (iPolicy < RXQ_POLICY_DROP_OLDEST) || (iPolicy > RXQ_POLICY_BLOCK))
+				return;
+			std::vector<std::vector<std::string> > result;
+			result = m_sql.safe_query("SELECT ID FROM Hardware WHERE (ID=='%q')", idx.c_str());
+			if (result.empty())
+				return;
+			m_sql.safe_query("UPDATE Hardware SET RxQueueSize=%d, RxQueuePolicy=%d WHERE (ID=='%q')", iSize, iPolicy, idx.c_str());
+
+			//the queue takes the new options with the next message of the hardware
+			CDomoticzHardwareBase *pHardware = m_mainworker.GetHardware(atoi(idx.c_str()));
+			if (pHardware != NULL)
+			{
+				pHardware->m_RxQueueSize = (size_t)iSize;
+				pHardware->m_RxQueuePolicy = (_eRxQueuePolicy)iPolicy;
+			}
+			root["status"] = "OK";
+			root["title"] = "SetRxQueueOptions";
+		}
+
 		void CWebServer::Cmd_GetActualHistory(WebEmSession & session, const request& req, Json::Value &root)
 		{
 			root["status"] = "OK";
@@ -3554,6 +3758,7 @@ namespace http {
 							offdelay
 						);
 					}
+					m_sql.ReloadSceneGraph();
 					if (m_sql.m_bEnableEventSystem)
 						m_mainworker.m_eventsystem.GetCurrentScenesGroups();
 				}
@@ -3615,6 +3820,7 @@ namespace http {
 				root["title"] = "DeleteSceneDevice";
 				m_sql.safe_query("DELETE FROM SceneDevices WHERE (ID == '%q')", idx.c_str());
 				m_sql.safe_query("DELETE FROM CamerasActiveDevices WHERE (DevSceneType==1) AND (DevSceneRowID == '%q')", idx.c_str());
+				m_sql.ReloadSceneGraph();
 				if (m_sql.m_bEnableEventSystem)
 					m_mainworker.m_eventsystem.GetCurrentScenesGroups();
 			}
@@ -3771,6 +3977,7 @@ namespace http {
 				root["status"] = "OK";
 				root["title"] = "DeleteAllSceneDevices";
 				result = m_sql.safe_query("DELETE FROM SceneDevices WHERE (SceneRowID == %q)", idx.c_str());
+				m_sql.ReloadSceneGraph();
 			}
 			else if (cparam == "getmanualhardware")
 			{
@@ -5251,6 +5458,7 @@ namespace http {
 						m_sql.safe_query(
 							"UPDATE DeviceStatus SET Used=1, Name='%q', SwitchType=%d WHERE (ID == '%q')",
 							name.c_str(), switchtype, ID.c_str());
+						m_sql.RescheduleSensorTimeout(std::strtoull(ID.c_str(), nullptr, 10));
 
 						//Now continue to insert the switch
 						dtype = pTypeRadiator1;
@@ -5480,6 +5688,7 @@ namespace http {
 				m_sql.safe_query(
 					"UPDATE DeviceStatus SET Used=1, Name='%q', SwitchType=%d WHERE (ID == '%q')",
 					name.c_str(), switchtype, ID.c_str());
+				m_sql.RescheduleSensorTimeout(std::strtoull(ID.c_str(), nullptr, 10));
 
 				if (lighttype == 407) {
 					//Openwebnet Bus Custom
@@ -8012,7 +8221,20 @@ namespace http {
 			int sensortimeout = atoi(request::findValue(&req, "SensorTimeout").c_str());
 			if (sensortimeout < 10)
 				sensortimeout = 10;
+			m_sql.GetPreferencesVar("SensorTimeout", rnOldvalue);
 			m_sql.UpdatePreferencesVar("SensorTimeout", sensortimeout);
+			if (rnOldvalue != sensortimeout)
+				m_sql.LoadDeviceTimeouts();
+
+			std::string CameraSnapshotMaxAge = request::findValue(&req, "CameraSnapshotMaxAge");
+			if (!CameraSnapshotMaxAge.empty())
+			{
+				int snapshotmaxage = atoi(CameraSnapshotMaxAge.c_str());
+				if (snapshotmaxage < 0)
+					snapshotmaxage = 0;
+				m_sql.UpdatePreferencesVar("CameraSnapshotMaxAge", snapshotmaxage);
+				m_mainworker.m_cameras.SetSnapshotMaxAge(snapshotmaxage);
+			}
 
 			int batterylowlevel = atoi(request::findValue(&req, "BatterLowLevel").c_str());
 			if (batterylowlevel > 100)
@@ -8104,6 +8326,7 @@ namespace http {
 			m_mainworker.StopDomoticzHardware();
 
 			m_sql.RestoreDatabase(dbasefile);
+			m_usersessions.Clear();
 			m_mainworker.AddAllDomoticzHardware();
 		}
 
@@ -11492,7 +11715,7 @@ namespace http {
 #endif
 
 			std::vector<std::vector<std::string> > result;
-			result = m_sql.safe_query("SELECT ID, Name, Enabled, Type, Address, Port, SerialPort, Username, Password, Extra, Mode1, Mode2, Mode3, Mode4, Mode5, Mode6, DataTimeout FROM Hardware ORDER BY ID ASC");
+			result = m_sql.safe_query("SELECT ID, Name, Enabled, Type, Address, Port, SerialPort, Username, Password, Extra, Mode1, Mode2, Mode3, Mode4, Mode5, Mode6, DataTimeout, RxQueueSize, RxQueuePolicy FROM Hardware ORDER BY ID ASC");
 			if (!result.empty())
 			{
 				int ii = 0;
@@ -11531,6 +11754,8 @@ namespace http {
 						root["result"][ii]["Mode6"] = atoi(sd[15].c_str());
 					}
 					root["result"][ii]["DataTimeout"] = atoi(sd[16].c_str());
+					root["result"][ii]["RxQueueSize"] = atoi(sd[17].c_str());
+					root["result"][ii]["RxQueuePolicy"] = atoi(sd[18].c_str());
 
 					//Special case for openzwave (status for nodes queried)
 					CDomoticzHardwareBase *pHardware = m_mainworker.GetHardware(atoi(sd[0].c_str()));
@@ -12176,6 +12401,7 @@ namespace http {
 			root["status"] = "OK";
 			root["title"] = "SetUnused";
 			m_sql.safe_query("UPDATE DeviceStatus SET Used=0 WHERE (ID == %d)", idx);
+			m_sql.RescheduleSensorTimeout(idx);
 			if (m_sql.m_bEnableEventSystem)
 				m_mainworker.m_eventsystem.RemoveSingleState(idx, m_mainworker.m_eventsystem.REASON_DEVICE);
 
@@ -12636,6 +12862,8 @@ namespace http {
 						used, name.c_str(), description.c_str(), switchtype, CustomImage, idx.c_str());
 				}
 			}
+			//the device could have been (un)used
+			m_sql.RescheduleSensorTimeout(std::strtoull(idx.c_str(), nullptr, 10));
 
 			if (bHasstrParam1)
 			{
@@ -13180,6 +13408,10 @@ namespace http {
 				{
 					root["SensorTimeout"] = nValue;
 				}
+				else if (Key == "CameraSnapshotMaxAge")
+				{
+					root["CameraSnapshotMaxAge"] = nValue;
+				}
 				else if (Key == "BatteryLowNotification")
 				{
 					root["BatterLowLevel"] = nValue;
@@ -13698,7 +13930,8 @@ namespace http {
 						root["status"] = "OK";
 						root["title"] = "Graph " + sensor + " " + srange;
 
-						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Value4, Value5, Value6, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Value4, Value5, Value6, Date, Unchanged FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						m_sql.ExpandShortLogRuns(result, 6, 7);
 						if (!result.empty())
 						{
 							int ii = 0;
@@ -14021,7 +14254,8 @@ namespace http {
 
 						root["displaytype"] = displaytype;
 
-						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Date, Unchanged FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						m_sql.ExpandShortLogRuns(result, 3, 4);
 						if (!result.empty())
 						{
 							int ii = 0;
@@ -14095,7 +14329,8 @@ namespace http {
 
 						root["displaytype"] = displaytype;
 
-						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value1, Value2, Value3, Date, Unchanged FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						m_sql.ExpandShortLogRuns(result, 3, 4);
 						if (!result.empty())
 						{
 							int ii = 0;
@@ -14177,7 +14412,8 @@ namespace http {
 						}
 
 						int ii = 0;
-						result = m_sql.safe_query("SELECT Value,[Usage], Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						result = m_sql.safe_query("SELECT Value,[Usage], Date, Unchanged FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+						m_sql.ExpandShortLogRuns(result, 2, 3);
 
 						int method = 0;
 						std::string sMethod = request::findValue(&req, "method");
@@ -14329,7 +14565,8 @@ namespace http {
 							bHaveFirstRealValue = true;
 						}
 						else {
-							result = m_sql.safe_query("SELECT Value, Date FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+							result = m_sql.safe_query("SELECT Value, Date, Unchanged FROM %s WHERE (DeviceRowID==%" PRIu64 ") ORDER BY Date ASC", dbasetable.c_str(), idx);
+							m_sql.ExpandShortLogRuns(result, 1, 2);
 						}
 
 						int method = 0;
@@ -17329,22 +17566,9 @@ namespace http {
 			if (sessionId.empty()) {
 				_log.Log(LOG_ERROR, "SessionStore : cannot get session without id.");
 			}
-			else {
-				std::vector<std::vector<std::string> > result;
-				result = m_sql.safe_query("SELECT SessionID, Username, AuthToken, ExpirationDate FROM UserSessions WHERE SessionID = '%q'",
-					sessionId.c_str());
-				if (!result.empty()) {
-					session.id = result[0][0].c_str();
-					session.username = base64_decode(result[0][1]);
-					session.auth_token = result[0][2].c_str();
-
-					std::string sExpirationDate = result[0][3];
-					//time_t now = mytime(NULL);
-					struct tm tExpirationDate;
-					ParseSQLdatetime(session.expires, tExpirationDate, sExpirationDate);
-					// RemoteHost is not used to restore the session
-					// LastUpdate is not used to restore the session
-				}
+			else if (m_usersessions.GetSession(sessionId, session)) {
+				// RemoteHost is not used to restore the session
+				session.remote_host.clear();
 			}
 
 			return session;
@@ -17359,33 +17583,7 @@ namespace http {
 				_log.Log(LOG_ERROR, "SessionStore : cannot store session without id.");
 				return;
 			}
-
-			char szExpires[30];
-			struct tm ltime;
-			localtime_r(&session.expires, &ltime);
-			strftime(szExpires, sizeof(szExpires), "%Y-%m-%d %H:%M:%S", &ltime);
-
-			std::string remote_host = (session.remote_host.size() <= 50) ? // IPv4 : 15, IPv6 : (39|45)
-				session.remote_host : session.remote_host.substr(0, 50);
-
-			WebEmStoredSession storedSession = GetSession(session.id);
-			if (storedSession.id.empty()) {
-				m_sql.safe_query(
-					"INSERT INTO UserSessions (SessionID, Username, AuthToken, ExpirationDate, RemoteHost) VALUES ('%q', '%q', '%q', '%q', '%q')",
-					session.id.c_str(),
-					base64_encode(session.username).c_str(),
-					session.auth_token.c_str(),
-					szExpires,
-					remote_host.c_str());
-			}
-			else {
-				m_sql.safe_query(
-					"UPDATE UserSessions set AuthToken = '%q', ExpirationDate = '%q', RemoteHost = '%q', LastUpdate = datetime('now', 'localtime') WHERE SessionID = '%q'",
-					session.auth_token.c_str(),
-					szExpires,
-					remote_host.c_str(),
-					session.id.c_str());
-			}
+			m_usersessions.StoreSession(session);
 		}
 
 		/**
@@ -17396,9 +17594,7 @@ namespace http {
 			if (sessionId.empty()) {
 				return;
 			}
-			m_sql.safe_query(
-				"DELETE FROM UserSessions WHERE SessionID = '%q'",
-				sessionId.c_str());
+			m_usersessions.RemoveSession(sessionId);
 		}
 
 		/**
@@ -17406,8 +17602,7 @@ namespace http {
 		 */
 		void CWebServer::CleanSessions() {
 			//_log.Log(LOG_STATUS, "SessionStore : clean...");
-			m_sql.safe_query(
-				"DELETE FROM UserSessions WHERE ExpirationDate < datetime('now', 'localtime')");
+			m_usersessions.CleanSessions();
 		}
 
 		/**
@@ -17418,7 +17613,7 @@ namespace http {
 		 * because the username will be unknown (see cWebemRequestHandler::checkAuthToken).
 		 */
 		void CWebServer::RemoveUsersSessions(const std::string& username, const WebEmSession & exceptSession) {
-			m_sql.safe_query("DELETE FROM UserSessions WHERE (Username=='%q') and (SessionID!='%q')", username.c_str(), exceptSession.id.c_str());
+			m_usersessions.RemoveUsersSessions(username, exceptSession.id);
 		}
 
 	} //server
@@ -190,6 +190,11 @@ private:
 	void Cmd_GetVersion(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetAuth(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetUptime(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetWebServerStats(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetDeviceUpdateStats(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetHTTPClientStats(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_GetRxQueueStats(WebEmSession & session, const request& req, Json::Value &root);
+	void Cmd_SetRxQueueOptions(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetActualHistory(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetNewHistory(WebEmSession & session, const request& req, Json::Value &root);
 	void Cmd_GetConfig(WebEmSession& session, const request& req, Json::Value& root);
@@ -299,6 +304,7 @@ private:
 	void PluginList(Json::Value &root);
 #ifdef ENABLE_PYTHON
 	void PluginLoadConfig();
+	void Cmd_GetPluginStats(WebEmSession & session, const request& req, Json::Value &root);
 #endif
 
 	//RTypes
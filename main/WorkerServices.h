@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+
+//The MainWorker services used by the logger and the webserver core.
+//They only reach the MainWorker through this interface, so they can also run without it (see benchmark/)
+class IWorkerServices
+{
+public:
+	virtual ~IWorkerServices() {}
+	virtual void HeartbeatUpdate(const std::string &component, bool critical = true) = 0;
+	virtual void HeartbeatRemove(const std::string &component) = 0;
+	virtual void ForceLogNotificationCheck() = 0;
+	virtual std::string GetLastSunriseSet() = 0;
+};
+
+//Set to the MainWorker in domoticz.cpp
+extern IWorkerServices *g_pWorkerServices;
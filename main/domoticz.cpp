@@ -140,6 +140,7 @@ time_t m_StartTime=time(NULL);
 std::string szRandomUUID = "???";
 
 MainWorker m_mainworker;
+IWorkerServices *g_pWorkerServices = &m_mainworker;
 CLogger _log;
 http::server::CWebServerHelper m_webservers;
 CSQLHelper m_sql;
@@ -16,7 +16,10 @@ extern http::server::CWebServerHelper m_webservers;
 CdzVents CdzVents::m_dzvents;
 
 CdzVents::CdzVents(void) :
-	m_version("2.5.5")
+	m_version("2.5.5"),
+	m_luaState(NULL),
+	m_bLuaStateBusy(false),
+	m_luaStateModulesGeneration(0)
 {
 	m_bdzVentsExist = false;
 }
@@ -25,6 +28,163 @@ CdzVents::~CdzVents(void)
 {
 }
 
+lua_State *CdzVents::AcquireLuaState(bool &bNewState)
+{
+	uint64_t modulesGeneration = m_scripts.GetModulesGeneration();
+
+	std::unique_lock<std::mutex> lock(m_luaStateMutex);
+	if (m_luaState != NULL)
+	{
+		if (m_bLuaStateBusy)
+		{
+			//the previous run did not finish (yet), it closes its state when it is done
+			_log.Log(LOG_ERROR, "dzVents: previous run still busy, starting a new runtime");
+			m_luaState = NULL;
+		}
+		else if (modulesGeneration != m_luaStateModulesGeneration)
+		{
+			//modules required by the scripts are cached by Lua, start over to load the changes
+			_log.Log(LOG_STATUS, "dzVents: modules changed, restarting the runtime");
+			FlushLuaState(m_luaState);
+			lua_close(m_luaState);
+			m_luaState = NULL;
+		}
+	}
+	bNewState = (m_luaState == NULL);
+	if (bNewState)
+	{
+		m_luaState = luaL_newstate();
+		m_luaStateModulesGeneration = modulesGeneration;
+
+		luaL_openlibs(m_luaState);
+		// reroute print library to Domoticz logger
+		lua_pushcfunction(m_luaState, l_domoticz_print);
+		lua_setglobal(m_luaState, "print");
+		lua_pushcfunction(m_luaState, l_dzVents_listScripts);
+		lua_setglobal(m_luaState, "dzVents_listScripts");
+		lua_pushcfunction(m_luaState, l_dzVents_isCurrentRuntime);
+		lua_setglobal(m_luaState, "dzVents_isCurrentRuntime");
+	}
+	m_bLuaStateBusy = true;
+	return m_luaState;
+}
+
+void CdzVents::ReleaseLuaState(lua_State *lua_state)
+{
+	std::unique_lock<std::mutex> lock(m_luaStateMutex);
+	lua_settop(lua_state, 0);
+	if (lua_state == m_luaState)
+	{
+		HandOverPendingStorage(lua_state);
+		m_bLuaStateBusy = false;
+		return;
+	}
+	//abandoned while it was running, the new runtime owns the persistent data now. Writing the data of
+	//this state would overwrite newer values, so what it did not write yet is handed over to the new runtime
+	_log.Log(LOG_ERROR, "dzVents: abandoned run finished, handing its unsaved persistent data over to the current runtime");
+	TakePendingStorage(lua_state);
+	lua_close(lua_state);
+	if ((m_luaState != NULL) && (!m_bLuaStateBusy))
+		HandOverPendingStorage(m_luaState);
+}
+
+void CdzVents::CloseLuaState()
+{
+	std::unique_lock<std::mutex> lock(m_luaStateMutex);
+	if (m_luaState == NULL)
+		return;
+	if (!m_bLuaStateBusy)
+	{
+		HandOverPendingStorage(m_luaState);
+		FlushLuaState(m_luaState);
+		lua_close(m_luaState);
+	}
+	m_luaState = NULL;
+}
+
+//Writes the persistent data that is only kept in memory to disk
+void CdzVents::FlushLuaState(lua_State *lua_state)
+{
+	lua_getglobal(lua_state, "dzVents_flushStorage");
+	if (!lua_isfunction(lua_state, -1))
+	{
+		lua_pop(lua_state, 1);
+		return;
+	}
+	if (lua_pcall(lua_state, 0, 0, 0) != 0)
+	{
+		_log.Log(LOG_ERROR, "dzVents: problem writing persistent data: %s", lua_tostring(lua_state, -1));
+		lua_pop(lua_state, 1);
+	}
+}
+
+//Keeps the persistent data an abandoned run did not write yet (m_luaStateMutex has to be locked)
+void CdzVents::TakePendingStorage(lua_State *lua_state)
+{
+	lua_getglobal(lua_state, "dzVents_pendingStorage");
+	if (!lua_isfunction(lua_state, -1))
+	{
+		lua_pop(lua_state, 1);
+		return;
+	}
+	if (lua_pcall(lua_state, 0, 1, 0) != 0)
+	{
+		_log.Log(LOG_ERROR, "dzVents: problem reading unsaved persistent data: %s", lua_tostring(lua_state, -1));
+		lua_pop(lua_state, 1);
+		return;
+	}
+	if (lua_istable(lua_state, -1))
+	{
+		lua_pushnil(lua_state);
+		while (lua_next(lua_state, -2) != 0)
+		{
+			//module name at -2, { filePath, source } at -1
+			if ((lua_type(lua_state, -2) == LUA_TSTRING) && (lua_istable(lua_state, -1)))
+			{
+				lua_getfield(lua_state, -1, "filePath");
+				lua_getfield(lua_state, -2, "source");
+				if ((lua_type(lua_state, -2) == LUA_TSTRING) && (lua_type(lua_state, -1) == LUA_TSTRING))
+				{
+					size_t len;
+					const char *szSource = lua_tolstring(lua_state, -1, &len);
+					m_pendingStorage[lua_tostring(lua_state, -4)] = std::make_pair(std::string(lua_tostring(lua_state, -2)), std::string(szSource, len));
+				}
+				lua_pop(lua_state, 2);
+			}
+			lua_pop(lua_state, 1);
+		}
+	}
+	lua_pop(lua_state, 1);
+}
+
+//Gives the data taken from abandoned runs to the idle current runtime and writes it (m_luaStateMutex has to be locked)
+void CdzVents::HandOverPendingStorage(lua_State *lua_state)
+{
+	if (m_pendingStorage.empty())
+		return;
+	lua_getglobal(lua_state, "dzVents_adoptStorage");
+	bool bCanAdopt = lua_isfunction(lua_state, -1);
+	lua_pop(lua_state, 1);
+	if (!bCanAdopt)
+		return; //the runtime is not set up, keep it for the next run
+
+	for (const auto & itt : m_pendingStorage)
+	{
+		lua_getglobal(lua_state, "dzVents_adoptStorage");
+		lua_pushstring(lua_state, itt.first.c_str());
+		lua_pushstring(lua_state, itt.second.first.c_str());
+		lua_pushlstring(lua_state, itt.second.second.data(), itt.second.second.size());
+		if (lua_pcall(lua_state, 3, 0, 0) != 0)
+		{
+			_log.Log(LOG_ERROR, "dzVents: problem handing over persistent data: %s", lua_tostring(lua_state, -1));
+			lua_pop(lua_state, 1);
+		}
+	}
+	m_pendingStorage.clear();
+	//it is already overdue, do not wait for the next flush interval
+	FlushLuaState(lua_state);
+}
+
 const std::string CdzVents::GetVersion()
 {
 	return m_version;
@@ -32,11 +192,6 @@ const std::string CdzVents::GetVersion()
 
 void CdzVents::EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const int secStatus)
 {
-	// reroute print library to Domoticz logger
-	luaL_openlibs(lua_state);
-	lua_pushcfunction(lua_state, l_domoticz_print);
-	lua_setglobal(lua_state, "print");
-
 	bool reasonTime = false;
 	bool reasonURL = false;
 	bool reasonSecurity = false;
@@ -55,11 +210,22 @@ void CdzVents::EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSys
 	ExportDomoticzDataToLua(lua_state, items);
 	SetGlobalVariables(lua_state, reasonTime, secStatus);
 
+	//the state is reused, do not leave the responses of an earlier run behind
 	if (reasonURL)
 		ProcessHttpResponse(lua_state, items);
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "httpresponse");
+	}
 
 	if (reasonSecurity)
 		ProcessSecurity(lua_state, items);
+	else
+	{
+		lua_pushnil(lua_state);
+		lua_setglobal(lua_state, "securityupdates");
+	}
 }
 
 void CdzVents::ProcessSecurity(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items)
@@ -496,6 +662,54 @@ void CdzVents::IterateTable(lua_State *lua_state, const int tIndex, std::vector<
 	}
 }
 
+// dzVents_listScripts('external' | 'internal') returns { { name = <script>, mtime = <seconds> }, ... } sorted by name
+int CdzVents::l_dzVents_listScripts(lua_State* lua_state)
+{
+	std::string type;
+	if (lua_gettop(lua_state) >= 1 && lua_isstring(lua_state, 1))
+		type = lua_tostring(lua_state, 1);
+
+	CdzVentsScripts::_eScriptType scriptType;
+	if (type == "external")
+		scriptType = CdzVentsScripts::SCRIPT_EXTERNAL;
+	else if (type == "internal")
+		scriptType = CdzVentsScripts::SCRIPT_INTERNAL;
+	else
+	{
+		lua_pushnil(lua_state);
+		return 1;
+	}
+
+	std::vector<CdzVentsScripts::_tScript> scripts;
+	m_dzvents.m_scripts.GetScripts(scriptType, scripts);
+
+	lua_createtable(lua_state, (int)scripts.size(), 0);
+	int index = 1;
+	for (const auto & itt : scripts)
+	{
+		lua_pushinteger(lua_state, index++);
+		lua_createtable(lua_state, 0, 2);
+		lua_pushstring(lua_state, "name");
+		lua_pushstring(lua_state, itt.Name.c_str());
+		lua_rawset(lua_state, -3);
+		lua_pushstring(lua_state, "mtime");
+		lua_pushnumber(lua_state, (lua_Number)itt.LastModified);
+		lua_rawset(lua_state, -3);
+		lua_rawset(lua_state, -3);
+	}
+	return 1;
+}
+
+//Returns false in a run that was abandoned (see AcquireLuaState), it must not write persistent data anymore
+int CdzVents::l_dzVents_isCurrentRuntime(lua_State* lua_state)
+{
+	lua_rawgeti(lua_state, LUA_REGISTRYINDEX, LUA_RIDX_MAINTHREAD);
+	lua_State *main_state = lua_tothread(lua_state, -1);
+	lua_pop(lua_state, 1);
+	lua_pushboolean(lua_state, (main_state == m_dzvents.m_luaState.load()) ? 1 : 0);
+	return 1;
+}
+
 int CdzVents::l_domoticz_print(lua_State* lua_state)
 {
 	int nargs = lua_gettop(lua_state);
@@ -1,5 +1,7 @@
 #pragma once
+#include <atomic>
 #include "EventSystem.h"
+#include "dzVentsScripts.h"
 
 class CdzVents
 {
@@ -12,8 +14,14 @@ public:
 	bool processLuaCommand(lua_State *lua_state, const std::string &filename, const int tIndex);
 	void EvaluateDzVents(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items, const int secStatus);
 
+	//The runtime keeps its state (loaded scripts, persistent data) between runs
+	lua_State *AcquireLuaState(bool &bNewState);
+	void ReleaseLuaState(lua_State *lua_state);
+	void CloseLuaState();
+
 	std::string m_scriptsDir, m_runtimeDir;
 	bool m_bdzVentsExist;
+	CdzVentsScripts m_scripts;
 
 private:
 
@@ -46,7 +54,19 @@ private:
 	void ProcessHttpResponse(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items);
 	void ProcessSecurity(lua_State *lua_state, const std::vector<CEventSystem::_tEventQueue> &items);
 
+	void FlushLuaState(lua_State *lua_state);
+	void TakePendingStorage(lua_State *lua_state);
+	void HandOverPendingStorage(lua_State *lua_state);
+
 	static int l_domoticz_print(lua_State* lua_state);
+	static int l_dzVents_listScripts(lua_State* lua_state);
+	static int l_dzVents_isCurrentRuntime(lua_State* lua_state);
 	static CdzVents m_dzvents;
 	std::string m_version;
+
+	std::mutex m_luaStateMutex;
+	std::atomic<lua_State*> m_luaState;	//also read without the mutex, by a run that checks it was not abandoned
+	bool m_bLuaStateBusy;
+	uint64_t m_luaStateModulesGeneration;
+	std::map<std::string, std::pair<std::string, std::string> > m_pendingStorage;	//unsaved persistent data of abandoned runs, by module name: file path, data
 };
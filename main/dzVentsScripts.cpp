@@ -0,0 +1,260 @@
+#include "stdafx.h"
+#include "dzVentsScripts.h"
+#ifdef WIN32
+#include "dirent_windows.h"
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <fcntl.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+CdzVentsScripts::CdzVentsScripts() :
+	m_bValid(false),
+	m_ModulesGeneration(0)
+{
+#if defined(__linux__)
+	m_inotifyFd = -1;
+#endif
+}
+
+CdzVentsScripts::~CdzVentsScripts()
+{
+	StopWatching();
+}
+
+void CdzVentsScripts::AddFolder(const std::string &Path, const _eScriptType Type)
+{
+	_tFolder folder;
+	folder.Path = Path;
+	folder.Type = Type;
+	folder.Modified = 0;
+#if defined(WIN32)
+	folder.hChange = INVALID_HANDLE_VALUE;
+#elif defined(__linux__)
+	folder.Watch = -1;
+#endif
+	m_Folders.push_back(folder);
+}
+
+void CdzVentsScripts::SetFolders(const std::string &ScriptsDir, const std::string &GeneratedScriptsDir, const std::vector<std::string> &ModuleDirs)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::vector<std::string> folders;
+	folders.push_back(ScriptsDir);
+	folders.push_back(GeneratedScriptsDir);
+	folders.insert(folders.end(), ModuleDirs.begin(), ModuleDirs.end());
+	if (folders.size() == m_Folders.size())
+	{
+		size_t ii = 0;
+		while ((ii < folders.size()) && (folders[ii] == m_Folders[ii].Path))
+			ii++;
+		if (ii == folders.size())
+			return;
+	}
+	StopWatching();
+	m_Folders.clear();
+	AddFolder(ScriptsDir, SCRIPT_EXTERNAL);
+	AddFolder(GeneratedScriptsDir, SCRIPT_INTERNAL);
+	for (const auto & itt : ModuleDirs)
+		AddFolder(itt, SCRIPT_MODULE);
+	m_bValid = false;
+}
+
+void CdzVentsScripts::Invalidate()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_bValid = false;
+}
+
+void CdzVentsScripts::StartWatching(_tFolder &folder)
+{
+#if defined(WIN32)
+	if (folder.hChange != INVALID_HANDLE_VALUE)
+		return;
+	folder.hChange = FindFirstChangeNotificationA(folder.Path.c_str(), FALSE,
+		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE);
+#elif defined(__linux__)
+	if (folder.Watch != -1)
+		return;
+	if (m_inotifyFd == -1)
+	{
+		m_inotifyFd = inotify_init();
+		if (m_inotifyFd == -1)
+			return;
+		fcntl(m_inotifyFd, F_SETFL, fcntl(m_inotifyFd, F_GETFL) | O_NONBLOCK);
+	}
+	folder.Watch = inotify_add_watch(m_inotifyFd, folder.Path.c_str(),
+		IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+#endif
+}
+
+void CdzVentsScripts::StopWatching()
+{
+	for (auto & itt : m_Folders)
+	{
+#if defined(WIN32)
+		if (itt.hChange != INVALID_HANDLE_VALUE)
+		{
+			FindCloseChangeNotification(itt.hChange);
+			itt.hChange = INVALID_HANDLE_VALUE;
+		}
+#elif defined(__linux__)
+		itt.Watch = -1;
+#endif
+	}
+#if defined(__linux__)
+	if (m_inotifyFd != -1)
+	{
+		close(m_inotifyFd);
+		m_inotifyFd = -1;
+	}
+#endif
+}
+
+//Returns true when one of the folders (might have) changed since the last listing
+bool CdzVentsScripts::HasChanged()
+{
+	bool bChanged = false;
+#if defined(__linux__)
+	if (m_inotifyFd != -1)
+	{
+		char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+		ssize_t len;
+		while ((len = read(m_inotifyFd, buffer, sizeof(buffer))) > 0)
+		{
+			bChanged = true;
+			for (char *ptr = buffer; ptr < buffer + len; ptr += sizeof(struct inotify_event) + ((struct inotify_event*)ptr)->len)
+			{
+				const struct inotify_event *event = (const struct inotify_event*)ptr;
+				if (event->mask & IN_IGNORED)
+				{
+					//folder removed, watched again when it is back
+					for (auto & itt : m_Folders)
+					{
+						if (itt.Watch == event->wd)
+							itt.Watch = -1;
+					}
+				}
+			}
+		}
+	}
+#endif
+	for (auto & itt : m_Folders)
+	{
+#if defined(WIN32)
+		if (itt.hChange != INVALID_HANDLE_VALUE)
+		{
+			if (WaitForSingleObject(itt.hChange, 0) == WAIT_OBJECT_0)
+			{
+				bChanged = true;
+				if (!FindNextChangeNotification(itt.hChange))
+				{
+					FindCloseChangeNotification(itt.hChange);
+					itt.hChange = INVALID_HANDLE_VALUE;
+				}
+			}
+			continue;
+		}
+#elif defined(__linux__)
+		if (itt.Watch != -1)
+			continue;
+#endif
+		//not watched, only files added or removed are noticed
+		struct stat st;
+		time_t modified = (stat(itt.Path.c_str(), &st) == 0) ? st.st_mtime : 0;
+		if (modified != itt.Modified)
+			bChanged = true;
+	}
+	return bChanged;
+}
+
+static bool ScriptNameCompare(const CdzVentsScripts::_tScript &a, const CdzVentsScripts::_tScript &b)
+{
+	return a.Name < b.Name;
+}
+
+void CdzVentsScripts::Refresh()
+{
+	std::vector<_tScript> scripts[SCRIPT_TYPE_MAX];
+	for (auto & itt : m_Folders)
+	{
+		//watch before listing, so a change during the listing is not missed
+		StartWatching(itt);
+
+		struct stat st;
+		itt.Modified = (stat(itt.Path.c_str(), &st) == 0) ? st.st_mtime : 0;
+
+		DIR *d = opendir(itt.Path.c_str());
+		if (d == NULL)
+			continue;
+		struct dirent *ent;
+		while ((ent = readdir(d)) != NULL)
+		{
+			std::string filename = ent->d_name;
+			if ((filename.size() <= 4) || (filename[0] == '.') || (filename.compare(filename.size() - 4, 4, ".lua") != 0))
+				continue;
+			//stat follows symbolic links, scripts are often linked from elsewhere
+			std::string path = itt.Path + filename;
+			if ((stat(path.c_str(), &st) != 0) || (!S_ISREG(st.st_mode)))
+				continue;
+			_tScript script;
+			script.Name = filename.substr(0, filename.size() - 4);
+			script.LastModified = (double)st.st_mtime;
+#if defined(__linux__)
+			//saving a script twice within a second must still be noticed
+			script.LastModified += st.st_mtim.tv_nsec / 1000000000.0;
+#endif
+			scripts[itt.Type].push_back(script);
+		}
+		closedir(d);
+	}
+	for (int ii = 0; ii < SCRIPT_TYPE_MAX; ii++)
+	{
+		std::sort(scripts[ii].begin(), scripts[ii].end(), ScriptNameCompare);
+		if (ii == SCRIPT_MODULE)
+		{
+			bool bSame = (scripts[ii].size() == m_Scripts[ii].size());
+			for (size_t jj = 0; (bSame) && (jj < scripts[ii].size()); jj++)
+			{
+				bSame = ((scripts[ii][jj].Name == m_Scripts[ii][jj].Name) && (scripts[ii][jj].LastModified == m_Scripts[ii][jj].LastModified));
+			}
+			if (!bSame)
+				m_ModulesGeneration++;
+		}
+		m_Scripts[ii].swap(scripts[ii]);
+	}
+	m_bValid = true;
+}
+
+void CdzVentsScripts::Update()
+{
+	if ((HasChanged()) || (!m_bValid))
+		Refresh();
+}
+
+void CdzVentsScripts::GetScripts(const _eScriptType Type, std::vector<_tScript> &scripts)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	Update();
+	scripts = m_Scripts[Type];
+}
+
+bool CdzVentsScripts::HaveScripts()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	Update();
+	return ((!m_Scripts[SCRIPT_EXTERNAL].empty()) || (!m_Scripts[SCRIPT_INTERNAL].empty()));
+}
+
+uint64_t CdzVentsScripts::GetModulesGeneration()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	Update();
+	return m_ModulesGeneration;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * List of the dzVents scripts on disk, kept by domoticz so the dzVents runtime does not
+ * have to list the script folders (by forking 'ls') each time it handles events.
+ * The folders are watched for changes (inotify on Linux, change notifications on Windows,
+ * the modification time of the folder elsewhere), the list is only read again after a change.
+ */
+class CdzVentsScripts
+{
+public:
+	enum _eScriptType
+	{
+		SCRIPT_EXTERNAL = 0,	//scripts/dzVents/scripts, written by the user
+		SCRIPT_INTERNAL,		//scripts/dzVents/generated_scripts, written from the events editor
+		SCRIPT_MODULE,			//shared modules required by the scripts
+		SCRIPT_TYPE_MAX
+	};
+	struct _tScript
+	{
+		std::string Name;		//filename without .lua
+		double LastModified;	//seconds, with the fraction where the filesystem has it
+	};
+
+	CdzVentsScripts();
+	~CdzVentsScripts();
+
+	void SetFolders(const std::string &ScriptsDir, const std::string &GeneratedScriptsDir, const std::vector<std::string> &ModuleDirs);
+	//Forces a new listing, for changes the watcher can not see
+	void Invalidate();
+
+	//Returns the scripts of a type sorted by name
+	void GetScripts(const _eScriptType Type, std::vector<_tScript> &scripts);
+	bool HaveScripts();
+	//Changes each time a shared module is added, removed or modified
+	uint64_t GetModulesGeneration();
+private:
+	struct _tFolder
+	{
+		std::string Path;
+		_eScriptType Type;
+		time_t Modified;
+#if defined(WIN32)
+		HANDLE hChange;
+#elif defined(__linux__)
+		int Watch;
+#endif
+	};
+
+	void AddFolder(const std::string &Path, const _eScriptType Type);
+	void StartWatching(_tFolder &folder);
+	void StopWatching();
+	bool HasChanged();
+	void Update();
+	void Refresh();
+
+	std::mutex m_mutex;
+	std::vector<_tFolder> m_Folders;
+	std::vector<_tScript> m_Scripts[SCRIPT_TYPE_MAX];
+	bool m_bValid;
+	uint64_t m_ModulesGeneration;
+#if defined(__linux__)
+	int m_inotifyFd;
+#endif
+};
@@ -362,6 +362,7 @@ void MainWorker::AddDomoticzHardware(CDomoticzHardwareBase *pHardware)
 	}
 	std::lock_guard<std::mutex> l(m_devicemutex);
 	pHardware->sDecodeRXMessage.connect(boost::bind(&MainWorker::DecodeRXMessage, this, _1, _2, _3, _4));
+	pHardware->sDecodeRXMessageBatch.connect(boost::bind(&MainWorker::DecodeRXMessageBatch, this, _1, _2));
 	pHardware->sOnConnected.connect(boost::bind(&MainWorker::OnHardwareConnected, this, _1));
 	m_hardwaredevices.push_back(pHardware);
 }
@@ -1065,7 +1066,7 @@ bool MainWorker::AddHardwareFromParams(
 		pHardware = new CEvohomeWeb(ID, Username, Password, Mode1, Mode2, Mode3);
 		break;
 	case HTYPE_Rtl433:
-		pHardware = new CRtl433(ID, Extra);
+		pHardware = new CRtl433(ID, Extra, Mode1, Username);
 		break;
 	case HTYPE_OnkyoAVTCP:
 		pHardware = new OnkyoAVTCP(ID, Address, Port);
@@ -1099,6 +1100,16 @@ bool MainWorker::AddHardwareFromParams(
 		pHardware->m_Name = Name;
 		pHardware->m_ShortName = Hardware_Short_Desc(Type);
 		pHardware->m_DataTimeout = DataTimeout;
+		std::vector<std::vector<std::string> > result;
+		result = m_sql.safe_query("SELECT RxQueueSize, RxQueuePolicy FROM Hardware WHERE (ID==%d)", ID);
+		if (!result.empty())
+		{
+			int RxQueueSize = atoi(result[0][0].c_str());
+			int RxQueuePolicy = atoi(result[0][1].c_str());
+			pHardware->m_RxQueueSize = (RxQueueSize > 0) ? (size_t)RxQueueSize : 0;
+			if ((RxQueuePolicy >= RXQ_POLICY_DROP_OLDEST) && (RxQueuePolicy <= RXQ_POLICY_BLOCK))
+				pHardware->m_RxQueuePolicy = (_eRxQueuePolicy)RxQueuePolicy;
+		}
 		AddDomoticzHardware(pHardware);
 
 		if (bDoStart)
@@ -1124,6 +1135,7 @@ bool MainWorker::Start()
 
 	HTTPClient::SetUserAgent(GenerateUserAgent());
 	m_notifications.Init();
+	m_sql.LoadDeviceTimeouts();
 	GetSunSettings();
 	GetAvailableWebThemes();
 #ifdef ENABLE_PYTHON
@@ -1206,7 +1218,7 @@ bool MainWorker::Stop()
 	if (m_rxMessageThread) {
 		// Stop RxMessage thread before hardware to avoid NULL pointer exception
 		m_TaskRXMessage.RequestStop();
-		UnlockRxMessageQueue();
+		m_rxMessageQueue.Stop();
 		m_rxMessageThread->join();
 		m_rxMessageThread.reset();
 	}
@@ -1226,7 +1238,7 @@ bool MainWorker::Stop()
 		m_pluginsystem.StopPluginSystem();
 #endif
 
-		//    m_cameras.StopCameraGrabber();
+		m_cameras.StopStreams();
 
 		HTTPClient::Cleanup();
 
@@ -1647,6 +1659,8 @@ void MainWorker::Do_Work()
 		struct tm ltime;
 		localtime_r(&atime, &ltime);
 
+		HandleDeviceTimeouts(atime);
+
 		if (ltime.tm_min != m_ScheduleLastMinute)
 		{
 			if (difftime(atime, m_ScheduleLastMinuteTime) > 30) //avoid RTC/NTP clock drifts
@@ -1669,7 +1683,6 @@ void MainWorker::Do_Work()
 					m_sql.UpdatePreferencesVar("WebPassword", "");
 					std::remove(szPwdResetFile.c_str());
 				}
-				m_notifications.CheckAndHandleLastUpdateNotification();
 			}
 			if (_log.NotificationLogsEnabled())
 			{
@@ -1688,7 +1701,6 @@ void MainWorker::Do_Work()
 				m_ScheduleLastHour = ltime.tm_hour;
 				GetSunSettings();
 
-				m_sql.CheckDeviceTimeout();
 				m_sql.CheckBatteryLow();
 
 				//check for daily schedule
@@ -1956,6 +1968,36 @@ void MainWorker::DecodeRXMessage(const CDomoticzHardwareBase *pHardware, const u
 	}
 }
 
+void MainWorker::DecodeRXMessageBatch(const CDomoticzHardwareBase *pHardware, const std::vector<_tRxBatchMessage> &messages)
+{
+	if ((pHardware == NULL) || (messages.empty()))
+		return;
+	if (((pHardware->HwdType == HTYPE_Domoticz) && (pHardware->m_HwdID == 8765)) || (messages.size() == 1))
+	{
+		for (const auto & itt : messages)
+			DecodeRXMessage(pHardware, itt.RXCommand, itt.Name.c_str(), itt.BatteryLevel);
+		return;
+	}
+	if (pHardware->m_HwdID < 1) {
+		_log.Log(LOG_ERROR, "RxQueue: cannot push message with invalid hardware id (id=%d, type=%d, name=%s)",
+			pHardware->m_HwdID,
+			pHardware->HwdType,
+			pHardware->m_Name.c_str());
+		return;
+	}
+	if (m_TaskRXMessage.IsStopRequested(0)) {
+		// Server is stopping
+		return;
+	}
+
+	unsigned long rxMessageIdx = m_rxMessageIdx;
+	m_rxMessageIdx += messages.size();
+
+	// Push all messages of the reading to the queue of the hardware, the decoder is woken up once
+	m_rxMessageQueue.PushBatch(pHardware->m_HwdID, messages, rxMessageIdx,
+		pHardware->m_RxQueueSize, pHardware->m_RxQueuePolicy, pHardware->m_RxQueueWeight);
+}
+
 void MainWorker::PushRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel)
 {
 	// Check command, submit it without waiting for it to be processed
@@ -1984,57 +2026,45 @@ void MainWorker::CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, c
 		return;
 	}
 
-	// Build queue item
-	_tRxQueueItem rxMessage;
-	if (defaultName != NULL)
-	{
-		rxMessage.Name = defaultName;
-	}
-	rxMessage.BatteryLevel = BatteryLevel;
-	rxMessage.rxMessageIdx = m_rxMessageIdx++;
-	rxMessage.hardwareId = pHardware->m_HwdID;
-	// defensive copy of the command
-	rxMessage.vrxCommand.resize(pRXCommand[0] + 1);
-	rxMessage.vrxCommand.insert(rxMessage.vrxCommand.begin(), pRXCommand, pRXCommand + pRXCommand[0] + 1);
-	rxMessage.crc = 0x0;
-#ifdef DEBUG_RXQUEUE
-	// CRC
-	boost::crc_optimal<16, 0x1021, 0xFFFF, 0, false, false> crc_ccitt2;
-	crc_ccitt2 = std::for_each(pRXCommand, pRXCommand + pRXCommand[0] + 1, crc_ccitt2);
-	rxMessage.crc = crc_ccitt2();
-#endif
-
 	if (m_TaskRXMessage.IsStopRequested(0)) {
 		// Server is stopping
 		return;
 	}
 
+	unsigned long rxMessageIdx = m_rxMessageIdx++;
+
 	// Trigger
-	rxMessage.trigger = NULL; // Should be initialized to NULL if trigger is no used
+	queue_element_trigger *trigger = NULL; // Should be initialized to NULL if trigger is no used
 	if (wait) { // add trigger to wait for the message to be processed
-		rxMessage.trigger = new queue_element_trigger();
+		trigger = new queue_element_trigger();
 	}
 
 #ifdef DEBUG_RXQUEUE
 	_log.Log(LOG_STATUS, "RxQueue: push a rxMessage(%lu) (hrdwId=%d, hrdwType=%d, hrdwName=%s, type=%02X, subtype=%02X)",
-		rxMessage.rxMessageIdx,
+		rxMessageIdx,
 		pHardware->m_HwdID,
 		pHardware->HwdType,
-		pHardware->Name.c_str(),
+		pHardware->m_Name.c_str(),
 		pRXCommand[1],
 		pRXCommand[2]);
 #endif
 
-	// Push item to queue
-	m_rxMessageQueue.push(rxMessage);
+	// Push item to the queue of the hardware (the command is copied into a queue slot)
+	if (!m_rxMessageQueue.Push(pHardware->m_HwdID, pRXCommand, defaultName, BatteryLevel, rxMessageIdx, trigger,
+		pHardware->m_RxQueueSize, pHardware->m_RxQueuePolicy, pHardware->m_RxQueueWeight))
+	{
+		// dropped, or server is stopping
+		delete trigger;
+		return;
+	}
 
-	if (rxMessage.trigger != NULL) {
+	if (trigger != NULL) {
 #ifdef DEBUG_RXQUEUE
-		_log.Log(LOG_STATUS, "RxQueue: wait for rxMessage(%lu) to be processed...", rxMessage.rxMessageIdx);
+		_log.Log(LOG_STATUS, "RxQueue: wait for rxMessage(%lu) to be processed...", rxMessageIdx);
 #endif
-		while (!rxMessage.trigger->timed_wait(std::chrono::duration<int>(1))) {
+		while (!trigger->timed_wait(std::chrono::duration<int>(1))) {
 #ifdef DEBUG_RXQUEUE
-			_log.Log(LOG_STATUS, "RxQueue: wait 1s for rxMessage(%lu) to be processed...", rxMessage.rxMessageIdx);
+			_log.Log(LOG_STATUS, "RxQueue: wait 1s for rxMessage(%lu) to be processed...", rxMessageIdx);
 #endif
 			if (m_TaskRXMessage.IsStopRequested(0)) {
 				// Server is stopping
@@ -2042,103 +2072,55 @@ void MainWorker::CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, c
 			}
 		}
 #ifdef DEBUG_RXQUEUE
-		if (moreThanTimeout) {
-			_log.Log(LOG_STATUS, "RxQueue: rxMessage(%lu) processed", rxMessage.rxMessageIdx);
-		}
+		_log.Log(LOG_STATUS, "RxQueue: rxMessage(%lu) processed", rxMessageIdx);
 #endif
-		delete rxMessage.trigger;
+		delete trigger;
 	}
 }
 
-void MainWorker::UnlockRxMessageQueue()
-{
-#ifdef DEBUG_RXQUEUE
-	_log.Log(LOG_STATUS, "RxQueue: unlock queue using dummy message");
-#endif
-	// Push dummy message to unlock queue
-	_tRxQueueItem rxMessage;
-	rxMessage.rxMessageIdx = m_rxMessageIdx++;
-	rxMessage.hardwareId = -1;
-	rxMessage.trigger = NULL;
-	rxMessage.BatteryLevel = 0;
-	m_rxMessageQueue.push(rxMessage);
-}
-
 void MainWorker::Do_Work_On_Rx_Messages()
 {
 	_log.Log(LOG_STATUS, "RxQueue: queue worker started...");
+	m_rxMessageQueue.SetConsumerThread();
 
 	while (!m_TaskRXMessage.IsStopRequested(0))
 	{
 		// Wait and pop next message or timeout
-		_tRxQueueItem rxQItem;
-		bool hasPopped = m_rxMessageQueue.timed_wait_and_pop<std::chrono::duration<int> >(rxQItem, std::chrono::duration<int>(5));
+		CRxMessageQueue::_tMessage *pMessage = m_rxMessageQueue.Pop(std::chrono::milliseconds(5000));
 		// (if no message for 5 seconds, returns anyway to check m_TaskRXMessage.IsStopRequested)
 
-		if (!hasPopped) {
-			// Timeout occurred : queue is empty
-#ifdef DEBUG_RXQUEUE
-			//_log.Log(LOG_STATUS, "RxQueue: the queue has been empty for five seconds");
-#endif
-			continue;
-		}
-		if (rxQItem.hardwareId == -1) {
-			// dummy message
-#ifdef DEBUG_RXQUEUE
-			_log.Log(LOG_STATUS, "RxQueue: dummy message popped");
-#endif
-			continue;
-		}
-		if (rxQItem.hardwareId < 1) {
-			_log.Log(LOG_ERROR, "RxQueue: cannot process invalid hardware id: (%d)", rxQItem.hardwareId);
-			// cannot process message with invalid id or null message
-			if (rxQItem.trigger != NULL) rxQItem.trigger->popped();
+		if (pMessage == NULL) {
+			// Timeout occurred (queue is empty) or server is stopping
 			continue;
 		}
 
-		const CDomoticzHardwareBase *pHardware = GetHardware(rxQItem.hardwareId);
+		const CDomoticzHardwareBase *pHardware = GetHardware(pMessage->HwdID);
 
 		// Check pointers
 		if (pHardware == NULL) {
-			_log.Log(LOG_ERROR, "RxQueue: cannot retrieve hardware with id: %d", rxQItem.hardwareId);
-			if (rxQItem.trigger != NULL) rxQItem.trigger->popped();
-			continue;
-		}
-		if (rxQItem.vrxCommand.empty()) {
-			_log.Log(LOG_ERROR, "RxQueue: cannot retrieve command with id: %d", rxQItem.hardwareId);
-			if (rxQItem.trigger != NULL) rxQItem.trigger->popped();
+			_log.Log(LOG_ERROR, "RxQueue: cannot retrieve hardware with id: %d", pMessage->HwdID);
+			if (pMessage->trigger != NULL) pMessage->trigger->popped();
+			m_rxMessageQueue.Release(pMessage);
 			continue;
 		}
 
-		const uint8_t *pRXCommand = &rxQItem.vrxCommand[0];
+		const uint8_t *pRXCommand = pMessage->RXCommand;
 
 #ifdef DEBUG_RXQUEUE
-		// CRC
-		boost::uint16_t crc = rxQItem.crc;
-		boost::crc_optimal<16, 0x1021, 0xFFFF, 0, false, false> crc_ccitt2;
-		crc_ccitt2 = std::for_each(pRXCommand, pRXCommand + rxQItem.vrxCommand.size(), crc_ccitt2);
-		if (crc != crc_ccitt2()) {
-			_log.Log(LOG_ERROR, "RxQueue: cannot process invalid rxMessage(%lu) from hardware with id=%d (type %d)",
-				rxQItem.rxMessageIdx,
-				rxQItem.hardwareId,
-				pHardware->HwdType);
-			if (rxQItem.trigger != NULL) rxQItem.trigger->popped();
-			continue;
-		}
-
 		_log.Log(LOG_STATUS, "RxQueue: process a rxMessage(%lu) (hrdwId=%d, hrdwType=%d, hrdwName=%s, type=%02X, subtype=%02X)",
-			rxQItem.rxMessageIdx,
+			pMessage->rxMessageIdx,
 			pHardware->m_HwdID,
 			pHardware->HwdType,
-			pHardware->Name.c_str(),
+			pHardware->m_Name.c_str(),
 			pRXCommand[1],
 			pRXCommand[2]);
 #endif
-		ProcessRXMessage(pHardware, pRXCommand, rxQItem.Name.c_str(), rxQItem.BatteryLevel);
-		if (rxQItem.trigger != NULL)
+		ProcessRXMessage(pHardware, pRXCommand, pMessage->Name.c_str(), pMessage->BatteryLevel);
+		if (pMessage->trigger != NULL)
 		{
-			rxQItem.trigger->popped();
+			pMessage->trigger->popped();
 		}
+		m_rxMessageQueue.Release(pMessage);
 	}
 
 	_log.Log(LOG_STATUS, "RxQueue: queue worker stopped...");
@@ -2465,7 +2447,7 @@ void MainWorker::ProcessRXMessage(const CDomoticzHardwareBase *pHardware, const
 	//Send to connected Sharing Users
 	m_sharedserver.SendToAll(pHardware->m_HwdID, DeviceRowIdx, (const char*)pRXCommand, pRXCommand[0] + 1, pClient2Ignore);
 
-	sOnDeviceReceived(pHardware->m_HwdID, DeviceRowIdx, DeviceName, pRXCommand);
+	m_deviceupdates.Publish(pHardware->m_HwdID, DeviceRowIdx, DeviceName, pRXCommand);
 }
 
 void MainWorker::decode_InterfaceMessage(const int HwdID, const _eHardwareTypes HwdType, const tRBUF *pResponse, _tRxMessageProcessingResult & procResult)
@@ -12986,6 +12968,7 @@ bool MainWorker::SwitchScene(const uint64_t idx, std::string switchcmd)
 		nValue,
 		szLastUpdate.c_str(),
 		idx);
+	m_sql.SetSceneGraphValue(idx, nValue);
 
 	//Check if we need to email a snapshot of a Camera
 	std::string emailserver;
@@ -13290,6 +13273,28 @@ void MainWorker::ForceLogNotificationCheck()
 	m_bForceLogNotificationCheck = true;
 }
 
+std::string MainWorker::GetLastSunriseSet()
+{
+	return m_LastSunriseSet;
+}
+
+//Handles the sensor timeouts and last update notifications that are due
+void MainWorker::HandleDeviceTimeouts(const time_t now)
+{
+	uint64_t DeviceRowIdx;
+	CDeviceTimeoutTracker::_eTimeoutType Type;
+	while (m_devicetimeouts.PopDue(now, DeviceRowIdx, Type))
+	{
+		time_t next;
+		if (Type == CDeviceTimeoutTracker::TIMEOUT_SENSOR)
+			next = m_sql.HandleSensorTimeout(DeviceRowIdx, now);
+		else
+			next = m_notifications.CheckAndHandleLastUpdateNotification(DeviceRowIdx, now);
+		//an update of the device in the meantime already set a newer deadline
+		m_devicetimeouts.ScheduleIfIdle(DeviceRowIdx, Type, next);
+	}
+}
+
 void MainWorker::HandleLogNotifications()
 {
 	std::list<CLogger::_tLogLineStruct> _loglines = _log.GetNotificationLogs();
@@ -13647,7 +13652,7 @@ bool MainWorker::UpdateDevice(const int HardwareID, const std::string &DeviceID,
 #endif
 
 	// signal connected devices (MQTT, fibaro, http push ... ) about the update
-	sOnDeviceReceived(HardwareID, devidx, devname, nullptr);
+	m_deviceupdates.Publish(HardwareID, devidx, devname, nullptr);
 
 	std::stringstream sidx;
 	sidx << devidx;
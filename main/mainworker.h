@@ -9,14 +9,18 @@
 #include "WindCalculation.h"
 #include "TrendCalculator.h"
 #include "StoppableTask.h"
+#include "WorkerServices.h"
 #include "../tcpserver/TCPServer.h"
 #include "concurrent_queue.h"
+#include "DeviceUpdateBus.h"
+#include "RxMessageQueue.h"
+#include "DeviceTimeoutTracker.h"
 #include "../webserver/server_settings.hpp"
 #ifdef ENABLE_PYTHON
 #	include "../hardware/plugins/PluginManager.h"
 #endif
 
-class MainWorker : public StoppableTask
+class MainWorker : public StoppableTask, public IWorkerServices
 {
 public:
 	MainWorker();
@@ -37,8 +41,8 @@ public:
 	CDomoticzHardwareBase* GetHardwareByIDType(const std::string &HwdId, const _eHardwareTypes HWType);
 	CDomoticzHardwareBase* GetHardwareByType(const _eHardwareTypes HWType);
 
-	void HeartbeatUpdate(const std::string &component, bool critical = true);
-	void HeartbeatRemove(const std::string &component);
+	void HeartbeatUpdate(const std::string &component, bool critical = true) override;
+	void HeartbeatRemove(const std::string &component) override;
 	void HeartbeatCheck();
 
 	void SetWebserverSettings(const http::server::server_settings & settings);
@@ -49,6 +53,7 @@ public:
 	std::string GetSecureWebserverPort();
 #endif
 	void DecodeRXMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel);
+	void DecodeRXMessageBatch(const CDomoticzHardwareBase *pHardware, const std::vector<_tRxBatchMessage> &messages);
 	void PushAndWaitRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel);
 
 	bool SwitchLight(const std::string &idx, const std::string &switchcmd, const std::string &level, const std::string &color, const std::string &ooc, const int ExtraDelay);
@@ -76,7 +81,8 @@ public:
 	bool GetSunSettings();
 	void LoadSharedUsers();
 
-	void ForceLogNotificationCheck();
+	void ForceLogNotificationCheck() override;
+	std::string GetLastSunriseSet() override;
 
 	bool RestartHardware(const std::string &idx);
 
@@ -105,7 +111,9 @@ public:
 	bool UpdateDevice(const int DevIdx, int nValue, std::string& sValue, const int signallevel = 12, const int batterylevel = 255, const bool parseTrigger = true);
 	bool UpdateDevice(const int HardwareID, const std::string &DeviceID, const int unit, const int devType, const int subType, int nValue, std::string &sValue, const int signallevel = 12, const int batterylevel = 255, const bool parseTrigger = true);
 
-	boost::signals2::signal<void(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const uint8_t *pRXCommand)> sOnDeviceReceived;
+	CDeviceUpdateBus m_deviceupdates;
+	CRxMessageQueue m_rxMessageQueue;
+	CDeviceTimeoutTracker m_devicetimeouts;
 	boost::signals2::signal<void(const uint64_t SceneIdx, const std::string &SceneName)> sOnSwitchScene;
 
 	CScheduler m_scheduler;
@@ -142,6 +150,7 @@ private:
 	void HandleAutomaticBackups();
 	uint64_t PerformRealActionFromDomoticzClient(const uint8_t *pRXCommand, CDomoticzHardwareBase **pOriginalHardware);
 	void HandleLogNotifications();
+	void HandleDeviceTimeouts(const time_t now);
 	std::map<std::string, std::pair<time_t, bool> > m_componentheartbeats;
 	std::mutex m_heartbeatmutex;
 
@@ -200,17 +209,6 @@ private:
 	std::shared_ptr<std::thread> m_rxMessageThread;
 	StoppableTask m_TaskRXMessage;
 	void Do_Work_On_Rx_Messages();
-	struct _tRxQueueItem {
-		std::string Name;
-		int BatteryLevel;
-		unsigned long rxMessageIdx;
-		int hardwareId;
-		std::vector<uint8_t> vrxCommand;
-		boost::uint16_t crc;
-		queue_element_trigger* trigger;
-	};
-	concurrent_queue<_tRxQueueItem> m_rxMessageQueue;
-	void UnlockRxMessageQueue();
 	void PushRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel);
 	void CheckAndPushRxMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel, const bool wait);
 	void ProcessRXMessage(const CDomoticzHardwareBase *pHardware, const uint8_t *pRXCommand, const char *defaultName, const int BatteryLevel); //battery level: 0-100, 255=no battery, -1 = don't set
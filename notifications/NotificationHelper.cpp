@@ -1231,89 +1231,118 @@ bool CNotificationHelper::CheckAndHandleRainNotification(
 }
 
 
-void CNotificationHelper::CheckAndHandleLastUpdateNotification()
+//Called by the device timeout tracker for a device with last update notifications,
+//returns when the notifications of the device have to be checked again (0 = not anymore)
+time_t CNotificationHelper::CheckAndHandleLastUpdateNotification(const uint64_t Idx, const time_t now)
 {
-	if (m_notifications.size() < 1)
-		return;
+	std::vector<_tNotification> notifications;
+	{
+		std::lock_guard<std::mutex> l(m_mutex);
+		std::map<uint64_t, std::vector<_tNotification> >::const_iterator itt = m_notifications.find(Idx);
+		if (itt == m_notifications.end())
+			return 0;
+		notifications = itt->second;
+	}
 
-	time_t atime = mytime(NULL);
-	atime -= m_NotificationSensorInterval;
-	std::map<uint64_t, std::vector<_tNotification> >::const_iterator itt;
+	extern time_t m_StartTime;
+	time_t atime = now - m_NotificationSensorInterval;
+	const std::string ttype = Notification_Type_Desc(NTYPE_LASTUPDATE, 1);
+	std::vector<uint64_t> sent;
+	bool bHaveLastUpdate = false;
 
-	for (itt = m_notifications.begin(); itt != m_notifications.end(); ++itt)
+	std::vector<_tNotification>::const_iterator itt2;
+	for (itt2 = notifications.begin(); itt2 != notifications.end(); ++itt2)
 	{
-		std::vector<_tNotification>::const_iterator itt2;
-		for (itt2 = itt->second.begin(); itt2 != itt->second.end(); ++itt2)
+		std::vector<std::string> splitresults;
+		StringSplit(itt2->Params, ";", splitresults);
+		if ((splitresults.size() < 3) || (splitresults[0] != ttype))
+			continue;
+		bHaveLastUpdate = true;
+		if (((atime >= itt2->LastSend) || (itt2->SendAlways) || (!itt2->CustomMessage.empty())) && (itt2->LastUpdate)) //emergency always goes true
 		{
-			if (((atime >= itt2->LastSend) || (itt2->SendAlways) || (!itt2->CustomMessage.empty())) && (itt2->LastUpdate)) //emergency always goes true
+			std::string recoverymsg;
+			bool bRecoveryMessage = false;
+			bRecoveryMessage = CustomRecoveryMessage(itt2->ID, recoverymsg, true);
+			if ((atime < itt2->LastSend) && (!itt2->SendAlways) && (!bRecoveryMessage))
+				continue;
+			std::string msg;
+			std::string szExtraData;
+			std::string custommsg;
+			uint32_t SensorTimeOut = static_cast<uint32_t>(atoi(splitresults[2].c_str()));  // minutes
+			uint32_t diff = static_cast<uint32_t>(round(difftime(now, itt2->LastUpdate)));
+			bool bStartTime = (difftime(now, m_StartTime) < SensorTimeOut * 60);
+			bool bSendNotification = ApplyRule(splitresults[1], (diff == SensorTimeOut * 60), (diff < SensorTimeOut * 60));
+			bool bCustomMessage = false;
+			bCustomMessage = CustomRecoveryMessage(itt2->ID, custommsg, false);
+
+			if (bSendNotification && !bStartTime && (!bRecoveryMessage || itt2->SendAlways))
 			{
-				std::vector<std::string> splitresults;
-				StringSplit(itt2->Params, ";", splitresults);
-				if (splitresults.size() < 3)
+				if (SystemUptime() < SensorTimeOut * 60 && (!bRecoveryMessage || itt2->SendAlways))
 					continue;
-				std::string ttype = Notification_Type_Desc(NTYPE_LASTUPDATE, 1);
-				if (splitresults[0] == ttype)
-				{
-					std::string recoverymsg;
-					bool bRecoveryMessage = false;
-					bRecoveryMessage = CustomRecoveryMessage(itt2->ID, recoverymsg, true);
-					if ((atime < itt2->LastSend) && (!itt2->SendAlways) && (!bRecoveryMessage))
-						continue;
-					extern time_t m_StartTime;
-					time_t btime = mytime(NULL);
-					std::string msg;
-					std::string szExtraData;
-					std::string custommsg;
-					uint64_t Idx = itt->first;
-					uint32_t SensorTimeOut = static_cast<uint32_t>(atoi(splitresults[2].c_str()));  // minutes
-					uint32_t diff = static_cast<uint32_t>(round(difftime(btime, itt2->LastUpdate)));
-					bool bStartTime = (difftime(btime, m_StartTime) < SensorTimeOut * 60);
-					bool bSendNotification = ApplyRule(splitresults[1], (diff == SensorTimeOut * 60), (diff < SensorTimeOut * 60));
-					bool bCustomMessage = false;
-					bCustomMessage = CustomRecoveryMessage(itt2->ID, custommsg, false);
-
-					if (bSendNotification && !bStartTime && (!bRecoveryMessage || itt2->SendAlways))
-					{
-						if (SystemUptime() < SensorTimeOut * 60 && (!bRecoveryMessage || itt2->SendAlways))
-							continue;
-						std::vector<std::vector<std::string> > result;
-						result = m_sql.safe_query("SELECT SwitchType FROM DeviceStatus WHERE (ID=%" PRIu64 ")", Idx);
-						if (result.empty())
-							continue;
-						szExtraData = "|Name=" + itt2->DeviceName + "|SwitchType=" + result[0][0] + "|";
-						std::string ltype = Notification_Type_Desc(NTYPE_LASTUPDATE, 0);
-						std::string label = Notification_Type_Label(NTYPE_LASTUPDATE);
-						char szDate[50];
-						char szTmp[300];
-						struct tm ltime;
-						localtime_r(&itt2->LastUpdate,&ltime);
-						sprintf(szDate, "%04d-%02d-%02d %02d:%02d:%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday,
-							ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
-						sprintf(szTmp,"Sensor %s %s: %s [%s %d %s]", itt2->DeviceName.c_str(), ltype.c_str(), szDate,
-							splitresults[1].c_str(), SensorTimeOut, label.c_str());
-						msg = szTmp;
-					}
-					else if (!bSendNotification && bRecoveryMessage)
-					{
-						msg = recoverymsg;
-						std::string clearstr = "!";
-						CustomRecoveryMessage(itt2->ID, clearstr, true);
-					}
-					else
-						continue;
+				std::vector<std::vector<std::string> > result;
+				result = m_sql.safe_query("SELECT SwitchType FROM DeviceStatus WHERE (ID=%" PRIu64 ")", Idx);
+				if (result.empty())
+					continue;
+				szExtraData = "|Name=" + itt2->DeviceName + "|SwitchType=" + result[0][0] + "|";
+				std::string ltype = Notification_Type_Desc(NTYPE_LASTUPDATE, 0);
+				std::string label = Notification_Type_Label(NTYPE_LASTUPDATE);
+				char szDate[50];
+				char szTmp[300];
+				struct tm ltime;
+				localtime_r(&itt2->LastUpdate,&ltime);
+				sprintf(szDate, "%04d-%02d-%02d %02d:%02d:%02d", ltime.tm_year + 1900, ltime.tm_mon + 1, ltime.tm_mday,
+					ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
+				sprintf(szTmp,"Sensor %s %s: %s [%s %d %s]", itt2->DeviceName.c_str(), ltype.c_str(), szDate,
+					splitresults[1].c_str(), SensorTimeOut, label.c_str());
+				msg = szTmp;
+			}
+			else if (!bSendNotification && bRecoveryMessage)
+			{
+				msg = recoverymsg;
+				std::string clearstr = "!";
+				CustomRecoveryMessage(itt2->ID, clearstr, true);
+			}
+			else
+				continue;
 
-					if (bCustomMessage && !bRecoveryMessage)
-						msg = ParseCustomMessage(custommsg, itt2->DeviceName, "");
-					SendMessageEx(Idx, itt2->DeviceName, itt2->ActiveSystems, msg, msg, szExtraData, itt2->Priority, std::string(""), true);
-					if (!bRecoveryMessage)
-					{
-						TouchNotification(itt2->ID);
-						CustomRecoveryMessage(itt2->ID, msg, true);
-					}
-				}
+			if (bCustomMessage && !bRecoveryMessage)
+				msg = ParseCustomMessage(custommsg, itt2->DeviceName, "");
+			SendMessageEx(Idx, itt2->DeviceName, itt2->ActiveSystems, msg, msg, szExtraData, itt2->Priority, std::string(""), true);
+			if (!bRecoveryMessage)
+			{
+				TouchNotification(itt2->ID);
+				CustomRecoveryMessage(itt2->ID, msg, true);
+				sent.push_back(itt2->ID);
 			}
 		}
 	}
+	if (!bHaveLastUpdate)
+		return 0;
+
+	//the next moment a rule can change its outcome: the timeout expires, the startup grace period
+	//ends or the notification interval passed, look at least every hour
+	time_t next = now + 3600;
+	for (itt2 = notifications.begin(); itt2 != notifications.end(); ++itt2)
+	{
+		std::vector<std::string> splitresults;
+		StringSplit(itt2->Params, ";", splitresults);
+		if ((splitresults.size() < 3) || (splitresults[0] != ttype))
+			continue;
+		time_t SensorTimeOut = static_cast<time_t>(atoi(splitresults[2].c_str())) * 60;
+		time_t LastSend = (std::find(sent.begin(), sent.end(), itt2->ID) != sent.end()) ? now : itt2->LastSend;
+		const time_t candidates[] = {
+			itt2->LastUpdate + SensorTimeOut,
+			itt2->LastUpdate + SensorTimeOut + 1,
+			m_StartTime + SensorTimeOut + 1,
+			LastSend + m_NotificationSensorInterval
+		};
+		for (const auto & candidate : candidates)
+		{
+			if ((candidate > now) && (candidate < next))
+				next = candidate;
+		}
+	}
+	return next;
 }
 
 void CNotificationHelper::TouchNotification(const uint64_t ID)
@@ -1360,6 +1389,8 @@ void CNotificationHelper::TouchLastUpdate(const uint64_t ID)
 			if (itt2->ID == ID)
 			{
 				itt2->LastUpdate = atime;
+				//evaluate right away for the recovery message, the timeout is rescheduled from there
+				m_mainworker.m_devicetimeouts.Schedule(itt->first, CDeviceTimeoutTracker::TIMEOUT_NOTIFICATION, atime);
 				return;
 			}
 		}
@@ -1518,6 +1549,7 @@ void CNotificationHelper::ReloadNotifications()
 {
 	std::lock_guard<std::mutex> l(m_mutex);
 	m_notifications.clear();
+	m_mainworker.m_devicetimeouts.Clear(CDeviceTimeoutTracker::TIMEOUT_NOTIFICATION);
 	std::vector<std::vector<std::string> > result;
 
 	m_sql.GetPreferencesVar("NotificationSensorInterval", m_NotificationSensorInterval);
@@ -1590,6 +1622,7 @@ void CNotificationHelper::ReloadNotifications()
 				std::string stime = result2[0][1];
 				ParseSQLdatetime(notification.LastUpdate, ntime, stime, atime.tm_isdst);
 			}
+			m_mainworker.m_devicetimeouts.Schedule(Idx, CDeviceTimeoutTracker::TIMEOUT_NOTIFICATION, mtime);
 		}
 		m_notifications[Idx].push_back(notification);
 	}
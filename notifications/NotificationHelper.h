@@ -49,7 +49,7 @@ public:
 	bool IsInConfig(const std::string &Key);
 
 	//notification functions
-	void CheckAndHandleLastUpdateNotification();
+	time_t CheckAndHandleLastUpdateNotification(const uint64_t Idx, const time_t now);
 	void ReloadNotifications();
 	bool AddNotification(
 		const std::string &DevIdx,
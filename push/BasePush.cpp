@@ -378,6 +378,7 @@ CBasePush::CBasePush()
 {
 	m_bLinkActive = false;
 	m_DeviceRowIdx = -1;
+	m_DeviceUpdateSubscription = 0;
 }
 
 // STATIC
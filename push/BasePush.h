@@ -2,6 +2,7 @@
 
 #include <boost/signals2.hpp>
 #include "../main/StoppableTask.h"
+#include "../main/DeviceUpdateBus.h"
 
 class CBasePush : public StoppableTask
 {
@@ -13,7 +14,7 @@ public:
 protected:
 	bool m_bLinkActive;
 	uint64_t m_DeviceRowIdx;
-	boost::signals2::connection m_sConnection;
+	int m_DeviceUpdateSubscription;
 	boost::signals2::connection m_sNotification;
 	boost::signals2::connection m_sSceneChanged;
 
@@ -22,13 +22,16 @@ CFibaroPush::CFibaroPush()
 void CFibaroPush::Start()
 {
 	UpdateActive();
-	m_sConnection = m_mainworker.sOnDeviceReceived.connect(boost::bind(&CFibaroPush::OnDeviceReceived, this, _1, _2, _3, _4));
+	m_DeviceUpdateSubscription = m_mainworker.m_deviceupdates.Subscribe("FibaroPush", [this](const DeviceUpdatePtr &pUpdate) { OnDeviceReceived(pUpdate); });
 }
 
 void CFibaroPush::Stop()
 {
-	if (m_sConnection.connected())
-		m_sConnection.disconnect();
+	if (m_DeviceUpdateSubscription != 0)
+	{
+		m_mainworker.m_deviceupdates.Unsubscribe(m_DeviceUpdateSubscription);
+		m_DeviceUpdateSubscription = 0;
+	}
 }
 
 void CFibaroPush::UpdateActive()
@@ -38,16 +41,16 @@ void CFibaroPush::UpdateActive()
 	m_bLinkActive = (fActive == 1);
 }
 
-void CFibaroPush::OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand)
+void CFibaroPush::OnDeviceReceived(const DeviceUpdatePtr &pUpdate)
 {
-	m_DeviceRowIdx = DeviceRowIdx;
-	if (m_bLinkActive)
+	m_DeviceRowIdx = pUpdate->DeviceRowIdx;
+	if ((m_bLinkActive) && (pUpdate->bHaveStatus))
 	{
-		DoFibaroPush();
+		DoFibaroPush(pUpdate);
 	}
 }
 
-void CFibaroPush::DoFibaroPush()
+void CFibaroPush::DoFibaroPush(const DeviceUpdatePtr &pUpdate)
 {
 	std::string fibaroIP = "";
 	std::string fibaroUsername = "";
@@ -75,8 +78,8 @@ void CFibaroPush::DoFibaroPush()
 		return;
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query(
-		"SELECT A.DeviceID, A.DelimitedValue, B.ID, B.Type, B.SubType, B.nValue, B.sValue, A.TargetType, A.TargetVariable, A.TargetDeviceID, A.TargetProperty, A.IncludeUnit, B.SwitchType FROM FibaroLink as A, DeviceStatus as B "
-		"WHERE (A.DeviceID == '%" PRIu64 "' AND A.Enabled = '1' AND A.DeviceID==B.ID)",
+		"SELECT DeviceID, DelimitedValue, TargetType, TargetVariable, TargetDeviceID, TargetProperty, IncludeUnit FROM FibaroLink "
+		"WHERE (DeviceID == '%" PRIu64 "' AND Enabled = '1')",
 		m_DeviceRowIdx);
 	if (!result.empty())
 	{
@@ -86,16 +89,16 @@ void CFibaroPush::DoFibaroPush()
 		{
 			std::vector<std::string> sd = *itt;
 			int delpos = atoi(sd[1].c_str());
-			int dType = atoi(sd[3].c_str());
-			int dSubType = atoi(sd[4].c_str());
-			int nValue = atoi(sd[5].c_str());
-			std::string sValue = sd[6].c_str();
-			int targetType = atoi(sd[7].c_str());
-			std::string targetVariable = sd[8].c_str();
-			int targetDeviceID = atoi(sd[9].c_str());
-			std::string targetProperty = sd[10].c_str();
-			int includeUnit = atoi(sd[11].c_str());
-			int metertype = atoi(sd[12].c_str());
+			int dType = pUpdate->Type;
+			int dSubType = pUpdate->SubType;
+			int nValue = pUpdate->nValue;
+			std::string sValue = pUpdate->sValue;
+			int targetType = atoi(sd[2].c_str());
+			std::string targetVariable = sd[3].c_str();
+			int targetDeviceID = atoi(sd[4].c_str());
+			std::string targetProperty = sd[5].c_str();
+			int includeUnit = atoi(sd[6].c_str());
+			int metertype = pUpdate->SwitchType;
 			std::string lstatus = "";
 
 			if ((targetType == 0) || (targetType == 1)) {
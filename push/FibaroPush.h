@@ -12,7 +12,7 @@ public:
 
 private:
 
-	void OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand);
-	void DoFibaroPush();
+	void OnDeviceReceived(const DeviceUpdatePtr &pUpdate);
+	void DoFibaroPush(const DeviceUpdatePtr &pUpdate);
 };
 extern CFibaroPush m_fibaropush;
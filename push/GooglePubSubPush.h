@@ -12,8 +12,8 @@ public:
 
 private:
 
-	void OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand);
-	void DoGooglePubSubPush();
+	void OnDeviceReceived(const DeviceUpdatePtr &pUpdate);
+	void DoGooglePubSubPush(const DeviceUpdatePtr &pUpdate);
 };
 extern CGooglePubSubPush m_googlepubsubpush;
 
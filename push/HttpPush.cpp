@@ -23,13 +23,16 @@ CHttpPush::CHttpPush()
 void CHttpPush::Start()
 {
 	UpdateActive();
-	m_sConnection = m_mainworker.sOnDeviceReceived.connect(boost::bind(&CHttpPush::OnDeviceReceived, this, _1, _2, _3, _4));
+	m_DeviceUpdateSubscription = m_mainworker.m_deviceupdates.Subscribe("HttpPush", [this](const DeviceUpdatePtr &pUpdate) { OnDeviceReceived(pUpdate); });
 }
 
 void CHttpPush::Stop()
 {
-	if (m_sConnection.connected())
-		m_sConnection.disconnect();
+	if (m_DeviceUpdateSubscription != 0)
+	{
+		m_mainworker.m_deviceupdates.Unsubscribe(m_DeviceUpdateSubscription);
+		m_DeviceUpdateSubscription = 0;
+	}
 }
 
 
@@ -40,16 +43,16 @@ void CHttpPush::UpdateActive()
 	m_bLinkActive = (fActive == 1);
 }
 
-void CHttpPush::OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand)
+void CHttpPush::OnDeviceReceived(const DeviceUpdatePtr &pUpdate)
 {
-	m_DeviceRowIdx = DeviceRowIdx;
-	if (m_bLinkActive)
+	m_DeviceRowIdx = pUpdate->DeviceRowIdx;
+	if ((m_bLinkActive) && (pUpdate->bHaveStatus))
 	{
-		DoHttpPush();
+		DoHttpPush(pUpdate);
 	}
 }
 
-void CHttpPush::DoHttpPush()
+void CHttpPush::DoHttpPush(const DeviceUpdatePtr &pUpdate)
 {
 	std::string httpUrl = "";
 	std::string httpData = "";
@@ -71,8 +74,8 @@ void CHttpPush::DoHttpPush()
 	}
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query(
-		"SELECT A.DeviceID, A.DelimitedValue, B.ID, B.Type, B.SubType, B.nValue, B.sValue, A.TargetType, A.TargetVariable, A.TargetDeviceID, A.TargetProperty, A.IncludeUnit, B.SwitchType, strftime('%%s', B.LastUpdate), B.Name FROM HttpLink as A, DeviceStatus as B "
-		"WHERE (A.DeviceID == '%" PRIu64 "' AND A.Enabled = '1' AND A.DeviceID==B.ID)",
+		"SELECT DeviceID, DelimitedValue, TargetType, TargetVariable, TargetDeviceID, TargetProperty, IncludeUnit FROM HttpLink "
+		"WHERE (DeviceID == '%" PRIu64 "' AND Enabled = '1')",
 		m_DeviceRowIdx);
 	if (!result.empty())
 	{
@@ -91,20 +94,20 @@ void CHttpPush::DoHttpPush()
 			std::string sdeviceId = sd[0].c_str();
 			std::string ldelpos = sd[1].c_str();
 			int delpos = atoi(sd[1].c_str());
-			int dType = atoi(sd[3].c_str());
-			int dSubType = atoi(sd[4].c_str());
-			int nValue = atoi(sd[5].c_str());
-			std::string sValue = sd[6].c_str();
-			//int targetType = atoi(sd[7].c_str());
-			std::string targetVariable = sd[8].c_str();
-			//int targetDeviceID = atoi(sd[9].c_str());
-			//std::string targetProperty = sd[10].c_str();
-			int includeUnit = atoi(sd[11].c_str());
-			int metertype = atoi(sd[12].c_str());
-			int lastUpdate = atoi(sd[13].c_str());
-			std::string ltargetVariable = sd[8].c_str();
-			std::string ltargetDeviceId = sd[9].c_str();
-			std::string lname = sd[14].c_str();
+			int dType = pUpdate->Type;
+			int dSubType = pUpdate->SubType;
+			int nValue = pUpdate->nValue;
+			std::string sValue = pUpdate->sValue;
+			//int targetType = atoi(sd[2].c_str());
+			std::string targetVariable = sd[3].c_str();
+			//int targetDeviceID = atoi(sd[4].c_str());
+			//std::string targetProperty = sd[5].c_str();
+			int includeUnit = atoi(sd[6].c_str());
+			int metertype = pUpdate->SwitchType;
+			int lastUpdate = (int)pUpdate->LastUpdateSeconds;
+			std::string ltargetVariable = sd[3].c_str();
+			std::string ltargetDeviceId = sd[4].c_str();
+			std::string lname = pUpdate->Name;
 			sendValue = sValue;
 
 			unsigned long tzoffset = get_tzoffset();
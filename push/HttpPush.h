@@ -12,7 +12,7 @@ public:
 
 private:
 
-	void OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand);
-	void DoHttpPush();
+	void OnDeviceReceived(const DeviceUpdatePtr &pUpdate);
+	void DoHttpPush(const DeviceUpdatePtr &pUpdate);
 };
 extern CHttpPush m_httppush;
@@ -33,15 +33,18 @@ bool CInfluxPush::Start()
 	m_thread = std::make_shared<std::thread>(&CInfluxPush::Do_Work, this);
 	SetThreadName(m_thread->native_handle(), "InfluxPush");
 
-	m_sConnection = m_mainworker.sOnDeviceReceived.connect(boost::bind(&CInfluxPush::OnDeviceReceived, this, _1, _2, _3, _4));
+	m_DeviceUpdateSubscription = m_mainworker.m_deviceupdates.Subscribe("InfluxPush", [this](const DeviceUpdatePtr &pUpdate) { OnDeviceReceived(pUpdate); });
 
 	return (m_thread != NULL);
 }
 
 void CInfluxPush::Stop()
 {
-	if (m_sConnection.connected())
-		m_sConnection.disconnect();
+	if (m_DeviceUpdateSubscription != 0)
+	{
+		m_mainworker.m_deviceupdates.Unsubscribe(m_DeviceUpdateSubscription);
+		m_DeviceUpdateSubscription = 0;
+	}
 
 	if (m_thread)
 	{
@@ -90,21 +93,21 @@ void CInfluxPush::UpdateSettings()
 	m_szURL = sURL.str();
 }
 
-void CInfluxPush::OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand)
+void CInfluxPush::OnDeviceReceived(const DeviceUpdatePtr &pUpdate)
 {
-	m_DeviceRowIdx = DeviceRowIdx;
-	if (m_bLinkActive)
+	m_DeviceRowIdx = pUpdate->DeviceRowIdx;
+	if ((m_bLinkActive) && (pUpdate->bHaveStatus))
 	{
-		DoInfluxPush();
+		DoInfluxPush(pUpdate);
 	}
 }
 
-void CInfluxPush::DoInfluxPush()
+void CInfluxPush::DoInfluxPush(const DeviceUpdatePtr &pUpdate)
 {
 	std::vector<std::vector<std::string> > result;
 	result = m_sql.safe_query(
-		"SELECT A.DeviceID, A.DelimitedValue, B.ID, B.Type, B.SubType, B.nValue, B.sValue, A.TargetType, A.TargetVariable, A.TargetDeviceID, A.TargetProperty, A.IncludeUnit, B.Name, B.SwitchType FROM PushLink as A, DeviceStatus as B "
-		"WHERE (A.PushType==1 AND A.DeviceID == '%" PRIu64 "' AND A.Enabled==1 AND A.DeviceID==B.ID)",
+		"SELECT DeviceID, DelimitedValue, TargetType, TargetVariable, TargetDeviceID, TargetProperty, IncludeUnit FROM PushLink "
+		"WHERE (PushType==1 AND DeviceID == '%" PRIu64 "' AND Enabled==1)",
 		m_DeviceRowIdx);
 	if (!result.empty())
 	{
@@ -115,17 +118,17 @@ void CInfluxPush::DoInfluxPush()
 		{
 			std::vector<std::string> sd = *itt;
 			int delpos = atoi(sd[1].c_str());
-			int dType = atoi(sd[3].c_str());
-			int dSubType = atoi(sd[4].c_str());
-			int nValue = atoi(sd[5].c_str());
-			std::string sValue = sd[6].c_str();
-			int targetType = atoi(sd[7].c_str());
-			//std::string targetVariable = sd[8].c_str();
-			//int targetDeviceID = atoi(sd[9].c_str());
-			//std::string targetProperty = sd[10].c_str();
-			int includeUnit = atoi(sd[11].c_str());
-			std::string name = sd[12];
-			int metertype = atoi(sd[13].c_str());
+			int dType = pUpdate->Type;
+			int dSubType = pUpdate->SubType;
+			int nValue = pUpdate->nValue;
+			std::string sValue = pUpdate->sValue;
+			int targetType = atoi(sd[2].c_str());
+			//std::string targetVariable = sd[3].c_str();
+			//int targetDeviceID = atoi(sd[4].c_str());
+			//std::string targetProperty = sd[5].c_str();
+			int includeUnit = atoi(sd[6].c_str());
+			std::string name = pUpdate->Name;
+			int metertype = pUpdate->SwitchType;
 
 			std::vector<std::string> strarray;
 			if (sValue.find(";") != std::string::npos) {
@@ -205,9 +208,14 @@ void CInfluxPush::Do_Work()
 			sSendData += sziData.str();
 			++itt;
 		}
+		//the points carry their own timestamp, so they can be sent without waiting for the previous batch
 		std::vector<std::string> ExtraHeaders;
-		std::string sResult;
-		if (!HTTPClient::POST(m_szURL, sSendData, ExtraHeaders, sResult, true, true))
+		if (!HTTPClient::SendAsync(HTTPClient::HTTP_METHOD_POST, m_szURL, sSendData, ExtraHeaders,
+			[](const bool bOK, const long /*http_code*/, const std::vector<unsigned char> & /*response*/)
+			{
+				if (!bOK)
+					_log.Log(LOG_ERROR, "InfluxLink: Error sending data to InfluxDB server! (check address/port/database/username/password)");
+			}))
 		{
 			_log.Log(LOG_ERROR, "InfluxLink: Error sending data to InfluxDB server! (check address/port/database/username/password)");
 		}
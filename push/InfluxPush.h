@@ -15,8 +15,8 @@ public:
 	void Stop();
 	void UpdateSettings();
 private:
-	void OnDeviceReceived(const int m_HwdID, const uint64_t DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand);
-	void DoInfluxPush();
+	void OnDeviceReceived(const DeviceUpdatePtr &pUpdate);
+	void DoInfluxPush(const DeviceUpdatePtr &pUpdate);
 
 	std::shared_ptr<std::thread> m_thread;
 	std::mutex m_background_task_mutex;
@@ -19,7 +19,7 @@ void CWebSocketPush::Start()
 	if (isStarted) {
 		return;
 	}
-	m_sConnection = m_mainworker.sOnDeviceReceived.connect(boost::bind(&CWebSocketPush::OnDeviceReceived, this, _1, _2, _3, _4));
+	m_DeviceUpdateSubscription = m_mainworker.m_deviceupdates.Subscribe("WebSocketPush", [this](const DeviceUpdatePtr &pUpdate) { OnDeviceReceived(pUpdate); });
 	m_sNotification = sOnNotificationReceived.connect(boost::bind(&CWebSocketPush::OnNotificationReceived, this, _1, _2, _3, _4, _5, _6));
 	m_sSceneChanged = m_mainworker.sOnSwitchScene.connect(boost::bind(&CWebSocketPush::OnSceneChange, this, _1, _2));
 	isStarted = true;
@@ -30,10 +30,14 @@ void CWebSocketPush::Stop()
 	if (!isStarted) 
 		return;
 
-	std::unique_lock<std::mutex> lock(handlerMutex);
+	//outside the handler lock, the subscriber thread could be waiting for it
+	if (m_DeviceUpdateSubscription != 0)
+	{
+		m_mainworker.m_deviceupdates.Unsubscribe(m_DeviceUpdateSubscription);
+		m_DeviceUpdateSubscription = 0;
+	}
 
-	if (m_sConnection.connected())
-		m_sConnection.disconnect();
+	std::unique_lock<std::mutex> lock(handlerMutex);
 
 	if (m_sNotification.connected())
 		m_sNotification.disconnect();
@@ -106,15 +110,15 @@ bool CWebSocketPush::WeListenTo(const unsigned long long DeviceRowIdx)
 	return std::find(listenIdxs.begin(), listenIdxs.end(), DeviceRowIdx) != listenIdxs.end();
 }
 
-void CWebSocketPush::OnDeviceReceived(const int m_HwdID, const unsigned long long DeviceRowIdx, const std::string &DeviceName, const unsigned char *pRXCommand)
+void CWebSocketPush::OnDeviceReceived(const DeviceUpdatePtr &pUpdate)
 {
 	std::unique_lock<std::mutex> lock(handlerMutex);
 	if (!isStarted) {
 		return;
 	}
 
-	m_sock->OnDeviceChanged(DeviceRowIdx);
-	if (WeListenTo(DeviceRowIdx)) {
+	m_sock->OnDeviceChanged(pUpdate->DeviceRowIdx);
+	if (WeListenTo(pUpdate->DeviceRowIdx)) {
 		// push notification to web socket
 	}
 }
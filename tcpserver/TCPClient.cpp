@@ -5,6 +5,9 @@
 #include "../main/Logger.h"
 #include "../webserver/proxyclient.h"
 
+//a client that has this much data waiting is not keeping up, it is disconnected (and will resync when it reconnects)
+#define MAX_CLIENT_PENDING_DATA (256 * 1024)
+
 namespace tcp {
 namespace server {
 
@@ -21,7 +24,10 @@ CTCPClientBase::~CTCPClientBase(void)
 }
 
 CTCPClient::CTCPClient(boost::asio::io_service& ios, CTCPServerIntBase *pManager)
-	: CTCPClientBase(pManager)
+	: CTCPClientBase(pManager),
+	ios_(ios),
+	writing_(false),
+	overflow_(false)
 {
 	socket_ = new boost::asio::ip::tcp::socket(ios);
 }
@@ -97,11 +103,61 @@ void CTCPClient::write(const char *pData, size_t Length)
 {
 	if (!m_bIsLoggedIn)
 		return;
-	boost::asio::async_write(*socket_, boost::asio::buffer(pData, Length),
-		boost::bind(&CTCPClient::handleWrite, shared_from_this(),
+	std::lock_guard<std::mutex> l(write_mutex_);
+	if (overflow_)
+		return;
+	if (pending_data_.size() + Length > MAX_CLIENT_PENDING_DATA)
+	{
+		overflow_ = true;
+		_log.Log(LOG_ERROR, "Shared server: client %s (%s) can not keep up, disconnecting...", m_username.c_str(), m_endpoint.c_str());
+		ios_.post(boost::bind(&CTCPClient::handleOverflow, shared_from_this()));
+		return;
+	}
+	pending_data_.append(pData, Length);
+	if (!writing_)
+	{
+		//the write is started from the io_service thread, frames queued in the meantime go out with it
+		writing_ = true;
+		ios_.post(boost::bind(&CTCPClient::startQueuedWrite, shared_from_this()));
+	}
+}
+
+void CTCPClient::startQueuedWrite()
+{
+	{
+		std::lock_guard<std::mutex> l(write_mutex_);
+		write_data_.clear();
+		write_data_.swap(pending_data_);
+	}
+	boost::asio::async_write(*socket_, boost::asio::buffer(write_data_),
+		boost::bind(&CTCPClient::handleQueuedWrite, shared_from_this(),
 		boost::asio::placeholders::error));
 }
 
+void CTCPClient::handleQueuedWrite(const boost::system::error_code& error)
+{
+	if (error)
+	{
+		if (error != boost::asio::error::operation_aborted)
+			pConnectionManager->stopClient(shared_from_this());
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> l(write_mutex_);
+		if (pending_data_.empty())
+		{
+			writing_ = false;
+			return;
+		}
+	}
+	startQueuedWrite();
+}
+
+void CTCPClient::handleOverflow()
+{
+	pConnectionManager->stopClient(shared_from_this());
+}
+
 void CTCPClient::handleWrite(const boost::system::error_code& error)
 {
 	if (error)
@@ -3,6 +3,8 @@
 #include "../main/Noncopyable.h"
 #include <boost/asio.hpp>
 #include <boost/array.hpp>
+#include <memory>
+#include <mutex>
 
 namespace http {
 	namespace server {
@@ -14,6 +16,7 @@ namespace tcp {
 namespace server {
 
 class CTCPServerIntBase;
+struct _tRemoteSharePermissions;
 
 class CTCPClientBase : 
 	private domoticz::noncopyable
@@ -30,6 +33,8 @@ public:
 	std::string m_username;
 	std::string m_endpoint;
 	bool m_bIsLoggedIn;
+	//devices this client may receive, set when it authenticates or the shared users change (guarded by the connection mutex of the server)
+	std::shared_ptr<const _tRemoteSharePermissions> m_pSharePermissions;
 
 	// usual tcp parameters
 	boost::asio::ip::tcp::socket *socket() { return socket_; }
@@ -53,10 +58,22 @@ public:
 private:
 	void handleRead(const boost::system::error_code& error, size_t length);
 	void handleWrite(const boost::system::error_code& error);
+	void startQueuedWrite();
+	void handleQueuedWrite(const boost::system::error_code& error);
+	void handleOverflow();
+
+	boost::asio::io_service& ios_;
 
 	/// Buffer for incoming data.
 	boost::array<char, 8192> buffer_;
 
+	/// Outgoing frames are queued and written in batches, one write at a time
+	std::mutex write_mutex_;
+	std::string pending_data_;
+	std::string write_data_;
+	bool writing_;
+	bool overflow_;
+
 };
 
 #ifndef NOCLOUD
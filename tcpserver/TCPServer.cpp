@@ -135,11 +135,15 @@ _tRemoteShareUser* CTCPServerIntBase::FindUser(const std::string &username)
 
 bool CTCPServerIntBase::HandleAuthentication(CTCPClient_ptr c, const std::string &username, const std::string &password)
 {
+	std::lock_guard<std::mutex> l(connectionMutex);
 	_tRemoteShareUser *pUser=FindUser(username);
 	if (pUser==NULL)
 		return false;
 
-	return ((pUser->Username==username)&&(pUser->Password==password));
+	if ((pUser->Username!=username)||(pUser->Password!=password))
+		return false;
+	c->m_pSharePermissions = m_permissions[username];
+	return true;
 }
 
 void CTCPServerIntBase::DoDecodeMessage(const CTCPClientBase *pClient, const unsigned char *pRXCommand)
@@ -178,10 +182,32 @@ void CTCPServerIntBase::SetRemoteUsers(const std::vector<_tRemoteShareUser> &use
 {
 	std::lock_guard<std::mutex> l(connectionMutex);
 	m_users=users;
+
+	m_permissions.clear();
+	for (const auto & itt : m_users)
+	{
+		std::shared_ptr<_tRemoteSharePermissions> pPermissions = std::make_shared<_tRemoteSharePermissions>();
+		pPermissions->bAllDevices = itt.Devices.empty();
+		pPermissions->Devices.insert(itt.Devices.begin(), itt.Devices.end());
+		m_permissions[itt.Username] = pPermissions;
+	}
+
+	//connected clients get the new permissions, clients of removed users do not receive anything anymore
+	for (const auto & itt : connections_)
+	{
+		if (!itt->m_bIsLoggedIn)
+			continue;
+		std::map<std::string, std::shared_ptr<const _tRemoteSharePermissions> >::const_iterator ittPermissions = m_permissions.find(itt->m_username);
+		if (ittPermissions != m_permissions.end())
+			itt->m_pSharePermissions = ittPermissions->second;
+		else
+			itt->m_pSharePermissions.reset();
+	}
 }
 
 unsigned int CTCPServerIntBase::GetUserDevicesCount(const std::string &username)
 {
+	std::lock_guard<std::mutex> l(connectionMutex);
 	_tRemoteShareUser *pUser=FindUser(username);
 	if (pUser==NULL)
 		return 0;
@@ -203,34 +229,12 @@ void CTCPServerIntBase::SendToAll(const int /*HardwareID*/, const uint64_t Devic
 	for (itt=connections_.begin(); itt!=connections_.end(); ++itt)
 	{
 		CTCPClientBase *pClient=itt->get();
-		if (pClient==pClient2Ignore)
+		if ((pClient==NULL)||(pClient==pClient2Ignore))
 			continue;
 
-		if (pClient)
-		{
-			_tRemoteShareUser *pUser=FindUser(pClient->m_username);
-			if (pUser!=NULL)
-			{
-				//check if we are allowed to get this device
-				bool bOk2Send=false;
-				if (pUser->Devices.size()==0)
-					bOk2Send=true;
-				else
-				{
-					int tdevices=pUser->Devices.size();
-					for (int ii=0; ii<tdevices; ii++)
-					{
-						if (pUser->Devices[ii]==DeviceRowID)
-						{
-							bOk2Send=true;
-							break;
-						}
-					}
-				}
-				if (bOk2Send)
-					pClient->write(pData,Length);
-			}
-		}
+		//check if we are allowed to get this device
+		if ((pClient->m_pSharePermissions)&&(pClient->m_pSharePermissions->IsAllowed(DeviceRowID)))
+			pClient->write(pData,Length);
 	}
 }
 
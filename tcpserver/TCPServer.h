@@ -2,7 +2,9 @@
 
 #include "../hardware/DomoticzHardware.h"
 #include "TCPClient.h"
+#include <map>
 #include <set>
+#include <unordered_set>
 
 namespace tcp {
 namespace server {
@@ -16,6 +18,18 @@ struct _tRemoteShareUser
 	std::vector<uint64_t> Devices;
 };
 
+//The devices a shared user may receive, resolved once when the users are set
+struct _tRemoteSharePermissions
+{
+	bool bAllDevices;	//a user without devices gets all devices
+	std::unordered_set<uint64_t> Devices;
+
+	bool IsAllowed(const uint64_t DeviceRowID) const
+	{
+		return (bAllDevices || (Devices.find(DeviceRowID) != Devices.end()));
+	}
+};
+
 #define RemoteMessage_id_Low 0xE2
 #define RemoteMessage_id_High 0x2E
 #define SECONDS_PER_DAY 60*60*24
@@ -57,6 +71,7 @@ protected:
 	void DoDecodeMessage(const CTCPClientBase *pClient, const unsigned char *pRXCommand);
 
 	std::vector<_tRemoteShareUser> m_users;
+	std::map<std::string, std::shared_ptr<const _tRemoteSharePermissions> > m_permissions;
 	CTCPServer *m_pRoot;
 
 	std::set<CTCPClient_ptr> connections_;
@@ -1,7 +1,7 @@
 #include "stdafx.h"
 #include "WebsocketHandler.h"
 #include "../main/localtime_r.h"
-#include "../main/mainworker.h"
+#include "../main/WorkerServices.h"
 #include "../main/Helper.h"
 #include "../main/json_helper.h"
 #include "cWebem.h"
@@ -227,10 +227,11 @@ namespace http {
 
 		void CWebsocketHandler::SendDateTime()
 		{
-			if (!m_mainworker.m_LastSunriseSet.empty())
+			std::string sLastSunriseSet = g_pWorkerServices->GetLastSunriseSet();
+			if (!sLastSunriseSet.empty())
 			{
 				std::vector<std::string> strarray;
-				StringSplit(m_mainworker.m_LastSunriseSet, ";", strarray);
+				StringSplit(sLastSunriseSet, ";", strarray);
 				if (strarray.size() == 10)
 				{
 					char szTmp[100];
@@ -556,6 +556,28 @@ namespace http {
 			return false;
 		}
 
+
+		/**
+		 * Parse name=value pairs of a query string (or url-encoded post content) starting at 'start',
+		 * only the values are url-decoded (the browser sends blanks as +, handled by url_decode).
+		 */
+		void cWebem::ParseQueryString(const std::string &query, size_t start, std::multimap<std::string, std::string> &parameters)
+		{
+			size_t p = start;
+			while (p <= query.size())
+			{
+				size_t q = query.find('=', p);
+				if (q == std::string::npos)
+					break;
+				size_t e = query.find('&', q + 1);
+				if (e == std::string::npos)
+					e = query.size();
+
+				std::multimap<std::string, std::string>::iterator itt = parameters.insert(std::make_pair(query.substr(p, q - p), std::string()));
+				request_handler::url_decode(query.data() + q + 1, e - q - 1, itt->second);
+				p = e + 1;
+			}
+		}
 		bool cWebem::CheckForPageOverride(WebEmSession & session, request& req, reply& rep)
 		{
 			// Decode url to path.
@@ -570,50 +592,11 @@ namespace http {
 
 			req.parameters.clear();
 
-			std::string request_path2 = req.uri; // we need the raw request string to parse the get-request
-			size_t paramPos = request_path2.find_first_of('?');
+			// we need the raw request string to parse the get-request
+			size_t paramPos = req.uri.find_first_of('?');
 			if (paramPos != std::string::npos)
 			{
-				std::string params = request_path2.substr(paramPos + 1);
-				std::string name;
-				std::string value;
-
-				size_t q = 0;
-				size_t p = q;
-				int flag_done = 0;
-				std::string uri = params;
-				while (!flag_done)
-				{
-					q = uri.find("=", p);
-					if (q == std::string::npos)
-					{
-						break;
-					}
-					name = uri.substr(p, q - p);
-					p = q + 1;
-					q = uri.find("&", p);
-					if (q != std::string::npos)
-						value = uri.substr(p, q - p);
-					else
-					{
-						value = uri.substr(p);
-						flag_done = 1;
-					}
-					// the browser sends blanks as +
-					while (1)
-					{
-						size_t p = value.find("+");
-						if (p == std::string::npos)
-							break;
-						value.replace(p, 1, " ");
-					}
-
-					// now, url-decode only the value
-					std::string decoded;
-					request_handler::url_decode(value, decoded);
-					req.parameters.insert(std::pair< std::string, std::string >(name, decoded));
-					p = q + 1;
-				}
+				ParseQueryString(req.uri, paramPos + 1, req.parameters);
 			}
 			if (req.method == "POST")
 			{
@@ -694,46 +677,7 @@ namespace http {
 					} //if (strstr(pContent_Type, "multipart/form-data") != NULL)
 					else if (strstr(pContent_Type, "application/x-www-form-urlencoded") != NULL)
 					{
-						std::string params = req.content;
-						std::string name;
-						std::string value;
-
-						size_t q = 0;
-						size_t p = q;
-						int flag_done = 0;
-						std::string uri = params;
-						while (!flag_done)
-						{
-							q = uri.find("=", p);
-							if (q == std::string::npos)
-							{
-								break;
-							}
-							name = uri.substr(p, q - p);
-							p = q + 1;
-							q = uri.find("&", p);
-							if (q != std::string::npos)
-								value = uri.substr(p, q - p);
-							else
-							{
-								value = uri.substr(p);
-								flag_done = 1;
-							}
-							// the browser sends blanks as +
-							while (1)
-							{
-								size_t p = value.find("+");
-								if (p == std::string::npos)
-									break;
-								value.replace(p, 1, " ");
-							}
-
-							// now, url-decode only the value
-							std::string decoded;
-							request_handler::url_decode(value, decoded);
-							req.parameters.insert(std::pair< std::string, std::string >(name, decoded));
-							p = q + 1;
-						}
+						ParseQueryString(req.content, 0, req.parameters);
 					}
 				}
 			}
@@ -1060,6 +1004,11 @@ namespace http {
 			mySessionStore = sessionStore;
 		}
 
+		server_stats & cWebem::GetServerStats()
+		{
+			return myRequestHandler.stats_;
+		}
+
 		session_store_impl_ptr cWebem::GetSessionStore()
 		{
 			return mySessionStore;
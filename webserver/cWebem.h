@@ -237,6 +237,11 @@ namespace http {
 
 			void SetWebCompressionMode(const _eWebCompressionMode gzmode);
 			_eWebCompressionMode m_gzipmode;
+
+			/// Request throughput/latency statistics of this server
+			server_stats & GetServerStats();
+			/// Add the url-decoded name=value pairs of a query string (or url-encoded post content) from 'start' on
+			static void ParseQueryString(const std::string &query, size_t start, std::multimap<std::string, std::string> &parameters);
 		private:
 			/// store map between include codes and application functions
 			std::map < std::string, webem_include_function > myIncludes;
@@ -36,6 +36,7 @@ namespace http {
 			default_abandoned_timeout_(20 * 60), // 20mn before stopping abandoned connection
 			abandoned_timer_(io_service, boost::posix_time::seconds(default_abandoned_timeout_)),
 			default_max_requests_(20),
+			requests_handled_(0),
 			send_buffer_(NULL)
 		{
 			secure_ = false;
@@ -61,6 +62,7 @@ namespace http {
 			default_abandoned_timeout_(20 * 60), // 20mn before stopping abandoned connection
 			abandoned_timer_(io_service, boost::posix_time::seconds(default_abandoned_timeout_)),
 			default_max_requests_(20),
+			requests_handled_(0),
 			send_buffer_(NULL)
 		{
 			secure_ = true;
@@ -103,6 +105,8 @@ namespace http {
 				return;
 			}
 			host_endpoint_address_ = endpoint.address().to_string();
+			if (request_handler_.stats_.enabled())
+				request_handler_.stats_.connection_opened();
 			//std::stringstream sstr;
 			//sstr << endpoint.port();
 			//sstr >> host_endpoint_port_;
@@ -404,6 +408,10 @@ namespace http {
 						if (request_.host_address.substr(0, 7) == "::ffff:") {
 							request_.host_address = request_.host_address.substr(7);
 						}
+						const bool bRecordStats = request_handler_.stats_.enabled();
+						std::chrono::steady_clock::time_point start_time;
+						if (bRecordStats)
+							start_time = std::chrono::steady_clock::now();
 						request_handler_.handle_request(request_, reply_);
 
 						if (reply_.status == reply::switching_protocols) {
@@ -439,7 +447,11 @@ namespace http {
 							reply::add_header_if_absent(&reply_, "Keep-Alive", ss.str());
 						}
 
-						MyWrite(reply_.to_string(request_.method));
+						std::string reply_data = reply_.to_string(request_.method);
+						if (bRecordStats && (reply_.status != reply::switching_protocols)) {
+							record_request(request_, start_time, reply_data.size());
+						}
+						MyWrite(reply_data);
 						if (reply_.status == reply::switching_protocols) {
 							// this was an upgrade request, set this value after MyWrite to allow the 101 response to go out
 							connection_type = connection_websocket;
@@ -468,7 +480,19 @@ namespace http {
 				case connection_websocket:
 				case connection_websocket_closing:
 					begin = boost::asio::buffer_cast<const char*>(_buf.data());
-					result = websocket_parser.parse((const unsigned char*)begin, _buf.size(), bytes_consumed, keepalive_);
+					if (!request_handler_.stats_.enabled())
+					{
+						result = websocket_parser.parse((const unsigned char*)begin, _buf.size(), bytes_consumed, keepalive_);
+					}
+					else
+					{
+						std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+						result = websocket_parser.parse((const unsigned char*)begin, _buf.size(), bytes_consumed, keepalive_);
+						if (result) {
+							uint64_t usec = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+							request_handler_.stats_.record(server_stats::category_websocket, usec, 0);
+						}
+					}
 					_buf.consume(bytes_consumed);
 					if (result) {
 						// we received a complete packet (that was handled already)
@@ -499,6 +523,19 @@ namespace http {
 			}
 		}
 
+		void connection::record_request(const request& req, const std::chrono::steady_clock::time_point& start_time, const size_t bytes_out)
+		{
+			uint64_t usec = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+			server_stats::request_category category = server_stats::category_other;
+			if (req.uri.find("json.htm") != std::string::npos)
+				category = server_stats::category_json;
+			else if (req.method == "GET")
+				category = server_stats::category_file;
+			request_handler_.stats_.record(category, usec, bytes_out);
+			if (++requests_handled_ > 1)
+				request_handler_.stats_.connection_reused();
+		}
+
 		void connection::handle_write(const boost::system::error_code& error, size_t bytes_transferred)
 		{
 			std::unique_lock<std::mutex> lock(writeMutex);
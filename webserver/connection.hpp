@@ -15,6 +15,7 @@
 #include <boost/array.hpp>
 #include <deque>
 #include <fstream>
+#include <chrono>
 #include "reply.hpp"
 #include "request.hpp"
 #include "request_handler.hpp"
@@ -75,6 +76,9 @@ namespace http {
 			void handle_read(const boost::system::error_code& e, std::size_t bytes_transferred);
 			void read_more();
 
+			/// Update the server statistics for a handled request
+			void record_request(const request& req, const std::chrono::steady_clock::time_point& start_time, const size_t bytes_out);
+
 			/// Handle completion of a write operation.
 			void handle_write(const boost::system::error_code& e, size_t bytes_transferred);
 			/// Protect the write queue
@@ -153,6 +157,9 @@ namespace http {
 			/// The default number of request to handle with the connection when keep-alive is enabled
 			unsigned int default_max_requests_;
 
+			/// Number of requests handled on this connection (for keep-alive statistics)
+			unsigned int requests_handled_;
+
 			// secure connection members below
 			// secure connection yes/no
 			bool secure_;
@@ -0,0 +1,136 @@
+#include "stdafx.h"
+#include "file_cache.hpp"
+#include <fstream>
+#include <sys/stat.h>
+#include "GZipHelper.h"
+
+#ifdef WIN32
+#define stat _stat
+#endif
+
+// Files larger than this are read from disk on every request
+#define FILE_CACHE_MAX_FILE_SIZE (1024 * 1024)
+// Maximum memory used by all cached files together
+#define FILE_CACHE_MAX_TOTAL_SIZE (32 * 1024 * 1024)
+
+namespace http {
+namespace server {
+
+file_cache::file_cache() :
+	m_total_size(0)
+{
+}
+
+bool file_cache::is_compressible(const std::string &extension)
+{
+	return (
+		(extension == "js")
+		|| (extension == "htm")
+		|| (extension == "html")
+		|| (extension == "css")
+		|| (extension == "json")
+		|| (extension == "svg")
+		|| (extension == "txt")
+		|| (extension == "xml")
+		);
+}
+
+std::shared_ptr<const file_cache::entry> file_cache::get(const std::string &full_path, const std::string &extension)
+{
+	struct stat st;
+	if (stat(full_path.c_str(), &st) != 0)
+		return std::shared_ptr<const entry>();
+	if (((st.st_mode & S_IFMT) != S_IFREG) || (st.st_size > FILE_CACHE_MAX_FILE_SIZE))
+		return std::shared_ptr<const entry>();
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		std::map<std::string, std::shared_ptr<const entry> >::const_iterator itt = m_entries.find(full_path);
+		if (itt != m_entries.end())
+		{
+			if ((itt->second->mtime == st.st_mtime) && (itt->second->size == (size_t)st.st_size))
+				return itt->second;
+		}
+	}
+
+	// (Re)load the file outside the lock
+	std::ifstream is(full_path.c_str(), std::ios::in | std::ios::binary);
+	if (!is.is_open())
+		return std::shared_ptr<const entry>();
+
+	std::shared_ptr<entry> pEntry = std::make_shared<entry>();
+	pEntry->content.reserve((size_t)st.st_size);
+	pEntry->content.append((std::istreambuf_iterator<char>(is)), (std::istreambuf_iterator<char>()));
+	pEntry->mtime = st.st_mtime;
+	pEntry->size = (size_t)st.st_size;
+	pEntry->has_includes = (pEntry->content.find("<!--#embed") != std::string::npos);
+
+	char szETag[50];
+	sprintf(szETag, "\"%llx-%llx\"", (unsigned long long)st.st_mtime, (unsigned long long)st.st_size);
+	pEntry->etag = szETag;
+
+	if ((!pEntry->has_includes) && (!pEntry->content.empty()) && is_compressible(extension))
+	{
+		CA2GZIP gzip((char*)pEntry->content.c_str(), (int)pEntry->content.size());
+		if ((gzip.Length > 0) && (gzip.Length < (int)pEntry->content.size()))
+			pEntry->gzip_content.assign((const char*)gzip.pgzip, gzip.Length);
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	std::map<std::string, std::shared_ptr<const entry> >::iterator itt = m_entries.find(full_path);
+	if (itt != m_entries.end())
+	{
+		m_total_size -= itt->second->content.size() + itt->second->gzip_content.size();
+		m_entries.erase(itt);
+	}
+	size_t entry_size = pEntry->content.size() + pEntry->gzip_content.size();
+	if (m_total_size + entry_size > FILE_CACHE_MAX_TOTAL_SIZE)
+	{
+		// start over, the files in use will be loaded again on their next request
+		m_entries.clear();
+		m_total_size = 0;
+	}
+	m_entries[full_path] = pEntry;
+	m_total_size += entry_size;
+	return pEntry;
+}
+
+bool file_cache::etag_match(const char *if_none_match, const std::string &etag)
+{
+	if ((if_none_match == NULL) || etag.empty())
+		return false;
+	std::string value = if_none_match;
+	if (value == "*")
+		return true;
+	// list of (possibly weak) entity tags
+	size_t pos = 0;
+	while (pos < value.size())
+	{
+		size_t end = value.find(',', pos);
+		if (end == std::string::npos)
+			end = value.size();
+		std::string tag = value.substr(pos, end - pos);
+		size_t first = tag.find_first_not_of(" \t");
+		size_t last = tag.find_last_not_of(" \t");
+		if (first != std::string::npos)
+		{
+			tag = tag.substr(first, last - first + 1);
+			if (tag.compare(0, 2, "W/") == 0)
+				tag = tag.substr(2);
+			if (tag == etag)
+				return true;
+		}
+		pos = end + 1;
+	}
+	return false;
+}
+
+void file_cache::clear()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_total_size = 0;
+}
+
+} // namespace server
+} // namespace http
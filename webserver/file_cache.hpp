@@ -0,0 +1,50 @@
+#pragma once
+#ifndef HTTP_FILE_CACHE_HPP
+#define HTTP_FILE_CACHE_HPP
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace http {
+namespace server {
+
+/// In-memory cache for static files served from the www folder.
+/// Entries are validated against the file modification time and size on each lookup,
+/// compressible files get their gzip variant computed once when they are loaded.
+class file_cache
+{
+public:
+	struct entry
+	{
+		std::string content;
+		std::string gzip_content; // empty when not compressible or not smaller
+		std::string etag;
+		time_t mtime;
+		size_t size;
+		bool has_includes; // content contains <!--#embed ...--> tags, handled per request by cWebem
+	};
+
+	file_cache();
+
+	/// Returns the cached file, loading it when needed. Returns NULL for files that
+	/// do not exist, are not regular files or are too large to be cached.
+	std::shared_ptr<const entry> get(const std::string &full_path, const std::string &extension);
+
+	/// Returns true if the If-None-Match header value matches the entity tag
+	static bool etag_match(const char *if_none_match, const std::string &etag);
+
+	void clear();
+private:
+	static bool is_compressible(const std::string &extension);
+
+	std::mutex m_mutex;
+	std::map<std::string, std::shared_ptr<const entry> > m_entries;
+	size_t m_total_size;
+};
+
+} // namespace server
+} // namespace http
+
+#endif // HTTP_FILE_CACHE_HPP
@@ -21,6 +21,7 @@
 #include "request.hpp"
 #include "cWebem.h"
 #include "GZipHelper.h"
+#include "file_cache.hpp"
 
 #include "../main/Logger.h"
 
@@ -193,6 +194,14 @@ bool request_handler::not_modified(const std::string &full_path, const request &
 	return false;
 }
 
+bool request_handler::accepts_gzip(const request &req)
+{
+	if (myWebem->m_gzipmode != WWW_USE_GZIP)
+		return false;
+	const char *encoding_header = request::get_req_header(&req, "Accept-Encoding");
+	return ((encoding_header != NULL) && (strstr(encoding_header, "gzip") != NULL));
+}
+
 void request_handler::handle_request(const request& req, reply& rep)
 {
 	modify_info mInfo;
@@ -337,7 +346,8 @@ void request_handler::handle_request(const request &req, reply &rep, modify_info
 			return;
 		}
 
-		if (request_path.find("styles/") != std::string::npos) 
+		bool bIsThemeFile = (request_path.find("styles/") != std::string::npos);
+		if (bIsThemeFile)
 		{
 			mInfo.mtime_support = false; // ignore caching on theme files
 		}
@@ -349,16 +359,62 @@ void request_handler::handle_request(const request &req, reply &rep, modify_info
 			}
 		}
 
+		std::shared_ptr<const file_cache::entry> pEntry = m_file_cache.get(full_path, (bHaveLoadedgzip) ? "gz" : extension);
+		if (pEntry)
+		{
+			is.close();
+			if ((!bIsThemeFile) && (!pEntry->has_includes))
+			{
+				// the gzip and identity encodings of a file are different representations, each gets its own ETag
+				bool bHasGzipVariant = (bHaveLoadedgzip || (!pEntry->gzip_content.empty()));
+				bool bServeGzip = (bHaveLoadedgzip) ? bHaveGZipSupport : ((!pEntry->gzip_content.empty()) && accepts_gzip(req));
+				std::string etag = pEntry->etag;
+				if (bServeGzip)
+					etag.insert(etag.size() - 1, "-gz");
+				bool bNotModified = file_cache::etag_match(request::get_req_header(&req, "If-None-Match"), etag);
+				if (bNotModified)
+				{
+					mInfo.mtime_support = true;
+					mInfo.is_modified = false;
+					rep = reply::stock_reply(reply::not_modified);
+				}
+				reply::add_header(&rep, "ETag", etag);
+				if (bHasGzipVariant)
+					reply::add_header(&rep, "Vary", "Accept-Encoding");
+				if (bNotModified)
+					return;
+			}
+		}
+
 		// fill out the reply to be sent to the client.
 		if (bHaveLoadedgzip && (!bHaveGZipSupport))
 		{
-			std::string gzcontent((std::istreambuf_iterator<char>(is)),
-				(std::istreambuf_iterator<char>()));
+			std::string gzcontent;
+			if (pEntry)
+				gzcontent = pEntry->content;
+			else
+				gzcontent.assign((std::istreambuf_iterator<char>(is)),
+					(std::istreambuf_iterator<char>()));
 
 			CGZIP2AT<> decompress((LPGZIP)gzcontent.c_str(), gzcontent.size());
 
 			rep.content.append(decompress.psz, decompress.Length);
 		}
+		else if (pEntry)
+		{
+			if ((!bHaveLoadedgzip) && (!pEntry->gzip_content.empty()) && accepts_gzip(req))
+			{
+				// serve the precompressed variant
+				rep.content = pEntry->gzip_content;
+				rep.bIsGZIP = true;
+				bHaveLoadedgzip = true;
+				bHaveGZipSupport = true;
+			}
+			else
+			{
+				rep.content = pEntry->content;
+			}
+		}
 		else
 		{
 			rep.content.append((std::istreambuf_iterator<char>(is)),
@@ -436,41 +492,53 @@ void request_handler::handle_request(const request &req, reply &rep, modify_info
   }
 }
 
+static int hex_value(const char c)
+{
+  if ((c >= '0') && (c <= '9'))
+    return c - '0';
+  if ((c >= 'a') && (c <= 'f'))
+    return c - 'a' + 10;
+  if ((c >= 'A') && (c <= 'F'))
+    return c - 'A' + 10;
+  return -1;
+}
+
 bool request_handler::url_decode(const std::string& in, std::string& out)
+{
+  return url_decode(in.data(), in.size(), out);
+}
+
+bool request_handler::url_decode(const char* in, const size_t length, std::string& out)
 {
   out.clear();
-  out.reserve(in.size());
-  for (std::size_t i = 0; i < in.size(); ++i)
+  out.reserve(length);
+  const char *end = in + length;
+  while (in != end)
   {
-    if (in[i] == '%')
-    {
-      if (i + 3 <= in.size())
-      {
-        int value;
-        std::istringstream is(in.substr(i + 1, 2));
-        if (is >> std::hex >> value)
-        {
-          out += static_cast<char>(value);
-          i += 2;
-        }
-        else
-        {
-          return false;
-        }
-      }
-      else
-      {
-        return false;
-      }
-    }
-    else if (in[i] == '+')
+    // copy plain characters in one go
+    const char *run = in;
+    while ((in != end) && (*in != '%') && (*in != '+'))
+      in++;
+    if (in != run)
+      out.append(run, in);
+    if (in == end)
+      break;
+
+    if (*in == '+')
     {
       out += ' ';
+      in++;
+      continue;
     }
-    else
-    {
-      out += in[i];
-    }
+    // %xx escape
+    if (end - in < 3)
+      return false;
+    int high = hex_value(in[1]);
+    if (high < 0)
+      return false;
+    int low = hex_value(in[2]);
+    out += static_cast<char>((low < 0) ? high : (high << 4) | low);
+    in += 3;
   }
   return true;
 }
@@ -13,6 +13,8 @@
 
 #include <string>
 #include "../main/Noncopyable.h"
+#include "file_cache.hpp"
+#include "server_stats.hpp"
 #ifndef WEBSERVER_DONT_USE_ZIP
 	#include <unzip.h>
 	#define USEWIN32IOAPI
@@ -49,6 +51,7 @@ public:
   /// Perform URL-decoding on a string. Returns false if the encoding was
   /// invalid.
   static bool url_decode(const std::string& in, std::string& out);
+  static bool url_decode(const char* in, const size_t length, std::string& out);
   
   /// The directory containing the files to be served.
   std::string doc_root_;
@@ -56,12 +59,18 @@ public:
   // expose myWebem so we can use it in websocket connections
   cWebem* Get_myWebem();
 
+  /// Request statistics, updated by the connections
+  server_stats stats_;
+
 protected:
   // Webem link to application code
   cWebem* myWebem;
 
 private:
 	bool not_modified(const std::string &full_path, const request &req, reply &rep, modify_info &mInfo);
+	bool accepts_gzip(const request &req);
+	// static files kept in memory
+	file_cache m_file_cache;
 	//zip support
 #ifndef WEBSERVER_DONT_USE_ZIP
 	  zlib_filefunc_def m_ffunc;
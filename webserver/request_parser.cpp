@@ -39,6 +39,7 @@ boost::tribool request_parser::consume(request& req, const char* &pInput, const
     {
       state_ = method;
       req.method.push_back(input);
+      req.headers.reserve(16);
       return boost::indeterminate;
     }
   case method:
@@ -53,7 +54,7 @@ boost::tribool request_parser::consume(request& req, const char* &pInput, const
     }
     else
     {
-      req.method.push_back(input);
+      append_token(req.method, pInput, end, ' ');
       return boost::indeterminate;
     }
   case uri_start:
@@ -79,7 +80,7 @@ boost::tribool request_parser::consume(request& req, const char* &pInput, const
     }
     else
     {
-      req.uri.push_back(input);
+      append_text(req.uri, pInput, end, ' ');
       return boost::indeterminate;
     }
   case http_version_h:
@@ -235,7 +236,7 @@ boost::tribool request_parser::consume(request& req, const char* &pInput, const
     else
     {
       state_ = header_value;
-      req.headers.back().value.push_back(input);
+      append_text(req.headers.back().value, pInput, end, '\r');
       return boost::indeterminate;
     }
   case header_name:
@@ -250,7 +251,7 @@ boost::tribool request_parser::consume(request& req, const char* &pInput, const
     }
     else
     {
-      req.headers.back().name.push_back(input);
+      append_token(req.headers.back().name, pInput, end, ':');
       return boost::indeterminate;
     }
   case space_before_header_value:
@@ -275,7 +276,7 @@ boost::tribool request_parser::consume(request& req, const char* &pInput, const
     }
     else
     {
-      req.headers.back().value.push_back(input);
+      append_text(req.headers.back().value, pInput, end, '\r');
       return boost::indeterminate;
     }
   case expecting_newline_2:
@@ -299,14 +300,9 @@ boost::tribool request_parser::consume(request& req, const char* &pInput, const
 		  {
 			  // this is a post request, so we need to read the content
 			  req.content_length = 0;
-			  for( std::vector<header>::iterator ph = req.headers.begin();  ph != req.headers.end(); ++ph )
-			  {
-				  std::string hname = (*ph).name;
-				  std::transform(hname.begin(), hname.end(), hname.begin(), ::tolower);
-				  if( hname == "content-length" ) {
-					  req.content_length = atoi( (*ph).value.c_str());
-					  break;
-				  }
+			  const char *pContentLength = request::get_req_header(&req, "Content-Length");
+			  if (pContentLength != NULL) {
+				  req.content_length = atoi(pContentLength);
 			  }
 
 			  // check on content_length, we might be done already
@@ -332,7 +328,7 @@ boost::tribool request_parser::consume(request& req, const char* &pInput, const
 		return boost::indeterminate;
 	  }
 	  // read all content
-	  req.content = std::string(pInput, req.content_length);
+	  req.content.assign(pInput, req.content_length);
 	  // adjust input pointer
 	  pInput = end;
 	  // all good
@@ -342,6 +338,23 @@ boost::tribool request_parser::consume(request& req, const char* &pInput, const
   }
 }
 
+void request_parser::append_token(std::string &out, const char* &pInput, const char *end, const char terminator)
+{
+  // the character before pInput has been validated already, take it together with all following token characters
+  const char *pStart = pInput - 1;
+  while ((pInput != end) && (*pInput != terminator) && is_char(*pInput) && !is_ctl(*pInput) && !is_tspecial(*pInput))
+    pInput++;
+  out.append(pStart, pInput);
+}
+
+void request_parser::append_text(std::string &out, const char* &pInput, const char *end, const char terminator)
+{
+  const char *pStart = pInput - 1;
+  while ((pInput != end) && (*pInput != terminator) && !is_ctl(*pInput))
+    pInput++;
+  out.append(pStart, pInput);
+}
+
 bool request_parser::is_char(int c)
 {
   return ((c >= 0) && (c <= 127));
@@ -13,6 +13,7 @@
 
 #include <boost/logic/tribool.hpp>
 #include <boost/tuple/tuple.hpp>
+#include <string>
 
 namespace http {
 namespace server {
@@ -54,6 +55,12 @@ private:
   /// Handle the next character of input.
   boost::tribool consume(request& req, const char* &input, const char *end);
 
+  /// Append the current character and the run of token (resp. text) characters
+  /// following it up to the terminator, so spans are copied at once instead of
+  /// character by character.
+  static void append_token(std::string &out, const char* &input, const char *end, const char terminator);
+  static void append_text(std::string &out, const char* &input, const char *end, const char terminator);
+
   /// Check if a byte is an HTTP character.
   static bool is_char(int c);
 
@@ -9,7 +9,7 @@
 #include "../main/Logger.h"
 #include "../main/Helper.h"
 #include "../main/localtime_r.h"
-#include "../main/mainworker.h"
+#include "../main/WorkerServices.h"
 
 extern bool g_bIsWSL;
 
@@ -115,7 +115,7 @@ void server_base::stop() {
 	io_service_.stop();
 
 	// Deregister heartbeat
-	m_mainworker.HeartbeatRemove(std::string("WebServer:") + settings_.listening_port);
+	g_pWorkerServices->HeartbeatRemove(std::string("WebServer:") + settings_.listening_port);
 }
 
 void server_base::handle_stop() {
@@ -133,7 +133,7 @@ void server_base::heart_beat(const boost::system::error_code& error)
 {
 	if (!error) {
 		// Heartbeat
-		m_mainworker.HeartbeatUpdate(std::string("WebServer:") + settings_.listening_port);
+		g_pWorkerServices->HeartbeatUpdate(std::string("WebServer:") + settings_.listening_port);
 
 		// Schedule next heartbeat
 		m_heartbeat_timer.expires_from_now(std::chrono::seconds(4));
@@ -0,0 +1,132 @@
+#include "stdafx.h"
+#include "server_stats.hpp"
+#include <string.h>
+
+namespace http {
+namespace server {
+
+server_stats::server_stats() :
+	enabled_(false)
+{
+	reset();
+}
+
+void server_stats::enable(const bool bEnable)
+{
+	if (bEnable && !enabled_)
+		reset();
+	enabled_ = bEnable;
+}
+
+void server_stats::reset()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	memset(&categories_, 0, sizeof(categories_));
+	connections_opened_ = 0;
+	connections_reused_ = 0;
+	start_time_ = time(NULL);
+}
+
+const char *server_stats::category_name(const request_category category)
+{
+	switch (category)
+	{
+	case category_json:
+		return "json";
+	case category_file:
+		return "file";
+	case category_websocket:
+		return "websocket";
+	default:
+		break;
+	}
+	return "other";
+}
+
+void server_stats::record(const request_category category, const uint64_t usec, const size_t bytes_out)
+{
+	if (category >= category_max)
+		return;
+
+	// bucket n holds latencies in [2^(n-1), 2^n) microseconds
+	int bucket = 0;
+	uint64_t value = usec;
+	while ((value > 0) && (bucket < histogram_size - 1))
+	{
+		value >>= 1;
+		bucket++;
+	}
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	category_stats &stats = categories_[category];
+	stats.requests++;
+	stats.bytes_out += bytes_out;
+	stats.total_usec += usec;
+	if (usec > stats.max_usec)
+		stats.max_usec = usec;
+	stats.histogram[bucket]++;
+}
+
+void server_stats::connection_opened()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	connections_opened_++;
+}
+
+void server_stats::connection_reused()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	connections_reused_++;
+}
+
+uint64_t server_stats::percentile(const category_stats &stats, const int percent)
+{
+	if (stats.requests == 0)
+		return 0;
+	uint64_t wanted = (stats.requests * percent + 99) / 100;
+	uint64_t seen = 0;
+	for (int ii = 0; ii < histogram_size; ii++)
+	{
+		seen += stats.histogram[ii];
+		if (seen >= wanted)
+		{
+			// report the upper bound of the bucket, but never more than the maximum seen
+			uint64_t upper = (ii == 0) ? 0 : ((uint64_t)1 << ii) - 1;
+			return (upper < stats.max_usec) ? upper : stats.max_usec;
+		}
+	}
+	return stats.max_usec;
+}
+
+void server_stats::get(const request_category category, category_snapshot &snapshot)
+{
+	memset(&snapshot, 0, sizeof(snapshot));
+	if (category >= category_max)
+		return;
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	const category_stats &stats = categories_[category];
+	snapshot.requests = stats.requests;
+	snapshot.bytes_out = stats.bytes_out;
+	snapshot.avg_usec = (stats.requests > 0) ? stats.total_usec / stats.requests : 0;
+	snapshot.max_usec = stats.max_usec;
+	snapshot.p50_usec = percentile(stats, 50);
+	snapshot.p90_usec = percentile(stats, 90);
+	snapshot.p99_usec = percentile(stats, 99);
+}
+
+void server_stats::get_connections(uint64_t &opened, uint64_t &reused)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	opened = connections_opened_;
+	reused = connections_reused_;
+}
+
+time_t server_stats::uptime()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	return time(NULL) - start_time_;
+}
+
+} // namespace server
+} // namespace http
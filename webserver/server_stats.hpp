@@ -0,0 +1,82 @@
+#pragma once
+#ifndef HTTP_SERVER_STATS_HPP
+#define HTTP_SERVER_STATS_HPP
+
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <time.h>
+
+namespace http {
+namespace server {
+
+/// Throughput and latency statistics of a webem server, collected by the connections.
+/// Latencies are kept in a log2 histogram (microseconds) so percentiles can be
+/// reported without storing individual samples.
+/// Collection is off by default, the connections only time requests while enabled.
+class server_stats
+{
+public:
+	enum request_category
+	{
+		category_json = 0,
+		category_file,
+		category_websocket,
+		category_other,
+		category_max
+	};
+
+	struct category_snapshot
+	{
+		uint64_t requests;
+		uint64_t bytes_out;
+		uint64_t avg_usec;
+		uint64_t max_usec;
+		uint64_t p50_usec;
+		uint64_t p90_usec;
+		uint64_t p99_usec;
+	};
+
+	server_stats();
+
+	bool enabled() const { return enabled_; }
+	/// Start or stop collecting, enabling also resets the statistics
+	void enable(const bool bEnable);
+
+	/// Record one handled request (or websocket frame) and its processing time
+	void record(const request_category category, const uint64_t usec, const size_t bytes_out);
+	/// Record a new connection, requests >1 on the same connection are counted as keep-alive reuse
+	void connection_opened();
+	void connection_reused();
+
+	void get(const request_category category, category_snapshot &snapshot);
+	void get_connections(uint64_t &opened, uint64_t &reused);
+	/// Seconds since the statistics were (re)started
+	time_t uptime();
+	void reset();
+
+	static const char *category_name(const request_category category);
+private:
+	enum { histogram_size = 32 };
+	struct category_stats
+	{
+		uint64_t requests;
+		uint64_t bytes_out;
+		uint64_t total_usec;
+		uint64_t max_usec;
+		uint64_t histogram[histogram_size];
+	};
+	static uint64_t percentile(const category_stats &stats, const int percent);
+
+	std::atomic<bool> enabled_;
+	std::mutex mutex_;
+	category_stats categories_[category_max];
+	uint64_t connections_opened_;
+	uint64_t connections_reused_;
+	time_t start_time_;
+};
+
+} // namespace server
+} // namespace http
+
+#endif // HTTP_SERVER_STATS_HPP
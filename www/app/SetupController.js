@@ -459,6 +459,9 @@ define(['app'], function (app) {
 					if (typeof data.SensorTimeout != 'undefined') {
 						$("#timeouttable #SensorTimeout").val(data.SensorTimeout);
 					}
+					if (typeof data.CameraSnapshotMaxAge != 'undefined') {
+						$("#camerasnapshottable #CameraSnapshotMaxAge").val(data.CameraSnapshotMaxAge);
+					}
 					if (typeof data.BatterLowLevel != 'undefined') {
 						$("#batterytable #BatterLowLevel").val(data.BatterLowLevel);
 					}
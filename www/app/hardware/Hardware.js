@@ -741,8 +741,12 @@ define(['app'], function (app) {
 				var headers = $("#hardwarecontent #divhttppoller #headers").val();
 				var postdata = $("#hardwarecontent #divhttppoller #postdata").val();
 				var extra = btoa(script) + "|" + btoa(method) + "|" + btoa(contenttype) + "|" + btoa(headers);
-				if (method == "1") {
-					extra = extra + "|" + btoa(postdata);
+				var skipunchanged = $("#hardwarecontent #divhttppoller #skipunchanged").is(":checked");
+				if ((method == "1") || (skipunchanged)) {
+					extra = extra + "|" + btoa((method == "1") ? postdata : "");
+				}
+				if (skipunchanged) {
+					extra = extra + "|" + btoa("1");
 				}
 
 				$.ajax({
@@ -1175,7 +1179,9 @@ define(['app'], function (app) {
 					url: "json.htm?type=command&param=updatehardware&htype=" + hardwaretype + "&name=" + encodeURIComponent(name) +
 					"&enabled=" + bEnabled + "&datatimeout=" + datatimeout	+
 					"&idx=" + idx +
-					"&extra=" + encodeURIComponent($("#hardwarecontent #hardwareparamsrtl433 #rtl433cmdline").val()),
+					"&extra=" + encodeURIComponent($("#hardwarecontent #hardwareparamsrtl433 #rtl433cmdline").val()) +
+					"&Mode1=" + $("#hardwarecontent #hardwareparamsrtl433 #rtl433format").val() +
+					"&username=" + encodeURIComponent($("#hardwarecontent #hardwareparamsrtl433 #rtl433allowed").val()),
 					async: false,
 					dataType: 'json',
 					success: function (data) {
@@ -1290,7 +1296,9 @@ define(['app'], function (app) {
 				$.ajax({
 					url: "json.htm?type=command&param=addhardware&htype=" + hardwaretype + "&name=" + encodeURIComponent(name) +
 					"&enabled=" + bEnabled + "&datatimeout=" + datatimeout	+
-					"&extra=" + encodeURIComponent($("#hardwarecontent #hardwareparamsrtl433 #rtl433cmdline").val()),
+					"&extra=" + encodeURIComponent($("#hardwarecontent #hardwareparamsrtl433 #rtl433cmdline").val()) +
+					"&Mode1=" + $("#hardwarecontent #hardwareparamsrtl433 #rtl433format").val() +
+					"&username=" + encodeURIComponent($("#hardwarecontent #hardwareparamsrtl433 #rtl433allowed").val()),
 					async: false,
 					dataType: 'json',
 					success: function (data) {
@@ -1973,8 +1981,12 @@ define(['app'], function (app) {
 				var postdata = $("#hardwarecontent #divhttppoller #postdata").val();
 
 				var extra = btoa(script) + "|" + btoa(method) + "|" + btoa(contenttype) + "|" + btoa(headers);
-				if (method == "1") {
-					extra = extra + "|" + btoa(postdata);
+				var skipunchanged = $("#hardwarecontent #divhttppoller #skipunchanged").is(":checked");
+				if ((method == "1") || (skipunchanged)) {
+					extra = extra + "|" + btoa((method == "1") ? postdata : "");
+				}
+				if (skipunchanged) {
+					extra = extra + "|" + btoa("1");
 				}
 				$.ajax({
 					url: "json.htm?type=command&param=addhardware&htype=" + hardwaretype + "&port=" + refresh + "&username=" + encodeURIComponent(username) + "&password=" + encodeURIComponent(password) + "&name=" + encodeURIComponent(name) + "&address=" + encodeURIComponent(url) + "&extra=" + extra + "&enabled=" + bEnabled + "&datatimeout=" + datatimeout,
@@ -3614,6 +3626,7 @@ define(['app'], function (app) {
 								if (tmparray.length >= 5) {
 									$("#hardwarecontent #hardwareparamshttp #postdata").val(atob(tmparray[4]));
 								}
+								$("#hardwarecontent #hardwareparamshttp #skipunchanged").prop("checked", (tmparray.length >= 6) && (atob(tmparray[5]) == "1"));
 								if (atob(tmparray[1]) == 1) {
 									$("#hardwarecontent #hardwareparamshttp #divpostdatalabel").show();
 									$("#hardwarecontent #hardwareparamshttp #divpostdatatextarea").show();
@@ -3727,6 +3740,8 @@ define(['app'], function (app) {
 						}
 						else if (data["Type"].indexOf("Rtl433") >= 0) {
 							$("#hardwarecontent #hardwareparamsrtl433 #rtl433cmdline").val(data["Extra"]);
+							$("#hardwarecontent #hardwareparamsrtl433 #rtl433format").val(data["Mode1"]);
+							$("#hardwarecontent #hardwareparamsrtl433 #rtl433allowed").val(data["Username"]);
 						}
 						if (
 							(data["Type"].indexOf("Domoticz") >= 0) ||